@@ -9,10 +9,18 @@
 // TODO: Check value of MICROS_PER_TICK
 
 #include "Timer.h"
+#include "profile.h"
 
 // 65000 gives a countdown time of exactly 65ms TODO: is it 65000 or 64999?
 #define MICROS_PER_TICK 64999UL // Number of microseconds in one timer cycle
 
+/**
+ * @brief ISR handler to increment the timeout variable for tracking total
+ * milliseconds
+ *
+ */
+static void timer_clockTickHandler(void);
+
 /**
  * @brief Tracks if the clock is currently running or stopped
  *
@@ -197,7 +205,11 @@ void timer_waitMillis(uint32_t delay_time) {
  * milliseconds
  *
  */
-static void timer_clockTickHandler() {
+static void timer_clockTickHandler(void) {
+    PROFILE_BEGIN(ISR_CLOCK);
+
     TIMER5_ICR_R |= TIMER_ICR_TATOCINT; // Clear interrupt flag
     _timeout_ticks++;
+
+    PROFILE_END(ISR_CLOCK);
 }
@@ -108,11 +108,4 @@ void timer_fireOnce(void (*f)(void), int millis);
  */
 void timer_fireFor(void (*f)(void), int millis, int times);
 
-/**
- * @brief ISR handler to increment the timeout variable for tracking total
- * milliseconds
- *
- */
-static void timer_clockTickHandler();
-
 #endif /* TIMER_H_ */
@@ -0,0 +1,280 @@
+/*
+ * avoid.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "avoid.h"
+#include "profile.h"
+
+#define AVOID_BACKUP_MM 100     // Backed off before planning
+#define AVOID_BACKUP_SPEED 100  // (mm/s)
+#define AVOID_TURN_SPEED 100    // Wheel speed turning in place (mm/s)
+#define AVOID_REJOIN_MM 700     // Back on the leg this far past where the robot was stopped
+#define AVOID_ATTEMPTS 8        // Plans per detour before the leg just carries on
+#define AVOID_ARRIVED_MM 30     // Waypoints this close are skipped
+#define AVOID_TURN_TOLERANCE 3  // Heading error (deg) a turn stops at, about one tick of turning
+#define AVOID_SETTLE_MS 300     // Rest after stopping, the odometry catches up with the coasting
+
+#define AVOID_RAD(deg) ((deg) * (M_PI / 180))
+
+/**
+ * Switch state and note the change for the caller
+ */
+static void avoid_enter(avoid_t *avoid, avoid_state_t state, uint32_t now)
+{
+    avoid->changed = 1;
+    avoid->previous = avoid->state;
+    avoid->spent = now - avoid->entered;
+    avoid->state = state;
+    avoid->entered = now;
+}
+
+/**
+ * Stop the wheels and rest before going on to a state
+ */
+static void avoid_settle(avoid_t *avoid, avoid_state_t next, uint32_t now)
+{
+    avoid->right = 0;
+    avoid->left = 0;
+    avoid->next = next;
+    avoid_enter(avoid, AVOID_SETTLE, now);
+}
+
+/**
+ * Something was hit: back off and plan again, or give up and face the leg
+ */
+static void avoid_contact(avoid_t *avoid, const oi_t *sensor, uint32_t now)
+{
+    avoid->fromX = sensor->poseX;
+    avoid->fromY = sensor->poseY;
+    avoid_settle(avoid, avoid->attempt < AVOID_ATTEMPTS ? AVOID_BACKUP : AVOID_FACE, now);
+}
+
+static int avoid_hit(const oi_t *sensor)
+{
+    return sensor->bumpLeft || sensor->bumpRight
+        || sensor->cliffLeft || sensor->cliffFrontLeft || sensor->cliffFrontRight || sensor->cliffRight;
+}
+
+/**
+ * Heading error to a heading, -180 to 180 (deg)
+ */
+static double avoid_error(const oi_t *sensor, double heading)
+{
+    double error = heading - sensor->poseHeading;
+
+    while (error > 180) {
+        error -= 360;
+    }
+    while (error <= -180) {
+        error += 360;
+    }
+    return error;
+}
+
+/**
+ * Turn in place towards a heading
+ *
+ * @returns 1 once the heading is reached (the wheels are then stopped)
+ */
+static int avoid_turn(avoid_t *avoid, const oi_t *sensor, double heading)
+{
+    double error = avoid_error(sensor, heading);
+
+    if (error > AVOID_TURN_TOLERANCE) {
+        avoid->right = AVOID_TURN_SPEED;
+        avoid->left = -AVOID_TURN_SPEED;
+        return 0;
+    }
+    if (error < -AVOID_TURN_TOLERANCE) {
+        avoid->right = -AVOID_TURN_SPEED;
+        avoid->left = AVOID_TURN_SPEED;
+        return 0;
+    }
+
+    avoid->right = 0;
+    avoid->left = 0;
+    return 1;
+}
+
+/**
+ * Go on to the next waypoint worth driving to, or plan again / face the leg when there is none
+ */
+static void avoid_nextWaypoint(avoid_t *avoid, const oi_t *sensor, uint32_t now)
+{
+    while (avoid->waypoint < avoid->path.count)
+    {
+        const plan_point_t *point = &avoid->path.points[avoid->waypoint++];
+        double dx = point->x - sensor->poseX;
+        double dy = point->y - sensor->poseY;
+
+        if (dx * dx + dy * dy >= AVOID_ARRIVED_MM * AVOID_ARRIVED_MM) {
+            avoid->toX = point->x;
+            avoid->toY = point->y;
+            avoid_enter(avoid, AVOID_TURN, now);
+            return;
+        }
+    }
+
+    // A detour too long for one path is driven in parts, each part a fresh plan
+    if (!avoid->path.complete && avoid->attempt < AVOID_ATTEMPTS) {
+        avoid_enter(avoid, AVOID_PLAN, now);
+    } else {
+        avoid_enter(avoid, AVOID_FACE, now);
+    }
+}
+
+/**
+ * Start a detour from the current pose
+ *
+ * @param avoid - Detour to start
+ * @param sensor - Sensor object with the pose, the robot should face along the leg
+ * @param remaining - Distance left on the leg, the detour does not rejoin past it (mm)
+ * @param speed - Forward driving speed (mm/s)
+ * @param now - Current time (ms)
+ */
+void avoid_start(avoid_t *avoid, const oi_t *sensor, int remaining, int speed, uint32_t now)
+{
+    int rejoin = remaining < AVOID_REJOIN_MM ? remaining : AVOID_REJOIN_MM;
+
+    avoid->state = AVOID_IDLE;
+    avoid->entered = now;
+    avoid->attempt = 0;
+    avoid->waypoint = 0;
+    avoid->speed = speed;
+    avoid->legX = sensor->poseX;
+    avoid->legY = sensor->poseY;
+    avoid->legHeading = sensor->poseHeading;
+    avoid->goalX = avoid->legX + rejoin * cos(AVOID_RAD(avoid->legHeading));
+    avoid->goalY = avoid->legY + rejoin * sin(AVOID_RAD(avoid->legHeading));
+    avoid->path.count = 0;
+    avoid->scan = 0;
+
+    // Whatever was hit is behind the first backup
+    avoid_contact(avoid, sensor, now);
+}
+
+/**
+ * Advance the detour by one control tick, then carry out right, left and scan
+ *
+ * @param avoid - Detour in progress
+ * @param sensor - Latest sensor frame
+ * @param now - Current time (ms)
+ *
+ * @returns 1 while the detour is running, 0 once it is DONE (or was never started)
+ */
+int avoid_step(avoid_t *avoid, const oi_t *sensor, uint32_t now)
+{
+    double dx, dy;
+
+    avoid->changed = 0;
+    avoid->scan = 0;
+
+    switch (avoid->state)
+    {
+    case AVOID_IDLE:
+    case AVOID_DONE:
+        return 0;
+
+    case AVOID_SETTLE:
+        if (now - avoid->entered >= AVOID_SETTLE_MS) {
+            avoid->fromX = sensor->poseX;
+            avoid->fromY = sensor->poseY;
+            avoid_enter(avoid, avoid->next, now);
+        }
+        break;
+
+    case AVOID_BACKUP:
+        dx = sensor->poseX - avoid->fromX;
+        dy = sensor->poseY - avoid->fromY;
+        if (dx * dx + dy * dy >= AVOID_BACKUP_MM * AVOID_BACKUP_MM) {
+            avoid_settle(avoid, AVOID_PLAN, now);
+        } else {
+            avoid->right = -AVOID_BACKUP_SPEED;
+            avoid->left = -AVOID_BACKUP_SPEED;
+        }
+        break;
+
+    case AVOID_PLAN: {
+        PROFILE_BEGIN(PLAN);
+        int found = plan_find(sensor->poseX, sensor->poseY, avoid->goalX, avoid->goalY, &avoid->path);
+        PROFILE_END(PLAN);
+
+        avoid->attempt++;
+        avoid->waypoint = 0;
+        if (found < 0) {
+            avoid->path.count = 0;
+            avoid_enter(avoid, avoid->attempt < AVOID_ATTEMPTS ? AVOID_BACKUP : AVOID_FACE, now);
+        } else {
+            avoid_nextWaypoint(avoid, sensor, now);
+        }
+        break;
+    }
+
+    case AVOID_TURN:
+        if (avoid_hit(sensor)) {
+            avoid_contact(avoid, sensor, now);
+        } else if (avoid_turn(avoid, sensor, atan2(avoid->toY - sensor->poseY, avoid->toX - sensor->poseX) * (180 / M_PI))) {
+            avoid_settle(avoid, AVOID_SCAN, now);
+        }
+        break;
+
+    case AVOID_SCAN:
+        // The caller scans before the next step; the segment starts where the robot stands
+        avoid->scan = 1;
+        avoid_enter(avoid, AVOID_DRIVE, now);
+        break;
+
+    case AVOID_DRIVE:
+        if (avoid_hit(sensor)) {
+            avoid_contact(avoid, sensor, now);
+            break;
+        }
+
+        // Progress along the segment, not the distance to the waypoint, so drifting sideways cannot stall it
+        dx = avoid->toX - avoid->fromX;
+        dy = avoid->toY - avoid->fromY;
+        if ((sensor->poseX - avoid->fromX) * dx + (sensor->poseY - avoid->fromY) * dy >= dx * dx + dy * dy) {
+            avoid->right = 0;
+            avoid->left = 0;
+            avoid_nextWaypoint(avoid, sensor, now);
+        } else {
+            avoid->right = avoid->speed;
+            avoid->left = avoid->speed;
+        }
+        break;
+
+    case AVOID_FACE:
+        if (avoid_turn(avoid, sensor, avoid->legHeading)) {
+            avoid_enter(avoid, AVOID_DONE, now);
+            return 0;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return 1;
+}
+
+/**
+ * How far the detour moved the robot, in the frame of the leg
+ *
+ * @param avoid - Detour, normally DONE
+ * @param sensor - Sensor object with the pose
+ * @param along - Distance moved along the leg (mm)
+ * @param left - Distance moved to the left of the leg (mm)
+ */
+void avoid_offset(const avoid_t *avoid, const oi_t *sensor, double *along, double *left)
+{
+    double ux = cos(AVOID_RAD(avoid->legHeading));
+    double uy = sin(AVOID_RAD(avoid->legHeading));
+    double dx = sensor->poseX - avoid->legX;
+    double dy = sensor->poseY - avoid->legY;
+
+    *along = dx * ux + dy * uy;
+    *left = dy * ux - dx * uy;
+}
@@ -0,0 +1,115 @@
+/*
+ * avoid.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Obstacle avoidance as a state machine stepped once per control tick.
+ *  avoid_step() never waits: it looks at the latest sensor frame and the
+ *  time, maybe changes state, and leaves the wheel speeds it wants (and
+ *  whether it wants a roadway scan) in the avoid_t for the caller to carry
+ *  out. Between steps the control loop keeps answering commands, sending
+ *  telemetry and logging, and a host simulation can drive it tick by tick
+ *  with made-up sensor frames.
+ *
+ *  A detour: back off AVOID_BACKUP_MM, plan over the grid (plan.h), then
+ *  for every waypoint turn to it, scan the roadway and drive to it, and at
+ *  the end face the leg again. Any bump or cliff on the way goes back to
+ *  backing off and planning, up to AVOID_ATTEMPTS plans. Every change of
+ *  state is flagged in changed with the state left and the time spent in
+ *  it, which the caller sends as a telemetry AVOID record.
+ */
+
+#ifndef AVOID_H_
+#define AVOID_H_
+
+#include "open_interface.h"
+#include "plan.h"
+
+#include <stdint.h>
+
+/**
+ * States, X(id, "name"). The names are for tools/telemetry.py, which reads
+ * them from this file to decode AVOID records; append new states at the end.
+ */
+#define AVOID_STATES(X) \
+    X(IDLE,   "idle")   /* Not avoiding anything */ \
+    X(BACKUP, "backup") /* Reversing off what was hit */ \
+    X(SETTLE, "settle") /* Wheels stopped, letting the robot come to rest */ \
+    X(PLAN,   "plan")   /* Planning the detour, takes one step */ \
+    X(TURN,   "turn")   /* Turning towards the next waypoint */ \
+    X(SCAN,   "scan")   /* Asking for a roadway scan before driving */ \
+    X(DRIVE,  "drive")  /* Driving to the waypoint */ \
+    X(FACE,   "face")   /* Turning back to the heading of the leg */ \
+    X(DONE,   "done")   /* Back on the leg, avoid_offset() has the result */
+
+typedef enum
+{
+#define AVOID_ENUM(id, name) AVOID_##id,
+    AVOID_STATES(AVOID_ENUM)
+#undef AVOID_ENUM
+    AVOID_NUM_STATES
+} avoid_state_t;
+
+// Typedef struct - One detour in progress
+typedef struct avoid
+{
+    avoid_state_t state;
+    avoid_state_t next;     // Where SETTLE goes once the robot is at rest
+    uint32_t entered;       // Time the state was entered (ms)
+    uint8_t attempt;        // Plans made
+    uint8_t waypoint;       // Next waypoint of path
+    int16_t speed;          // Forward driving speed (mm/s)
+    double legX;            // Pose when the detour started, the leg runs along heading
+    double legY;
+    double legHeading;
+    double goalX;           // Where the detour rejoins the leg
+    double goalY;
+    double fromX;           // Where the current backup or segment started
+    double fromY;
+    double toX;             // Waypoint being driven to
+    double toY;
+    plan_path_t path;
+
+    // What the caller has to do after each step
+    int16_t right;          // Wheel speeds (mm/s)
+    int16_t left;
+    uint8_t scan;           // Run a roadway scan before the next step
+    uint8_t changed;        // The state changed this step
+    avoid_state_t previous; // State left, when changed
+    uint32_t spent;         // Time spent in it (ms), when changed
+} avoid_t;
+
+/**
+ * Start a detour from the current pose
+ *
+ * @param avoid - Detour to start
+ * @param sensor - Sensor object with the pose, the robot should face along the leg
+ * @param remaining - Distance left on the leg, the detour does not rejoin past it (mm)
+ * @param speed - Forward driving speed (mm/s)
+ * @param now - Current time (ms)
+ */
+void avoid_start(avoid_t *avoid, const oi_t *sensor, int remaining, int speed, uint32_t now);
+
+/**
+ * Advance the detour by one control tick, then carry out right, left and scan
+ *
+ * @param avoid - Detour in progress
+ * @param sensor - Latest sensor frame
+ * @param now - Current time (ms)
+ *
+ * @returns 1 while the detour is running, 0 once it is DONE (or was never started)
+ */
+int avoid_step(avoid_t *avoid, const oi_t *sensor, uint32_t now);
+
+/**
+ * How far the detour moved the robot, in the frame of the leg
+ *
+ * @param avoid - Detour, normally DONE
+ * @param sensor - Sensor object with the pose
+ * @param along - Distance moved along the leg (mm)
+ * @param left - Distance moved to the left of the leg (mm)
+ */
+void avoid_offset(const avoid_t *avoid, const oi_t *sensor, double *along, double *left);
+
+#endif /* AVOID_H_ */
@@ -14,6 +14,21 @@
 // GPIO_PORTE_DATA_R -- Name of the memory mapped register for GPIO Port E, 
 // which is connected to the push buttons
 #include "button.h"
+#include "profile.h"
+#include "Timer.h"
+
+#include "driverlib/interrupt.h"
+
+#define BUTTON_PINS 0x0F
+
+static button_state_t button_states[BUTTON_COUNT];
+
+static button_event_t button_queue[BUTTON_QUEUE_SIZE];
+static volatile uint32_t button_head; // Next event to write
+static volatile uint32_t button_tail; // Next event to read
+
+static void button_edgeHandler(void);
+static void button_tickHandler(void);
 
 /**
  * Initialize PORTE and configure bits 0-3 to be used as inputs for the buttons.
@@ -45,6 +60,30 @@ void button_init() {
 	// 3) Enable digital functionality for button inputs, 
 	//    do not modify other PORTE enables
 	GPIO_PORTE_DEN_R |= 0x0F;
+
+	// Interrupt on both edges of the button pins, the tick takes over from the first one
+	GPIO_PORTE_IM_R &= ~BUTTON_PINS;
+	GPIO_PORTE_IS_R &= ~BUTTON_PINS;
+	GPIO_PORTE_IBE_R |= BUTTON_PINS;
+	GPIO_PORTE_ICR_R = BUTTON_PINS;
+	IntRegister(INT_GPIOE, button_edgeHandler);
+	NVIC_EN0_R |= (1 << 4);          // Enable GPIO Port E interrupts
+
+	// TIMER4A samples the buttons while any of them is settling or pressed
+	SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R4;
+	timer_waitMillis(1);
+	TIMER4_CTL_R &= ~TIMER_CTL_TAEN;
+	TIMER4_CFG_R = TIMER_CFG_16_BIT;
+	TIMER4_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
+	TIMER4_TAPR_R = 0x0F;            // 1us per count
+	TIMER4_TAILR_R = BUTTON_TICK_MS * 1000 - 1;
+	TIMER4_ICR_R = TIMER_ICR_TATOCINT;
+	TIMER4_IMR_R |= TIMER_IMR_TATOIM;
+	NVIC_PRI17_R |= NVIC_PRI17_INTC_M; // Priority 7 (lowest)
+	NVIC_EN2_R |= (1 << 6);          // Enable TIMER4A interrupts
+	IntRegister(INT_TIMER4A, button_tickHandler);
+
+	GPIO_PORTE_IM_R |= BUTTON_PINS;
 	
 	initialized = 1;
 }
@@ -67,7 +106,104 @@ uint8_t button_getButton() {
 	return 0;
 }
 
+/**
+ * Take the oldest debounced event
+ * @param event - Filled in with the event
+ * @return 1 if there was an event, 0 if the queue is empty
+ */
+int button_getEvent(button_event_t *event) {
+	if (button_tail == button_head) {
+		return 0;
+	}
+
+	*event = button_queue[button_tail & (BUTTON_QUEUE_SIZE - 1)];
+	button_tail++;
+	return 1;
+}
 
+/**
+ * Queue an event, only called from the tick so there is a single writer
+ */
+static void button_post(uint8_t button, button_event_type_t type) {
+	button_event_t *event;
 
+	if (button_head - button_tail >= BUTTON_QUEUE_SIZE) {
+		return; // Nobody is reading, drop it
+	}
 
+	event = &button_queue[button_head & (BUTTON_QUEUE_SIZE - 1)];
+	event->button = button;
+	event->type = type;
+	event->time = timer_getMillis();
+	button_head++;
+}
 
+/**
+ * First edge of a press or a release: stop listening to the bouncing contacts
+ * and let the tick sample them
+ */
+static void button_edgeHandler(void) {
+	GPIO_PORTE_IM_R &= ~BUTTON_PINS;
+	GPIO_PORTE_ICR_R = BUTTON_PINS;
+	TIMER4_CTL_R |= TIMER_CTL_TAEN;
+}
+
+/**
+ * One debounce tick of every button, the TIMER4A tick calls it with the pins it read
+ * @param states - Debounce state of the BUTTON_COUNT buttons, all zero to start with
+ * @param raw - Buttons reading pressed, bit 0 is button 1
+ * @param post - Called with each event found, button 1 is the leftmost
+ * @return 1 while any button is pressed or settling, 0 once all are released and settled
+ */
+int button_debounce(button_state_t states[BUTTON_COUNT], uint8_t raw,
+		void (*post)(uint8_t button, button_event_type_t type)) {
+	uint8_t i;
+	uint8_t busy = 0;
+
+	for (i = 0; i < BUTTON_COUNT; i++) {
+		button_state_t *state = &states[i];
+		uint8_t pressed = (raw >> i) & 1;
+
+		if (pressed != state->pressed) {
+			if (++state->settle >= BUTTON_DEBOUNCE_MS / BUTTON_TICK_MS) {
+				state->pressed = pressed;
+				state->settle = 0;
+				state->held = 0;
+				post(i + 1, pressed ? BUTTON_PRESS : BUTTON_RELEASE);
+			}
+		} else {
+			state->settle = 0;
+		}
+
+		if (state->pressed && state->held < BUTTON_LONG_MS / BUTTON_TICK_MS) {
+			if (++state->held == BUTTON_LONG_MS / BUTTON_TICK_MS) {
+				post(i + 1, BUTTON_LONG_PRESS);
+			}
+		}
+
+		busy |= state->pressed || state->settle;
+	}
+
+	return busy;
+}
+
+/**
+ * Debounce tick, a reading only counts once it has been stable for BUTTON_DEBOUNCE_MS
+ */
+static void button_tickHandler(void) {
+	uint8_t raw;
+
+	TIMER4_ICR_R = TIMER_ICR_TATOCINT;
+	PROFILE_BEGIN(ISR_BUTTON);
+
+	raw = ~GPIO_PORTE_DATA_R & BUTTON_PINS; // Pressed reads low
+
+	// All released and settled: back to waiting for an edge
+	if (!button_debounce(button_states, raw, button_post)) {
+		TIMER4_CTL_R &= ~TIMER_CTL_TAEN;
+		GPIO_PORTE_ICR_R = BUTTON_PINS;
+		GPIO_PORTE_IM_R |= BUTTON_PINS;
+	}
+
+	PROFILE_END(ISR_BUTTON);
+}
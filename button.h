@@ -13,8 +13,51 @@
 #include <stdint.h>
 #include <inc/tm4c123gh6pm.h>
 
+/*
+ * An edge on any button raises the Port E interrupt, which hands over to a
+ * 5ms TIMER4A sampling tick. A button must read the same for
+ * BUTTON_DEBOUNCE_MS before it counts as pressed or released; held for
+ * BUTTON_LONG_MS it also reports a long press. Events are queued for
+ * button_getEvent(). The tick stops and the edge interrupt is re-armed once
+ * every button is released. The debouncing itself is button_debounce(),
+ * which touches no hardware.
+ */
+
+#define BUTTON_TICK_MS 5
+#define BUTTON_DEBOUNCE_MS 20
+#define BUTTON_LONG_MS 800
+
+// Pending events kept (power of two), further events are dropped
+#define BUTTON_QUEUE_SIZE 8
+
+#define BUTTON_COUNT 4
+
+typedef enum
+{
+	BUTTON_PRESS = 0,
+	BUTTON_RELEASE = 1,
+	BUTTON_LONG_PRESS = 2 // Held for BUTTON_LONG_MS, the RELEASE still follows
+} button_event_type_t;
+
+// Typedef struct - One debounced button event
+typedef struct button_event
+{
+	uint8_t button;           // 1 is the leftmost button, 4 the rightmost
+	button_event_type_t type;
+	uint32_t time;            // timer_getMillis() when it was detected
+} button_event_t;
+
+// Typedef struct - Debounce state of one button
+typedef struct button_state
+{
+	uint8_t pressed;   // Debounced state
+	uint8_t settle;    // Ticks the raw reading has differed from the debounced state
+	uint16_t held;     // Ticks the button has been pressed
+} button_state_t;
+
 /**
  * Initialize PORTE and configure bits 0-3 to be used as inputs for the buttons.
+ * Also sets up the edge interrupt and the TIMER4A debounce tick.
  */
 void button_init();
 
@@ -24,4 +67,21 @@ void button_init();
  */
 uint8_t button_getButton();
 
+/**
+ * Take the oldest debounced event
+ * @param event - Filled in with the event
+ * @return 1 if there was an event, 0 if the queue is empty
+ */
+int button_getEvent(button_event_t *event);
+
+/**
+ * One debounce tick of every button, the TIMER4A tick calls it with the pins it read
+ * @param states - Debounce state of the BUTTON_COUNT buttons, all zero to start with
+ * @param raw - Buttons reading pressed, bit 0 is button 1
+ * @param post - Called with each event found, button 1 is the leftmost
+ * @return 1 while any button is pressed or settling, 0 once all are released and settled
+ */
+int button_debounce(button_state_t states[BUTTON_COUNT], uint8_t raw,
+		void (*post)(uint8_t button, button_event_type_t type));
+
 #endif /* BUTTON_H_ */
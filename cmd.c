@@ -0,0 +1,226 @@
+/*
+ * cmd.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "cmd.h"
+#include "telemetry.h"
+#include "uart.h"
+
+#include <ctype.h>
+#include <string.h>
+
+static const char *const cmd_verbNames[CMD_NUM_VERBS] = {
+#define CMD_NAME(id, verb, maxArgs) verb,
+    CMD_VERBS(CMD_NAME)
+#undef CMD_NAME
+};
+
+static const uint8_t cmd_maxArgs[CMD_NUM_VERBS] = {
+#define CMD_MAX(id, verb, maxArgs) maxArgs,
+    CMD_VERBS(CMD_MAX)
+#undef CMD_MAX
+};
+
+// Single keys typed on an empty line
+static const struct
+{
+    char key;
+    cmd_verb_t verb;
+    uint8_t argc;
+    int16_t args[CMD_MAX_ARGS];
+} cmd_keys[] = {
+    { 'r', CMD_STOP,    0, { 0, 0 } },
+    { 't', CMD_START,   0, { 0, 0 } },
+    { 'p', CMD_PROFILE, 0, { 0, 0 } },
+    { 'x', CMD_TRACE,   0, { 0, 0 } },
+    { 'c', CMD_CLEAR,   0, { 0, 0 } },
+    { 'm', CMD_TELEOP,  0, { 0, 0 } },
+    { 'e', CMD_AUTO,    0, { 0, 0 } },
+    { 'w', CMD_DRIVE,   2, { 150, 0 } },
+    { 's', CMD_DRIVE,   2, { -150, 0 } },
+    { 'a', CMD_DRIVE,   2, { 0, 45 } },
+    { 'd', CMD_DRIVE,   2, { 0, -45 } },
+};
+
+#define CMD_NUM_KEYS ((int)(sizeof(cmd_keys) / sizeof(cmd_keys[0])))
+
+static char cmd_line[CMD_LINE_SIZE];
+static uint8_t cmd_length;
+static char cmd_overflow; // Current line is too long, skip to its end
+
+/**
+ * Skip spaces
+ */
+static const char *cmd_skipSpaces(const char *s)
+{
+    while (*s == ' ' || *s == '\t') {
+        s++;
+    }
+    return s;
+}
+
+/**
+ * Read a decimal number, the pointer is moved past it
+ *
+ * @returns 1 if there was a number, 0 if there was none or it is beyond +-INT32_MAX
+ */
+static int cmd_parseInt(const char **s, int32_t *value)
+{
+    const char *p = *s;
+    int negative = 0;
+    int32_t result = 0;
+
+    if (*p == '-') {
+        negative = 1;
+        p++;
+    }
+    if (!isdigit((unsigned char)*p)) {
+        return 0;
+    }
+    while (isdigit((unsigned char)*p))
+    {
+        int digit = *p++ - '0';
+        if (result > (INT32_MAX - digit) / 10) {
+            return 0;
+        }
+        result = result * 10 + digit;
+    }
+
+    *value = negative ? -result : result;
+    *s = p;
+    return 1;
+}
+
+/**
+ * Parse one complete line
+ *
+ * @returns 1 if the line is a valid command
+ */
+static int cmd_parseLine(char *line, cmd_t *cmd)
+{
+    const char *s = cmd_skipSpaces(line);
+    char *end = line + strlen(line);
+    int32_t id;
+    int i, n;
+
+    cmd->id = 0;
+    cmd->argc = 0;
+
+    // Trailing spaces too, so only what was typed is left
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t')) {
+        *--end = '\0';
+    }
+    if (*s == '\0') {
+        return 0; // Blank line
+    }
+
+    if (!cmd_parseInt(&s, &id) || id <= 0 || id > 0xFFFF) {
+        return 0; // Without an id there is nobody to answer
+    }
+    cmd->id = (uint16_t)id;
+    s = cmd_skipSpaces(s);
+
+    for (i = 0; i < CMD_NUM_VERBS; i++)
+    {
+        const char *name = cmd_verbNames[i];
+        for (n = 0; name[n] != '\0' && toupper((unsigned char)s[n]) == name[n]; n++);
+
+        if (name[n] == '\0' && (s[n] == '\0' || s[n] == ' ' || s[n] == '\t')) {
+            cmd->verb = (cmd_verb_t)i;
+            s = cmd_skipSpaces(s + n);
+            break;
+        }
+    }
+
+    if (i == CMD_NUM_VERBS) {
+        cmd->verb = CMD_NUM_VERBS;
+        cmd_ack(cmd, CMD_ERR_UNKNOWN);
+        return 0;
+    }
+
+    while (*s != '\0')
+    {
+        if (cmd->argc == cmd_maxArgs[cmd->verb] || !cmd_parseInt(&s, &cmd->args[cmd->argc])) {
+            cmd_ack(cmd, CMD_ERR_ARGUMENT);
+            return 0;
+        }
+        cmd->argc++;
+        s = cmd_skipSpaces(s);
+    }
+
+    return 1;
+}
+
+/**
+ * Parse the received bytes, returns as soon as one command is complete
+ * Malformed lines are acknowledged with an error and skipped
+ *
+ * @param cmd - Filled in with the command
+ *
+ * @returns 1 if a command was parsed, 0 once no complete line is left
+ */
+int cmd_poll(cmd_t *cmd)
+{
+    char c;
+    int i;
+
+    while (uart_tryReceive(&c))
+    {
+        if (c == '\r' || c == '\n')
+        {
+            uint32_t received = uart_rxTime();
+            int complete = cmd_length > 0 && !cmd_overflow;
+            cmd_line[cmd_length] = '\0';
+            cmd_length = 0;
+            cmd_overflow = 0;
+
+            // Stamped with the terminator, not with what arrived after it
+            if (complete && cmd_parseLine(cmd_line, cmd)) {
+                cmd->received = received;
+                return 1;
+            }
+            continue;
+        }
+
+        // Terminal keys
+        if (cmd_length == 0 && !cmd_overflow)
+        {
+            for (i = 0; i < CMD_NUM_KEYS; i++)
+            {
+                if (cmd_keys[i].key == c) {
+                    cmd->id = 0;
+                    cmd->verb = cmd_keys[i].verb;
+                    cmd->argc = cmd_keys[i].argc;
+                    cmd->args[0] = cmd_keys[i].args[0];
+                    cmd->args[1] = cmd_keys[i].args[1];
+                    cmd->received = uart_rxTime();
+                    return 1;
+                }
+            }
+        }
+
+        if (cmd_length < CMD_LINE_SIZE - 1) {
+            cmd_line[cmd_length++] = c;
+        } else {
+            cmd_overflow = 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Acknowledge a command, does nothing for terminal keys (id 0)
+ *
+ * @param cmd - The command being answered
+ * @param status - Result of the command
+ */
+void cmd_ack(const cmd_t *cmd, cmd_status_t status)
+{
+    if (cmd->id != 0) {
+        telemetry_sendAck(cmd->id, cmd->verb < CMD_NUM_VERBS ? cmd->verb : 0xFF, status);
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ * cmd.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Command channel from the control center over UART1. The UART1 ISR only
+ *  queues received bytes; cmd_poll() assembles them into lines at thread
+ *  level and parses
+ *
+ *    <id> <VERB> [argument [argument]]\r
+ *
+ *  where id is a request number from 1 to 65535 that is echoed back in the
+ *  telemetry ACK record. Spaces around the line and between the fields are
+ *  ignored and verbs are not case sensitive. For use from a plain
+ *  terminal a single key typed on an empty line is also a command with id 0,
+ *  which is never acknowledged: 'r' stop at the next stop, 't' start,
+ *  'p' profile dump, 'x' trace dump, 'c' clear the field map, 'm' teleop,
+ *  'e' back to auto and 'w'/'s'/'a'/'d' drive while held (key repeat keeps
+ *  the dead-man alive).
+ */
+
+#ifndef CMD_H_
+#define CMD_H_
+
+#include <stdint.h>
+
+// Longest accepted line, longer lines are discarded
+#define CMD_LINE_SIZE 32
+
+// Most numeric arguments of one command
+#define CMD_MAX_ARGS 2
+
+/**
+ * Command verbs, X(id, "VERB", most arguments), more arguments are rejected with CMD_ERR_ARGUMENT
+ */
+#define CMD_VERBS(X) \
+    X(START,   "START",   0) /* Start the route */ \
+    X(STOP,    "STOP",    1) /* Stop request at stop n, 0 for the next stop */ \
+    X(SPEED,   "SPEED",   1) /* Set the driving speed (mm/s) */ \
+    X(POSE,    "POSE",    0) /* Send a pose record now */ \
+    X(PROFILE, "PROFILE", 0) /* Send the profile statistics as TEXT records */ \
+    X(TRACE,   "TRACE",   0) /* Send the trace buffer as TRACE records */ \
+    X(TELEOP,  "TELEOP",  0) /* Hand the wheels to the operator */ \
+    X(DRIVE,   "DRIVE",   2) /* Teleop velocity (mm/s, +-500) and turn rate (deg/s, CCW positive, +-240) */ \
+    X(AUTO,    "AUTO",    0) /* Leave teleop and continue the route */ \
+    X(CLEAR,   "CLEAR",   0) /* Forget the hazards of the field map, in flash too */
+
+typedef enum
+{
+#define CMD_ENUM(id, verb, maxArgs) CMD_##id,
+    CMD_VERBS(CMD_ENUM)
+#undef CMD_ENUM
+    CMD_NUM_VERBS
+} cmd_verb_t;
+
+/**
+ * Result sent back in the ACK record
+ */
+typedef enum
+{
+    CMD_OK = 0,
+    CMD_ERR_UNKNOWN = 1,  // Verb not recognised (verb field of the ACK is 0xFF)
+    CMD_ERR_ARGUMENT = 2, // Argument missing or out of range
+    CMD_ERR_STATE = 3     // Not possible right now
+} cmd_status_t;
+
+// Typedef struct - One parsed command
+typedef struct cmd
+{
+    uint16_t id;       // Request id, 0 for terminal keys
+    cmd_verb_t verb;
+    int32_t args[CMD_MAX_ARGS];
+    uint8_t argc;
+    uint32_t received; // profile_now() when its terminator (or key) was received
+} cmd_t;
+
+/**
+ * Parse the received bytes, returns as soon as one command is complete
+ * Malformed lines are acknowledged with an error and skipped
+ *
+ * @param cmd - Filled in with the command
+ *
+ * @returns 1 if a command was parsed, 0 once no complete line is left
+ */
+int cmd_poll(cmd_t *cmd);
+
+/**
+ * Acknowledge a command, does nothing for terminal keys (id 0)
+ *
+ * @param cmd - The command being answered
+ * @param status - Result of the command
+ */
+void cmd_ack(const cmd_t *cmd, cmd_status_t status);
+
+#endif /* CMD_H_ */
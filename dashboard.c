@@ -0,0 +1,239 @@
+/*
+ * dashboard.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "dashboard.h"
+#include "button.h"
+#include "lcd.h"
+#include "profile.h"
+#include "Timer.h"
+#include "uart.h"
+#include "work.h"
+
+#include <stddef.h>
+
+static const char *const dashboard_titles[DASHBOARD_NUM_PAGES] = {
+    "POSE", "LOOP", "LINK", "SCAN"
+};
+
+static dashboard_page_t dashboard_page;
+static const char *dashboard_alertText;
+static unsigned int dashboard_lastDraw;  // timer_getMillis() of the last redraw
+
+// Control loop periods since the last redraw, in profile ticks
+static uint32_t loop_last;
+static uint32_t loop_count;
+static uint32_t loop_min;
+static uint32_t loop_max;
+static uint64_t loop_total;
+
+static int leg_number;
+static int leg_done;
+static int leg_total;
+
+static int scan_objects = -1; // -1 until the first scan
+static int scan_angle;
+static int scan_dist;
+static unsigned int scan_time; // timer_getMillis() of the scan
+
+/**
+ * Reset the statistics and show the pose page
+ */
+void dashboard_init(void)
+{
+    dashboard_page = DASHBOARD_POSE;
+    dashboard_alertText = NULL;
+    dashboard_lastDraw = timer_getMillis();
+    loop_count = 0;
+    loop_last = profile_now();
+    scan_objects = -1;
+}
+
+/**
+ * Select the page to show, drawn at the next dashboard_update()
+ *
+ * @param page - Page to show
+ */
+void dashboard_show(dashboard_page_t page)
+{
+    if (page < DASHBOARD_NUM_PAGES) {
+        dashboard_page = page;
+    }
+}
+
+/**
+ * Show a message in place of the title line, NULL to clear it
+ *
+ * @param text - Message (at most 20 characters are shown), must stay valid while shown
+ */
+void dashboard_alert(const char *text)
+{
+    dashboard_alertText = text;
+}
+
+/**
+ * Record one pass of the control loop, call once per sensor frame
+ */
+void dashboard_loopTick(void)
+{
+    uint32_t now = profile_now();
+    uint32_t period = now - loop_last;
+    loop_last = now;
+
+    if (loop_count == 0 || period < loop_min) {
+        loop_min = period;
+    }
+    if (loop_count == 0 || period > loop_max) {
+        loop_max = period;
+    }
+    loop_total += period;
+    loop_count++;
+}
+
+/**
+ * Record the progress along the current leg of the route
+ *
+ * @param leg - Number of the leg, counted from 1
+ * @param done - Distance driven (mm)
+ * @param total - Length of the leg (mm)
+ */
+void dashboard_setLeg(int leg, int done, int total)
+{
+    leg_number = leg;
+    leg_done = done;
+    leg_total = total;
+}
+
+/**
+ * Record the result of an IR scan
+ *
+ * @param objects - Number of objects found
+ * @param angle - Angle of the nearest object (deg), DASHBOARD_NO_OBJECT without objects
+ * @param dist - Distance of the nearest object (cm), DASHBOARD_NO_OBJECT without objects
+ */
+void dashboard_setScan(int objects, int angle, int dist)
+{
+    scan_objects = objects;
+    scan_angle = angle;
+    scan_dist = dist;
+    scan_time = timer_getMillis();
+}
+
+static void dashboard_drawPose(const oi_t *sensor)
+{
+    lcd_printfLine(1, "x%6d y%6d mm", (int)sensor->poseX, (int)sensor->poseY);
+    lcd_printfLine(2, "hdg %4d v %4d mm/s", (int)sensor->poseHeading,
+                   (sensor->requestedLeftVelocity + sensor->requestedRightVelocity) / 2);
+    if (leg_number > 0) {
+        lcd_printfLine(3, "leg %d %5d/%5d", leg_number, leg_done, leg_total);
+    } else {
+        lcd_printfLine(3, "waiting for START");
+    }
+}
+
+static void dashboard_drawLoop(void)
+{
+    uart_tx_stats_t tx;
+
+    if (loop_count > 0) {
+        uint32_t mean = loop_total / loop_count;
+        uint32_t us = mean / PROFILE_TICKS_PER_US + 1;
+        lcd_printfLine(1, "%3u.%u Hz %5u us", 1000000 / us, 10000000 / us % 10, us);
+        lcd_printfLine(2, "jit -%u +%u us", (mean - loop_min) / PROFILE_TICKS_PER_US,
+                       (loop_max - mean) / PROFILE_TICKS_PER_US);
+    } else {
+        lcd_printfLine(1, "loop stalled");
+        lcd_putsLine(2, "");
+    }
+
+    uart_getTxStats(&tx);
+    lcd_printfLine(3, "drop wk %u tx %u", work_dropped(), tx.dropped);
+}
+
+static void dashboard_drawLink(void)
+{
+    const oi_linkStats_t *link = oi_getLinkStats();
+
+    lcd_printfLine(1, "frames %u", link->frames);
+    lcd_printfLine(2, "bad %u fe %u oe %u", link->badFrames, link->framing, link->overrun);
+    lcd_printfLine(3, "brk %u par %u to %u", link->breaks, link->parity, link->timeouts);
+}
+
+static void dashboard_drawScan(void)
+{
+    if (scan_objects < 0) {
+        lcd_printfLine(1, "no scan yet");
+        lcd_putsLine(2, "");
+        lcd_putsLine(3, "");
+        return;
+    }
+
+    lcd_printfLine(1, "%d objects", scan_objects);
+    if (scan_objects > 0) {
+        lcd_printfLine(2, "near %3d deg %3d cm", scan_angle, scan_dist);
+    } else {
+        lcd_putsLine(2, "road clear");
+    }
+    lcd_printfLine(3, "%u s ago", (timer_getMillis() - scan_time) / 1000);
+}
+
+/**
+ * Handle button events and redraw the page if DASHBOARD_PERIOD_MS has passed or a button was pressed,
+ * call from the main loop
+ *
+ * @param sensor - Latest sensor data
+ */
+void dashboard_update(const oi_t *sensor)
+{
+    unsigned int now = timer_getMillis();
+    button_event_t event;
+    char pressed = 0;
+
+    // Button n shows page n right away, a long press dismisses the alert
+    while (button_getEvent(&event))
+    {
+        if (event.type == BUTTON_PRESS) {
+            dashboard_show((dashboard_page_t)(event.button - 1));
+            pressed = 1;
+        } else if (event.type == BUTTON_LONG_PRESS) {
+            dashboard_alert(NULL);
+            pressed = 1;
+        }
+    }
+
+    if (!pressed && now - dashboard_lastDraw < DASHBOARD_PERIOD_MS) {
+        return;
+    }
+    dashboard_lastDraw = now;
+
+    if (dashboard_alertText != NULL) {
+        lcd_putsLine(0, dashboard_alertText);
+    } else {
+        lcd_printfLine(0, "%d/%d %s", dashboard_page + 1, DASHBOARD_NUM_PAGES, dashboard_titles[dashboard_page]);
+    }
+
+    switch (dashboard_page)
+    {
+    case DASHBOARD_POSE:
+        dashboard_drawPose(sensor);
+        break;
+    case DASHBOARD_LOOP:
+        dashboard_drawLoop();
+        break;
+    case DASHBOARD_LINK:
+        dashboard_drawLink();
+        break;
+    case DASHBOARD_SCAN:
+        dashboard_drawScan();
+        break;
+    default:
+        break;
+    }
+
+    // Statistics cover one redraw period
+    loop_count = 0;
+    loop_total = 0;
+}
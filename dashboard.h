@@ -0,0 +1,87 @@
+/*
+ * dashboard.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Status pages on the 20x4 LCD. dashboard_update() is called from the
+ *  control loop and redraws the selected page at most every
+ *  DASHBOARD_PERIOD_MS; the LCD framebuffer sends only the changed cells in
+ *  the background, so a redraw never waits on the display. Pressing button
+ *  n shows page n at once. An alert (e.g. STOP REQUESTED) replaces the title
+ *  line of every page until it is cleared or any button is held down.
+ */
+
+#ifndef DASHBOARD_H_
+#define DASHBOARD_H_
+
+#include "open_interface.h"
+
+#include <stdint.h>
+
+// Time between redraws
+#define DASHBOARD_PERIOD_MS 250
+
+// Angle and distance passed to dashboard_setScan() when the scan found nothing
+#define DASHBOARD_NO_OBJECT -1
+
+typedef enum
+{
+    DASHBOARD_POSE = 0, // Pose, wheel speed and progress along the current leg
+    DASHBOARD_LOOP = 1, // Control loop rate and period jitter
+    DASHBOARD_LINK = 2, // Sensor link frames and UART errors
+    DASHBOARD_SCAN = 3, // Summary of the last IR scan
+    DASHBOARD_NUM_PAGES
+} dashboard_page_t;
+
+/**
+ * Reset the statistics and show the pose page
+ */
+void dashboard_init(void);
+
+/**
+ * Select the page to show, drawn at the next dashboard_update()
+ *
+ * @param page - Page to show
+ */
+void dashboard_show(dashboard_page_t page);
+
+/**
+ * Show a message in place of the title line, NULL to clear it
+ *
+ * @param text - Message (at most 20 characters are shown), must stay valid while shown
+ */
+void dashboard_alert(const char *text);
+
+/**
+ * Record one pass of the control loop, call once per sensor frame
+ */
+void dashboard_loopTick(void);
+
+/**
+ * Record the progress along the current leg of the route
+ *
+ * @param leg - Number of the leg, counted from 1
+ * @param done - Distance driven (mm)
+ * @param total - Length of the leg (mm)
+ */
+void dashboard_setLeg(int leg, int done, int total);
+
+/**
+ * Record the result of an IR scan
+ *
+ * @param objects - Number of objects found
+ * @param angle - Angle of the nearest object (deg), DASHBOARD_NO_OBJECT without objects
+ * @param dist - Distance of the nearest object (cm), DASHBOARD_NO_OBJECT without objects
+ */
+void dashboard_setScan(int objects, int angle, int dist);
+
+/**
+ * Handle button events and redraw the page if DASHBOARD_PERIOD_MS has passed or a button was pressed,
+ * call from the main loop
+ *
+ * @param sensor - Latest sensor data
+ */
+void dashboard_update(const oi_t *sensor);
+
+#endif /* DASHBOARD_H_ */
@@ -0,0 +1,137 @@
+/*
+ * filter.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "filter.h"
+
+/**
+ * Sort a small buffer in place
+ */
+static void filter_sort(int16_t *samples, int count)
+{
+    int i, j;
+
+    for (i = 1; i < count; i++)
+    {
+        int16_t value = samples[i];
+        for (j = i; j > 0 && samples[j - 1] > value; j--) {
+            samples[j] = samples[j - 1];
+        }
+        samples[j] = value;
+    }
+}
+
+/**
+ * Sum of the samples
+ *
+ * @param samples - Samples
+ * @param count - Number of samples
+ *
+ * @returns the sum
+ */
+int32_t filter_sum(const int16_t *samples, int count)
+{
+    int32_t sum = 0;
+    int i = 0;
+
+#if FILTER_SIMD
+    // Word loads need an aligned start
+    if (((uintptr_t)samples & 2) != 0 && count > 0) {
+        sum = *samples++;
+        count--;
+    }
+
+    // SMLAD with 1 in both halves adds both samples of a word to the sum
+    const int32_t *pairs = (const int32_t *)samples;
+    for (; i + 1 < count; i += 2) {
+        sum = _smlad(*pairs++, 0x00010001, sum);
+    }
+#endif
+
+    for (; i < count; i++) {
+        sum += samples[i];
+    }
+
+    return sum;
+}
+
+/**
+ * Median of the samples, the buffer is sorted in place
+ *
+ * @param samples - Samples, sorted on return
+ * @param count - Number of samples (small, this is an insertion sort)
+ *
+ * @returns the median, the mean of the two middle samples for an even count
+ */
+int16_t filter_median(int16_t *samples, int count)
+{
+    filter_sort(samples, count);
+
+    if (count % 2 == 0) {
+        return (samples[count / 2 - 1] + samples[count / 2]) / 2;
+    }
+    return samples[count / 2];
+}
+
+/**
+ * Mean after dropping the lowest and the highest samples, the buffer is sorted in place
+ *
+ * @param samples - Samples, sorted on return
+ * @param count - Number of samples
+ * @param trim - Samples dropped at each end
+ *
+ * @returns the mean of the remaining samples, rounded to nearest
+ */
+int16_t filter_trimmedMean(int16_t *samples, int count, int trim)
+{
+    int kept = count - 2 * trim;
+    int32_t sum;
+
+    if (kept <= 0) {
+        return filter_median(samples, count);
+    }
+
+    filter_sort(samples, count);
+
+    sum = filter_sum(samples + trim, kept);
+
+    return (sum + (sum >= 0 ? kept / 2 : -kept / 2)) / kept;
+}
+
+/**
+ * Exponential smoothing of a buffer of states towards new samples:
+ * state += (sample - state) * alpha, element by element
+ *
+ * @param state - Smoothed values (32-bit aligned), updated in place
+ * @param samples - New samples (32-bit aligned)
+ * @param count - Number of elements
+ * @param alpha - Weight of the new sample, Q15 (32768 would be 1.0, so at most 32767)
+ */
+void filter_ema(int16_t *state, const int16_t *samples, int count, int16_t alpha)
+{
+    int i = 0;
+
+#if FILTER_SIMD
+    // QSUB16 takes both differences at once (saturating, as the C path clamps),
+    // SMULBB/SMULTB scale the low and high halves
+    int32_t *statePairs = (int32_t *)state;
+    const int32_t *samplePairs = (const int32_t *)samples;
+    for (; i + 1 < count; i += 2, statePairs++, samplePairs++)
+    {
+        int32_t diff = _qsub16(*samplePairs, *statePairs);
+        int16_t low = state[i] + (_smulbb(diff, alpha) >> 15);
+        int16_t high = state[i + 1] + (_smultb(diff, alpha) >> 15);
+        *statePairs = (uint16_t)low | ((int32_t)high << 16);
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        int32_t diff = samples[i] - state[i];
+        diff = diff > 32767 ? 32767 : (diff < -32768 ? -32768 : diff);
+        state[i] += (diff * alpha) >> 15;
+    }
+}
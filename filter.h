@@ -0,0 +1,67 @@
+/*
+ * filter.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Small filters over buffers of 16-bit samples. On the Cortex-M4 the sums
+ *  and the exponential smoothing work on two samples per instruction with
+ *  the DSP extension (SMLAD, QSUB16, SMULxB); any other build uses the plain
+ *  C loops, which give bit-identical results.
+ */
+
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include <stdint.h>
+
+// The TI compiler targeting the M4 provides the DSP instructions as intrinsics
+#if defined(__TI_ARM__) && defined(__TI_TMS470_V7M4__)
+#define FILTER_SIMD 1
+#else
+#define FILTER_SIMD 0
+#endif
+
+/**
+ * Sum of the samples
+ *
+ * @param samples - Samples
+ * @param count - Number of samples
+ *
+ * @returns the sum
+ */
+int32_t filter_sum(const int16_t *samples, int count);
+
+/**
+ * Median of the samples, the buffer is sorted in place
+ *
+ * @param samples - Samples, sorted on return
+ * @param count - Number of samples (small, this is an insertion sort)
+ *
+ * @returns the median, the mean of the two middle samples for an even count
+ */
+int16_t filter_median(int16_t *samples, int count);
+
+/**
+ * Mean after dropping the lowest and the highest samples, the buffer is sorted in place
+ *
+ * @param samples - Samples, sorted on return
+ * @param count - Number of samples
+ * @param trim - Samples dropped at each end
+ *
+ * @returns the mean of the remaining samples, rounded to nearest
+ */
+int16_t filter_trimmedMean(int16_t *samples, int count, int trim);
+
+/**
+ * Exponential smoothing of a buffer of states towards new samples:
+ * state += (sample - state) * alpha, element by element
+ *
+ * @param state - Smoothed values (32-bit aligned), updated in place
+ * @param samples - New samples (32-bit aligned)
+ * @param count - Number of elements
+ * @param alpha - Weight of the new sample, Q15 (32768 would be 1.0, so at most 32767)
+ */
+void filter_ema(int16_t *state, const int16_t *samples, int count, int16_t alpha);
+
+#endif /* FILTER_H_ */
@@ -0,0 +1,388 @@
+/*
+ * grid.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "grid.h"
+#include "profile.h"
+
+#include <inc/tm4c123gh6pm.h>
+#include <stddef.h>
+
+#define GRID_BYTES (GRID_SIZE * GRID_SIZE / 4)
+#define GRID_WORDS (GRID_BYTES / 4)
+
+#define GRID_MAGIC 0x32445247  // "GRD2", bump the digit when the layout changes
+#define GRID_FLASH_BLOCK 1024  // Erase size of the TM4C123 flash
+
+#define GRID_STEP_MM (GRID_CELL_MM / 2) // Ray steps, no cell is skipped
+#define GRID_BODY_MM 170      // Radius of the Create, bumpers are on its edge
+#define GRID_HALF_PATH_MM 175 // Half the width the robot sweeps while driving
+#define GRID_CLIFF_MM 150     // Cliff sensors from the center of the robot
+
+#define GRID_RAD(deg) ((deg) * (M_PI / 180))
+
+// Fixed point cell coordinates of grid_hazardAhead(), 1/65536 of a cell
+#define GRID_Q 16
+#define GRID_Q_PER_MM ((float)(1L << GRID_Q) / GRID_CELL_MM)
+
+// Typedef struct - Image of the grid in flash
+typedef struct grid_flash
+{
+    uint32_t magic;
+    uint32_t sum;   // Of the cell words
+    uint32_t cells[GRID_WORDS];
+    uint32_t ages[GRID_WORDS];
+} grid_flash_t;
+
+// Flash address of word i of a field of the image, the image is only ever read through pointers
+#define GRID_FLASH_WORD(field, i) (GRID_FLASH_ADDRESS + offsetof(grid_flash_t, field) + (i) * sizeof(uint32_t))
+
+static uint32_t grid_cells[GRID_WORDS]; // 16 cells per word, row by row
+static uint32_t grid_ages[GRID_WORDS];  // Runs since each hazard was last hit, same layout
+
+/**
+ * Index of the cell under a world point
+ *
+ * @returns -1 outside the grid
+ */
+static int grid_index(double x, double y)
+{
+    int col = (int)floor((x - GRID_ORIGIN_MM) / GRID_CELL_MM);
+    int row = (int)floor((y - GRID_ORIGIN_MM) / GRID_CELL_MM);
+
+    if (col < 0 || col >= GRID_SIZE || row < 0 || row >= GRID_SIZE) {
+        return -1;
+    }
+    return row * GRID_SIZE + col;
+}
+
+/**
+ * Two bit field i of a packed array
+ */
+static uint32_t grid_bits(const uint32_t *words, int i)
+{
+    return words[i >> 4] >> ((i & 15) * 2) & 3;
+}
+
+static void grid_setBits(uint32_t *words, int i, uint32_t value)
+{
+    int shift = (i & 15) * 2;
+    words[i >> 4] = (words[i >> 4] & ~(3u << shift)) | value << shift;
+}
+
+static grid_cell_t grid_read(int i)
+{
+    return (grid_cell_t)grid_bits(grid_cells, i);
+}
+
+static void grid_write(int i, grid_cell_t cell)
+{
+    grid_setBits(grid_cells, i, cell);
+}
+
+/**
+ * Mark every cell unknown
+ */
+void grid_init(void)
+{
+    int i;
+
+    for (i = 0; i < GRID_WORDS; i++) {
+        grid_cells[i] = 0;
+        grid_ages[i] = 0;
+    }
+}
+
+/**
+ * Replace the grid with the hazards saved in flash, one run older. Hazards not hit
+ * again for GRID_HAZARD_RUNS runs are dropped
+ *
+ * @returns the number of hazard cells loaded, -1 if flash holds no grid
+ */
+int grid_load(void)
+{
+    const grid_flash_t *saved = (const grid_flash_t *)GRID_FLASH_ADDRESS;
+    uint32_t sum = 0;
+    int i, hazards = 0;
+
+    if (saved->magic != GRID_MAGIC) {
+        return -1;
+    }
+    for (i = 0; i < GRID_WORDS; i++) {
+        sum += saved->cells[i] + saved->ages[i];
+    }
+    if (sum != saved->sum) {
+        return -1;
+    }
+
+    for (i = 0; i < GRID_WORDS; i++) {
+        grid_cells[i] = saved->cells[i];
+        grid_ages[i] = saved->ages[i];
+    }
+    for (i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+    {
+        uint32_t age = grid_bits(grid_ages, i) + 1;
+
+        if (grid_read(i) == GRID_HAZARD && age < GRID_HAZARD_RUNS) {
+            grid_setBits(grid_ages, i, age);
+            hazards++;
+        } else {
+            grid_write(i, GRID_UNKNOWN);
+            grid_setBits(grid_ages, i, 0);
+        }
+    }
+
+    return hazards;
+}
+
+/**
+ * Program one word of flash, the CPU stalls while it does
+ */
+static void grid_flashWrite(uint32_t address, uint32_t data)
+{
+    FLASH_FMA_R = address;
+    FLASH_FMD_R = data;
+    FLASH_FMC_R = FLASH_FMC_WRKEY | FLASH_FMC_WRITE;
+    while (FLASH_FMC_R & FLASH_FMC_WRITE);
+}
+
+/**
+ * Write the grid to flash
+ *
+ * @returns the number of hazard cells saved, -1 if the flash did not read back what was written
+ */
+int grid_save(void)
+{
+    const grid_flash_t *saved = (const grid_flash_t *)GRID_FLASH_ADDRESS;
+    uint32_t address;
+    uint32_t sum = 0;
+    int i, hazards = 0;
+
+    for (i = 0; i < GRID_WORDS; i++) {
+        sum += grid_cells[i] + grid_ages[i];
+    }
+    for (i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+        hazards += grid_read(i) == GRID_HAZARD;
+    }
+
+    // Interrupts stay on, a handler fetching from flash just waits for the operation
+    for (address = GRID_FLASH_ADDRESS; address < GRID_FLASH_ADDRESS + sizeof(grid_flash_t); address += GRID_FLASH_BLOCK)
+    {
+        FLASH_FMA_R = address;
+        FLASH_FMC_R = FLASH_FMC_WRKEY | FLASH_FMC_ERASE;
+        while (FLASH_FMC_R & FLASH_FMC_ERASE);
+    }
+
+    // Magic last, so a reset halfway leaves an image grid_load() rejects
+    grid_flashWrite(GRID_FLASH_WORD(sum, 0), sum);
+    for (i = 0; i < GRID_WORDS; i++) {
+        grid_flashWrite(GRID_FLASH_WORD(cells, i), grid_cells[i]);
+        grid_flashWrite(GRID_FLASH_WORD(ages, i), grid_ages[i]);
+    }
+    grid_flashWrite(GRID_FLASH_WORD(magic, 0), GRID_MAGIC);
+
+    for (i = 0; i < GRID_WORDS; i++)
+    {
+        if (saved->cells[i] != grid_cells[i] || saved->ages[i] != grid_ages[i]) {
+            return -1;
+        }
+    }
+    return saved->magic == GRID_MAGIC && saved->sum == sum ? hazards : -1;
+}
+
+/**
+ * Forget every hazard, here and in flash
+ *
+ * @returns 0, -1 if the flash did not read back what was written
+ */
+int grid_clear(void)
+{
+    grid_init();
+    return grid_save();
+}
+
+/**
+ * Look up the cell under a world point
+ *
+ * @param x - (mm)
+ * @param y - (mm)
+ *
+ * @returns the state of the cell, GRID_UNKNOWN outside the grid
+ */
+grid_cell_t grid_get(double x, double y)
+{
+    int i = grid_index(x, y);
+    return i < 0 ? GRID_UNKNOWN : grid_read(i);
+}
+
+/**
+ * Look up a cell by its column (along x) and row (along y)
+ *
+ * @returns the state of the cell, GRID_UNKNOWN outside the grid
+ */
+grid_cell_t grid_cellAt(int col, int row)
+{
+    if (col < 0 || col >= GRID_SIZE || row < 0 || row >= GRID_SIZE) {
+        return GRID_UNKNOWN;
+    }
+    return grid_read(row * GRID_SIZE + col);
+}
+
+/**
+ * Set the cell under a world point, does nothing outside the grid
+ *
+ * @param x - (mm)
+ * @param y - (mm)
+ * @param cell - New state
+ */
+void grid_set(double x, double y, grid_cell_t cell)
+{
+    int i = grid_index(x, y);
+    if (i >= 0) {
+        grid_write(i, cell);
+    }
+}
+
+/**
+ * Trace every sample of a stamped (and de-skewed) scan into the grid
+ *
+ * @param scan - Scan whose samples carry the pose they were taken at
+ */
+void grid_markScan(const scan_t *scan)
+{
+    int i, mm;
+
+    for (i = 0; i < scan->count; i++)
+    {
+        const scan_sample_t *sample = &scan->samples[i];
+        double heading = sample->heading / 100.0;
+        double bearing = GRID_RAD(heading + sample->angle - 90); // Servo 90 looks along the heading
+        double x = sample->x + SCAN_SENSOR_MM * cos(GRID_RAD(heading));
+        double y = sample->y + SCAN_SENSOR_MM * sin(GRID_RAD(heading));
+        double dx = cos(bearing);
+        double dy = sin(bearing);
+        int hit = sample->range <= SCAN_IR_RANGE;
+        int clear = (hit ? sample->range : SCAN_IR_RANGE) * 10;
+
+        // Free up to the return, without clearing what a scan cannot see
+        for (mm = 0; mm < clear; mm += GRID_STEP_MM)
+        {
+            int cell = grid_index(x + mm * dx, y + mm * dy);
+            if (cell >= 0 && grid_read(cell) != GRID_HAZARD) {
+                grid_write(cell, GRID_FREE);
+            }
+        }
+
+        if (hit)
+        {
+            int cell = grid_index(x + clear * dx, y + clear * dy);
+            if (cell >= 0 && grid_read(cell) != GRID_HAZARD) {
+                grid_write(cell, GRID_OCCUPIED);
+            }
+        }
+    }
+}
+
+/**
+ * Mark the cell at a distance and angle from the robot a hazard, hit on this run
+ */
+static void grid_markAt(const oi_t *sensor, int mm, int angle)
+{
+    double bearing = GRID_RAD(sensor->poseHeading + angle);
+    int i = grid_index(sensor->poseX + mm * cos(bearing), sensor->poseY + mm * sin(bearing));
+
+    if (i >= 0) {
+        grid_write(i, GRID_HAZARD);
+        grid_setBits(grid_ages, i, 0);
+    }
+}
+
+/**
+ * Mark a hazard under every bumper or cliff sensor that is triggered
+ *
+ * @param sensor - Sensor object with the pose and the sensor bits
+ */
+void grid_markContact(const oi_t *sensor)
+{
+    // Both bumpers is a hit straight ahead
+    if (sensor->bumpLeft && sensor->bumpRight) {
+        grid_markAt(sensor, GRID_BODY_MM + GRID_STEP_MM, 0);
+    } else if (sensor->bumpLeft) {
+        grid_markAt(sensor, GRID_BODY_MM + GRID_STEP_MM, 40);
+    } else if (sensor->bumpRight) {
+        grid_markAt(sensor, GRID_BODY_MM + GRID_STEP_MM, -40);
+    }
+
+    if (sensor->cliffLeft) {
+        grid_markAt(sensor, GRID_CLIFF_MM, 70);
+    }
+    if (sensor->cliffFrontLeft) {
+        grid_markAt(sensor, GRID_CLIFF_MM, 20);
+    }
+    if (sensor->cliffFrontRight) {
+        grid_markAt(sensor, GRID_CLIFF_MM, -20);
+    }
+    if (sensor->cliffRight) {
+        grid_markAt(sensor, GRID_CLIFF_MM, -70);
+    }
+}
+
+/**
+ * Look for a hazard in the path of the robot
+ *
+ * @param x - Robot position (mm)
+ * @param y - (mm)
+ * @param heading - (deg, CCW positive)
+ * @param reach - How far ahead to look (mm)
+ *
+ * @returns the distance from the front of the robot to the nearest hazard in its path (mm), -1 if none
+ */
+int grid_hazardAhead(double x, double y, double heading, int reach)
+{
+    PROFILE_BEGIN(HAZARD_AHEAD);
+
+    // Runs every pass of the motion loop: one float sine and cosine, then integer steps
+    float rad = (float)GRID_RAD(heading);
+    float c = cosf(rad) * GRID_Q_PER_MM; // Heading (cells << GRID_Q per mm)
+    float s = sinf(rad) * GRID_Q_PER_MM;
+    int32_t aheadX = (int32_t)(GRID_STEP_MM * c); // Next row
+    int32_t aheadY = (int32_t)(GRID_STEP_MM * s);
+    int32_t sideX = (int32_t)(-GRID_STEP_MM * s); // Next cell of a row, to the left
+    int32_t sideY = (int32_t)(GRID_STEP_MM * c);
+    int32_t rowX = (int32_t)(((float)x - GRID_ORIGIN_MM) * GRID_Q_PER_MM + GRID_BODY_MM * c + GRID_HALF_PATH_MM * s);
+    int32_t rowY = (int32_t)(((float)y - GRID_ORIGIN_MM) * GRID_Q_PER_MM + GRID_BODY_MM * s - GRID_HALF_PATH_MM * c);
+    int found = -1;
+    int ahead, side;
+
+    // Row by row across the path, nearest row first, each from its right end
+    for (ahead = 0; ahead <= reach && found < 0; ahead += GRID_STEP_MM)
+    {
+        int32_t px = rowX;
+        int32_t py = rowY;
+
+        for (side = -GRID_HALF_PATH_MM; side <= GRID_HALF_PATH_MM; side += GRID_STEP_MM)
+        {
+            // Negative is outside the grid, so the shift never has to floor
+            if (px >= 0 && py >= 0)
+            {
+                int col = px >> GRID_Q;
+                int row = py >> GRID_Q;
+                if (col < GRID_SIZE && row < GRID_SIZE && grid_read(row * GRID_SIZE + col) == GRID_HAZARD) {
+                    found = ahead;
+                    break;
+                }
+            }
+            px += sideX;
+            py += sideY;
+        }
+
+        rowX += aheadX;
+        rowY += aheadY;
+    }
+
+    PROFILE_END(HAZARD_AHEAD);
+    return found;
+}
@@ -0,0 +1,125 @@
+/*
+ * grid.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Occupancy grid of the test field in odometry coordinates, which start
+ *  from the same spot every run. The field is cut into GRID_SIZE x GRID_SIZE
+ *  cells of GRID_CELL_MM, two bits each, four to a byte: 1600 bytes of RAM
+ *  for a 4 m square. Scans mark the cells their rays cross free and the
+ *  cells they end in occupied; bumps and cliffs mark hazards, which scans
+ *  never clear (the IR sensor sees over posts and potholes).
+ *
+ *  Hazards survive a reset: grid_save() writes the grid to the last 4 KB of
+ *  flash, reserved in tm4c123gh6pm.cmd, and grid_load() brings back the
+ *  hazards from it. Occupied cells are not kept, cars and pedestrians move on.
+ *  Each hazard also keeps the number of runs since it was last hit (another
+ *  two bits, 1600 bytes more), so one that was taken away is forgotten after
+ *  GRID_HAZARD_RUNS runs; grid_clear() (the CLEAR command) forgets them all.
+ */
+
+#ifndef GRID_H_
+#define GRID_H_
+
+#include "open_interface.h"
+#include "scan.h"
+
+#include <stdint.h>
+
+#define GRID_SIZE 80      // Cells along each side
+#define GRID_CELL_MM 50
+#define GRID_ORIGIN_MM -500 // World x and y of the corner of cell 0, 0
+#define GRID_HAZARD_RUNS 3  // Runs a hazard is remembered for, counting the one it was last hit on (at most 4, the age has two bits)
+
+// Where the grid is kept between runs, must match the GRID region of tm4c123gh6pm.cmd
+#define GRID_FLASH_ADDRESS 0x3F000
+
+typedef enum
+{
+    GRID_UNKNOWN = 0,
+    GRID_FREE = 1,     // Seen through by a scan
+    GRID_OCCUPIED = 2, // A scan ended here
+    GRID_HAZARD = 3    // Bumped into or fell off, kept for GRID_HAZARD_RUNS runs or until grid_clear()
+} grid_cell_t;
+
+/**
+ * Mark every cell unknown
+ */
+void grid_init(void);
+
+/**
+ * Replace the grid with the hazards saved in flash, one run older. Hazards not hit
+ * again for GRID_HAZARD_RUNS runs are dropped
+ *
+ * @returns the number of hazard cells loaded, -1 if flash holds no grid
+ */
+int grid_load(void);
+
+/**
+ * Write the grid to flash
+ *
+ * @returns the number of hazard cells saved, -1 if the flash did not read back what was written
+ */
+int grid_save(void);
+
+/**
+ * Forget every hazard, here and in flash
+ *
+ * @returns 0, -1 if the flash did not read back what was written
+ */
+int grid_clear(void);
+
+/**
+ * Look up the cell under a world point
+ *
+ * @param x - (mm)
+ * @param y - (mm)
+ *
+ * @returns the state of the cell, GRID_UNKNOWN outside the grid
+ */
+grid_cell_t grid_get(double x, double y);
+
+/**
+ * Look up a cell by its column (along x) and row (along y)
+ *
+ * @returns the state of the cell, GRID_UNKNOWN outside the grid
+ */
+grid_cell_t grid_cellAt(int col, int row);
+
+/**
+ * Set the cell under a world point, does nothing outside the grid
+ *
+ * @param x - (mm)
+ * @param y - (mm)
+ * @param cell - New state
+ */
+void grid_set(double x, double y, grid_cell_t cell);
+
+/**
+ * Trace every sample of a stamped (and de-skewed) scan into the grid
+ *
+ * @param scan - Scan whose samples carry the pose they were taken at
+ */
+void grid_markScan(const scan_t *scan);
+
+/**
+ * Mark a hazard under every bumper or cliff sensor that is triggered
+ *
+ * @param sensor - Sensor object with the pose and the sensor bits
+ */
+void grid_markContact(const oi_t *sensor);
+
+/**
+ * Look for a hazard in the path of the robot
+ *
+ * @param x - Robot position (mm)
+ * @param y - (mm)
+ * @param heading - (deg, CCW positive)
+ * @param reach - How far ahead to look (mm)
+ *
+ * @returns the distance from the front of the robot to the nearest hazard in its path (mm), -1 if none
+ */
+int grid_hazardAhead(double x, double y, double heading, int reach);
+
+#endif /* GRID_H_ */
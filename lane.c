@@ -0,0 +1,182 @@
+/*
+ * lane.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "lane.h"
+
+#define LANE_MIN_DEV 8          // Least noise assumed for any signal (counts)
+#define LANE_TAPE_CONTRAST 1000 // Tape brightness above the floor until the tape was seen (counts)
+#define LANE_TAPE_MIN 300       // Least step above the floor that is learnt as tape (counts)
+#define LANE_WALL_RANGE 800     // Light bumper rise above the background that is full scale (counts)
+#define LANE_ADAPT_SHIFT 6      // Floor and background follow readings close to them by 1/64 per frame
+#define LANE_TAPE_SHIFT 3       // Tape brightness follows bright readings by 1/8 per frame
+
+// Lateral error (mm) a sensor stands for at full scale
+#define LANE_SIDE_MM 50         // Left or right cliff sensor on the tape
+#define LANE_FRONT_MM 150       // Front cliff sensor on the tape, the CyBot is well over the line
+#define LANE_WALL_MM 100        // Side light bumper at full scale, the front ones count half
+
+// Controller, gains are for 100 mm/s and scale with the speed
+#define LANE_KP 6               // Steering (mm/s) per 10 mm of error
+#define LANE_KD 30              // Steering (mm/s) per 10 mm the error changed since the last frame
+#define LANE_MAX_STEER 40       // Largest correction (% of the speed)
+
+/**
+ * Signals of the cliff sensors and of the light bumpers, left to right
+ */
+static void lane_signals(const oi_t *sensor, int32_t cliff[4], int32_t light[4])
+{
+    cliff[0] = sensor->cliffLeftSignal;
+    cliff[1] = sensor->cliffFrontLeftSignal;
+    cliff[2] = sensor->cliffFrontRightSignal;
+    cliff[3] = sensor->cliffRightSignal;
+    light[0] = sensor->lightBumpLeftSignal;
+    light[1] = sensor->lightBumpFrontLeftSignal;
+    light[2] = sensor->lightBumpFrontRightSignal;
+    light[3] = sensor->lightBumpRightSignal;
+}
+
+/**
+ * Mean and standard deviation (both x16) from the sums of LANE_LEARN_FRAMES readings
+ */
+static void lane_stats(int32_t *sum, int32_t *squares)
+{
+    int32_t mean = *sum / LANE_LEARN_FRAMES;
+    int32_t var = *squares / LANE_LEARN_FRAMES - mean * mean;
+    int32_t dev = (int32_t)(sqrt(var > 0 ? var : 0) * 16);
+
+    *sum = *sum * 16 / LANE_LEARN_FRAMES;
+    *squares = dev > LANE_MIN_DEV * 16 ? dev : LANE_MIN_DEV * 16;
+}
+
+/**
+ * Scale a value between two levels to 0-1000
+ */
+static int32_t lane_scale(int32_t value, int32_t low, int32_t high)
+{
+    if (value <= low) {
+        return 0;
+    }
+    if (value >= high) {
+        return 1000;
+    }
+    return (value - low) * 1000 / (high - low);
+}
+
+/**
+ * Forget the calibration and the statistics
+ *
+ * @param lane - Controller to reset
+ */
+void lane_init(lane_t *lane)
+{
+    memset(lane, 0, sizeof(*lane));
+}
+
+/**
+ * Add a sensor frame to the calibration, taken standing in the lane away from tape and walls
+ *
+ * @param lane - Controller being calibrated
+ * @param sensor - Latest sensor frame
+ *
+ * @returns 1 once LANE_LEARN_FRAMES frames were seen and the calibration is set
+ */
+int lane_learn(lane_t *lane, const oi_t *sensor)
+{
+    int32_t cliff[4], light[4];
+    int i;
+
+    if (lane->learnt >= LANE_LEARN_FRAMES) {
+        return 1;
+    }
+
+    // Until calibrated the means hold sums and the deviations sums of squares
+    lane_signals(sensor, cliff, light);
+    for (i = 0; i < 4; i++)
+    {
+        lane->floor[i] += cliff[i];
+        lane->floorDev[i] += cliff[i] * cliff[i];
+        lane->ambient[i] += light[i];
+        lane->ambientDev[i] += light[i] * light[i];
+    }
+
+    if (++lane->learnt < LANE_LEARN_FRAMES) {
+        return 0;
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        lane_stats(&lane->floor[i], &lane->floorDev[i]);
+        lane_stats(&lane->ambient[i], &lane->ambientDev[i]);
+        lane->tape[i] = lane->floor[i] + LANE_TAPE_CONTRAST * 16;
+    }
+    return 1;
+}
+
+/**
+ * Steering correction for the latest sensor frame, call once per frame while driving straight
+ *
+ * @param lane - Calibrated controller
+ * @param sensor - Latest sensor frame
+ * @param speed - Forward speed of the wheels (mm/s)
+ *
+ * @returns the speed to add to the right wheel and take from the left one (mm/s)
+ */
+int lane_steer(lane_t *lane, const oi_t *sensor, int speed)
+{
+    int32_t cliff[4], light[4];
+    int32_t tape[4], wall[4];
+    int i;
+
+    if (lane->learnt < LANE_LEARN_FRAMES || speed <= 0) {
+        return 0;
+    }
+
+    lane_signals(sensor, cliff, light);
+    for (i = 0; i < 4; i++)
+    {
+        int32_t value = cliff[i] * 16;
+        int32_t noise = 3 * lane->floorDev[i];
+        int32_t step = 2 * noise > LANE_TAPE_MIN * 16 ? 2 * noise : LANE_TAPE_MIN * 16;
+
+        // Follow the floor while on it, learn the tape whenever it is clearly brighter
+        if (abs(value - lane->floor[i]) < noise) {
+            lane->floor[i] += (value - lane->floor[i]) >> LANE_ADAPT_SHIFT;
+        } else if (value > lane->floor[i] + step) {
+            lane->tape[i] += (value - lane->tape[i]) >> LANE_TAPE_SHIFT;
+        }
+        if (lane->tape[i] < lane->floor[i] + step) {
+            lane->tape[i] = lane->floor[i] + step;
+        }
+        tape[i] = lane_scale(value, lane->floor[i] + noise, lane->tape[i]);
+
+        value = light[i] * 16;
+        noise = 3 * lane->ambientDev[i];
+        if (value < lane->ambient[i] + noise) {
+            lane->ambient[i] += (value - lane->ambient[i]) >> LANE_ADAPT_SHIFT;
+        }
+        wall[i] = lane_scale(value, lane->ambient[i] + noise, lane->ambient[i] + noise + LANE_WALL_RANGE * 16);
+    }
+
+    // Positive when the right side is closer to the edge of the lane
+    int32_t error = (LANE_SIDE_MM * (tape[3] - tape[0]) + LANE_FRONT_MM * (tape[2] - tape[1])
+                   + LANE_WALL_MM * (wall[3] - wall[0]) + LANE_WALL_MM / 2 * (wall[2] - wall[1])) / 1000;
+
+    int32_t steer = (LANE_KP * error + LANE_KD * (error - lane->error)) * speed / 1000;
+    int32_t limit = speed * LANE_MAX_STEER / 100;
+    steer = steer > limit ? limit : (steer < -limit ? -limit : steer);
+
+    lane->error = error;
+    lane->steer = steer;
+    lane->frames++;
+    if (steer != 0) {
+        lane->corrected++;
+    }
+    if (abs(error) > lane->worst) {
+        lane->worst = abs(error);
+    }
+    return steer;
+}
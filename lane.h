@@ -0,0 +1,79 @@
+/*
+ * lane.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Lane keeping from the analog signals of the Create: the four cliff
+ *  sensors see the white boundary tape as a brighter floor, the light
+ *  bumpers see walls and curbs beside the road as a stronger reflection.
+ *  Every sensor frame lane_steer() turns them into a lateral error and
+ *  returns a steering correction (a PD controller) for the wheel speeds.
+ *
+ *  Nothing is a fixed threshold. lane_learn() measures the floor and the
+ *  light bumper background at the start, standing in the lane; while
+ *  driving, readings close to the floor keep adapting it and readings well
+ *  above it teach the brightness of the tape. A reading is then scaled to
+ *  0-1000 between floor and tape (cliff sensors) or from the background to
+ *  LANE_WALL_RANGE above it (light bumpers).
+ */
+
+#ifndef LANE_H_
+#define LANE_H_
+
+#include "open_interface.h"
+
+#include <stdint.h>
+
+#define LANE_LEARN_FRAMES 32 // Sensor frames lane_learn() averages at the start
+
+// Typedef struct - Calibration and state of the lane keeping controller
+typedef struct lane
+{
+    // Cliff sensors: left, front left, front right, right
+    int32_t floor[4];       // Mean signal of the floor (x16)
+    int32_t floorDev[4];    // Its standard deviation (x16)
+    int32_t tape[4];        // Mean signal of the tape (x16)
+
+    // Light bumpers: left, front left, front right, right
+    int32_t ambient[4];     // Mean signal without a wall in range (x16)
+    int32_t ambientDev[4];  // Its standard deviation (x16)
+
+    uint8_t learnt;         // Frames lane_learn() has seen, LANE_LEARN_FRAMES once calibrated
+    int16_t error;          // Lateral error of the last frame (mm, positive: steer left)
+    int16_t steer;          // Last correction (mm/s, added to the right wheel)
+
+    uint32_t frames;        // Frames steered since lane_init()
+    uint32_t corrected;     // Frames with a correction
+    uint16_t worst;         // Largest error seen (mm)
+} lane_t;
+
+/**
+ * Forget the calibration and the statistics
+ *
+ * @param lane - Controller to reset
+ */
+void lane_init(lane_t *lane);
+
+/**
+ * Add a sensor frame to the calibration, taken standing in the lane away from tape and walls
+ *
+ * @param lane - Controller being calibrated
+ * @param sensor - Latest sensor frame
+ *
+ * @returns 1 once LANE_LEARN_FRAMES frames were seen and the calibration is set
+ */
+int lane_learn(lane_t *lane, const oi_t *sensor);
+
+/**
+ * Steering correction for the latest sensor frame, call once per frame while driving straight
+ *
+ * @param lane - Calibrated controller
+ * @param sensor - Latest sensor frame
+ * @param speed - Forward speed of the wheels (mm/s)
+ *
+ * @returns the speed to add to the right wheel and take from the left one (mm/s)
+ */
+int lane_steer(lane_t *lane, const oi_t *sensor, int speed);
+
+#endif /* LANE_H_ */
@@ -12,6 +12,10 @@
 
 
 #include "lcd.h"
+#include "profile.h"
+
+#include <stdarg.h>
+#include "driverlib/interrupt.h"
 
 #define BIT0		0x01
 #define BIT1		0x02
@@ -50,10 +54,44 @@
 #define LCD_PORT_DATA	GPIO_PORTF_DATA_R
 #define LCD_PORT_CNTRL	GPIO_PORTD_DATA_R
 
+#define LCD_DATA_PINS	0x1E	//PF1:4
+#define LCD_BUSY_FLAG	0x80
+
+//Background flush: at most one bus byte per TIMER2A tick. Every byte the flush sends
+//(character or set address) takes the HD44780 37us; with the busy flag the tick only
+//needs to cover that, without it the tick leaves margin for a slow controller.
+#define LCD_FLUSH_PERIOD_US		40
+#define LCD_FLUSH_FALLBACK_US	60
+#define LCD_FLUSH_BUSY_TICKS	50	//Busy this many ticks in a row (2ms): stop trusting the flag
+#define LCD_EN_PULSE		2	//Busy loop iterations for the >450ns enable pulse
+
+//Worst-case execution times, waited when the busy flag cannot be read
+#define LCD_CHAR_US		43
+#define LCD_COMMAND_US	1000
+#define LCD_CLEAR_US	3000
+
+//DDRAM address of the first cell of each line
+static const uint8_t lcd_lineAddress[LCD_HEIGHT] = {0x00, 0x40, 0x14, 0x54};
+
+static char lcd_frame[LCD_HEIGHT][LCD_WIDTH];	//What the callers want shown
+static char lcd_shown[LCD_HEIGHT][LCD_WIDTH];	//What the HD44780 holds, only touched by the flush
+static volatile uint8_t lcd_rowDirty[LCD_HEIGHT];	//Row may differ, set by writers and cleared by the flush
+
+static int8_t lcd_flushRow = -1;	//Row being compared, -1 for none
+static uint8_t lcd_flushCol;
+static uint8_t lcd_lastRow;		//Row picked last, the next pick starts after it
+static uint8_t lcd_address;		//DDRAM address counter of the HD44780
+static volatile uint32_t lcd_busCount;
+static uint8_t lcd_busyTicks;		//Flush ticks in a row the controller was busy
+static volatile uint8_t lcd_busyFlagOk = 1;	//Cleared when the busy flag never went low, fixed delays from then on
+static volatile uint32_t lcd_busyPolls;
+
+static void lcd_flushHandler(void);
 
-//TODO: Poll Busy Flag
 
 //private function prototypes
+static uint8_t lcd_readStatus(void);
+static void lcd_waitReady(unsigned int fallbackMicros);
 
 uint8_t lcd_reverseNibble(uint8_t x)
 {
@@ -63,13 +101,12 @@ uint8_t lcd_reverseNibble(uint8_t x)
 
 void lcd_init(void)
 {
-	//TODO: Remove waitMillis after commands -- poll busy flag in sendCommand
-	volatile uint32_t i = 0;
 	SYSCTL_RCGCGPIO_R |= BIT3 | BIT5; //Turn on PORTD, PORTF sys clock
 
-	//Set port to output
-	GPIO_PORTF_DIR_R |= 0x1E; //Pins 1:4
-	GPIO_PORTF_DEN_R |= 0x1E;
+	//Set port to output, the pull-ups make an LCD that does not answer a read look busy
+	GPIO_PORTF_DIR_R |= LCD_DATA_PINS;
+	GPIO_PORTF_DEN_R |= LCD_DATA_PINS;
+	GPIO_PORTF_PUR_R |= LCD_DATA_PINS;
 
 	GPIO_PORTD_DIR_R |= (EN_PIN | RS_PIN | RW_PIN);
 	GPIO_PORTD_DEN_R |= (EN_PIN | RS_PIN | RW_PIN);
@@ -92,30 +129,41 @@ void lcd_init(void)
 	lcd_sendNibble(0x02);			//Function set 4 bit
 	timer_waitMillis(1);
 
+	//From here on the busy flag can be read, lcd_sendCommand() waits for it
+	lcd_busyFlagOk = 1;
 	lcd_sendCommand(0x28);			//Function 4 bit / 2 lines
-	timer_waitMillis(1);
 
 	//lcd_sendCommand(0x10);			//Set cursor
-	//timer_waitMillis(1);
 
 	//lcd_sendCommand(HD_BLINK_ON | HD_CURSOR_ON | HD_DISPLAY_ON);
 	lcd_sendCommand(0x0F);
-	timer_waitMillis(1);
 
 	lcd_sendCommand(0x28);			//Function 4 bit / 2 lines
-	timer_waitMillis(1);
-
 
 	lcd_sendCommand(0x06);			//Increment Cursor / No Display Shift
-	timer_waitMillis(1);
 
+	lcd_sendCommand(HD_LCD_CLEAR);
 
-	lcd_sendCommand(0x01);			//Return Home
-	timer_waitMillis(1);
-
-	lcd_clear();
-	timer_waitMillis(1);
+	//Display and framebuffer both blank, address counter at 0
+	memset(lcd_frame, ' ', sizeof(lcd_frame));
+	memset(lcd_shown, ' ', sizeof(lcd_shown));
+	memset((void *)lcd_rowDirty, 0, sizeof(lcd_rowDirty));
+	lcd_flushRow = -1;
+	lcd_address = 0;
 
+	//TIMER2A drives the background flush, only enabled while cells are dirty
+	SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R2;
+	timer_waitMicros(1);
+	TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
+	TIMER2_CFG_R = TIMER_CFG_16_BIT;
+	TIMER2_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
+	TIMER2_TAPR_R = 0x0F;					//1us per count
+	TIMER2_TAILR_R = (lcd_busyFlagOk ? LCD_FLUSH_PERIOD_US : LCD_FLUSH_FALLBACK_US) - 1;
+	TIMER2_ICR_R = TIMER_ICR_TATOCINT;
+	TIMER2_IMR_R |= TIMER_IMR_TATOIM;
+	NVIC_PRI5_R |= NVIC_PRI5_INTD_M;		//Priority 7 (lowest)
+	NVIC_EN0_R |= (1 << 23);				//Enable TIMER2A interrupts
+	IntRegister(INT_TIMER2A, lcd_flushHandler);
 }
 
 ///Send Char to LCD
@@ -128,12 +176,10 @@ void lcd_putc(char data)
 	//Send High nibble
 	lcd_sendNibble(data >> 4);
 
-	timer_waitMicros(43);
-
 	//Send Lower Nibble
 	lcd_sendNibble(data & 0x0F);
 
-	//TODO: Poll Busy flag
+	lcd_waitReady(LCD_CHAR_US);
 }
 
 ///Send Character array to LCD
@@ -150,53 +196,113 @@ void lcd_puts(char data[])
 ///Send Command to LCD - Position, Clear, Etc.
 void lcd_sendCommand(uint8_t data)
 {
-	//Enable High
-	LCD_PORT_CNTRL |= EN_PIN;
 	LCD_PORT_CNTRL &= ~(RW_PIN | RS_PIN); // Write Command
 
 	//Send High nibble
 	lcd_sendNibble(data >> 4);
 
-	timer_waitMicros(1);
 	//Send Lower Nibble
 	lcd_sendNibble(data & 0x0F);
 
-	//TODO: Poll Busy Flag
-	timer_waitMillis(1);
+	//Clear and home take 1.52ms, everything else 37us
+	lcd_waitReady(data <= HD_RETURN_HOME ? LCD_CLEAR_US : LCD_COMMAND_US);
 }
 
 
-///Send 4bit nibble to lcd, then clear port.
+///Send 4bit nibble to lcd, the controller latches it on the falling edge of EN
 void lcd_sendNibble(uint8_t theNibble)
 {
+	volatile int i;
+
 	#ifdef IS_STEPPER_BOARD
 	theNibble = lcd_reverseNibble(theNibble);
     #endif
+	LCD_PORT_DATA = (LCD_PORT_DATA & ~LCD_DATA_PINS) | ((theNibble & 0x0F) << 1); //PORTF1:4
+
+	//Enable pulse >450ns, data setup 80ns before the falling edge
 	LCD_PORT_CNTRL |= EN_PIN;
-	LCD_PORT_DATA |= (theNibble & 0x0F) << 1; //PORTD1:4
+	for (i = 0; i < LCD_EN_PULSE; i++);
+	LCD_PORT_CNTRL &= ~(EN_PIN);
+
+	//Enable cycle time >1us
+	for (i = 0; i < LCD_EN_PULSE; i++);
+}
 
-	//Data Hold time before Clock = 40ns -- Change if faster clock
-	timer_waitMicros(20);
-	//Clock in Data
+///Read one nibble while RW is high
+static uint8_t lcd_readNibble(void)
+{
+	volatile int i;
+	uint8_t theNibble;
+
+	//Data is valid 360ns after the rising edge of EN
+	LCD_PORT_CNTRL |= EN_PIN;
+	for (i = 0; i < LCD_EN_PULSE; i++);
+	theNibble = (LCD_PORT_DATA & LCD_DATA_PINS) >> 1;
 	LCD_PORT_CNTRL &= ~(EN_PIN);
+	for (i = 0; i < LCD_EN_PULSE; i++);
 
-	timer_waitMicros(20);
-	//Clear Port
-	LCD_PORT_DATA &= ~((0x0F) << 1);
+	#ifdef IS_STEPPER_BOARD
+	theNibble = lcd_reverseNibble(theNibble);
+	#endif
+	return theNibble;
 }
 
-///Clear LCD Screen
-void inline lcd_clear(void)
+///Read the busy flag (bit 7) and address counter, leaves the bus in write mode
+static uint8_t lcd_readStatus(void)
 {
-	lcd_sendCommand(HD_LCD_CLEAR);
+	uint8_t status;
+
+	GPIO_PORTF_DIR_R &= ~LCD_DATA_PINS;
+	LCD_PORT_CNTRL = (LCD_PORT_CNTRL & ~RS_PIN) | RW_PIN;
 
-	//This command takes over 1ms to complete
-	timer_waitMillis(2);
+	status = lcd_readNibble() << 4;
+	status |= lcd_readNibble();
 
+	LCD_PORT_CNTRL &= ~(RW_PIN);
+	GPIO_PORTF_DIR_R |= LCD_DATA_PINS;
+	lcd_busyPolls++;
+
+	return status;
+}
+
+///Wait for the controller to finish, or the worst-case time if the busy flag cannot be read
+/**
+ * If the flag is still set after the worst-case time the LCD does not answer reads
+ * (RW not wired, or the pull-ups read back as busy); polling is given up for good.
+ */
+static void lcd_waitReady(unsigned int fallbackMicros)
+{
+	unsigned int start;
+
+	if (!lcd_busyFlagOk) {
+		timer_waitMicros(fallbackMicros);
+		return;
+	}
+
+	start = timer_getMicros();
+	while (lcd_readStatus() & LCD_BUSY_FLAG) {
+		//An interrupt between the read and the clock can use up the time, so read once more
+		if (timer_getMicros() - start > fallbackMicros) {
+			if (lcd_readStatus() & LCD_BUSY_FLAG) {
+				lcd_busyFlagOk = 0;
+			}
+			break;
+		}
+	}
+}
+
+///Clear LCD Screen - blanks the framebuffer, the flush only rewrites cells that were not blank
+void lcd_clear(void)
+{
+	uint8_t y;
+
+	for (y = 0; y < LCD_HEIGHT; y++) {
+		lcd_putsLine(y, "");
+	}
 }
 
 ///Return Cursor to 0,0
-void inline lcd_home(void)
+void lcd_home(void)
 {
 	lcd_sendCommand(HD_RETURN_HOME);
 }
@@ -242,55 +348,172 @@ void lcd_setCursorPos(uint8_t x, uint8_t y) {
  */
 
 void lcd_printf(const char *format, ...) {
-	static char lastbuffer[LCD_TOTAL_CHARS + 1];
-
 	char buffer[LCD_TOTAL_CHARS + 1];
+	char *str = buffer;
+	uint8_t x, y;
 	va_list arglist;
+
 	va_start(arglist, format);
 	vsnprintf(buffer, LCD_TOTAL_CHARS + 1, format, arglist);
+	va_end(arglist);
 
-	if (!strcmp(lastbuffer, buffer))
-		return;
-
-	strcpy(lastbuffer, buffer);
-	lcd_clear();
-	char *str = buffer;
-	int charnum = 0;
-	while (*str && charnum < LCD_TOTAL_CHARS) {
+	//Lay the text out line by line, a newline or the end of the text blanks the rest of the line
+	for (y = 0; y < LCD_HEIGHT; y++) {
+		for (x = 0; x < LCD_WIDTH; x++) {
+			if (*str == '\0' || *str == '\n') {
+				lcd_setChar(x, y, ' ');
+			} else {
+				lcd_setChar(x, y, *str++);
+			}
+		}
 		if (*str == '\n') {
-			/* fill remainder of line with spaces */
-			charnum += LCD_WIDTH - charnum % LCD_WIDTH;
-		} else {
-			lcd_putc(*str);
-			charnum++;
+			str++;
 		}
+	}
+}
 
-		str++;
-
-		/*
-		 * The LCD's lines are not sequential; for future reference, the address are like
-		 * 0x00...0x13 : line 1
-		 * 0x14...0x27 : line 3
-		 * 0x28...0x3F : random junk
-		 * 0x40...0x53 : line 2
-		 * 0x54...0x68 : line 4
-		 *
-		 * The cursor position must be reset at the end of every line, otherwise, after writing line 1, it writes line 3 and then nothingness
-		 */
-
-		if (charnum % LCD_WIDTH == 0) {
-			switch (charnum / LCD_WIDTH) {
-			case 1:
-				lcd_gotoLine(2);
-				break;
-			case 2:
-				lcd_gotoLine(3);
+///Put one character in the framebuffer, top left is 0,0
+/**
+ * Returns immediately; the flush sends the cell to the display in the background
+ * and only if it differs from what the display shows.
+ */
+void lcd_setChar(uint8_t x, uint8_t y, char c) {
+	if (x >= LCD_WIDTH || y >= LCD_HEIGHT || lcd_frame[y][x] == c) {
+		return;
+	}
+
+	//Cell first, then the row flag: a flush that clears the flag after this still sees the cell
+	lcd_frame[y][x] = c;
+	lcd_rowDirty[y] = 1;
+	TIMER2_CTL_R |= TIMER_CTL_TAEN;
+}
+
+///Put a string in the framebuffer starting at x,y, clipped at the end of the line
+void lcd_putsAt(uint8_t x, uint8_t y, const char *str) {
+	while (*str && x < LCD_WIDTH) {
+		lcd_setChar(x++, y, *str++);
+	}
+}
+
+///Replace one whole line of the framebuffer, padded with spaces
+void lcd_putsLine(uint8_t y, const char *str) {
+	uint8_t x;
+
+	for (x = 0; x < LCD_WIDTH; x++) {
+		lcd_setChar(x, y, *str ? *str++ : ' ');
+	}
+}
+
+///printf into one whole line of the framebuffer, padded with spaces
+void lcd_printfLine(uint8_t y, const char *format, ...) {
+	char buffer[LCD_WIDTH + 1];
+	va_list arglist;
+
+	va_start(arglist, format);
+	vsnprintf(buffer, LCD_WIDTH + 1, format, arglist);
+	va_end(arglist);
+
+	lcd_putsLine(y, buffer);
+}
+
+///Returns 1 once the display shows the whole framebuffer
+int lcd_flushed(void) {
+	return (TIMER2_CTL_R & TIMER_CTL_TAEN) == 0;
+}
+
+///Returns the number of bytes the flush has sent to the HD44780
+uint32_t lcd_busWrites(void) {
+	return lcd_busCount;
+}
+
+///Returns 1 while the busy flag is polled, 0 once the driver fell back to fixed delays
+int lcd_busyFlagUsed(void) {
+	return lcd_busyFlagOk;
+}
+
+///Returns the number of busy flag reads so far
+uint32_t lcd_busyFlagPolls(void) {
+	return lcd_busyPolls;
+}
+
+///Send one byte, rs is RS_PIN for a character or 0 for a command
+static void lcd_busWrite(uint8_t data, uint8_t rs) {
+	LCD_PORT_CNTRL = (LCD_PORT_CNTRL & ~(RW_PIN | RS_PIN)) | rs;
+	lcd_sendNibble(data >> 4);
+	lcd_sendNibble(data & 0x0F);
+	lcd_busCount++;
+}
+
+///Background flush, sends at most one byte per tick
+/**
+ * Walks the dirty rows (round robin, so a row that changes all the time cannot
+ * starve the others) and sends the first cell that differs from the display.
+ * A set address command is only sent when the HD44780 address counter is not
+ * already at that cell, so a run of changed cells costs one byte each. A tick
+ * where the controller still reports busy is skipped. The timer is stopped once
+ * every row is clean. Ticking every 40us, it is profiled without trace events,
+ * a redraw would overwrite the whole trace buffer.
+ */
+static void lcd_flushHandler(void) {
+	uint8_t i, row, col, address;
+
+	TIMER2_ICR_R = TIMER_ICR_TATOCINT;
+	PROFILE_BEGIN_UNTRACED(ISR_LCD);
+
+	if (lcd_busyFlagOk && (lcd_readStatus() & LCD_BUSY_FLAG)) {
+		if (++lcd_busyTicks < LCD_FLUSH_BUSY_TICKS) {
+			PROFILE_END_UNTRACED(ISR_LCD);
+			return;
+		}
+		//Never came ready, flush on fixed timing from now on
+		lcd_busyFlagOk = 0;
+		TIMER2_TAILR_R = LCD_FLUSH_FALLBACK_US - 1;
+	}
+	lcd_busyTicks = 0;
+
+	for (;;) {
+		if (lcd_flushRow < 0) {
+			for (i = 1; i <= LCD_HEIGHT; i++) {
+				row = (lcd_lastRow + i) % LCD_HEIGHT;
+				if (lcd_rowDirty[row]) {
+					break;
+				}
+			}
+			if (i > LCD_HEIGHT) {
+				TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
 				break;
-			case 3:
-				lcd_gotoLine(4);
 			}
+			lcd_rowDirty[row] = 0;
+			lcd_lastRow = row;
+			lcd_flushRow = row;
+			lcd_flushCol = 0;
+		}
+
+		row = lcd_flushRow;
+		col = lcd_flushCol;
+		while (col < LCD_WIDTH && lcd_frame[row][col] == lcd_shown[row][col]) {
+			col++;
+		}
+		lcd_flushCol = col;
+
+		if (col == LCD_WIDTH) {
+			lcd_flushRow = -1;
+			continue;
+		}
+
+		address = lcd_lineAddress[row] + col;
+		if (address != lcd_address) {
+			lcd_busWrite(LCD_DDRAM_WRITE | address, 0);
+			lcd_address = address;
+		} else {
+			char c = lcd_frame[row][col];
+			lcd_busWrite(c, RS_PIN);
+			lcd_shown[row][col] = c;
+			lcd_address++;
+			lcd_flushCol++;
 		}
+		break;
 	}
-	va_end(arglist);
-}
 
+	PROFILE_END_UNTRACED(ISR_LCD);
+}
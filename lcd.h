@@ -17,6 +17,17 @@
 #include <inc/tm4c123gh6pm.h>
 #include "Timer.h"
 
+/*
+ * lcd_printf(), lcd_clear() and the lcd_setChar() family only write a 20x4
+ * framebuffer and return immediately. A TIMER2A interrupt sends the cells that
+ * differ from the display in the background, at most one byte every 40us, and
+ * stops once the display is up to date. Every transfer waits on the HD44780
+ * busy flag (RW on PD6, data pins read back as inputs); if the flag never
+ * clears the driver falls back to the worst-case fixed delays. lcd_putc(), lcd_puts(), lcd_sendCommand()
+ * and the cursor functions still talk to the HD44780 directly and would
+ * interleave with the flush; they are only meant for lcd_init().
+ */
+
 /// Extra function for the stepper motor board
 uint8_t lcd_reverseNibble(uint8_t x);
 
@@ -29,11 +40,11 @@ void lcd_putc(char data);
 ///Send Character array to LCD
 void lcd_puts(char data[]);
 
-///Clear LCD Screen
-void inline lcd_clear(void);
+///Clear LCD Screen (framebuffer)
+void lcd_clear(void);
 
 ///Return Cursor to 0,0
-void inline lcd_home(void);
+void lcd_home(void);
 
 ///Goto Line on LCD - 0 Indexed
 void lcd_gotoLine(uint8_t lineNum);
@@ -41,8 +52,33 @@ void lcd_gotoLine(uint8_t lineNum);
 ///Set cursor position - top left is 0,0
 void lcd_setCursorPos(uint8_t x, uint8_t y);
 
+/// Print a formatted string to the framebuffer, newlines move to the next line
 void lcd_printf(const char *format, ...);
 
+///Put one character in the framebuffer, top left is 0,0
+void lcd_setChar(uint8_t x, uint8_t y, char c);
+
+///Put a string in the framebuffer starting at x,y, clipped at the end of the line
+void lcd_putsAt(uint8_t x, uint8_t y, const char *str);
+
+///Replace one whole line of the framebuffer, padded with spaces
+void lcd_putsLine(uint8_t y, const char *str);
+
+///printf into one whole line of the framebuffer, padded with spaces
+void lcd_printfLine(uint8_t y, const char *format, ...);
+
+///Returns 1 once the display shows the whole framebuffer
+int lcd_flushed(void);
+
+///Returns the number of bytes the flush has sent to the HD44780
+uint32_t lcd_busWrites(void);
+
+///Returns 1 while the busy flag is polled, 0 once the driver fell back to fixed delays
+int lcd_busyFlagUsed(void);
+
+///Returns the number of busy flag reads so far
+uint32_t lcd_busyFlagPolls(void);
+
 ///Send command to LCD - Position, Clear, Etc.
 void lcd_sendCommand(uint8_t data);
 
@@ -0,0 +1,267 @@
+/*
+ * locate.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "locate.h"
+
+// Odometry noise, as variance added per unit of motion
+#define LOCATE_ALONG_VAR 0.8     // Along the motion (mm^2 per mm driven)
+#define LOCATE_CROSS_VAR 0.2     // Sideways (mm^2 per mm driven)
+#define LOCATE_TURN_VAR 0.3      // Heading (deg^2 per deg turned)
+#define LOCATE_DRIFT_VAR 0.002   // Heading (deg^2 per mm driven)
+
+// Measurement noise and matching
+#define LOCATE_RANGE_VAR_CM2 4   // Least range variance trusted, whatever the scan says (cm^2)
+#define LOCATE_BEARING_DEG 3     // Standard deviation of the object angle
+#define LOCATE_GATE 9.21         // Mahalanobis distance^2 of a match, chi-square 2 dof at 99%
+#define LOCATE_MAX_WIDTH_CM 10   // Wider objects are not posts
+
+#define LOCATE_RAD(deg) ((deg) * (M_PI / 180))
+#define LOCATE_DEG(rad) ((rad) * (180 / M_PI))
+
+// Typedef struct - A landmark of the field
+typedef struct locate_post
+{
+    int16_t x;      // Centre (mm)
+    int16_t y;
+    int16_t radius;
+} locate_post_t;
+
+// Covariance of x, y (mm) and heading (rad)
+static double locate_P[3][3];
+
+/**
+ * Start from a pose known exactly (the start of the route)
+ *
+ * @param sensor - Sensor object whose pose is set
+ * @param x - (mm)
+ * @param y - (mm)
+ * @param heading - (deg, CCW positive)
+ */
+void locate_init(oi_t *sensor, double x, double y, double heading)
+{
+    sensor->poseX = x;
+    sensor->poseY = y;
+    sensor->poseHeading = heading;
+    memset(locate_P, 0, sizeof(locate_P));
+}
+
+/**
+ * Grow the pose uncertainty by the motion of the latest sensor frame, call once per frame
+ *
+ * @param sensor - Sensor object, distance and angle of the frame already added to the pose
+ */
+void locate_predict(const oi_t *sensor)
+{
+    double d = sensor->distance;
+    double turned = fabs(sensor->angle);
+    double driven = fabs(d);
+
+    if (driven == 0 && turned == 0) {
+        return;
+    }
+
+    // The pose moved along the mean heading of the frame, see oi_updatePoll()
+    double heading = LOCATE_RAD(sensor->poseHeading - sensor->angle / 2);
+    double c = cos(heading);
+    double s = sin(heading);
+    double j0 = -d * s; // Jacobian of x and y by the heading
+    double j1 = d * c;
+    double (*P)[3] = locate_P;
+
+    // P = F P F', F the identity plus j0, j1 in the heading column
+    P[0][0] += 2 * j0 * P[0][2] + j0 * j0 * P[2][2];
+    P[1][1] += 2 * j1 * P[1][2] + j1 * j1 * P[2][2];
+    P[0][1] += j0 * P[1][2] + j1 * P[0][2] + j0 * j1 * P[2][2];
+    P[0][2] += j0 * P[2][2];
+    P[1][2] += j1 * P[2][2];
+
+    // Plus the noise of this frame, along and across the motion
+    double along = LOCATE_ALONG_VAR * driven;
+    double cross = LOCATE_CROSS_VAR * driven;
+    P[0][0] += along * c * c + cross * s * s;
+    P[1][1] += along * s * s + cross * c * c;
+    P[0][1] += (along - cross) * c * s;
+    P[2][2] += LOCATE_RAD(LOCATE_RAD(LOCATE_TURN_VAR * turned + LOCATE_DRIFT_VAR * driven));
+
+    P[1][0] = P[0][1];
+    P[2][0] = P[0][2];
+    P[2][1] = P[1][2];
+}
+
+// Matching a sweep against the landmarks, only built once they are measured
+#ifdef LOCATE_ENABLE
+static const locate_post_t locate_posts[LOCATE_NUM_LANDMARKS] = {
+#define LOCATE_POST(id, x, y, radius) { x, y, radius },
+    LOCATE_LANDMARKS(LOCATE_POST)
+#undef LOCATE_POST
+};
+
+/**
+ * Wrap an angle to -pi to pi
+ */
+static double locate_wrap(double angle)
+{
+    while (angle > M_PI) {
+        angle -= 2 * M_PI;
+    }
+    while (angle <= -M_PI) {
+        angle += 2 * M_PI;
+    }
+    return angle;
+}
+
+/**
+ * Predict the range and bearing the sensor would measure to a landmark
+ *
+ * @param z - Range (mm, to the surface) and bearing (rad, left of the heading)
+ * @param H - Jacobian of z by x, y and heading
+ */
+static void locate_measure(const oi_t *sensor, const locate_post_t *post, double z[2], double H[2][3])
+{
+    double heading = LOCATE_RAD(sensor->poseHeading);
+    double c = cos(heading);
+    double s = sin(heading);
+    double dx = post->x - (sensor->poseX + SCAN_SENSOR_MM * c);
+    double dy = post->y - (sensor->poseY + SCAN_SENSOR_MM * s);
+    double q = dx * dx + dy * dy;
+    double r = sqrt(q);
+
+    z[0] = r - post->radius;
+    z[1] = locate_wrap(atan2(dy, dx) - heading);
+
+    H[0][0] = -dx / r;
+    H[0][1] = -dy / r;
+    H[0][2] = SCAN_SENSOR_MM * (dx * s - dy * c) / r;
+    H[1][0] = dy / q;
+    H[1][1] = -dx / q;
+    H[1][2] = -SCAN_SENSOR_MM * (dx * c + dy * s) / q - 1;
+}
+#endif
+
+/**
+ * Correct the pose with the landmarks found in a sweep taken standing still
+ *
+ * @param sensor - Sensor object whose pose is corrected
+ * @param obstacles - Objects found by the sweep
+ * @param count - Number of objects
+ *
+ * @returns the number of objects matched to a landmark, always 0 without LOCATE_ENABLE
+ */
+int locate_observe(oi_t *sensor, const Obstacle *obstacles, int count)
+{
+#ifdef LOCATE_ENABLE
+    double (*P)[3] = locate_P;
+    uint8_t used[LOCATE_NUM_LANDMARKS] = { 0 };
+    int matched = 0;
+    int i, j, k;
+
+    for (i = 0; i < count; i++)
+    {
+        const Obstacle *obstacle = &obstacles[i];
+        double rangeVar = obstacle->variance > LOCATE_RANGE_VAR_CM2 ? obstacle->variance : LOCATE_RANGE_VAR_CM2;
+        double bearingVar = LOCATE_RAD(LOCATE_BEARING_DEG) * LOCATE_RAD(LOCATE_BEARING_DEG);
+        double best = LOCATE_GATE;
+        double bestNu[2], bestH[2][3], bestS[2][2];
+        int landmark = -1;
+
+        if (obstacle->clipped || obstacle->linearWidth > LOCATE_MAX_WIDTH_CM) {
+            continue;
+        }
+
+        for (j = 0; j < LOCATE_NUM_LANDMARKS; j++)
+        {
+            double z[2], H[2][3], S[2][2], nu[2];
+
+            if (used[j]) {
+                continue;
+            }
+            locate_measure(sensor, &locate_posts[j], z, H);
+            nu[0] = obstacle->dist * 10 - z[0];
+            nu[1] = locate_wrap(LOCATE_RAD(obstacle->angle - 90) - z[1]);
+
+            // S = H P H' + R
+            S[0][0] = rangeVar * 100;
+            S[1][1] = bearingVar;
+            S[0][1] = 0;
+            for (k = 0; k < 3; k++)
+            {
+                double h0 = H[0][0] * P[0][k] + H[0][1] * P[1][k] + H[0][2] * P[2][k];
+                double h1 = H[1][0] * P[0][k] + H[1][1] * P[1][k] + H[1][2] * P[2][k];
+                S[0][0] += h0 * H[0][k];
+                S[0][1] += h0 * H[1][k];
+                S[1][1] += h1 * H[1][k];
+            }
+            S[1][0] = S[0][1];
+
+            double det = S[0][0] * S[1][1] - S[0][1] * S[1][0];
+            double d2 = (nu[0] * nu[0] * S[1][1] - 2 * nu[0] * nu[1] * S[0][1] + nu[1] * nu[1] * S[0][0]) / det;
+            if (d2 < best) {
+                best = d2;
+                landmark = j;
+                memcpy(bestNu, nu, sizeof(nu));
+                memcpy(bestH, H, sizeof(H));
+                memcpy(bestS, S, sizeof(S));
+            }
+        }
+
+        if (landmark < 0) {
+            continue;
+        }
+        used[landmark] = 1;
+        matched++;
+
+        // K = P H' S^-1
+        double det = bestS[0][0] * bestS[1][1] - bestS[0][1] * bestS[1][0];
+        double Si[2][2] = { { bestS[1][1] / det, -bestS[0][1] / det },
+                            { -bestS[1][0] / det, bestS[0][0] / det } };
+        double PHt[3][2], K[3][2], dx[3];
+        for (k = 0; k < 3; k++)
+        {
+            PHt[k][0] = P[k][0] * bestH[0][0] + P[k][1] * bestH[0][1] + P[k][2] * bestH[0][2];
+            PHt[k][1] = P[k][0] * bestH[1][0] + P[k][1] * bestH[1][1] + P[k][2] * bestH[1][2];
+            K[k][0] = PHt[k][0] * Si[0][0] + PHt[k][1] * Si[1][0];
+            K[k][1] = PHt[k][0] * Si[0][1] + PHt[k][1] * Si[1][1];
+            dx[k] = K[k][0] * bestNu[0] + K[k][1] * bestNu[1];
+        }
+
+        // P -= K H P, H P being PHt transposed
+        for (j = 0; j < 3; j++)
+        {
+            for (k = j; k < 3; k++)
+            {
+                P[j][k] -= K[j][0] * PHt[k][0] + K[j][1] * PHt[k][1];
+                P[k][j] = P[j][k];
+            }
+        }
+
+        sensor->poseX += dx[0];
+        sensor->poseY += dx[1];
+        sensor->poseHeading = LOCATE_DEG(locate_wrap(LOCATE_RAD(sensor->poseHeading) + dx[2]));
+    }
+
+    return matched;
+#else
+    (void)sensor;
+    (void)obstacles;
+    (void)count;
+    return 0; // Placeholder landmarks must not move the pose
+#endif
+}
+
+/**
+ * Standard deviations of the pose estimate
+ *
+ * @param x - (mm)
+ * @param y - (mm)
+ * @param heading - (deg)
+ */
+void locate_sigma(double *x, double *y, double *heading)
+{
+    *x = sqrt(locate_P[0][0]);
+    *y = sqrt(locate_P[1][1]);
+    *heading = LOCATE_DEG(sqrt(locate_P[2][2]));
+}
@@ -0,0 +1,88 @@
+/*
+ * locate.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Landmark localization: an extended Kalman filter that corrects the
+ *  odometry pose (oi_t poseX, poseY, poseHeading) in place. The filter only
+ *  keeps the 3x3 covariance of the pose; locate_predict() grows it with
+ *  every sensor frame by how far the wheels went and turned, and
+ *  locate_observe() matches the objects of a sweep against the posts in
+ *  LOCATE_LANDMARKS and pulls the pose towards where they say the CyBot is.
+ *
+ *  An object is matched to the landmark with the smallest Mahalanobis
+ *  distance inside the gate, so passengers, cars and posts too far from
+ *  where the odometry expects them are ignored. Each update is a fixed
+ *  amount of work per object and landmark, and the state is 72 bytes.
+ */
+
+#ifndef LOCATE_H_
+#define LOCATE_H_
+
+#include "open_interface.h"
+#include "scan.h"
+
+#include <stdint.h>
+
+// Uncomment once LOCATE_LANDMARKS holds positions measured on the field, until then no sweep corrects the pose
+//#define LOCATE_ENABLE
+
+/**
+ * Posts of the test field, X(id, x, y, radius) in the odometry frame that
+ * auto_drive() starts at its first leg (mm), turns counted in odometry
+ * degrees like the route. The positions below are placeholders, a sign 250 mm
+ * past each stop and 350 mm to the right of the road worked out from the leg
+ * lengths; they are not measured and LOCATE_ENABLE stays off until they are.
+ */
+#define LOCATE_LANDMARKS(X) \
+    X(STOP1_SIGN, 2611, 1052, 25) \
+    X(STOP2_SIGN, 2401, 3369, 25) \
+    X(STOP3_SIGN, 1080, 2610, 25)
+
+typedef enum
+{
+#define LOCATE_ENUM(id, x, y, radius) LOCATE_##id,
+    LOCATE_LANDMARKS(LOCATE_ENUM)
+#undef LOCATE_ENUM
+    LOCATE_NUM_LANDMARKS
+} locate_landmark_t;
+
+/**
+ * Start from a pose known exactly (the start of the route)
+ *
+ * @param sensor - Sensor object whose pose is set
+ * @param x - (mm)
+ * @param y - (mm)
+ * @param heading - (deg, CCW positive)
+ */
+void locate_init(oi_t *sensor, double x, double y, double heading);
+
+/**
+ * Grow the pose uncertainty by the motion of the latest sensor frame, call once per frame
+ *
+ * @param sensor - Sensor object, distance and angle of the frame already added to the pose
+ */
+void locate_predict(const oi_t *sensor);
+
+/**
+ * Correct the pose with the landmarks found in a sweep taken standing still
+ *
+ * @param sensor - Sensor object whose pose is corrected
+ * @param obstacles - Objects found by the sweep
+ * @param count - Number of objects
+ *
+ * @returns the number of objects matched to a landmark, always 0 without LOCATE_ENABLE
+ */
+int locate_observe(oi_t *sensor, const Obstacle *obstacles, int count);
+
+/**
+ * Standard deviations of the pose estimate
+ *
+ * @param x - (mm)
+ * @param y - (mm)
+ * @param heading - (deg)
+ */
+void locate_sigma(double *x, double *y, double *heading);
+
+#endif /* LOCATE_H_ */
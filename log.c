@@ -0,0 +1,96 @@
+/*
+ * log.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "log.h"
+#include "profile.h"
+#include "telemetry.h"
+#include "Timer.h"
+
+#include <stdbool.h>
+#include "driverlib/interrupt.h"
+
+static log_entry_t log_buffer[LOG_BUFFER_SIZE];
+static volatile uint32_t log_head;  // Next entry to write
+static volatile uint32_t log_tail;  // Next entry to send
+static volatile uint32_t log_dropped;
+
+/**
+ * Empty the log ring
+ */
+void log_init(void)
+{
+    log_head = 0;
+    log_tail = 0;
+    log_dropped = 0;
+}
+
+/**
+ * Store one message in the log ring, safe to call from an ISR
+ * Use the LOG() macro instead so the level check happens at compile time
+ *
+ * @param id - Message from log_msgs.h
+ * @param argc - Number of the arguments that are used
+ */
+void log_write(log_message_t id, uint8_t argc, int32_t a, int32_t b, int32_t c)
+{
+    PROFILE_BEGIN(LOG_WRITE);
+
+    bool was_disabled = IntMasterDisable();
+
+    if (log_head - log_tail >= LOG_BUFFER_SIZE) {
+        // Keep the older messages, they explain how we got here
+        log_dropped++;
+    } else {
+        log_entry_t *entry = &log_buffer[log_head & (LOG_BUFFER_SIZE - 1)];
+        entry->time = timer_getMillis();
+        entry->id = id;
+        entry->argc = argc;
+        entry->args[0] = a;
+        entry->args[1] = b;
+        entry->args[2] = c;
+        log_head++;
+    }
+
+    if (!was_disabled) {
+        IntMasterEnable();
+    }
+
+    PROFILE_END(LOG_WRITE);
+}
+
+/**
+ * Send every pending message as a telemetry LOG record, call from the main loop
+ */
+void log_drain(void)
+{
+    log_entry_t entry;
+
+    while (log_tail != log_head)
+    {
+        // Copy out first so an ISR can reuse the slot while the record is sent
+        bool was_disabled = IntMasterDisable();
+        entry = log_buffer[log_tail & (LOG_BUFFER_SIZE - 1)];
+        log_tail++;
+        if (!was_disabled) {
+            IntMasterEnable();
+        }
+
+        telemetry_sendLog(entry.id, entry.time, entry.args, entry.argc);
+    }
+
+    if (log_dropped != 0)
+    {
+        bool was_disabled = IntMasterDisable();
+        int32_t dropped = log_dropped;
+        log_dropped = 0;
+        if (!was_disabled) {
+            IntMasterEnable();
+        }
+
+        telemetry_sendLog(LOG_DROPPED, timer_getMillis(), &dropped, 1);
+    }
+}
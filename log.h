@@ -0,0 +1,102 @@
+/*
+ * log.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Deferred, tokenized logging. LOG(id, args...) stores the message number,
+ *  a timestamp and up to LOG_MAX_ARGS integer arguments in a RAM ring, which
+ *  is safe and cheap from ISRs and tight loops. log_drain() later sends the
+ *  entries as telemetry LOG records; the text lives only in log_msgs.h and
+ *  is put back together on the host by tools/telemetry.py.
+ *
+ *  Messages below LOG_LEVEL are removed at compile time.
+ */
+
+#ifndef LOG_H_
+#define LOG_H_
+
+#include <stdint.h>
+#include "log_msgs.h"
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE  4
+
+// Lowest level compiled into the firmware, can be overridden from the build options
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Number of entries in the ring (power of two)
+#define LOG_BUFFER_SIZE 32
+
+// Most integer arguments one message can carry
+#define LOG_MAX_ARGS 3
+
+typedef enum
+{
+#define LOG_ENUM(id, level, format) LOG_##id,
+    LOG_MESSAGES(LOG_ENUM)
+#undef LOG_ENUM
+    LOG_NUM_MESSAGES
+} log_message_t;
+
+// Compile-time level of every message, LOG_LEVEL_OF_<id>
+enum
+{
+#define LOG_LEVEL_ENUM(id, level, format) LOG_LEVEL_OF_##id = LOG_LEVEL_##level,
+    LOG_MESSAGES(LOG_LEVEL_ENUM)
+#undef LOG_LEVEL_ENUM
+};
+
+/**
+ * Log a message from log_msgs.h with 0 to LOG_MAX_ARGS integer arguments
+ * e.g. LOG(BUMP, bits) or LOG(STOP_REQUESTED)
+ */
+#define LOG(...) LOG_SELECT(__VA_ARGS__, LOG_3, LOG_2, LOG_1, LOG_0, _)(__VA_ARGS__)
+#define LOG_SELECT(_0, _1, _2, _3, NAME, ...) NAME
+#define LOG_0(id) LOG_EMIT(id, 0, 0, 0, 0)
+#define LOG_1(id, a) LOG_EMIT(id, 1, a, 0, 0)
+#define LOG_2(id, a, b) LOG_EMIT(id, 2, a, b, 0)
+#define LOG_3(id, a, b, c) LOG_EMIT(id, 3, a, b, c)
+
+// The level test is a constant, so disabled messages leave no code behind
+#define LOG_EMIT(id, argc, a, b, c) \
+    do { \
+        if (LOG_LEVEL_OF_##id >= LOG_LEVEL) { \
+            log_write(LOG_##id, (argc), (int32_t)(a), (int32_t)(b), (int32_t)(c)); \
+        } \
+    } while (0)
+
+// Typedef struct - One pending log message
+typedef struct log_entry
+{
+    uint32_t time;  // timer_getMillis() when it was logged
+    uint8_t id;     // log_message_t
+    uint8_t argc;
+    int32_t args[LOG_MAX_ARGS];
+} log_entry_t;
+
+/**
+ * Empty the log ring
+ */
+void log_init(void);
+
+/**
+ * Store one message in the log ring, safe to call from an ISR
+ * Use the LOG() macro instead so the level check happens at compile time
+ *
+ * @param id - Message from log_msgs.h
+ * @param argc - Number of the arguments that are used
+ */
+void log_write(log_message_t id, uint8_t argc, int32_t a, int32_t b, int32_t c);
+
+/**
+ * Send every pending message as a telemetry LOG record, call from the main loop
+ */
+void log_drain(void);
+
+#endif /* LOG_H_ */
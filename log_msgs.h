@@ -0,0 +1,39 @@
+/*
+ * log_msgs.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Table of every log message, X(id, level, "format"). The firmware only
+ *  ever sends the message number (position in this table) and the raw
+ *  arguments; the format strings are compiled out and tools/telemetry.py
+ *  reads them from this file to print the log. Append new messages at the
+ *  end so older captures still decode, and keep the format to %d, %u and %x.
+ */
+
+#ifndef LOG_MSGS_H_
+#define LOG_MSGS_H_
+
+#define LOG_MESSAGES(X) \
+    X(DROPPED,        WARN,  "Log ring overflowed, %u messages dropped") \
+    X(BUMP,           WARN,  "ALERT! CyRide has hit a short object in the road. (bumpers %x)") \
+    X(CLIFF,          WARN,  "ALERT! Sinkhole in the roadway. (cliff sensors %x)") \
+    X(TALL_OBJECT,    WARN,  "ALERT! Tall object present in the roadway at %d deg, %d cm. Waiting for it to cross.") \
+    X(STOP_REQUESTED, INFO,  "Stop Requested") \
+    X(FACING_FORWARD, DEBUG, "Back on the path, facing forward (x offset %d mm)") \
+    X(TELEOP_TIMEOUT, WARN,  "Teleop: no DRIVE command for %d ms, wheels stopped") \
+    X(SCAN_PLAN,      DEBUG, "Roadway check: plan %u (0 cached, 1 partial, 2 full), sweep %u-%u deg") \
+    X(SCAN_CACHE,     INFO,  "Scan cache: %u roadway checks without a sweep, %u partial, %u samples saved") \
+    X(GRID_LOADED,    INFO,  "Field map: %d hazard cells remembered from earlier runs") \
+    X(GRID_SAVED,     INFO,  "Field map: %d hazard cells saved") \
+    X(GRID_SAVE_FAILED, WARN, "Field map: flash did not verify, hazards will be forgotten") \
+    X(GRID_SLOW,      DEBUG, "Known hazard %d mm ahead, slowing to %d mm/s") \
+    X(DETOUR_PLAN,    INFO,  "Detour: %u waypoints, %u mm, %u cells searched") \
+    X(DETOUR_NO_PATH, WARN,  "Detour: no path around the obstacle (attempt %d)") \
+    X(LOCATE_FIX,     INFO,  "Localized on %u landmarks, pose moved %d mm and %d (0.1 deg)") \
+    X(LANE_LEARNT,    INFO,  "Lane keeping calibrated: floor %d left, %d right, light bumper background %d") \
+    X(LANE_STATS,     INFO,  "Lane keeping: steered on %u of %u frames, largest error %u mm") \
+    X(GRID_CLEARED,   INFO,  "Field map: hazards cleared") \
+    X(TALL_OBJECT_GONE, INFO, "Roadway clear again, blocked for %u sweeps (%u ms)")
+
+#endif /* LOG_MSGS_H_ */
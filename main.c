@@ -17,6 +17,10 @@
  */
 void main() {
     /* Init CyBot Subsystems */
+    profile_init();
+    trace_init();
+    log_init();
+    work_init();
     adc_init();
     button_init();
     lcd_init();
@@ -26,26 +30,31 @@ void main() {
     timer_init();
     uart_init(115200);
     uart_interrupt_init();
+    telemetry_init(uart_sendChar);
+    dashboard_init();
 
     /* iRobot Open Interface */
     oi_t *sensor_data;
     sensor_data = oi_alloc();
     oi_init(sensor_data);
 
+    /* Hazards found on earlier runs */
+    grid_init();
+    int hazards = grid_load();
+    if (hazards >= 0) {
+        LOG(GRID_LOADED, hazards);
+    }
+
     // load_songs(); // OI Songs
 
-    /* Wait for user to start */
-    while (1)
-    {
-        char msg = uart_receive();
+    /* Wait for the control center to start ("<id> START", or 't' in a terminal) */
+    control_waitForStart(sensor_data);
 
-        if (msg == 't') {
-            break;
-        }
-    }
+    /* Lane keeping learns the floor where the CyBot was put down */
+    calibrate_lane(sensor_data);
 
     /* Program Main Thread */
-    uart_sendStr("Welcome to CyRide! This is #23: Orange Route\n\r");
+    telemetry_sendText("Welcome to CyRide! This is #23: Orange Route");
 
     turn_clockwise(sensor_data, 80); // Face the passengers, bottom right corner of test field
     int passengerCount = detect_passengers();
@@ -5,15 +5,312 @@
 
 #include "movement.h"
 
+// Cliff sensors packed as left, front left, front right, right (bit 3 to 0)
+#define CLIFF_BITS(sensor) ((sensor)->cliffLeft << 3 | (sensor)->cliffFrontLeft << 2 | (sensor)->cliffFrontRight << 1 | (sensor)->cliffRight)
+
+// Time between pose records while driving
+#define POSE_PERIOD_MS 100
+
+// Teleop stops the wheels when no DRIVE command arrived for this long, longer than the
+// delay before a held key repeats (500 ms on most terminals) plus one repeat
+#define TELEOP_TIMEOUT_MS 600
+
+// Fastest teleop turn rate (deg/s), both wheels at 500 mm/s
+#define TELEOP_MAX_TURN 240
+
+// Gap the Create needs between sensor queries, see oi_update()
+#define CONTROL_OI_GAP_MS 25
+
+// Distance between the wheels of the Create 2 (mm)
+#define WHEEL_BASE 235
+
+// Most objects one scan reports
+#define DETECT_MAX_OBJECTS 7
+
+// Speed (mm/s) within HAZARD_SLOW_MM of a hazard remembered in the grid
+#define HAZARD_SPEED 50
+#define HAZARD_SLOW_MM 300
+
+// Heading errors at a stop up to this (deg) are not turned for
+#define STOP_TURN_TOLERANCE 2
+
+// Part of a scan that counts as the roadway: servo angles and range (cm)
+#define ROADWAY_START 75
+#define ROADWAY_END 115
+#define ROADWAY_CM 50
+
 /* CyBot Properties */
 int NUM_PASSENGERS = 0;
-int DETECTED_OBJS = 0;
-char DEBUG_OUTPUT[65]; // Output message to give PuTTY
 
 /* Global Flags */
 volatile char STOP_FLAG;
 volatile char OBJECT_FLAG;
 
+/* Settings from the control center */
+static int drive_speed = 100;   // Forward driving speed (mm/s)
+static char route_started;      // START received
+static int route_leg;           // Legs of the route driven so far, for the dashboard
+static scan_t route_scans[2];   // Latest sweep and the one before it
+static int route_scanIndex;     // Which of route_scans is the latest
+static scancache_t route_cache; // Last full sweep, answers roadway checks without sweeping
+static avoid_t route_avoid;     // Detour around the last bump or cliff, stepped by the movement loop
+static lane_t route_lane;       // Lane keeping, calibrated by calibrate_lane()
+static double route_travelled;  // Distance of the frames control_poll() applied since move_forward_auto() last took it (mm)
+static unsigned int control_lastFrame; // timer_getMillis() when control_poll() applied the last frame
+static char control_busy;       // control_idle() is running
+
+#ifdef LOCATE_ENABLE
+// Where auto_drive() reaches each stop, facing the next leg (mm, deg). Odometry frame, reset at
+// the start of the route: the headings are the sums of the turns auto_drive() commands, not the
+// real 90, 180 and 180 degrees those turns end up at
+static const double route_stops[3][3] = {
+    { 2217,  880,  78 }, // Stop 1
+    { 2442, 2941, 150 }, // Stop 2
+    { 1099, 2180, 147 }  // Stop 3
+};
+#endif
+
+/* Teleoperation state */
+static char teleop_requested;   // TELEOP received, taken over by the running movement loop
+static char teleop_active;      // move_manual() is running
+static char teleop_moving;      // Wheels are following a DRIVE command
+static unsigned int teleop_lastDrive; // timer_getMillis() of the last DRIVE command
+
+
+/**
+ * Send the dead reckoning pose to the control center
+ *
+ * @param oi_t *sensor - Sensor object holding the pose
+ */
+static void report_pose(oi_t *sensor)
+{
+    telemetry_sendPose((int16_t)sensor->poseX, (int16_t)sensor->poseY, (int16_t)(sensor->poseHeading * 100));
+}
+
+/**
+ * Apply a teleop velocity command to the wheels right away
+ *
+ * @param velocity - Forward speed (mm/s)
+ * @param turnRate - Rotation (deg/s, CCW positive)
+ */
+static void teleop_drive(int velocity, int turnRate)
+{
+    int delta = turnRate * (M_PI / 180) * (WHEEL_BASE / 2);
+    int right = velocity + delta;
+    int left = velocity - delta;
+
+    right = right > 500 ? 500 : (right < -500 ? -500 : right);
+    left = left > 500 ? 500 : (left < -500 ? -500 : left);
+
+    oi_setWheels(right, left);
+    teleop_moving = (right != 0 || left != 0);
+    teleop_lastDrive = timer_getMillis();
+}
+
+/**
+ * Carry out one command from the control center (see cmd.h)
+ *
+ * @param oi_t *sensor - Sensor object to store flags and status
+ * @param cmd - The parsed command
+ */
+static void control_command(oi_t *sensor, const cmd_t *cmd)
+{
+    cmd_status_t status = CMD_OK;
+    int stop;
+
+    switch (cmd->verb)
+    {
+    case CMD_START:
+        if (route_started) {
+            status = CMD_ERR_STATE; // Already driving
+        } else {
+            route_started = 1;
+        }
+        break;
+
+    case CMD_STOP:
+        stop = cmd->argc > 0 ? cmd->args[0] : 0;
+        if (stop < 0 || stop > 3) {
+            status = CMD_ERR_ARGUMENT;
+            break;
+        }
+        STOP_FLAG |= 1 << stop;
+        TRACE_INSTANT(STOP_REQUEST, stop);
+        oi_play_song(0); // Stop Requested Tone
+        dashboard_alert("STOP REQUESTED");
+        LOG(STOP_REQUESTED);
+        break;
+
+    case CMD_SPEED:
+        if (cmd->argc != 1 || cmd->args[0] < 20 || cmd->args[0] > 500) {
+            status = CMD_ERR_ARGUMENT;
+            break;
+        }
+        drive_speed = cmd->args[0]; // Used from the next drive command on
+        break;
+
+    case CMD_POSE:
+        report_pose(sensor);
+        break;
+
+    case CMD_PROFILE:
+        // As records, raw text on the telemetry link would be taken for a broken frame
+        profile_dump(telemetry_sendText);
+        break;
+
+    case CMD_TRACE:
+        telemetry_sendTrace();
+        break;
+
+    case CMD_TELEOP:
+        teleop_requested = 1;
+        break;
+
+    case CMD_DRIVE:
+        if (!teleop_active) {
+            status = CMD_ERR_STATE;
+            break;
+        }
+        if (cmd->argc != 2 || cmd->args[0] < -500 || cmd->args[0] > 500
+                || cmd->args[1] < -TELEOP_MAX_TURN || cmd->args[1] > TELEOP_MAX_TURN) {
+            status = CMD_ERR_ARGUMENT;
+            break;
+        }
+        teleop_drive(cmd->args[0], cmd->args[1]);
+        profile_record(PROFILE_DRIVE_LATENCY, profile_now() - cmd->received);
+        break;
+
+    case CMD_AUTO:
+        if (!teleop_active && !teleop_requested) {
+            status = CMD_ERR_STATE;
+        }
+        teleop_requested = 0;
+        teleop_active = 0;
+        break;
+
+    case CMD_CLEAR:
+        if (grid_clear() < 0) {
+            status = CMD_ERR_STATE;
+            LOG(GRID_SAVE_FAILED);
+        } else {
+            LOG(GRID_CLEARED);
+        }
+        break;
+
+    default:
+        status = CMD_ERR_UNKNOWN;
+        break;
+    }
+
+    cmd_ack(cmd, status);
+}
+
+/**
+ * Everything the control loop does besides reading the sensors: answer commands,
+ * run the work the ISRs deferred and send pending log messages.
+ * Does nothing when called from inside itself, a command or work item never nests it.
+ *
+ * @param oi_t *sensor - Sensor object to store flags and status
+ */
+void control_idle(oi_t *sensor)
+{
+    cmd_t cmd;
+
+    if (control_busy) {
+        return;
+    }
+    control_busy = 1;
+
+    while (cmd_poll(&cmd)) {
+        control_command(sensor, &cmd);
+    }
+
+    work_run();
+    log_drain();
+    dashboard_update(sensor);
+
+    control_busy = 0;
+}
+
+/**
+ * Refresh the sensors, the one loop that serves control_idle() once the route runs: during
+ * the gap the OI needs after the last frame, then while the next frame is received. Then
+ * apply what every loop relies on: the dashboard tick, hazards in the grid, the pose
+ * uncertainty and the distance of the leg
+ *
+ * @param oi_t *sensor - Sensor object to store flags and status
+ * @param timeout - Give up after this long (ms), 0 to wait for as long as it takes
+ *
+ * @returns 1 once the frame was applied, 0 on a timeout (the query is aborted and sent again,
+ *          so the next call waits for a fresh frame rather than one that may never come)
+ */
+int control_poll(oi_t *sensor, unsigned int timeout)
+{
+    unsigned int start = timer_getMillis();
+
+    for (;;)
+    {
+        control_idle(sensor);
+
+        // Same 25ms gap oi_update() leaves to avoid USART errors, a query already sent is kept
+        if (timer_getMillis() - control_lastFrame >= CONTROL_OI_GAP_MS) {
+            oi_updateStart(sensor);
+        }
+        if (oi_updatePoll(sensor)) {
+            break;
+        }
+        if (timeout != 0 && timer_getMillis() - start >= timeout) {
+            // A query was sent once the gap had passed, re-arm it the way oi_updatePoll() does
+            if (timer_getMillis() - control_lastFrame >= CONTROL_OI_GAP_MS) {
+                oi_updateRestart(sensor);
+            }
+            return 0;
+        }
+    }
+
+    control_lastFrame = timer_getMillis();
+    dashboard_loopTick();
+    grid_markContact(sensor);
+    locate_predict(sensor);
+    route_travelled += sensor->distance;
+    return 1;
+}
+
+/**
+ * One step of the control loop: refresh the sensors, serving control_idle() during the
+ * pause the OI needs between queries and while the sensor frame is received.
+ * Use instead of oi_update() in movement loops.
+ *
+ * @param oi_t *sensor - Sensor object to store flags and status
+ */
+void control_update(oi_t *sensor)
+{
+    PROFILE_BEGIN(OI_UPDATE);
+
+    control_poll(sensor, 0);
+
+    PROFILE_END(OI_UPDATE);
+}
+
+/**
+ * Keep the control loop running until the control center sends START
+ *
+ * @param oi_t *sensor - Sensor object to store flags and status
+ */
+void control_waitForStart(oi_t *sensor)
+{
+    double ignored = 0;
+
+    while (!route_started)
+    {
+        control_idle(sensor);
+
+        // The operator may position the CyBot before the route starts
+        if (teleop_requested) {
+            move_manual(sensor, &ignored);
+        }
+    }
+}
 
 /**
  * Stop the CyBot (set motor power to 0)
@@ -31,12 +328,12 @@ void stop()
  */
 void move_forward(oi_t *sensor, int millimeters)
 {
-    oi_setWheels(100, 100); // move full speed ahead
+    oi_setWheels(drive_speed, drive_speed); // move ahead at the commanded speed
 
     double sum = 0;
     while (sum < millimeters) {
         sum += sensor->distance;
-        oi_update(sensor);
+        control_update(sensor);
     }
 
     stop();
@@ -55,7 +352,7 @@ void move_backward(oi_t *sensor, int millimeters)
     double sum = 0;
     while (sum < millimeters) {
         sum -= sensor->distance;
-        oi_update(sensor);
+        control_update(sensor);
     }
 
     stop();
@@ -74,7 +371,7 @@ void turn_clockwise(oi_t *sensor, double degrees)
     double angle = 0;
     while (abs(angle) < degrees) { // checking the angle to make sure not to surpass the user specifies
       angle += sensor->angle;
-      oi_update(sensor);
+      control_update(sensor);
     }
 
     stop();
@@ -93,7 +390,7 @@ void turn_counterclockwise(oi_t *sensor, double degrees)
     double angle = 0;
     while (abs(angle) < degrees) { // checking the angle to make sure not to surpass the user specifies
        angle += sensor->angle;
-       oi_update(sensor);
+       control_update(sensor);
     }
 
     stop();
@@ -107,94 +404,61 @@ void turn_counterclockwise(oi_t *sensor, double degrees)
  */
 int measureDistIR(int raw_val)
 {
-    return 51792 * pow(raw_val, -1.149);
+    return scan_irToCm(raw_val);
 }
 
 /**
  * Scan the environment for objects close to the Cybot using the front-facing servo IR and ultrasonic sensor
- * @returns the object with the smallest width found
+ * The sweep is sent to the control center and summarised on the dashboard
+ *
+ * @param scan - Filled in with the sweep
+ * @param prior - Earlier sweep from the same spot to fuse in, NULL if the CyBot moved since
+ * @param sensor - Stamps the samples with the pose so a sweep while driving can be de-skewed,
+ *                 NULL if the CyBot stands still
+ * @param startAngle - First angle to sweep (deg)
+ * @param endAngle - Last angle to sweep (deg)
+ * @param obstacles - Filled in with the objects found
+ * @param max - Room in obstacles
+ *
+ * @returns the number of objects found
  */
-Obstacle detect_obj()
+int detect_obj(scan_t *scan, const scan_t *prior, oi_t *sensor, uint8_t startAngle, uint8_t endAngle, Obstacle *obstacles, int max)
 {
-    int distancesIR[91];  // Record sensor distances
-
-    int curAngle = 0;     // Angle the sensor is currently set at
-    int i = 0;            // For loop counter
-    int distCount = 0;    // Record of how many distances are above normal
-    int numObs = 0;       // Object count
+    PROFILE_BEGIN(DETECT_OBJ);
 
-    servo_to_right(); // Return to 0 first
-    timer_waitMillis(300);
-
-    // Scan and record sensor data
-    while (curAngle <= 180)
-    {
-        distancesIR[i] = adc_read(); // Should be averaged value via hardware
-
-        //sprintf(DEBUG_OUTPUT, "%d\t\t%d\n\r", curAngle, measureDistIR(distancesIR[i]));
-        //uart_sendStr(DEBUG_OUTPUT);
-
-        servo_move(2);
-        curAngle += 2;
-        i++;
-    }
-
-    // Iterate and find object properties
-    for (i = 0; i < 91; i++)
-    {
-        if (measureDistIR(distancesIR[i]) < 50)
-        { // Max distance IR can read is 50 cm
-            distCount++;
-        }
-        else
-        {
-            if (distCount >= 5)
-            {
-                Obstacle tempObj;
-                tempObj.startAngle = (i - distCount) * 2;
-                tempObj.endAngle = (i - 1) * 2;
-                tempObj.angle = (tempObj.startAngle + tempObj.endAngle) / 2; // Angle midpoint
-                tempObj.startDist = measureDistIR(distancesIR[(i - distCount)]);
-                tempObj.endDist = measureDistIR(distancesIR[(i - 1)]);
-                tempObj.dist = (tempObj.startDist + tempObj.endDist) / 2; // Dist midpoint
-                tempObj.width = tempObj.endAngle - tempObj.startAngle;
-                tempObj.linearWidth = tempObj.width * (M_PI / 180) * tempObj.dist;
-//                        sqrt((pow(tempObj.startDist, 2) + pow(tempObj.endDist, 2))
-//                                - (2 * tempObj.startDist * tempObj.endDist * cos(tempObj.width))); // sqrt(a^2 + b^2 - 2abcos(angle)) = c
-
-                OBJECTS[numObs] = tempObj;
-                numObs++;
-            }
+    int i;
+    int numObs;
+    int nearest = 0;
 
-            distCount = 0;
-        }
+    scan_sweep(scan, startAngle, endAngle, 2, sensor);
+    scan_deskew(scan);
+    if (prior != NULL) {
+        scan_fusePrior(scan, prior);
     }
 
-    // Second scan with PING
-    for (i = 0; i < numObs; i++)
-    {
-        servo_to_right();
-        servo_move(OBJECTS[i].angle);
-
-        OBJECTS[i].ping = ping_read();  // Get PING at midpoint
-        timer_waitMillis(100);
+    // PING the objects the IR found, then find them again on the fused ranges
+    numObs = scan_segment(scan, obstacles, max);
+    scan_ping(scan, obstacles, numObs);
+    if (scan_fusePing(scan, obstacles, numObs) > 0) {
+        numObs = scan_segment(scan, obstacles, max);
     }
 
-    int minWidth = OBJECTS[0].width; // Object with smallest width
-    int smallIndex = 0; // Index of smallest object
+    scan_send(scan); // Fused sweep to the control center
 
-    // Find min width
-    for (i = 0; i < numObs; i++)
+    for (i = 1; i < numObs; i++)
     {
-        if (OBJECTS[i].width < minWidth)
-        {
-            minWidth = OBJECTS[i].width;
-            smallIndex = i;
+        if (obstacles[i].dist < obstacles[nearest].dist) {
+            nearest = i;
         }
     }
+    if (numObs > 0) {
+        dashboard_setScan(numObs, obstacles[nearest].angle, obstacles[nearest].dist);
+    } else {
+        dashboard_setScan(0, DASHBOARD_NO_OBJECT, DASHBOARD_NO_OBJECT);
+    }
 
-    DETECTED_OBJS = numObs;
-    return OBJECTS[smallIndex];
+    PROFILE_END(DETECT_OBJ);
+    return numObs;
 }
 
 /**
@@ -203,206 +467,212 @@ Obstacle detect_obj()
  * @returns the number of passengers detected
  */
 int detect_passengers() {
-    detect_obj();
-    NUM_PASSENGERS = DETECTED_OBJS;
+    Obstacle passengers[DETECT_MAX_OBJECTS];
 
-    // Passenger Count to Control Center
-    sprintf(DEBUG_OUTPUT, "\n\rPassenger Count: %d\n\r", NUM_PASSENGERS);
-    uart_sendStr(DEBUG_OUTPUT);
+    NUM_PASSENGERS = detect_obj(&route_scans[route_scanIndex], NULL, NULL, 0, 180, passengers, DETECT_MAX_OBJECTS);
 
-    // Output Passenger List to Control Center
-    sprintf(DEBUG_OUTPUT, "\n\r### List of Passengers ###\n\r%-12s%-12s%-12s%-12s%-12s\n\r", "Passenger #", "Angle", "IR Distance", "Width", "Linear");
-    uart_sendStr(DEBUG_OUTPUT);
+    // Passenger Count to Control Center
+    telemetry_sendPassengers(NUM_PASSENGERS);
 
+    // Passenger List to Control Center
     int i;
     for (i = 0; i < NUM_PASSENGERS; i++)
     {
-        sprintf(DEBUG_OUTPUT, "%-12d%-12d%-12d%-12d%-12d\n\r", i + 1, OBJECTS[i].angle, OBJECTS[i].dist, OBJECTS[i].width, OBJECTS[i].linearWidth);
-        uart_sendStr(DEBUG_OUTPUT);
+        telemetry_obstacle_t record;
+        record.index = i;
+        record.angle = passengers[i].angle;
+        record.startAngle = passengers[i].startAngle;
+        record.endAngle = passengers[i].endAngle;
+        record.dist = passengers[i].dist;
+        record.ping = passengers[i].ping;
+        record.linearWidth = passengers[i].linearWidth;
+        record.confidence = passengers[i].confidence;
+        telemetry_sendObstacle(&record);
     }
 
-    uart_sendStr("\n\r"); // End Table
-
     return NUM_PASSENGERS;
 }
 
 /**
  * Scan the robot path for tall objects to use in the auto IR check
  *
- * @returns the index of the objects in the way in the global objects array
+ * @param oi_t *sensor - Sensor object holding the pose
+ * @param blocker - Filled in with the object in the way, if any
+ * @param startAngle - First angle to sweep (deg)
+ * @param endAngle - Last angle to sweep (deg)
+ * @param again - The CyBot has not moved since the last scan, fuse that sweep in
+ *
+ * @returns 1 if an object is in the way
  */
-int scan_roadway() {
-    detect_obj();
+int scan_roadway(oi_t *sensor, Obstacle *blocker, uint8_t startAngle, uint8_t endAngle, int again) {
+    Obstacle objects[DETECT_MAX_OBJECTS];
+    const scan_t *prior = again ? &route_scans[route_scanIndex] : NULL;
+
+    route_scanIndex ^= 1;
+    int count = detect_obj(&route_scans[route_scanIndex], prior, sensor, startAngle, endAngle, objects, DETECT_MAX_OBJECTS);
+    grid_markScan(&route_scans[route_scanIndex]);
 
     // Only if the objects are directly in front, consider them in the way
     int i;
-    for (i = 0; i < DETECTED_OBJS; i++) {
-        if ((OBJECTS[i].angle <= 115 && OBJECTS[i].angle >= 75) && OBJECTS[i].dist <= 50) {
-            return i;
+    for (i = 0; i < count; i++) {
+        if (objects[i].angle <= ROADWAY_END && objects[i].angle >= ROADWAY_START && objects[i].dist <= ROADWAY_CM) {
+            *blocker = objects[i];
+            return 1;
         }
     }
 
-    return -1;
+    return 0;
 }
 
 /**
  * A specialized scan from IR to detect tall objects (cars, pedestrians) in the roadway and wait for them to cross
+ * Only the part of the roadway the last full sweep cannot vouch for is swept, see scancache.h
  *
  * @param oi_t *sensor - Sensor object to store flags and status
  */
 void ir_sensor_check(oi_t * sensor) {
+    Obstacle blocker;
+    unsigned int blocked = 0; // Sweeps that found an object in the way
+    uint8_t startAngle = ROADWAY_START;
+    uint8_t endAngle = ROADWAY_END;
+
+    scancache_plan_t plan = scancache_plan(&route_cache, sensor->poseX, sensor->poseY, sensor->poseHeading,
+                                           &startAngle, &endAngle, ROADWAY_CM);
+    LOG(SCAN_PLAN, plan, startAngle, endAngle);
+    if (plan == SCANCACHE_NONE) {
+        oi_setWheels(drive_speed, drive_speed);
+        return;
+    }
+
     oi_setWheels(0, 0);
-    int objIndex = scan_roadway();
 
-    // If objects exist, alert control center until they are gone
-    while (objIndex != -1) {
-        uart_sendStr("ALERT! Tall object present in the roadway. Waiting for it to cross.\n\r");
+    // If objects exist, alert control center until they are gone; one record when the object is
+    // seen and one when it is gone, a car waiting for minutes must not fill the log ring
+    uint32_t since = timer_getMillis();
+    while (scan_roadway(sensor, &blocker, startAngle, endAngle, blocked > 0)) {
+        if (blocked == 0) {
+            LOG(TALL_OBJECT, blocker.angle, blocker.dist);
+        }
+        blocked++;
         oi_setWheels(0, 0);
-        objIndex = scan_roadway();
+    }
+    if (blocked > 0) {
+        LOG(TALL_OBJECT_GONE, blocked, timer_getMillis() - since);
+    }
+
+    // The CyBot stood still, so the last sweep was taken where it stands
+    if (plan == SCANCACHE_FULL) {
+        scancache_store(&route_cache, &route_scans[route_scanIndex], sensor->poseX, sensor->poseY, sensor->poseHeading);
     }
 
-    oi_setWheels(100, 100);
+    oi_setWheels(drive_speed, drive_speed);
 }
 
 /**
- * Autonomously navigate around the object hit or detected
+ * Log and trace a bump or cliff
+ *
+ * @param oi_t *sensor - Sensor object with the bumper and cliff bits
+ *
+ * @returns 1 if a bumper or cliff sensor is triggered
+ */
+static int check_contact(oi_t *sensor)
+{
+    if (sensor->bumpLeft == 1 || sensor->bumpRight == 1) { // We hit something!
+        TRACE_INSTANT(BUMP, sensor->bumpLeft << 1 | sensor->bumpRight);
+        LOG(BUMP, sensor->bumpLeft << 1 | sensor->bumpRight);
+        return 1;
+    }
+    if (sensor->cliffLeft == 1 || sensor->cliffFrontLeft == 1 || sensor->cliffRight == 1 || sensor->cliffFrontRight == 1) {
+        TRACE_INSTANT(CLIFF, CLIFF_BITS(sensor));
+        LOG(CLIFF, CLIFF_BITS(sensor));
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Stop and start a detour around what was just hit
+ *
+ * @param oi_t *sensor - Sensor object with the pose
+ * @param remaining - Distance left on the leg (mm)
+ */
+static void avoid_begin(oi_t *sensor, int remaining)
+{
+    oi_setWheels(0, 0);
+    avoid_start(&route_avoid, sensor, remaining, drive_speed, timer_getMillis());
+    telemetry_sendAvoid(route_avoid.state, route_avoid.previous, route_avoid.spent, 0, 0);
+    OBJECT_FLAG = 1;
+}
+
+/**
+ * Step the detour once and carry out what it asks for: report state changes, scan the
+ * roadway before a segment and set the wheels
  *
  * @param oi_t *sensor - Sensor object to store flags and status
- * @param int direction - The side of the CyBot that the object was detected (0 for left, 1 for right)
  *
- * @returns the x and y coordinate of the new position the robot should be for corrections
+ * @returns 1 while the detour is running, 0 once it is done
  */
-Point go_around_object(oi_t *sensor, int y_remaining) {
-    int tile_width = 600;//width of a hole in the ground
-    int bot_width = 300;//cybot width
-    int bump_width = 100;//width of a short object
-    double backup_dist = 100;//distance to back up when an object is encountered
-    double turn_angle = 42;//angle to turn when incrementally moving around objects
-    double turn_angle_calibrated = turn_angle + 15;//adjusted value of turn_angle for use in distance calculations
-    double target = backup_dist / (cos((turn_angle_calibrated * (3.14 / 180)))) + 200; //if distance traveled while avoiding object surpasses this, the bot is past the object
-
-    Point xy_dists;//struct to store how far the bot has moved in the x and y directions while moving around an object/hole
-    xy_dists.x = 0;//x distance moved
-    xy_dists.y = 0;//y distance moved
-    char object_type;//type of object that the bot encountered, 0 if short object, 1 if hole
-    int object_width;//distance to move to get around object, value set based on object type + width of the bot
-
-    while(OBJECT_FLAG){//main loop executes while bot is avoiding an obstacle, bot backs up, turns slightly,
-                       //then attempts to continue forward to incrementally navigate around the obstacle
-        move_backward(sensor, backup_dist);
-        xy_dists.y -= backup_dist;//subtract backward distance from y value
-        timer_waitMillis(300);
-        turn_counterclockwise(sensor, turn_angle); //turn slightly to go around object
-        timer_waitMillis(300);
-        
-        oi_setWheels(100, 100); //attempt to pass object
-        double sum = 0; //distance traveled forward
-        while (sum < target) { //move forward until bot is able to go around object or another object is encountered
-            if(sensor->bumpLeft == 1 || sensor->bumpRight == 1){//check for bump, restarts main loop if true
-                object_type = 0;
-                uart_sendStr("ALERT! CyRide has hit a short object in the road.\n\r");
-                break;
-            } else if(sensor->cliffLeft == 1 || sensor->cliffFrontLeft == 1 || sensor->cliffFrontRight == 1 || sensor->cliffRight == 1){//check for cliff, restarts main loop if true
-                object_type = 1;
-                uart_sendStr("ALERT! Sinkhole in the roadway.\n\r");
-                break;
-            }
-            sum += sensor->distance;
-            xy_dists.x += sensor->distance * (sin((turn_angle_calibrated * (3.14 / 180))));//calculation for x distance traveled
-            xy_dists.y += sensor->distance * (cos((turn_angle_calibrated * (3.14 / 180))));//calculation for y distance traveled
-            oi_update(sensor);
-        }
-        stop();
-        timer_waitMillis(300);
-        turn_clockwise(sensor, turn_angle); //turn back to original direction to continue forward
-        timer_waitMillis(300);
-        if(sum >= target){//if bot is past the obstacle, move fully past the obstacle while checking for new obstacles
-            if(object_type == 1){ //set distance to fully pass by the object
-                object_width = tile_width + bot_width;
-            } else{
-                object_width = bump_width + bot_width;
-            }
-            ir_sensor_check(sensor);//scan for tall objects in path
-            oi_setWheels(100, 100);
-            sum = 0;
-            while (sum < object_width) { //move forward until past object or another object is encountered
-                if(sensor->bumpLeft == 1 || sensor->bumpRight == 1){//check for bump, restarts main loop if true
-                    uart_sendStr("ALERT! CyRide has hit a short object in the road.\n\r");
-                    object_type = 0;
-                    break;
-                } else if(sensor->cliffFrontLeft == 1 || sensor->cliffFrontRight == 1){ //check for cliff, restarts main loop if true
-                    uart_sendStr("ALERT! Sinkhole in the roadway.\n\r");
-                    object_type = 1;
-                    break;
-                } else if(sensor->cliffLeft == 1) {//checks for cliff on far left
-                    if(object_type == 1){//indicates if bot just went around a cliff, if so turn slightly to avoid the cliff again
-                        stop();
-                        timer_waitMillis(300);
-                        turn_clockwise(sensor, 2);
-                        timer_waitMillis(300);
-                        oi_setWheels(100, 100);
-                    } else {//previous object was a bump, bot needs to move around this cliff, restarts main loop
-                        uart_sendStr("ALERT! Sinkhole in the roadway.\n\r");
-                        object_type = 1;
-                        break;
-                    }
-                } else if(sensor->cliffRight == 1) {//checks for cliff on far right
-                    if(object_type == 1){//indicates if bot just went around a cliff, if so turn slightly to avoid the cliff again
-                        stop();
-                        timer_waitMillis(300);
-                        turn_counterclockwise(sensor, 2);
-                        timer_waitMillis(300);
-                        oi_setWheels(100, 100);
-                    } else {//previous object was a bump, bot needs to move around this cliff, restarts main loop
-                        uart_sendStr("ALERT! Sinkhole in the roadway.\n\r");
-                        object_type = 1;
-                        break;
-                    }
-                }
-                if(xy_dists.y >= y_remaining) {//checks if bot has reached a point where it needs to turn, breaks out of outermost loop and returns to main program
-                    stop();
-                    timer_waitMillis(300);
-                    OBJECT_FLAG = 0;//cleared to break outermost loop
-                    sum = 0;//clears forward distance since bot needs to turn and orientation will change
-                    break;
-                }
-                sum += sensor->distance;
-                xy_dists.y += sensor->distance;
-                oi_update(sensor);
+static int avoid_tick(oi_t *sensor)
+{
+    int16_t right = route_avoid.right;
+    int16_t left = route_avoid.left;
 
-            }
-            stop();
-            timer_waitMillis(300);
-            if(sum >= object_width){//check if bot has moved fully around the encountered obstacle, returns back to path if so
-                turn_clockwise(sensor, 80); //turn back towards the path
-                ir_sensor_check(sensor);
-                oi_setWheels(100, 100);
-                sum = 0;
-                double x_dist = xy_dists.x;
-                while (sum < x_dist) { //move forward until back on the path or another object is encountered
-                    if(sensor->bumpLeft == 1 || sensor->bumpRight == 1){//check for bump, restarts main loop if true
-                        uart_sendStr("ALERT! CyRide has hit a short object in the road.\n\r");
-                        object_type = 0;
-                        break;
-                    } else if(sensor->cliffLeft == 1 || sensor->cliffFrontLeft == 1 || sensor->cliffRight == 1 || sensor->cliffFrontRight == 1){ //check for cliff, restarts main loop if true
-                        uart_sendStr("ALERT! Sinkhole in the roadway.\n\r");
-                        object_type = 1;
-                        break;
-                    }
-                    sum += sensor->distance;
-                    xy_dists.x -= sensor->distance;
-                    oi_update(sensor);
-                }
-                if(sum >= x_dist) { //made it back onto the path, break the outermost loop and return to main program
-                    uart_sendStr("facing forward\n\r");
-                    turn_counterclockwise(sensor, 76); //back to facing forward
-                    timer_waitMillis(300);
-                    OBJECT_FLAG = 0; //clear flag to end outermost loop
-                }
+    // Bumps and cliffs while detouring, avoid_step() plans around them
+    if (route_avoid.state == AVOID_TURN || route_avoid.state == AVOID_DRIVE) {
+        check_contact(sensor);
+    }
+
+    PROFILE_BEGIN(AVOID);
+    int running = avoid_step(&route_avoid, sensor, timer_getMillis());
+    PROFILE_END(AVOID);
+
+    if (route_avoid.changed) {
+        telemetry_sendAvoid(route_avoid.state, route_avoid.previous, route_avoid.spent,
+                            route_avoid.attempt, route_avoid.waypoint);
+        if (route_avoid.previous == AVOID_PLAN) {
+            if (route_avoid.path.count > 0) {
+                LOG(DETOUR_PLAN, route_avoid.path.count, route_avoid.path.length, route_avoid.path.expanded);
+            } else {
+                LOG(DETOUR_NO_PATH, route_avoid.attempt);
             }
         }
     }
-    return xy_dists;//returns change in x and y values
+
+    // ir_sensor_check() leaves the wheels at drive_speed, so they are always set after it
+    if (route_avoid.scan) {
+        ir_sensor_check(sensor);
+    }
+    if (route_avoid.scan || route_avoid.right != right || route_avoid.left != left) {
+        oi_setWheels(route_avoid.right, route_avoid.left);
+    }
+
+    OBJECT_FLAG = running;
+    return running;
+}
+
+/**
+ * Autonomously navigate around the object hit or detected, blocking until back on the leg
+ * The bump or cliff is already in the grid (control_update() marks it). The CyBot backs off,
+ * plans the shortest safe path over the grid back onto its line (see plan.h) and drives it;
+ * every new bump or cliff on the way is planned around in turn. move_forward_auto() steps
+ * the same detour (avoid.h) from its own loop instead of waiting here.
+ *
+ * @param oi_t *sensor - Sensor object to store flags and status
+ * @param int y_remaining - Distance left on the current leg, the detour does not rejoin past it
+ *
+ * @returns how far the CyBot moved along the leg (y) and to the left of it (x)
+ */
+Point go_around_object(oi_t *sensor, int y_remaining) {
+    Point xy_dists;
+
+    avoid_begin(sensor, y_remaining);
+    while (avoid_tick(sensor)) {
+        control_update(sensor);
+    }
+
+    avoid_offset(&route_avoid, sensor, &xy_dists.y, &xy_dists.x);
+    LOG(FACING_FORWARD, (int)xy_dists.x);
+    return xy_dists;
 }
 
 /**
@@ -415,68 +685,201 @@ Point go_around_object(oi_t *sensor, int y_remaining) {
  * @returns the distance the robot just traveled
  */
 double move_forward_auto(oi_t *sensor, int millimeters) {
+    TRACE_INSTANT(LEG_START, 0);
+    route_leg++;
+
 //    ir_sensor_check(sensor);
-    oi_setWheels(100, 100); // Set power and drive baby
+    oi_setWheels(drive_speed, drive_speed); // Set power and drive baby
 
     int num_scans = 1;
+    int slowed = 0;
+    int wheelSpeed = drive_speed; // Wheel command last sent: speed + steer right, speed - steer left
+    int wheelSteer = 0;
+    unsigned int lastPose = timer_getMillis();
     double sum = 0;
-    Point autoPoint;
     double x_dist = 0;
+    double detourSum = 0; // sum when the detour started
+    double along, left;
+    route_travelled = 0;
     while (sum < millimeters) {
-
-        //sprintf(DEBUG_OUTPUT, "%d\t\t%d\n\r", curAngle, measureDistIR(distancesIR[i]));
-        //uart_sendStr(DEBUG_OUTPUT);
+        PROFILE_BEGIN(MOTION_LOOP);
+
+        /* Detour in progress, the rest of the loop keeps running while it is stepped */
+        if (OBJECT_FLAG) {
+            if (!avoid_tick(sensor)) {
+                avoid_offset(&route_avoid, sensor, &along, &left);
+                sum = detourSum + along;
+                x_dist += left; // On top of what teleop added earlier on the leg
+                LOG(FACING_FORWARD, (int)x_dist);
+                oi_setWheels(drive_speed, drive_speed); // Set power and drive baby
+                wheelSpeed = drive_speed;
+                wheelSteer = 0;
+            }
+        }
 
         /* IR Sensor Check */
-        if (sum >= (num_scans * 500)) {
+        else if (sum >= (num_scans * 500)) {
             ir_sensor_check(sensor);
             num_scans++;
+            wheelSpeed = drive_speed;
+            wheelSteer = 0;
         }
 
-        /* Bump Sensor Check */
-        if (sensor->bumpLeft == 1 || sensor->bumpRight == 1) { // We hit something!
-            uart_sendStr("ALERT! CyRide has hit a short object in the road.\n\r");
-            oi_setWheels(0, 0);
-            timer_waitMillis(300);
-
-            OBJECT_FLAG = 1;
-            autoPoint = go_around_object(sensor, millimeters - sum);
-            sum += autoPoint.y;
-            x_dist = autoPoint.x;
-            oi_setWheels(100, 100); // Set power and drive baby
+        /* Bump and Cliff Sensor Check */
+        if (!OBJECT_FLAG && check_contact(sensor)) {
+            avoid_begin(sensor, millimeters - sum);
+            detourSum = sum;
         }
-        
-        /* Cliff Sensor Check */
-        if (sensor->cliffLeft == 1 || sensor->cliffFrontLeft == 1 || sensor->cliffRight == 1 || sensor->cliffFrontRight == 1) {
-            uart_sendStr("ALERT! Pot hole in the roadway.\n\r");
-            oi_setWheels(0, 0);
-            timer_waitMillis(300);
-            
-            OBJECT_FLAG = 1;
-            autoPoint = go_around_object(sensor, millimeters - sum);
-            sum += autoPoint.y;
-            x_dist = autoPoint.x;
-            oi_setWheels(100, 100); // Set power and drive baby
+
+        /* Known Hazard Check */
+        int hazard = OBJECT_FLAG ? -1 : grid_hazardAhead(sensor->poseX, sensor->poseY, sensor->poseHeading, HAZARD_SLOW_MM);
+        if (hazard >= 0 && drive_speed > HAZARD_SPEED) {
+            if (!slowed) {
+                LOG(GRID_SLOW, hazard, HAZARD_SPEED);
+            }
+            slowed = 1;
+        } else if (!OBJECT_FLAG) {
+            slowed = 0;
         }
 
-//        /* Border Sensor Check */
-//        if (sensor->lightBumpRightSignal == 1 || sensor->lightBumpCenterRightSignal == 1 || sensor->lightBumpFrontRightSignal == 1) {
-//           stop();
-//           timer_waitMillis(300);
-//           turn_counterclockwise(sensor, 3);
-//           timer_waitMillis(300);
-//           oi_setWheels(100, 100);
-//        }
+        /* Lane Keeping, also applies the speed chosen above */
+        if (!OBJECT_FLAG) {
+            int speed = slowed ? HAZARD_SPEED : drive_speed;
+            int steer = lane_steer(&route_lane, sensor, speed);
+            if (speed != wheelSpeed || steer != wheelSteer) {
+                oi_setWheels(speed + steer, speed - steer);
+                wheelSpeed = speed;
+                wheelSteer = steer;
+            }
+        }
 
-        // lcd_printf("%lf", sum);
-        sum += sensor->distance;
-        oi_update(sensor);
+        /* Pose to Control Center */
+        if (timer_getMillis() - lastPose >= POSE_PERIOD_MS) {
+            report_pose(sensor);
+            lastPose = timer_getMillis();
+        }
+
+        /* Manual override requested by the control center */
+        if (teleop_requested) {
+            if (OBJECT_FLAG) {
+                // The detour measures from the pose, it simply carries on from where the operator left the CyBot
+                double ignored = 0;
+                move_manual(sensor, &ignored);
+                oi_setWheels(route_avoid.right, route_avoid.left);
+            } else {
+                x_dist += move_manual(sensor, &sum);
+                oi_setWheels(drive_speed, drive_speed);
+                wheelSpeed = drive_speed;
+                wheelSteer = 0;
+            }
+            route_travelled = 0; // move_manual() already accounted for its frames
+        }
+
+        // Every frame since the last pass, the ones of a roadway sweep too
+        if (!OBJECT_FLAG) {
+            sum += route_travelled;
+        }
+        route_travelled = 0;
+        dashboard_setLeg(route_leg, sum, millimeters);
+        control_update(sensor);
+
+        PROFILE_END(MOTION_LOOP);
     }
 
     stop();
+    report_pose(sensor);
     return x_dist;
 }
 
+/**
+ * Learn the floor and the light bumper background for lane keeping (see lane.h)
+ * The CyBot has to stand in the lane, clear of the tape and of walls
+ *
+ * @param oi_t *sensor - Sensor object to store flags and status
+ */
+void calibrate_lane(oi_t *sensor)
+{
+    lane_init(&route_lane);
+    do {
+        control_update(sensor);
+    } while (!lane_learn(&route_lane, sensor));
+
+    LOG(LANE_LEARNT, route_lane.floor[0] / 16, route_lane.floor[3] / 16, route_lane.ambient[3] / 16);
+}
+
+/**
+ * Wait for passengers if a stop was requested for this stop or for the next stop
+ *
+ * @param int stop - Number of the stop that was reached
+ */
+static void serve_stop(int stop)
+{
+    char mask = 1 | 1 << stop;
+
+    if (STOP_FLAG & mask) {
+        timer_waitMillis(3000);
+        dashboard_alert(NULL);
+        STOP_FLAG &= ~mask;
+    }
+}
+
+/**
+ * Sweep for the posts of the field at a stop and correct the pose with them (see locate.h).
+ * Only when a post was matched does the CyBot face the heading the route expects there and
+ * the next leg account for where it really stopped.
+ *
+ * @param oi_t *sensor - Sensor object to store flags and status
+ * @param int stop - Number of the stop that was reached
+ * @param double *x_dist - Set to how far the CyBot is past the stop along the next leg (mm),
+ *                         left alone if no post was matched
+ *
+ * @returns the number of posts matched
+ */
+static int relocate(oi_t *sensor, int stop, double *x_dist)
+{
+#ifdef LOCATE_ENABLE
+    Obstacle objects[DETECT_MAX_OBJECTS];
+    const double *expected = route_stops[stop - 1];
+    double x = sensor->poseX;
+    double y = sensor->poseY;
+    double heading = sensor->poseHeading;
+
+    route_scanIndex ^= 1;
+    int count = detect_obj(&route_scans[route_scanIndex], NULL, NULL, 0, 180, objects, DETECT_MAX_OBJECTS);
+    int matched = locate_observe(sensor, objects, count);
+
+    double moved = sqrt((sensor->poseX - x) * (sensor->poseX - x) + (sensor->poseY - y) * (sensor->poseY - y));
+    double turned = sensor->poseHeading - heading;
+    LOG(LOCATE_FIX, matched, (int)moved, (int)(turned * 10));
+
+    if (matched == 0) {
+        return 0;
+    }
+
+    double turn = expected[2] - sensor->poseHeading;
+    while (turn > 180) {
+        turn -= 360;
+    }
+    while (turn <= -180) {
+        turn += 360;
+    }
+    if (turn > STOP_TURN_TOLERANCE) {
+        turn_counterclockwise(sensor, turn);
+    } else if (turn < -STOP_TURN_TOLERANCE) {
+        turn_clockwise(sensor, -turn);
+    }
+
+    *x_dist = (sensor->poseX - expected[0]) * cos(expected[2] * (M_PI / 180))
+            + (sensor->poseY - expected[1]) * sin(expected[2] * (M_PI / 180));
+    return matched;
+#else
+    (void)sensor;
+    (void)stop;
+    (void)x_dist;
+    return 0; // No measured landmarks, a sweep could not correct anything
+#endif
+}
+
 /**
  * Perform the CyRide 23 Orange Route test path autonomously
  * Please see the Test Field diagram for a visual path. The measurements have been
@@ -488,100 +891,108 @@ void auto_drive(oi_t *sensor_data)
 {
     double x_dist;
     double x_dist2;
+
+    scancache_init(&route_cache);
+    locate_init(sensor_data, 0, 0, 0); // route_stops and the landmarks are measured from here
     x_dist = move_forward_auto(sensor_data, 2030); // 203 cm
     turn_counterclockwise(sensor_data, 78); // 90 deg
     timer_waitMillis(300);
-    uart_sendStr("Now approaching Stop 1\n\r");
+    telemetry_sendAlert(TELEMETRY_ALERT_APPROACHING, 1);
     x_dist2 = move_forward_auto(sensor_data, 900 - x_dist);
 
     // Stop 1 reached
-    uart_sendStr("Stop 1 Reached\n\r");
-
-    if (STOP_FLAG) {
-        timer_waitMillis(3000);
-        lcd_clear();
-        STOP_FLAG = 0;
-    }
+    telemetry_sendAlert(TELEMETRY_ALERT_STOP_REACHED, 1);
+    TRACE_INSTANT(STOP_REACHED, 1);
+    serve_stop(1);
+    relocate(sensor_data, 1, &x_dist2);
 
     x_dist = move_forward_auto(sensor_data, 365 - x_dist2);
     turn_counterclockwise(sensor_data, 7); // 14 deg
     timer_waitMillis(300);
     x_dist2 = move_forward_auto(sensor_data, 1710 - x_dist);
-    uart_sendStr("Now approaching Stop 2\n\r");
+    telemetry_sendAlert(TELEMETRY_ALERT_APPROACHING, 2);
     turn_counterclockwise(sensor_data, 65); // 76 deg
     timer_waitMillis(300);
 
     // Stop 2 reached
-    uart_sendStr("Stop 2 Reached\n\r");
-
-    if (STOP_FLAG) {
-        timer_waitMillis(3000);
-        lcd_clear();
-        STOP_FLAG = 0;
-    }
+    telemetry_sendAlert(TELEMETRY_ALERT_STOP_REACHED, 2);
+    TRACE_INSTANT(STOP_REACHED, 2);
+    serve_stop(2);
+    relocate(sensor_data, 2, &x_dist2);
 
     x_dist = move_forward_auto(sensor_data, 500 - x_dist2);
     turn_counterclockwise(sensor_data, 78); // 90 deg
     timer_waitMillis(300);
     x_dist2 = move_forward_auto(sensor_data, 1360 - x_dist);
-    uart_sendStr("Now approaching Stop 3\n\r");
+    telemetry_sendAlert(TELEMETRY_ALERT_APPROACHING, 3);
     turn_clockwise(sensor_data, 81); // 90 deg
     timer_waitMillis(300);
 
     // Stop 3 reached
-    uart_sendStr("Stop 3 Reached\n\r");
-    if (STOP_FLAG) {
-        timer_waitMillis(3000);
-        lcd_clear();
-        STOP_FLAG = 0;
-    }
+    telemetry_sendAlert(TELEMETRY_ALERT_STOP_REACHED, 3);
+    TRACE_INSTANT(STOP_REACHED, 3);
+    serve_stop(3);
+    relocate(sensor_data, 3, &x_dist2);
 
     x_dist = move_forward_auto(sensor_data, 1000 - x_dist2);
     turn_counterclockwise(sensor_data, 78); // 90 deg
     timer_waitMillis(300);
     x_dist2 = move_forward_auto(sensor_data, 1400 - x_dist);
-    uart_sendStr("Now approaching Park & Ride Terminal\n\r");
+    telemetry_sendAlert(TELEMETRY_ALERT_APPROACHING, 4);
     turn_counterclockwise(sensor_data, 73); // 90 deg
     timer_waitMillis(300);
+
+    LOG(SCAN_CACHE, route_cache.plans[SCANCACHE_NONE], route_cache.plans[SCANCACHE_PARTIAL], route_cache.saved);
+    LOG(LANE_STATS, route_lane.corrected, route_lane.frames, route_lane.worst);
+
+    // Remember the hazards of this run for the next one
+    int hazards = grid_save();
+    if (hazards < 0) {
+        LOG(GRID_SAVE_FAILED);
+    } else {
+        LOG(GRID_SAVED, hazards);
+    }
 }
 
 /**
  * Manual override to drive the CyBot
+ * Follows DRIVE commands (velocity and turn rate) until AUTO is received and stops the
+ * wheels whenever no DRIVE command arrived for TELEOP_TIMEOUT_MS
  *
  * @param oi_t *sensor - Sensor object to store flags and status
  * @param double *sum - Pointer to sensor's distance sum to update autonomous after manual override completes
+ *
+ * @returns the sideways offset (mm, left positive) from the heading the override started at
  */
-void move_manual(oi_t *sensor, double * sum, int distance) {
-    while (1)
-    {
-        char msg = uart_receive();
-        int angle = 0;
+double move_manual(oi_t *sensor, double * sum) {
+    double startX = sensor->poseX;
+    double startY = sensor->poseY;
+    double heading = sensor->poseHeading * (M_PI / 180);
+
+    teleop_requested = 0;
+    teleop_active = 1;
+    teleop_lastDrive = timer_getMillis();
+    stop();
 
-        // CyRide corrected manually, ready to return to auto drive
-        if (msg == 'e') {
-            break;
-        }
+    while (teleop_active)
+    {
+        control_update(sensor); // DRIVE commands are applied from here as they arrive
 
-        // If 0, Manual mode
-        if (msg == 'w')
-        {
-            move_forward(sensor, 50);
-            distance -= 5;
-        }
-        else if (msg == 's')
-        {
-            move_backward(sensor, 50);
-            distance += 5;
-        }
-        else if (msg == 'a')
-        {
-            turn_counterclockwise(sensor, 5);
-            angle += 5;
-        }
-        else if (msg == 'd')
-        {
-            turn_clockwise(sensor, 5);
-            angle -= 5;
+        // Dead-man: the operator's link went quiet
+        if (teleop_moving && timer_getMillis() - teleop_lastDrive > TELEOP_TIMEOUT_MS) {
+            stop();
+            teleop_moving = 0;
+            LOG(TELEOP_TIMEOUT, TELEOP_TIMEOUT_MS);
         }
     }
+
+    stop();
+    teleop_moving = 0;
+
+    // Hand the distance covered along the route back to the autonomous drive
+    double dx = sensor->poseX - startX;
+    double dy = sensor->poseY - startY;
+    *sum += dx * cos(heading) + dy * sin(heading);
+
+    return -dx * sin(heading) + dy * cos(heading);
 }
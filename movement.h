@@ -10,33 +10,32 @@
 
 /* CyBot Subsystems */
 #include "adc.h"
+#include "avoid.h"
 #include "button.h"
+#include "cmd.h"
+#include "dashboard.h"
+#include "grid.h"
+#include "lane.h"
 #include "lcd.h"
+#include "locate.h"
+#include "log.h"
 #include "music.h"
 #include "open_interface.h"
 #include "ping.h"
+#include "plan.h"
+#include "profile.h"
+#include "scan.h"
+#include "scancache.h"
 #include "servo.h"
+#include "telemetry.h"
 #include "Timer.h"
 #include "uart.h"
+#include "work.h"
 
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-// Typedef struct - Obstacle properties such as angle located, distance away from robot, width, and linear width
-typedef struct Obstacle
-{
-    int startAngle;
-    int endAngle;
-    int angle; // Angle at the midpoint of object
-    int startDist;
-    int endDist;
-    int dist;
-    int ping;
-    int width;
-    int linearWidth;
-} Obstacle;
-
 // Point struct to track the CyBot's location in the xy plane
 typedef struct Point
 {
@@ -44,8 +43,42 @@ typedef struct Point
     double y;
 } Point;
 
-Obstacle OBJECTS[7];  // List to record found obstacles
-char DEBUG_OUTPUT[65]; // Output message to give PuTTY
+/**
+ * Everything the control loop does besides reading the sensors: answer commands,
+ * run the work the ISRs deferred and send pending log messages
+ *
+ * @param oi_t *sensor - Sensor object to store flags and status
+ */
+void control_idle(oi_t *sensor);
+
+/**
+ * Refresh the sensors, the one loop that serves control_idle() once the route runs: during
+ * the gap the OI needs after the last frame, then while the next frame is received. Then
+ * apply what every loop relies on: the dashboard tick, hazards in the grid, the pose
+ * uncertainty and the distance of the leg
+ *
+ * @param oi_t *sensor - Sensor object to store flags and status
+ * @param timeout - Give up after this long (ms), 0 to wait for as long as it takes
+ *
+ * @returns 1 once the frame was applied, 0 on a timeout (the query is aborted and sent again,
+ *          so the next call waits for a fresh frame rather than one that may never come)
+ */
+int control_poll(oi_t *sensor, unsigned int timeout);
+
+/**
+ * One step of the control loop: control_poll() without a timeout.
+ * Use instead of oi_update() in movement loops.
+ *
+ * @param oi_t *sensor - Sensor object to store flags and status
+ */
+void control_update(oi_t *sensor);
+
+/**
+ * Keep the control loop running until the control center sends START
+ *
+ * @param oi_t *sensor - Sensor object to store flags and status
+ */
+void control_waitForStart(oi_t *sensor);
 
 /**
  * Stop the CyBot (set motor power to 0)
@@ -94,9 +127,20 @@ int measureDistIR(int raw_val);
 
 /**
  * Scan the environment for objects close to the Cybot using the front-facing servo IR and ultrasonic sensor
- * @returns the object with the smallest width found
+ * The sweep is sent to the control center and summarised on the dashboard
+ *
+ * @param scan - Filled in with the sweep
+ * @param prior - Earlier sweep from the same spot to fuse in, NULL if the CyBot moved since
+ * @param sensor - Stamps the samples with the pose so a sweep while driving can be de-skewed,
+ *                 NULL if the CyBot stands still
+ * @param startAngle - First angle to sweep (deg)
+ * @param endAngle - Last angle to sweep (deg)
+ * @param obstacles - Filled in with the objects found
+ * @param max - Room in obstacles
+ *
+ * @returns the number of objects found
  */
-Obstacle detect_obj();
+int detect_obj(scan_t *scan, const scan_t *prior, oi_t *sensor, uint8_t startAngle, uint8_t endAngle, Obstacle *obstacles, int max);
 
 /**
  * A specialized scan from IR to detect the number of passengers located at the starting platform
@@ -108,26 +152,37 @@ int detect_passengers();
 /**
  * Scan the robot path for tall objects to use in the auto IR check
  *
- * @returns the index of the objects in the way in the global objects array
+ * @param oi_t *sensor - Sensor object holding the pose
+ * @param blocker - Filled in with the object in the way, if any
+ * @param startAngle - First angle to sweep (deg)
+ * @param endAngle - Last angle to sweep (deg)
+ * @param again - The CyBot has not moved since the last scan, fuse that sweep in
+ *
+ * @returns 1 if an object is in the way
  */
-int scan_roadway();
+int scan_roadway(oi_t *sensor, Obstacle *blocker, uint8_t startAngle, uint8_t endAngle, int again);
 
 /**
  * A specialized scan from IR to detect tall objects (cars, pedestrians) in the roadway and wait for them to cross
+ * Only the part of the roadway the last full sweep cannot vouch for is swept, see scancache.h
  *
  * @param oi_t *sensor - Sensor object to store flags and status
  */
 void ir_sensor_check(oi_t * sensor);
 
 /**
- * Autonomously navigate around the object hit or detected
+ * Autonomously navigate around the object hit or detected, blocking until back on the leg
+ * The bump or cliff is already in the grid (control_update() marks it). The CyBot backs off,
+ * plans the shortest safe path over the grid back onto its line (see plan.h) and drives it;
+ * every new bump or cliff on the way is planned around in turn. move_forward_auto() steps
+ * the same detour (avoid.h) from its own loop instead of waiting here.
  *
  * @param oi_t *sensor - Sensor object to store flags and status
- * @param int direction - The side of the CyBot that the object was detected (0 for left, 1 for right)
+ * @param int y_remaining - Distance left on the current leg, the detour does not rejoin past it
  *
- * @returns the x and y coordinate of the new position the robot should be for corrections
+ * @returns how far the CyBot moved along the leg (y) and to the left of it (x)
  */
-Point go_around_object(oi_t *sensor, int y_remaining,);
+Point go_around_object(oi_t *sensor, int y_remaining);
 
 /**
  * Move the CyBot forward a set distance with autonomous detection and correction for objects in the path
@@ -140,6 +195,14 @@ Point go_around_object(oi_t *sensor, int y_remaining,);
  */
 double move_forward_auto(oi_t *sensor, int millimeters);
 
+/**
+ * Learn the floor and the light bumper background for lane keeping (see lane.h)
+ * The CyBot has to stand in the lane, clear of the tape and of walls
+ *
+ * @param oi_t *sensor - Sensor object to store flags and status
+ */
+void calibrate_lane(oi_t *sensor);
+
 /**
  * Perform the CyRide 23 Orange Route test path autonomously
  * Please see the Test Field diagram for a visual path. The measurements have been
@@ -151,10 +214,14 @@ void auto_drive(oi_t *sensor_data);
 
 /**
  * Manual override to drive the CyBot
+ * Follows DRIVE commands (velocity and turn rate) until AUTO is received and stops the
+ * wheels whenever no DRIVE command arrived for TELEOP_TIMEOUT_MS
  *
  * @param oi_t *sensor - Sensor object to store flags and status
  * @param double *sum - Pointer to sensor's distance sum to update autonomous after manual override completes
+ *
+ * @returns the sideways offset (mm, left positive) from the heading the override started at
  */
-void move_manual(oi_t *sensor, double * sum, int distance);
+double move_manual(oi_t *sensor, double * sum);
 
 #endif /* MOVEMENT_H_ */
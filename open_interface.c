@@ -16,6 +16,18 @@
  */
 
 #include "open_interface.h"
+#include "profile.h"
+#include "udma.h"
+#include "work.h"
+
+//used to get the current moved degrees from encoder count
+static double oi_getDegrees(oi_t *self);
+
+// Get the number of radians moved since last call
+static double oi_getRadians(oi_t *self);
+
+// Gets the distance moved since the last call to getDistance
+static double oi_getDistance(oi_t *self);
 
 #define OI_OPCODE_START 128
 #define OI_OPCODE_BAUD 129
@@ -85,6 +97,11 @@
 float motor_cal_factor_L = 1.00;
 float motor_cal_factor_R = 1.00;
 
+// Shutoff button, see GPIOF_Handler()
+static volatile uint8_t oi_shutoff;     // Pressed since oi_init, the wheels stay stopped
+static volatile uint8_t oi_txOpen;      // A multi-byte command is being written at thread level
+static volatile uint8_t oi_stopPending; // Pressed while it was, stop the wheels once it is written
+
 /// Initialize the iRobot open interface without updating a struct
 /// internal function
 void oi_init_noupdate(void);
@@ -120,6 +137,32 @@ void oi_uartSendBuff(const uint8_t theData[], uint8_t theSize);
 /// internal function
 int16_t oi_parseInt(uint8_t *theInt);
 
+/// Write a drive command with both wheels at 0, from the shutoff ISR as well
+/// With the 16 byte TX FIFO on this waits for at most 5 bytes (434 us) to drain
+static void oi_stopWheels(void)
+{
+    oi_uartSendChar(OI_OPCODE_DRIVE_WHEELS);
+    oi_uartSendChar(0);
+    oi_uartSendChar(0);
+    oi_uartSendChar(0);
+    oi_uartSendChar(0);
+}
+
+/// Bracket a multi-byte command so the shutoff button cannot split it
+static void oi_txBegin(void)
+{
+    oi_txOpen = 1;
+}
+
+static void oi_txEnd(void)
+{
+    oi_txOpen = 0;
+    if (oi_stopPending) {
+        oi_stopPending = 0;
+        oi_stopWheels();
+    }
+}
+
 /// Allocate and clear all memory for OI Struct
 oi_t *oi_alloc()
 {
@@ -140,6 +183,7 @@ void oi_init_noupdate()
 {
     timer_init();
     oi_uartInit();
+    oi_shutoff = 0;
     oi_uartSendChar(OI_OPCODE_START);
 
     oi_uartSendChar(OI_OPCODE_FULL); // Use full mode, unrestricted control
@@ -163,6 +207,10 @@ void oi_init(oi_t *self)
     oi_update(self);
     oi_update(self); // Call twice to clear distance/angle
 
+    self->poseX = 0;
+    self->poseY = 0;
+    self->poseHeading = 0;
+
 }
 
 void oi_close()
@@ -171,31 +219,120 @@ void oi_close()
     oi_uartSendChar(OI_OPCODE_STOP);
 }
 
-/// Update all sensor and store in oi_t struct
-void oi_update(oi_t *self)
+/// Sensor frame filled by the uDMA in the background
+static uint8_t oi_sensorBuffer[SENSOR_PACKET_SIZE];
+static volatile char oi_frameReady;   // The uDMA has delivered a full frame
+static char oi_frameRequested;        // A sensor query is outstanding
+static uint32_t oi_frameStart;        // profile_now() when it was sent, runs with interrupts off too
+static oi_linkStats_t oi_linkStats;   // Receive errors of the sensor link
+
+/// uDMA completion of a sensor frame, runs in the UART4 ISR
+static void oi_frameDone(uint8_t channel)
 {
-    uint8_t sensorBuffer[SENSOR_PACKET_SIZE];
+    (void)channel;
+    oi_frameReady = 1;
+}
+
+/// Request a sensor frame, the uDMA receives it while the CPU does other work
+/// Does nothing if a request is still outstanding
+void oi_updateStart(oi_t *self)
+{
+    (void)self; // The frame is parsed into the struct oi_updatePoll() is given
+
+    if (oi_frameRequested) {
+        return;
+    }
+
+    oi_frameReady = 0;
+    oi_frameRequested = 1;
+    oi_frameStart = profile_now();
+
+    // Arm the receive before querying so no byte can be missed
+    udma_receive(UDMA_CH_UART4_RX, &UART4_DR_R, oi_sensorBuffer, SENSOR_PACKET_SIZE);
 
     // Query list of sensors
+    oi_txBegin();
     oi_uartSendChar(OI_OPCODE_SENSORS);
     oi_uartSendChar(OI_SENSOR_PACKET_GROUP100);
+    oi_txEnd();
+}
 
-    // Read all the sensor data
-    uint8_t i;
-    for (i = 0; i < SENSOR_PACKET_SIZE; i++) {
-        // read each sensor byte
-        sensorBuffer[i] = oi_uartReceive();
+/// Give up on the outstanding sensor frame and request a new one: stop the uDMA, throw away
+/// what UART4 still holds so the next frame starts aligned, and query again
+void oi_updateRestart(oi_t *self)
+{
+    udma_abort(UDMA_CH_UART4_RX);
+    while ((UART4_FR_R & UART_FR_RXFE) == 0) {
+        (void)UART4_DR_R;
+    }
+    UART4_ECR_R = 0; // Errors of the lost frame are not the next one's
+
+    oi_frameRequested = 0;
+    oi_linkStats.timeouts++;
+    oi_updateStart(self);
+}
+
+/// Parse the requested sensor frame into the oi_t struct once it has arrived
+/// A frame that has not arrived after OI_FRAME_TIMEOUT_MS is requested again
+/// \return 1 if the struct was updated, 0 if the frame is still being received
+int oi_updatePoll(oi_t *self)
+{
+    if (!oi_frameRequested) {
+        return 0;
+    }
+    if (!oi_frameReady)
+    {
+        if (profile_now() - oi_frameStart >= OI_FRAME_TIMEOUT_MS * 1000UL * PROFILE_TICKS_PER_US) {
+            oi_updateRestart(self);
+        }
+        return 0;
+    }
+
+    oi_frameRequested = 0;
+
+    // Errors latched by the UART while the uDMA was reading the frame
+    uint32_t status = UART4_RSR_R;
+    oi_linkStats.frames++;
+    if (status != 0) {
+        oi_linkStats.badFrames++;
+        oi_linkStats.framing += (status & UART_RSR_FE) != 0;
+        oi_linkStats.parity += (status & UART_RSR_PE) != 0;
+        oi_linkStats.breaks += (status & UART_RSR_BE) != 0;
+        oi_linkStats.overrun += (status & UART_RSR_OE) != 0;
+        UART4_ECR_R = 0; // Any write clears the flags
     }
 
     // Parse the sensor data into the struct
-    oi_parsePacket(self, sensorBuffer);
+    oi_parsePacket(self, oi_sensorBuffer);
+
+    return 1;
+}
+
+/// Receive error counts of the sensor link since power up
+const oi_linkStats_t *oi_getLinkStats(void)
+{
+    return &oi_linkStats;
+}
+
+/// Update all sensor and store in oi_t struct
+void oi_update(oi_t *self)
+{
+    PROFILE_BEGIN(OI_UPDATE);
+
+    oi_updateStart(self);
+    while (!oi_updatePoll(self)); // the 80 byte frame takes about 7ms at 115200, a lost one is
+                                  // requested again after OI_FRAME_TIMEOUT_MS
 
     timer_waitMillis(25); // reduces USART errors that occur when continuously
                           // transmitting/receiving min wait time=15ms
+
+    PROFILE_END(OI_UPDATE);
 }
 
 void oi_parsePacket(oi_t *self, uint8_t packet[])
 {
+    PROFILE_BEGIN(OI_PARSE);
+
     self->wheelDropLeft = !!(packet[0] & 0x08);
     self->wheelDropRight = !!(packet[0] & 0x04);
     self->bumpLeft = !!(packet[0] & 0x02);
@@ -287,6 +424,19 @@ void oi_parsePacket(oi_t *self, uint8_t packet[])
 
     self->distance = oi_getDistance(self);
     self->angle = oi_getDegrees(self);
+
+    // Integrate the pose along the mean heading of this step
+    double heading = (self->poseHeading + self->angle / 2) * (M_PI / 180);
+    self->poseX += self->distance * cos(heading);
+    self->poseY += self->distance * sin(heading);
+    self->poseHeading += self->angle;
+    if (self->poseHeading >= 180) {
+        self->poseHeading -= 360;
+    } else if (self->poseHeading < -180) {
+        self->poseHeading += 360;
+    }
+
+    PROFILE_END(OI_PARSE);
 }
 
 inline int16_t oi_parseInt(uint8_t *theInt)
@@ -301,24 +451,37 @@ inline int16_t oi_parseInt(uint8_t *theInt)
 /// \param power_intensity (0-255) 0=off, 255=full intensity
 void oi_setLeds(uint8_t play_led, uint8_t advance_led, uint8_t power_color, uint8_t power_intensity)
 {
+    oi_txBegin();
+
     // LED Opcode
     oi_uartSendChar(OI_OPCODE_LEDS);
 
     // Set the Play and Advance LEDs
-    oi_uartSendChar(advance_led << 3 && play_led << 2);
+    oi_uartSendChar((advance_led << 3) | (play_led << 2));
 
     // Set the power led color
     oi_uartSendChar(power_color);
 
     // Set the power led intensity
     oi_uartSendChar(power_intensity);
+
+    oi_txEnd();
 }
 
 /// \brief Set direction and speed of the robot's wheels
 /// \param linear velocity in mm/s values range from -500 -> 500 of right wheel
 /// \param linear velocity in mm/s values range from -500 -> 500 of left wheel
+/// Once the shutoff button was pressed the wheels are only ever set to 0
 void oi_setWheels(int16_t right_wheel, int16_t left_wheel)
 {
+    oi_txBegin();
+
+    // Tested inside the bracket: a press from here on stops the wheels after this command,
+    // one before it is seen here
+    if (oi_shutoff) {
+        right_wheel = 0;
+        left_wheel = 0;
+    }
     right_wheel = right_wheel * motor_cal_factor_R;
     left_wheel = left_wheel * motor_cal_factor_L;
     oi_uartSendChar(OI_OPCODE_DRIVE_WHEELS);
@@ -326,6 +489,7 @@ void oi_setWheels(int16_t right_wheel, int16_t left_wheel)
     oi_uartSendChar(right_wheel & 0xff);
     oi_uartSendChar(left_wheel >> 8);
     oi_uartSendChar(left_wheel & 0xff);
+    oi_txEnd();
 }
 
 /// \brief Load song sequence
@@ -336,6 +500,7 @@ void oi_setWheels(int16_t right_wheel, int16_t left_wheel)
 void oi_loadSong(int song_index, int num_notes, unsigned char *notes, unsigned char *duration)
 {
     int i;
+    oi_txBegin();
     oi_uartSendChar(OI_OPCODE_SONG);
     oi_uartSendChar(song_index);
     oi_uartSendChar(num_notes);
@@ -343,12 +508,15 @@ void oi_loadSong(int song_index, int num_notes, unsigned char *notes, unsigned c
         oi_uartSendChar(notes[i]);
         oi_uartSendChar(duration[i]);
     }
+    oi_txEnd();
 }
 
 /// Plays a given song; use oi_load_song(...) first
 void oi_play_song(int index) {
+    oi_txBegin();
     oi_uartSendChar(OI_OPCODE_PLAY);
     oi_uartSendChar(index);
+    oi_txEnd();
 }
 
 /// Runs default go charge program; robot will search for dock
@@ -395,10 +563,25 @@ void oi_uartInit(void)
     UART4_IBRD_R = iBRD;
     UART4_FBRD_R = fBRD;
 
-    UART4_LCRH_R = UART_LCRH_WLEN_8; // 8 bit, 1 stop, no parity, no FIFO
+    UART4_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_FEN; // 8 bit, 1 stop, no parity, FIFOs on
     UART4_CC_R = UART_CC_CS_SYSCLK;  // Use System Clock
+    UART4_DMACTL_R = UART_DMACTL_RXDMAE; // Sensor frames are received by the uDMA
     UART4_CTL_R = UART_CTL_RXE | UART_CTL_TXE |
                   UART_CTL_UARTEN; // Enable Rx, Tx and UART module
+
+    udma_init();
+    udma_assign(UDMA_CH_UART4_RX, 2, oi_frameDone);
+
+    // uDMA completions are signalled on the UART4 vector
+    NVIC_EN1_R |= 0x10000000;              // enable IRQ 60 by setting bit 28
+    IntRegister(INT_UART4, UART4_Handler);
+    IntMasterEnable();
+}
+
+/// UART4 interrupt, only raised for uDMA completions
+void UART4_Handler(void)
+{
+    udma_service(UDMA_CH_UART4_RX);
 }
 
 /// transmit character
@@ -457,7 +640,7 @@ char *oi_checkFirmware()
     static char firmware[21];
 
     char buffer[512];
-    uint16_t ptr;
+    uint16_t ptr = 0;
 
     // Reset the iRobot
     oi_uartSendChar(OI_OPCODE_RESET);
@@ -505,14 +688,34 @@ void oi_shutoff_init(void)
     IntMasterEnable();                     // enable global interrupts
 }
 
+/// Bottom half of the shutoff button, runs at thread level (see work.h)
+static void oi_shutoffWork(uint32_t arg)
+{
+    (void)arg;
+    oi_close();
+}
+
 void GPIOF_Handler(void)
 {
+    PROFILE_BEGIN(ISR_GPIOF);
+
     if (GPIO_PORTF_RIS_R & BIT0) {
-        // shutoff button was pressed, turn off OI
-        oi_close();
+        // shutoff button was pressed, stop the wheels right away whatever the
+        // thread is blocked in; a command half written goes out first
+        oi_shutoff = 1;
+        if (oi_txOpen) {
+            oi_stopPending = 1;
+        } else {
+            oi_stopWheels();
+        }
+
+        // turn off OI once the ISR has returned (oi_close waits on UART4)
+        work_post(oi_shutoffWork, 0, WORK_PRIO_HIGH);
 
         GPIO_PORTF_ICR_R |= BIT0; // clear interrupt
     }
+
+    PROFILE_END(ISR_GPIOF);
 }
 
 /**
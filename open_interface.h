@@ -97,6 +97,11 @@ typedef struct {
 	//Motion sensors
 	double distance;
 	double angle;
+
+	//Dead reckoning pose since oi_init, x along the starting heading
+	double poseX;       // (mm)
+	double poseY;       // (mm)
+	double poseHeading; // (deg, CCW positive, -180 to 180)
 	int8_t requestedVelocity;
 	int8_t requestedRadius;
 	int16_t requestedRightVelocity;
@@ -129,6 +134,21 @@ typedef struct {
 
 } oi_t;
 
+// Typedef struct - Health of the sensor link, counted since power up
+typedef struct oi_linkStats
+{
+	uint32_t frames;    // Sensor frames received
+	uint32_t badFrames; // Frames received with any UART error below
+	uint32_t framing;   // Missing stop bit
+	uint32_t parity;
+	uint32_t breaks;
+	uint32_t overrun;   // A byte arrived before the previous one was read
+	uint32_t timeouts;  // Frames requested again after OI_FRAME_TIMEOUT_MS
+} oi_linkStats_t;
+
+// A sensor frame not received after this long is requested again (it takes 7 ms at 115200)
+#define OI_FRAME_TIMEOUT_MS 50
+
 
 ///Allocate and clear all memory for OI Struct
 oi_t * oi_alloc();
@@ -145,6 +165,22 @@ void oi_close();
 ///Update sensor data
 void oi_update(oi_t *self);
 
+///Request sensor data without waiting, the frame is received by the uDMA
+void oi_updateStart(oi_t *self);
+
+///Parse the requested sensor data once it has arrived, requests it again after OI_FRAME_TIMEOUT_MS
+///\return 1 if the struct was updated, 0 if the frame is still being received
+int oi_updatePoll(oi_t *self);
+
+///Give up on the outstanding sensor frame and request a new one
+void oi_updateRestart(oi_t *self);
+
+///Receive error counts of the sensor link since power up
+const oi_linkStats_t *oi_getLinkStats(void);
+
+///UART4 interrupt handler, services uDMA completions
+void UART4_Handler(void);
+
 /// \brief Set the LEDS on the Create
 /// \param play_led 0=off, 1=on
 /// \param advance_led 0=off, 1=on
@@ -181,15 +217,6 @@ void oi_shutoff_init(void);
 //used to handle interrupt to shut off OI
 void GPIOF_Handler(void);
 
-//used to get the current moved degrees from encoder count
-static double oi_getDegrees(oi_t *self);
-
-// Get the number of radians moved since last call
-static double oi_getRadians(oi_t *self);
-
-// Gets the distance moved since the last call to getDistance
-static double oi_getDistance(oi_t *self);
-
 // Sets the calibration factor for the motors. Defualt is 1
 void oi_setMotorCalibration(double left, double right);
 
@@ -8,6 +8,7 @@
 #include "Timer.h"
 #include "lcd.h"
 #include "ping.h"
+#include "profile.h"
 #include "uart.h"
 
 volatile char FLAG;
@@ -130,9 +131,13 @@ int ping_read(void) {
  * Capture PING))) response pulse start and end time (rising and falling edge)
  */
 void TIMER3B_Handler(void) {
+    PROFILE_BEGIN(ISR_PING);
+
     if (TIMER3_MIS_R & 0b0000011000000000) {
         time = TIMER3_TBR_R; // Read the sensor
         TIMER3_ICR_R |= 0b0000011000000000; // Interrupt Clear
         FLAG = 1; // Throw flag
     }
+
+    PROFILE_END(ISR_PING);
 }
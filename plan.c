@@ -0,0 +1,363 @@
+/*
+ * plan.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "plan.h"
+#include "grid.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+/*
+ * Step costs, a straight step is 10 and a diagonal one 14 (10 * sqrt 2), so
+ * the octile distance is an exact heuristic on an empty window. Cells within
+ * PLAN_HARD_CELLS of a hazard or occupied cell are closed to the robot's
+ * centre: its radius is 170 mm, and both it and the obstacle can be half a
+ * cell off the centres the search measures between. Up to PLAN_NEAR_CELLS
+ * they cost PLAN_NEAR_COST extra per step, cells no scan has seen
+ * PLAN_UNKNOWN_COST.
+ * A robot that starts inside a closed zone may take steps in it until its
+ * cost reaches PLAN_ESCAPE_COST, too little to reach across an obstacle.
+ */
+#define PLAN_STRAIGHT 10
+#define PLAN_DIAGONAL 14
+#define PLAN_HARD_CELLS 5
+#define PLAN_NEAR_CELLS 7
+#define PLAN_NEAR_COST 20
+#define PLAN_UNKNOWN_COST 2
+#define PLAN_ESCAPE_COST 30
+
+#define PLAN_CELLS (PLAN_WINDOW * PLAN_WINDOW)
+#define PLAN_UNSEEN 0xFFFF    // g of a cell the search has not reached
+#define PLAN_CLOSED 0x80      // In plan_state, the cell's cost is final
+#define PLAN_DIRECTION 0x07   // In plan_state, step that reached the cell
+
+static uint32_t plan_blocked[PLAN_WINDOW]; // One bit per column, closed to the robot
+static uint32_t plan_near[PLAN_WINDOW];    // Close to an obstacle, costs extra
+static uint32_t plan_unknown[PLAN_WINDOW]; // Not seen by a scan
+static uint16_t plan_g[PLAN_CELLS];        // Cost from the start
+static uint8_t plan_state[PLAN_CELLS];
+static uint16_t plan_heap[PLAN_CELLS];     // Open cells by f = g + h, reused for the path afterwards
+static uint16_t plan_heapPos[PLAN_CELLS];  // Where each open cell is in plan_heap
+static int plan_heapSize;
+static int plan_col0;                      // Grid cell of window cell 0
+static int plan_row0;
+static int plan_goalCol;
+static int plan_goalRow;
+
+// Steps, counterclockwise from +x
+static const int8_t plan_dc[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static const int8_t plan_dr[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+#define PLAN_BIT(map, col, row) ((map)[row] >> (col) & 1)
+
+/**
+ * Grid cell under a world point
+ */
+static void plan_cellOf(double x, double y, int *col, int *row)
+{
+    *col = (int)floor((x - GRID_ORIGIN_MM) / GRID_CELL_MM);
+    *row = (int)floor((y - GRID_ORIGIN_MM) / GRID_CELL_MM);
+}
+
+/**
+ * Octile distance from a window cell to the goal
+ */
+static int plan_h(int i)
+{
+    int dc = abs(i % PLAN_WINDOW - plan_goalCol);
+    int dr = abs(i / PLAN_WINDOW - plan_goalRow);
+    return dc > dr ? PLAN_STRAIGHT * dc + (PLAN_DIAGONAL - PLAN_STRAIGHT) * dr
+                   : PLAN_STRAIGHT * dr + (PLAN_DIAGONAL - PLAN_STRAIGHT) * dc;
+}
+
+static int plan_f(int i)
+{
+    return plan_g[i] + plan_h(i);
+}
+
+static void plan_heapSet(int pos, int i)
+{
+    plan_heap[pos] = i;
+    plan_heapPos[i] = pos;
+}
+
+/**
+ * Move an open cell towards the top of the heap until its parent is cheaper
+ */
+static void plan_heapUp(int pos)
+{
+    int i = plan_heap[pos];
+    int f = plan_f(i);
+
+    while (pos > 0 && plan_f(plan_heap[(pos - 1) / 2]) > f)
+    {
+        plan_heapSet(pos, plan_heap[(pos - 1) / 2]);
+        pos = (pos - 1) / 2;
+    }
+    plan_heapSet(pos, i);
+}
+
+/**
+ * Take the cheapest open cell off the heap
+ */
+static int plan_heapPop(void)
+{
+    int top = plan_heap[0];
+    int i = plan_heap[--plan_heapSize];
+    int f = plan_f(i);
+    int pos = 0;
+
+    while (2 * pos + 1 < plan_heapSize)
+    {
+        int child = 2 * pos + 1;
+        if (child + 1 < plan_heapSize && plan_f(plan_heap[child + 1]) < plan_f(plan_heap[child])) {
+            child++;
+        }
+        if (plan_f(plan_heap[child]) >= f) {
+            break;
+        }
+        plan_heapSet(pos, plan_heap[child]);
+        pos = child;
+    }
+    if (plan_heapSize > 0) {
+        plan_heapSet(pos, i);
+    }
+
+    return top;
+}
+
+/**
+ * Mark the cells around an obstacle in the window closed or near
+ */
+static void plan_inflate(int col, int row)
+{
+    int dc, dr;
+
+    for (dr = -PLAN_NEAR_CELLS; dr <= PLAN_NEAR_CELLS; dr++)
+    {
+        int r = row + dr;
+        if (r < 0 || r >= PLAN_WINDOW) {
+            continue;
+        }
+        for (dc = -PLAN_NEAR_CELLS; dc <= PLAN_NEAR_CELLS; dc++)
+        {
+            int c = col + dc;
+            int d2 = dc * dc + dr * dr;
+            if (c < 0 || c >= PLAN_WINDOW || d2 > PLAN_NEAR_CELLS * PLAN_NEAR_CELLS) {
+                continue;
+            }
+            plan_near[r] |= 1u << c;
+            if (d2 <= PLAN_HARD_CELLS * PLAN_HARD_CELLS) {
+                plan_blocked[r] |= 1u << c;
+            }
+        }
+    }
+}
+
+/**
+ * Copy the grid under the window into the bitmaps, obstacles just outside still count
+ */
+static void plan_loadWindow(void)
+{
+    int col, row;
+
+    for (row = 0; row < PLAN_WINDOW; row++) {
+        plan_blocked[row] = 0;
+        plan_near[row] = 0;
+        plan_unknown[row] = 0;
+    }
+
+    for (row = -PLAN_NEAR_CELLS; row < PLAN_WINDOW + PLAN_NEAR_CELLS; row++)
+    {
+        for (col = -PLAN_NEAR_CELLS; col < PLAN_WINDOW + PLAN_NEAR_CELLS; col++)
+        {
+            grid_cell_t cell = grid_cellAt(plan_col0 + col, plan_row0 + row);
+            if (cell == GRID_OCCUPIED || cell == GRID_HAZARD) {
+                plan_inflate(col, row);
+            } else if (cell == GRID_UNKNOWN && col >= 0 && col < PLAN_WINDOW && row >= 0 && row < PLAN_WINDOW) {
+                plan_unknown[row] |= 1u << col;
+            }
+        }
+    }
+}
+
+/**
+ * Whether the robot can drive straight between the centres of two window cells
+ */
+static int plan_lineClear(int from, int to)
+{
+    int c0 = from % PLAN_WINDOW, r0 = from / PLAN_WINDOW;
+    int dc = to % PLAN_WINDOW - c0, dr = to / PLAN_WINDOW - r0;
+    int steps = 4 * (abs(dc) > abs(dr) ? abs(dc) : abs(dr)); // Quarter cells
+    int s;
+
+    for (s = 1; s <= steps; s++)
+    {
+        int c = (int)floor(c0 + (double)dc * s / steps + 0.5);
+        int r = (int)floor(r0 + (double)dr * s / steps + 0.5);
+        if (PLAN_BIT(plan_blocked, c, r)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Find the shortest safe path between two points of the grid
+ *
+ * @param fromX - Robot position (mm)
+ * @param fromY
+ * @param toX - Goal (mm), moved further along the line from the start while it is blocked
+ * @param toY
+ * @param path - Filled in with the waypoints
+ *
+ * @returns 0 if a path was found, -1 if the goal cannot be reached inside the window
+ */
+int plan_find(double fromX, double fromY, double toX, double toY, plan_path_t *path)
+{
+    int startCol, startRow, goalCol, goalRow;
+    int start, goal, i, k, n;
+    double dx = toX - fromX, dy = toY - fromY;
+    double lineMm = sqrt(dx * dx + dy * dy);
+
+    path->count = 0;
+    path->complete = 0;
+    path->length = 0;
+    path->expanded = 0;
+
+    plan_cellOf(fromX, fromY, &startCol, &startRow);
+    plan_cellOf(toX, toY, &goalCol, &goalRow);
+    plan_col0 = (startCol + goalCol) / 2 - PLAN_WINDOW / 2;
+    plan_row0 = (startRow + goalRow) / 2 - PLAN_WINDOW / 2;
+    startCol -= plan_col0;
+    startRow -= plan_row0;
+    if (startCol < 0 || startCol >= PLAN_WINDOW || startRow < 0 || startRow >= PLAN_WINDOW) {
+        return -1;
+    }
+
+    plan_loadWindow();
+
+    // A goal on an obstacle moves on past it, in half cells along the line
+    for (k = 0; ; k++)
+    {
+        double along = lineMm > 0 ? 1 + k * (GRID_CELL_MM / 2) / lineMm : 1;
+        plan_cellOf(fromX + dx * along, fromY + dy * along, &goalCol, &goalRow);
+        goalCol -= plan_col0;
+        goalRow -= plan_row0;
+        if (goalCol < 0 || goalCol >= PLAN_WINDOW || goalRow < 0 || goalRow >= PLAN_WINDOW || (lineMm == 0 && k > 0)) {
+            return -1;
+        }
+        if (!PLAN_BIT(plan_blocked, goalCol, goalRow)) {
+            toX = fromX + dx * along;
+            toY = fromY + dy * along;
+            break;
+        }
+    }
+    plan_goalCol = goalCol;
+    plan_goalRow = goalRow;
+    start = startRow * PLAN_WINDOW + startCol;
+    goal = goalRow * PLAN_WINDOW + goalCol;
+
+    for (i = 0; i < PLAN_CELLS; i++) {
+        plan_g[i] = PLAN_UNSEEN;
+        plan_state[i] = 0;
+    }
+    plan_g[start] = 0;
+    plan_heapSize = 0;
+    plan_heapSet(plan_heapSize++, start);
+
+    while (plan_heapSize > 0)
+    {
+        int cell = plan_heapPop();
+        int col = cell % PLAN_WINDOW, row = cell / PLAN_WINDOW;
+        int escaping = PLAN_BIT(plan_blocked, col, row) && plan_g[cell] < PLAN_ESCAPE_COST;
+
+        plan_state[cell] |= PLAN_CLOSED;
+        path->expanded++;
+        if (cell == goal) {
+            break;
+        }
+
+        for (k = 0; k < 8; k++)
+        {
+            int c = col + plan_dc[k], r = row + plan_dr[k];
+            if (c < 0 || c >= PLAN_WINDOW || r < 0 || r >= PLAN_WINDOW) {
+                continue;
+            }
+
+            int next = r * PLAN_WINDOW + c;
+            if (plan_state[next] & PLAN_CLOSED) {
+                continue;
+            }
+            if (!escaping && PLAN_BIT(plan_blocked, c, r)) {
+                continue;
+            }
+            // No cutting corners past a closed cell
+            if ((k & 1) && !escaping && (PLAN_BIT(plan_blocked, c, row) || PLAN_BIT(plan_blocked, col, r))) {
+                continue;
+            }
+
+            uint32_t g = plan_g[cell] + ((k & 1) ? PLAN_DIAGONAL : PLAN_STRAIGHT);
+            if (PLAN_BIT(plan_near, c, r)) {
+                g += PLAN_NEAR_COST;
+            }
+            if (PLAN_BIT(plan_unknown, c, r)) {
+                g += PLAN_UNKNOWN_COST;
+            }
+            if (g >= plan_g[next]) {
+                continue;
+            }
+
+            if (plan_g[next] == PLAN_UNSEEN) {
+                plan_heapSet(plan_heapSize++, next);
+            }
+            plan_g[next] = g;
+            plan_state[next] = k;
+            plan_heapUp(plan_heapPos[next]);
+        }
+    }
+
+    if (!(plan_state[goal] & PLAN_CLOSED)) {
+        return -1;
+    }
+
+    // Walk back from the goal, the heap is free to hold the cells start first
+    n = 0;
+    for (i = goal; i != start; i = i - plan_dr[plan_state[i] & PLAN_DIRECTION] * PLAN_WINDOW - plan_dc[plan_state[i] & PLAN_DIRECTION]) {
+        n++;
+    }
+    k = n;
+    for (i = goal; i != start; i = i - plan_dr[plan_state[i] & PLAN_DIRECTION] * PLAN_WINDOW - plan_dc[plan_state[i] & PLAN_DIRECTION]) {
+        plan_heap[k--] = i;
+    }
+    plan_heap[0] = start;
+
+    // Keep the cells the robot has to turn at: the farthest one still in line of sight
+    double x = fromX, y = fromY, length = 0;
+    int anchor = 0;
+    while (anchor < n && path->count < PLAN_MAX_WAYPOINTS)
+    {
+        int j = n;
+        while (j > anchor + 1 && !plan_lineClear(plan_heap[anchor], plan_heap[j])) {
+            j--;
+        }
+
+        plan_point_t *point = &path->points[path->count++];
+        double px = j == n ? toX : GRID_ORIGIN_MM + (plan_col0 + plan_heap[j] % PLAN_WINDOW + 0.5) * GRID_CELL_MM;
+        double py = j == n ? toY : GRID_ORIGIN_MM + (plan_row0 + plan_heap[j] / PLAN_WINDOW + 0.5) * GRID_CELL_MM;
+        point->x = (int16_t)px;
+        point->y = (int16_t)py;
+        length += sqrt((px - x) * (px - x) + (py - y) * (py - y));
+        x = px;
+        y = py;
+        anchor = j;
+    }
+
+    path->complete = anchor == n;
+    path->length = (uint16_t)length;
+    return 0;
+}
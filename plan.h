@@ -0,0 +1,57 @@
+/*
+ * plan.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Shortest detours over the occupancy grid (grid.h). An A* search runs on
+ *  a PLAN_WINDOW x PLAN_WINDOW window of grid cells centred between the
+ *  robot and the goal, with 8-connected moves. Hazards and occupied cells
+ *  are grown by the robot's radius so the robot can be planned as a point;
+ *  cells a little further out still cost extra, which keeps the detour off
+ *  the obstacles where there is room. The search is small enough (a few ms)
+ *  to simply run again from scratch whenever a bump or cliff adds a hazard.
+ *
+ *  The cell path is shortened to the few waypoints that still have a clear
+ *  line of sight between them, which is what the robot drives.
+ */
+
+#ifndef PLAN_H_
+#define PLAN_H_
+
+#include <stdint.h>
+
+#define PLAN_WINDOW 32       // Cells along each side of the search window (1.6 m)
+#define PLAN_MAX_WAYPOINTS 8 // A longer detour stops short, drive it and plan again
+
+// Typedef struct - A waypoint in world coordinates (mm)
+typedef struct plan_point
+{
+    int16_t x;
+    int16_t y;
+} plan_point_t;
+
+// Typedef struct - Detour found by plan_find(), straight segments from the start through every waypoint
+typedef struct plan_path
+{
+    uint8_t count;      // Waypoints, the last one is the goal unless complete is 0
+    uint8_t complete;   // The path reaches the goal
+    uint16_t length;    // Of the segments (mm)
+    uint16_t expanded;  // Cells the search took off the open list
+    plan_point_t points[PLAN_MAX_WAYPOINTS];
+} plan_path_t;
+
+/**
+ * Find the shortest safe path between two points of the grid
+ *
+ * @param fromX - Robot position (mm)
+ * @param fromY
+ * @param toX - Goal (mm), moved further along the line from the start while it is blocked
+ * @param toY
+ * @param path - Filled in with the waypoints
+ *
+ * @returns 0 if a path was found, -1 if the goal cannot be reached inside the window
+ */
+int plan_find(double fromX, double fromY, double toX, double toY, plan_path_t *path);
+
+#endif /* PLAN_H_ */
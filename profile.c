@@ -0,0 +1,174 @@
+/*
+ * profile.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#if defined(__linux__)
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#endif
+
+#include "profile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if !defined(__linux__)
+#define DWT_CTRL_R   (*((volatile uint32_t *)0xE0001000))
+#define DEMCR_R      (*((volatile uint32_t *)0xE000EDFC))
+#define DWT_CTRL_CYCCNTENA 0x00000001
+#define DEMCR_TRCENA       0x01000000
+#endif
+
+static profile_stats_t profile_stats[PROFILE_NUM_REGIONS];
+
+static const char *const profile_names[PROFILE_NUM_REGIONS] = {
+#define PROFILE_NAME(id, name) name,
+    PROFILE_REGIONS(PROFILE_NAME)
+#undef PROFILE_NAME
+};
+
+#if defined(__linux__)
+void (*profile_hostClock)(void);
+
+/**
+ * Read the free running tick counter (nanoseconds from CLOCK_MONOTONIC)
+ */
+uint32_t profile_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    // Afterwards, so the simulation has caught up with the time returned
+    if (profile_hostClock != NULL) {
+        profile_hostClock();
+    }
+
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+#endif
+
+/**
+ * Enable the cycle counter and clear all region statistics
+ */
+void profile_init(void)
+{
+#if !defined(__linux__)
+    DEMCR_R |= DEMCR_TRCENA;            // Power up the DWT unit
+    DWT_CYCCNT_R = 0;
+    DWT_CTRL_R |= DWT_CTRL_CYCCNTENA;   // Start counting CPU cycles
+#endif
+
+    profile_reset();
+}
+
+/**
+ * Clear all region statistics
+ */
+void profile_reset(void)
+{
+    memset(profile_stats, 0, sizeof(profile_stats));
+}
+
+/**
+ * Add one measured duration to a region, safe to call from an ISR
+ *
+ * @param region - The region the duration belongs to
+ * @param ticks - The duration in profile ticks
+ */
+void profile_record(profile_region_t region, uint32_t ticks)
+{
+    profile_stats_t *stats = &profile_stats[region];
+
+    if (stats->count == 0 || ticks < stats->min) {
+        stats->min = ticks;
+    }
+
+    if (ticks > stats->max) {
+        stats->max = ticks;
+    }
+
+    stats->count++;
+    stats->total += ticks;
+
+    // Bucket is floor(log2(ticks)), durations past the last bucket are counted in it
+    int bucket = 0;
+    while ((ticks >>= 1) != 0 && bucket < PROFILE_BUCKETS - 1) {
+        bucket++;
+    }
+
+    stats->histogram[bucket]++;
+}
+
+/**
+ * @param region - The region to look up
+ *
+ * @returns the statistics recorded for the region
+ */
+const profile_stats_t *profile_get(profile_region_t region)
+{
+    return &profile_stats[region];
+}
+
+/**
+ * @param region - The region to look up
+ *
+ * @returns the printable name of the region
+ */
+const char *profile_name(profile_region_t region)
+{
+    return profile_names[region];
+}
+
+/**
+ * Print min/mean/max and the non-empty histogram buckets of every region
+ *
+ * @param output - Output function the report is written through (telemetry_sendText on the CyBot)
+ */
+void profile_dump(void (*output)(const char *))
+{
+    char line[80];
+    int i, b;
+
+    output("\n\r### Profile (us) ###\n\r");
+    sprintf(line, "%-24s%-10s%-10s%-10s%-10s\n\r", "Region", "Count", "Min", "Mean", "Max");
+    output(line);
+
+    for (i = 0; i < PROFILE_NUM_REGIONS; i++)
+    {
+        const profile_stats_t *stats = &profile_stats[i];
+
+        if (stats->count == 0) {
+            continue;
+        }
+
+        sprintf(line, "%-24s%-10lu%-10lu%-10lu%-10lu\n\r", profile_names[i],
+                (unsigned long)stats->count,
+                (unsigned long)(stats->min / PROFILE_TICKS_PER_US),
+                (unsigned long)(stats->total / stats->count / PROFILE_TICKS_PER_US),
+                (unsigned long)(stats->max / PROFILE_TICKS_PER_US));
+        output(line);
+
+        // One entry per non-empty bucket, labelled with the bucket's upper bound; the last
+        // bucket also counts everything longer, so it is labelled with its lower bound
+        for (b = 0; b < PROFILE_BUCKETS; b++)
+        {
+            if (stats->histogram[b] == 0) {
+                continue;
+            }
+            if (b == PROFILE_BUCKETS - 1) {
+                sprintf(line, "   >= %lu us: %lu\n\r", (unsigned long)((1ULL << b) / PROFILE_TICKS_PER_US),
+                        (unsigned long)stats->histogram[b]);
+            } else {
+                sprintf(line, "    < %lu us: %lu\n\r",
+                        (unsigned long)(((2ULL << b) + PROFILE_TICKS_PER_US - 1) / PROFILE_TICKS_PER_US),
+                        (unsigned long)stats->histogram[b]);
+            }
+            output(line);
+        }
+    }
+
+    output("\n\r");
+}
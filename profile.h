@@ -0,0 +1,142 @@
+/*
+ * profile.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Timing of named code regions with begin/end markers. On the CyBot the
+ *  Cortex-M4 DWT cycle counter is used; a Linux host build falls back to
+ *  clock_gettime() so host benchmarks share the same instrumentation.
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <stdint.h>
+#include "trace.h"
+
+// Comment out to compile every PROFILE_BEGIN/PROFILE_END marker out of the firmware
+#define PROFILE_ENABLE
+
+// Number of log2 histogram buckets per region, bucket n holds durations of [2^n, 2^(n+1)) ticks
+#define PROFILE_BUCKETS 24
+
+#if defined(__linux__)
+#define PROFILE_TICKS_PER_US 1000 // Host build counts nanoseconds
+#else
+#define PROFILE_TICKS_PER_US 16   // DWT counts CPU cycles of the 16 MHz system clock
+#endif
+
+/**
+ * Regions that can be profiled, X(id, name)
+ */
+#define PROFILE_REGIONS(X) \
+    X(OI_UPDATE,   "oi_update") \
+    X(OI_PARSE,    "oi_parsePacket") \
+    X(DETECT_OBJ,  "detect_obj") \
+    X(ISR_PING,    "TIMER3B_Handler") \
+    X(ISR_UART,    "uart_interrupt_handler") \
+    X(ISR_GPIOF,   "GPIOF_Handler") \
+    X(ISR_CLOCK,   "timer_clockTickHandler") \
+    X(ISR_LCD,     "lcd_flushHandler") \
+    X(ISR_BUTTON,  "button_tickHandler") \
+    X(MOTION_LOOP, "move_forward_auto") \
+    X(UART_SEND,   "uart_sendStr") \
+    X(LOG_WRITE,   "log_write") \
+    X(WORK_ITEM,   "work item") \
+    X(DRIVE_LATENCY, "DRIVE command to wheels") \
+    X(PLAN,        "plan_find") \
+    X(AVOID,       "avoid_step") \
+    X(HAZARD_AHEAD, "grid_hazardAhead")
+
+typedef enum
+{
+#define PROFILE_ENUM(id, name) PROFILE_##id,
+    PROFILE_REGIONS(PROFILE_ENUM)
+#undef PROFILE_ENUM
+    PROFILE_NUM_REGIONS
+} profile_region_t;
+
+// Typedef struct - Aggregate timing of one region, all values in ticks
+typedef struct profile_stats
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t histogram[PROFILE_BUCKETS];
+} profile_stats_t;
+
+#if defined(__linux__)
+/**
+ * Read the free running tick counter (nanoseconds from CLOCK_MONOTONIC)
+ */
+uint32_t profile_now(void);
+
+/**
+ * Run at every profile_now() when set, a simulation of the hardware moves on with the clock
+ * while the code under test waits on it
+ */
+extern void (*profile_hostClock)(void);
+#else
+#define DWT_CYCCNT_R (*((volatile uint32_t *)0xE0001004))
+
+/**
+ * Read the free running tick counter (DWT CYCCNT, CPU cycles)
+ */
+#define profile_now() (DWT_CYCCNT_R)
+#endif
+
+#ifdef PROFILE_ENABLE
+#define PROFILE_BEGIN(id) uint32_t _profile_start_##id = profile_now(); TRACE_BEGIN(PROFILE_##id)
+#define PROFILE_END(id) TRACE_END(PROFILE_##id); profile_record(PROFILE_##id, profile_now() - _profile_start_##id)
+// Statistics only, for ISRs that run too often to put events in the trace ring
+#define PROFILE_BEGIN_UNTRACED(id) uint32_t _profile_start_##id = profile_now()
+#define PROFILE_END_UNTRACED(id) profile_record(PROFILE_##id, profile_now() - _profile_start_##id)
+#else
+#define PROFILE_BEGIN(id) ((void)0)
+#define PROFILE_END(id) ((void)0)
+#define PROFILE_BEGIN_UNTRACED(id) ((void)0)
+#define PROFILE_END_UNTRACED(id) ((void)0)
+#endif
+
+/**
+ * Enable the cycle counter and clear all region statistics
+ */
+void profile_init(void);
+
+/**
+ * Clear all region statistics
+ */
+void profile_reset(void);
+
+/**
+ * Add one measured duration to a region, safe to call from an ISR
+ *
+ * @param region - The region the duration belongs to
+ * @param ticks - The duration in profile ticks
+ */
+void profile_record(profile_region_t region, uint32_t ticks);
+
+/**
+ * @param region - The region to look up
+ *
+ * @returns the statistics recorded for the region
+ */
+const profile_stats_t *profile_get(profile_region_t region);
+
+/**
+ * @param region - The region to look up
+ *
+ * @returns the printable name of the region
+ */
+const char *profile_name(profile_region_t region);
+
+/**
+ * Print min/mean/max and the non-empty histogram buckets of every region
+ *
+ * @param output - Output function the report is written through (telemetry_sendText on the CyBot)
+ */
+void profile_dump(void (*output)(const char *));
+
+#endif /* PROFILE_H_ */
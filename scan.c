@@ -0,0 +1,494 @@
+/*
+ * scan.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "scan.h"
+#include "adc.h"
+#include "filter.h"
+#include "movement.h"
+#include "ping.h"
+#include "servo.h"
+#include "telemetry.h"
+#include "Timer.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+/*
+ * Segmentation. A sample closer than SCAN_ENTER_CM opens an object and only a
+ * sample farther than SCAN_EXIT_CM closes it, so readings hovering around the
+ * IR range do not chop an object up. A jump of more than SCAN_EDGE_CM between
+ * neighbours is the edge between two objects, one in front of the other.
+ * Objects separated by at most SCAN_MAX_GAP far samples with matching
+ * distances on both sides are one object that a noisy sample split.
+ */
+#define SCAN_ENTER_CM (SCAN_IR_RANGE - 5)
+#define SCAN_EXIT_CM (SCAN_IR_RANGE + 5)
+#define SCAN_EDGE_CM 12
+#define SCAN_MAX_GAP 2
+#define SCAN_MIN_SAMPLES 2   // Narrower runs are noise
+#define SCAN_SURE_SAMPLES 6  // Runs at least this wide get the full width score
+#define SCAN_SURE_VAR 4      // Objects this certain (cm^2) get the full range score
+#define SCAN_DOUBT_VAR 64    // and this uncertain none
+
+// IR readings per angle, the highest and lowest are dropped and the rest averaged
+#define SCAN_IR_READS 5
+#define SCAN_IR_TRIM 1
+
+/*
+ * Noise models for the fusion, as standard deviations in cm. The IR sensor
+ * gets noisy quickly with distance (its output flattens out), the PING)))
+ * sensor stays within about 1%, but its beam is wide: aimed at the middle of
+ * an object it is trusted less the farther a sample is from where it was
+ * aimed, and not at all outside the object.
+ */
+#define SCAN_IR_SIGMA(cm) (1 + (cm) * (cm) / 400)
+#define SCAN_PING_SIGMA(cm, offset) (1 + (cm) / 100 + (offset) / 2)
+#define SCAN_IR_MAX_CM 80        // Beyond this the IR reading says nothing
+#define SCAN_FAR_CM 999          // Readings are clamped to this, keeps the fixed point math in 32 bits
+#define SCAN_GATE_SIGMAS 3       // Readings this far apart see different things, keep the IR
+#define SCAN_DRIFT_VAR_PER_S 4   // Growth of the prior's variance per second (objects move)
+
+// Longest wait for a sensor frame (25ms gap and about 7ms to receive it) before a sample is stamped with the
+// last pose, control_poll() then sends the query again
+#define SCAN_FRAME_TIMEOUT_MS 60
+
+#define SCAN_RAD(deg) ((deg) * (M_PI / 180))
+#define SCAN_DEG(rad) ((rad) * (180 / M_PI))
+
+// Typedef struct - Samples first to last of a scan that belong to one object
+typedef struct scan_run
+{
+    int first;
+    int last;
+} scan_run_t;
+
+/**
+ * Convert a raw IR reading to a distance
+ *
+ * @param raw - ADC reading
+ *
+ * @returns the distance in cm
+ */
+int scan_irToCm(int raw)
+{
+    return 51792 * pow(raw, -1.149);
+}
+
+/**
+ * Sweep the servo and record the IR sensor at every step
+ *
+ * @param scan - Filled in with the samples
+ * @param startAngle - First angle (deg)
+ * @param endAngle - Last angle (deg), at most SCAN_MAX_SAMPLES samples are taken
+ * @param step - Degrees between samples
+ * @param sensor - Refreshed while the servo settles to stamp every sample with the pose,
+ *                 NULL if the CyBot stands still (the stamps are left 0). Each frame goes
+ *                 through control_poll(), so commands, contacts and the leg keep being served
+ */
+void scan_sweep(scan_t *scan, uint8_t startAngle, uint8_t endAngle, uint8_t step, oi_t *sensor)
+{
+    int angle, i;
+    int16_t reads[SCAN_IR_READS];
+
+    scan->time = timer_getMillis();
+    scan->step = step;
+    scan->count = 0;
+
+    for (angle = startAngle; angle <= endAngle && scan->count < SCAN_MAX_SAMPLES; angle += step)
+    {
+        scan_sample_t *sample = &scan->samples[scan->count++];
+
+        // The sensor frame is received while the servo settles, then the sample is taken
+        servo_set_angle(angle);
+        if (sensor != NULL) {
+            control_poll(sensor, SCAN_FRAME_TIMEOUT_MS);
+            sample->x = (int16_t)sensor->poseX;
+            sample->y = (int16_t)sensor->poseY;
+            sample->heading = (int16_t)(sensor->poseHeading * 100);
+        } else {
+            sample->x = 0;
+            sample->y = 0;
+            sample->heading = 0;
+        }
+        servo_wait();
+
+        // The hardware already averages 8 conversions; this removes single outliers
+        for (i = 0; i < SCAN_IR_READS; i++) {
+            reads[i] = adc_read();
+        }
+
+        sample->angle = angle;
+        sample->raw = filter_trimmedMean(reads, SCAN_IR_READS, SCAN_IR_TRIM);
+        sample->dist = sample->raw > 0 ? scan_irToCm(sample->raw) : SCAN_FAR_CM;
+        if (sample->dist > SCAN_FAR_CM) {
+            sample->dist = SCAN_FAR_CM;
+        }
+        sample->ping = SCAN_NO_PING;
+
+        // Until fused, the range is the IR reading
+        sample->range = sample->dist;
+        if (sample->dist <= SCAN_IR_MAX_CM) {
+            sample->var = SCAN_IR_SIGMA(sample->dist) * SCAN_IR_SIGMA(sample->dist);
+        } else {
+            sample->var = SCAN_UNKNOWN_VAR;
+        }
+    }
+}
+
+/**
+ * Position of the IR sensor for a sample's stamp (mm)
+ */
+static void scan_sensorAt(const scan_sample_t *sample, double *x, double *y)
+{
+    double heading = SCAN_RAD(sample->heading / 100.0);
+
+    *x = sample->x + SCAN_SENSOR_MM * cos(heading);
+    *y = sample->y + SCAN_SENSOR_MM * sin(heading);
+}
+
+/**
+ * Move every sample into the frame of the pose of the last sample, for sweeps
+ * taken while driving. Close samples are re-projected through their point in
+ * the world, far ones only turned by the change of heading. Samples keep
+ * their order; the angles are no longer evenly spaced.
+ *
+ * @param scan - Stamped scan to correct
+ *
+ * @returns the number of samples that moved
+ */
+int scan_deskew(scan_t *scan)
+{
+    int i;
+    int moved = 0;
+    double refX, refY, angle;
+
+    if (scan->count == 0) {
+        return 0;
+    }
+
+    const scan_sample_t *ref = &scan->samples[scan->count - 1];
+    scan_sensorAt(ref, &refX, &refY);
+
+    for (i = 0; i < scan->count - 1; i++)
+    {
+        scan_sample_t *sample = &scan->samples[i];
+        if (sample->x == ref->x && sample->y == ref->y && sample->heading == ref->heading) {
+            continue;
+        }
+
+        if (sample->range <= SCAN_IR_MAX_CM)
+        {
+            // Where the sample hit, seen from the last pose; servo 90 looks along the heading
+            double x, y;
+            double bearing = SCAN_RAD(sample->heading / 100.0 + sample->angle - 90);
+            scan_sensorAt(sample, &x, &y);
+            x += sample->range * 10 * cos(bearing) - refX;
+            y += sample->range * 10 * sin(bearing) - refY;
+
+            int range = (int)(sqrt(x * x + y * y) / 10 + 0.5);
+            sample->range = range < SCAN_FAR_CM ? range : SCAN_FAR_CM;
+            angle = SCAN_DEG(atan2(y, x)) - ref->heading / 100.0 + 90;
+        } else {
+            angle = sample->angle + (sample->heading - ref->heading) / 100.0;
+        }
+
+        while (angle < -180) {
+            angle += 360;
+        }
+        while (angle >= 180) {
+            angle -= 360;
+        }
+        sample->angle = angle < 0 ? 0 : (angle > 180 ? 180 : (uint8_t)(angle + 0.5));
+        sample->x = ref->x;
+        sample->y = ref->y;
+        sample->heading = ref->heading;
+        moved++;
+    }
+
+    return moved;
+}
+
+/**
+ * Kalman update of one sample with a measurement, skipped when the two disagree
+ * by more than SCAN_GATE_SIGMAS standard deviations
+ *
+ * @returns 1 if the measurement was used
+ */
+static int scan_update(scan_sample_t *sample, uint32_t range, uint32_t var)
+{
+    uint32_t diff = range > sample->range ? range - sample->range : sample->range - range;
+    uint32_t total = sample->var + var;
+
+    if (sample->var < SCAN_UNKNOWN_VAR && diff * diff > SCAN_GATE_SIGMAS * SCAN_GATE_SIGMAS * total) {
+        return 0;
+    }
+
+    // Inverse variance weighting, the gain is sample->var / total
+    sample->range = (sample->range * var + range * sample->var + total / 2) / total;
+    sample->var = (sample->var * var + total / 2) / total;
+    if (sample->var == 0) {
+        sample->var = 1;
+    }
+    return 1;
+}
+
+/**
+ * Fuse the PING))) distance of every obstacle into the samples it covers
+ * Call after scan_ping(), then segment again on the fused ranges
+ *
+ * @param scan - Scan to update
+ * @param obstacles - Obstacles with their ping measured
+ * @param count - Number of obstacles
+ *
+ * @returns the number of samples the PING))) readings were fused into
+ */
+int scan_fusePing(scan_t *scan, const Obstacle *obstacles, int count)
+{
+    int i, j;
+    int fused = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        uint32_t ping = obstacles[i].ping;
+        if (ping == SCAN_NO_PING) {
+            continue;
+        }
+
+        for (j = 0; j < scan->count; j++)
+        {
+            scan_sample_t *sample = &scan->samples[j];
+            if (sample->angle < obstacles[i].startAngle || sample->angle > obstacles[i].endAngle) {
+                continue;
+            }
+
+            uint32_t sigma = SCAN_PING_SIGMA(ping, abs(sample->angle - obstacles[i].angle));
+            fused += scan_update(sample, ping, sigma * sigma);
+        }
+    }
+
+    return fused;
+}
+
+/**
+ * Fuse the previous sweep of the same place into a new one, angle by angle
+ * The prior's variance grows with its age first. Only valid if the robot did not move.
+ *
+ * @param scan - New scan to update
+ * @param prior - Earlier scan taken from the same pose with the same angles
+ */
+void scan_fusePrior(scan_t *scan, const scan_t *prior)
+{
+    int i;
+    uint32_t drift = SCAN_DRIFT_VAR_PER_S * (scan->time - prior->time) / 1000;
+
+    for (i = 0; i < scan->count && i < prior->count; i++)
+    {
+        const scan_sample_t *before = &prior->samples[i];
+        if (before->angle != scan->samples[i].angle || before->var >= SCAN_UNKNOWN_VAR) {
+            continue;
+        }
+
+        // Predict: the prior is only as good as the world is still
+        uint32_t var = before->var + drift;
+        scan_update(&scan->samples[i], before->range, var < SCAN_UNKNOWN_VAR ? var : SCAN_UNKNOWN_VAR);
+    }
+}
+
+/**
+ * Fill in an obstacle from a segment and score how sure we are it is real
+ *
+ * Confidence (0-100): up to 40 for width in samples, 30 for the share of
+ * samples in the segment that actually read close (a merged gap lowers it)
+ * and 30 for the variance of the fused range. An object cut off by either
+ * end of the sweep loses a quarter, its width is unknown.
+ */
+static void scan_makeObstacle(const scan_t *scan, const scan_run_t *segment, Obstacle *obstacle)
+{
+    int i;
+    int samples = segment->last - segment->first + 1;
+    int close = 0;
+    int sum = 0;
+    uint32_t var = 0;
+    int confidence;
+
+    obstacle->ping = SCAN_NO_PING;
+    for (i = segment->first; i <= segment->last; i++)
+    {
+        const scan_sample_t *sample = &scan->samples[i];
+        if (sample->range <= SCAN_EXIT_CM) {
+            sum += sample->range;
+            var += sample->var;
+            close++;
+        }
+        if (sample->ping != SCAN_NO_PING) {
+            obstacle->ping = sample->ping;
+        }
+    }
+
+    obstacle->startAngle = scan->samples[segment->first].angle;
+    obstacle->endAngle = scan->samples[segment->last].angle;
+    obstacle->angle = (obstacle->startAngle + obstacle->endAngle) / 2; // Angle midpoint
+    obstacle->startDist = scan->samples[segment->first].range;
+    obstacle->endDist = scan->samples[segment->last].range;
+    obstacle->dist = sum / close; // Mean of the close ranges
+    obstacle->variance = var / close;
+    obstacle->width = obstacle->endAngle - obstacle->startAngle;
+    obstacle->linearWidth = obstacle->width * (M_PI / 180) * obstacle->dist;
+    obstacle->clipped = segment->first == 0 || segment->last == scan->count - 1;
+
+    confidence = 40 * (samples < SCAN_SURE_SAMPLES ? samples : SCAN_SURE_SAMPLES) / SCAN_SURE_SAMPLES;
+    confidence += 30 * close / samples;
+    if (obstacle->variance <= SCAN_SURE_VAR) {
+        confidence += 30;
+    } else if (obstacle->variance < SCAN_DOUBT_VAR) {
+        confidence += 30 * (SCAN_DOUBT_VAR - obstacle->variance) / (SCAN_DOUBT_VAR - SCAN_SURE_VAR);
+    }
+    if (obstacle->clipped) {
+        confidence = confidence * 3 / 4;
+    }
+    obstacle->confidence = confidence;
+}
+
+/**
+ * Distance difference between two samples
+ */
+static int scan_jump(const scan_t *scan, int a, int b)
+{
+    return abs((int)scan->samples[a].range - (int)scan->samples[b].range);
+}
+
+/**
+ * A segment is complete: merge it into the pending one if only a short gap of
+ * matching distance separates them, otherwise emit the pending one
+ *
+ * @returns the number of obstacles written (0 or 1)
+ */
+static int scan_closeSegment(const scan_t *scan, scan_run_t *pending, const scan_run_t *segment, Obstacle *obstacle)
+{
+    int written = 0;
+
+    if (pending->first >= 0 && segment->first >= 0 && segment->first - pending->last - 1 <= SCAN_MAX_GAP
+            && segment->first - pending->last > 1 && scan_jump(scan, pending->last, segment->first) <= SCAN_EDGE_CM) {
+        pending->last = segment->last;
+        return 0;
+    }
+
+    if (pending->first >= 0 && pending->last - pending->first + 1 >= SCAN_MIN_SAMPLES) {
+        scan_makeObstacle(scan, pending, obstacle);
+        written = 1;
+    }
+    *pending = *segment;
+    return written;
+}
+
+/**
+ * Find the obstacles in a scan by distance hysteresis and edges, see SCAN_ENTER_CM
+ * Objects running into either end of the sweep are reported with clipped set
+ *
+ * @param scan - Scan to segment
+ * @param obstacles - Filled in with the obstacles found, in angle order
+ * @param max - Room in obstacles, further obstacles are ignored
+ *
+ * @returns the number of obstacles written
+ */
+int scan_segment(const scan_t *scan, Obstacle *obstacles, int max)
+{
+    int i;
+    int found = 0;
+    scan_run_t open = { -1, -1 };    // Object the samples are in
+    scan_run_t pending = { -1, -1 }; // Last closed object, may still be merged with the next
+    scan_run_t none = { -1, -1 };
+
+    for (i = 0; i < scan->count && found < max; i++)
+    {
+        int dist = scan->samples[i].range;
+
+        if (open.first >= 0)
+        {
+            if (dist > SCAN_EXIT_CM) {
+                found += scan_closeSegment(scan, &pending, &open, &obstacles[found]);
+                open.first = -1;
+                continue;
+            }
+            if (scan_jump(scan, open.last, i) > SCAN_EDGE_CM) {
+                found += scan_closeSegment(scan, &pending, &open, &obstacles[found]);
+                open.first = -1;
+            } else {
+                open.last = i;
+                continue;
+            }
+        }
+
+        // Not in an object (or an edge just ended one)
+        if (dist < SCAN_ENTER_CM && found < max) {
+            open.first = i;
+            open.last = i;
+        }
+    }
+
+    // An object still open runs into the end of the sweep
+    if (open.first >= 0 && found < max) {
+        found += scan_closeSegment(scan, &pending, &open, &obstacles[found]);
+    }
+    if (found < max) {
+        found += scan_closeSegment(scan, &pending, &none, &obstacles[found]);
+    }
+
+    return found;
+}
+
+/**
+ * Aim the PING))) sensor at the midpoint of every obstacle and record its distance
+ * in the obstacle and in the sample at that angle
+ *
+ * @param scan - Scan the obstacles came from
+ * @param obstacles - Obstacles to measure
+ * @param count - Number of obstacles
+ */
+void scan_ping(scan_t *scan, Obstacle *obstacles, int count)
+{
+    int i, j;
+
+    for (i = 0; i < count; i++)
+    {
+        servo_set_angle(obstacles[i].angle);
+        servo_wait();
+
+        // Get PING at midpoint, clamped like the IR readings: a missed echo times out at
+        // many metres, which would overflow the fusion math (a negative width is no echo either)
+        int ping = ping_read();
+        obstacles[i].ping = ping < 0 || ping > SCAN_FAR_CM ? SCAN_FAR_CM : ping;
+        timer_waitMillis(100);
+
+        for (j = 0; j < scan->count; j++)
+        {
+            if (scan->samples[j].angle == obstacles[i].angle) {
+                scan->samples[j].ping = obstacles[i].ping;
+            }
+        }
+    }
+}
+
+/**
+ * Send the fused ranges of a scan as a telemetry SCAN record
+ *
+ * @param scan - Scan to send
+ */
+void scan_send(const scan_t *scan)
+{
+    uint16_t dist[SCAN_MAX_SAMPLES];
+    int i;
+
+    if (scan->count == 0) {
+        return;
+    }
+
+    for (i = 0; i < scan->count; i++) {
+        dist[i] = scan->samples[i].range;
+    }
+    telemetry_sendScan(scan->samples[0].angle, scan->step, dist, scan->count);
+}
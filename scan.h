@@ -0,0 +1,168 @@
+/*
+ * scan.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Servo sweeps of the IR sensor into a polar scan owned by the caller, and
+ *  segmentation of a scan into obstacles written to a caller-supplied array.
+ *  Nothing here keeps state between calls, so one scan can be segmented,
+ *  pinged, sent as telemetry and checked for the roadway without copying.
+ *
+ *  Every sample carries a range estimate with its variance. A sweep starts
+ *  it from the IR reading; scan_fusePing() and scan_fusePrior() refine it
+ *  with the PING))) readings and an earlier sweep from the same spot (a
+ *  one-step Kalman update per angle), and segmentation works on the result.
+ *
+ *  Each sample is also stamped with the odometry pose it was taken at. If the
+ *  CyBot moved during the sweep, scan_deskew() moves every sample into the
+ *  frame of the last one before segmentation, so an object keeps its shape
+ *  and is reported where it is seen from the robot's pose at the end.
+ */
+
+#ifndef SCAN_H_
+#define SCAN_H_
+
+#include "open_interface.h"
+
+#include <stdint.h>
+
+// Samples in a full 0-180 degree sweep at 2 degree steps
+#define SCAN_MAX_SAMPLES 91
+
+// Value of scan_sample_t.ping when the PING))) sensor was not aimed at the sample
+#define SCAN_NO_PING 0xFFFF
+
+// Farthest distance the IR sensor reads reliably (cm)
+#define SCAN_IR_RANGE 50
+
+// Variance of a range nothing is known about (cm^2)
+#define SCAN_UNKNOWN_VAR 0xFFFF
+
+// IR sensor ahead of the wheel axis, the point the robot turns about (mm)
+#define SCAN_SENSOR_MM 110
+
+// Typedef struct - One sample of a sweep
+typedef struct scan_sample
+{
+    uint8_t angle;  // Servo angle (deg)
+    uint16_t raw;   // IR reading from the ADC
+    uint16_t dist;  // IR distance (cm)
+    uint16_t ping;  // PING))) distance (cm), SCAN_NO_PING if not measured
+    uint16_t range; // Fused range estimate (cm)
+    uint16_t var;   // Variance of range (cm^2)
+    int16_t x;      // Robot pose when sampled (mm, odometry)
+    int16_t y;
+    int16_t heading; // (0.01 deg, CCW positive)
+} scan_sample_t;
+
+// Typedef struct - One servo sweep
+typedef struct scan
+{
+    uint32_t time;  // timer_getMillis() when the sweep started
+    uint8_t step;   // Degrees between samples
+    uint8_t count;  // Samples taken
+    scan_sample_t samples[SCAN_MAX_SAMPLES];
+} scan_t;
+
+// Typedef struct - Obstacle properties such as angle located, distance away from robot, width, and linear width
+typedef struct Obstacle
+{
+    int startAngle;
+    int endAngle;
+    int angle; // Angle at the midpoint of object
+    int startDist;
+    int endDist;
+    int dist;       // Fused range (cm)
+    int variance;   // Of dist (cm^2)
+    int ping;
+    int width;
+    int linearWidth;
+    int confidence; // 0-100, how sure the segmentation is that the object is real
+    int clipped;    // Runs into an end of the sweep, the real width may be larger
+} Obstacle;
+
+/**
+ * Convert a raw IR reading to a distance
+ *
+ * @param raw - ADC reading
+ *
+ * @returns the distance in cm
+ */
+int scan_irToCm(int raw);
+
+/**
+ * Sweep the servo and record the IR sensor at every step
+ *
+ * @param scan - Filled in with the samples
+ * @param startAngle - First angle (deg)
+ * @param endAngle - Last angle (deg), at most SCAN_MAX_SAMPLES samples are taken
+ * @param step - Degrees between samples
+ * @param sensor - Refreshed while the servo settles to stamp every sample with the pose,
+ *                 NULL if the CyBot stands still (the stamps are left 0)
+ */
+void scan_sweep(scan_t *scan, uint8_t startAngle, uint8_t endAngle, uint8_t step, oi_t *sensor);
+
+/**
+ * Move every sample into the frame of the pose of the last sample, for sweeps
+ * taken while driving. Close samples are re-projected through their point in
+ * the world, far ones only turned by the change of heading. Samples keep
+ * their order; the angles are no longer evenly spaced.
+ *
+ * @param scan - Stamped scan to correct
+ *
+ * @returns the number of samples that moved
+ */
+int scan_deskew(scan_t *scan);
+
+/**
+ * Fuse the PING))) distance of every obstacle into the samples it covers
+ * Call after scan_ping(), then segment again on the fused ranges
+ *
+ * @param scan - Scan to update
+ * @param obstacles - Obstacles with their ping measured
+ * @param count - Number of obstacles
+ *
+ * @returns the number of samples the PING))) readings were fused into
+ */
+int scan_fusePing(scan_t *scan, const Obstacle *obstacles, int count);
+
+/**
+ * Fuse the previous sweep of the same place into a new one, angle by angle
+ * The prior's variance grows with its age first. Only valid if the robot did not move.
+ *
+ * @param scan - New scan to update
+ * @param prior - Earlier scan taken from the same pose with the same angles
+ */
+void scan_fusePrior(scan_t *scan, const scan_t *prior);
+
+/**
+ * Find the obstacles in a scan by distance hysteresis and edges, see scan.c
+ * Objects running into either end of the sweep are reported with clipped set
+ *
+ * @param scan - Scan to segment
+ * @param obstacles - Filled in with the obstacles found, in angle order
+ * @param max - Room in obstacles, further obstacles are ignored
+ *
+ * @returns the number of obstacles written
+ */
+int scan_segment(const scan_t *scan, Obstacle *obstacles, int max);
+
+/**
+ * Aim the PING))) sensor at the midpoint of every obstacle and record its distance
+ * in the obstacle and in the sample at that angle
+ *
+ * @param scan - Scan the obstacles came from
+ * @param obstacles - Obstacles to measure
+ * @param count - Number of obstacles
+ */
+void scan_ping(scan_t *scan, Obstacle *obstacles, int count);
+
+/**
+ * Send the fused ranges of a scan as a telemetry SCAN record
+ *
+ * @param scan - Scan to send
+ */
+void scan_send(const scan_t *scan);
+
+#endif /* SCAN_H_ */
@@ -0,0 +1,202 @@
+/*
+ * scancache.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "scancache.h"
+#include "Timer.h"
+
+#include <math.h>
+
+/*
+ * A cached sweep answers nothing once it is older than SCANCACHE_MAX_AGE_MS
+ * (pedestrians walk) or the robot drove more than SCANCACHE_MAX_TRAVEL_MM
+ * away from it (the odometry error grows and the cone ahead is out of IR
+ * range of where it was taken); both ask for a full sweep to refill it.
+ * Within those, the rays of the cone are followed in SCANCACHE_POINT_CM
+ * steps and every point has to lie on the free part of the cached ray
+ * nearest in angle, SCANCACHE_MARGIN_CM short of an object it hit.
+ */
+#define SCANCACHE_MAX_AGE_MS 8000
+#define SCANCACHE_MAX_TRAVEL_MM 1000
+#define SCANCACHE_POINT_CM 5
+#define SCANCACHE_MARGIN_CM 5
+#define SCANCACHE_SWEEP_MARGIN 4 // Degrees swept past the unseen rays so segmentation sees the edges
+
+#define SCANCACHE_RAD(deg) ((deg) * (M_PI / 180))
+#define SCANCACHE_DEG(rad) ((rad) * (180 / M_PI))
+
+/**
+ * Position of the IR sensor for a robot pose (mm)
+ */
+static void scancache_sensor(double x, double y, double heading, double *sx, double *sy)
+{
+    *sx = x + SCAN_SENSOR_MM * cos(SCANCACHE_RAD(heading));
+    *sy = y + SCAN_SENSOR_MM * sin(SCANCACHE_RAD(heading));
+}
+
+/**
+ * Forget the cached sweep and clear the counters
+ *
+ * @param cache - Cache to reset
+ */
+void scancache_init(scancache_t *cache)
+{
+    cache->valid = 0;
+    cache->plans[SCANCACHE_NONE] = 0;
+    cache->plans[SCANCACHE_PARTIAL] = 0;
+    cache->plans[SCANCACHE_FULL] = 0;
+    cache->saved = 0;
+}
+
+/**
+ * Store a sweep taken at a pose, replacing the cached one
+ *
+ * @param cache - Cache to fill
+ * @param scan - Fused sweep
+ * @param x - Robot position when swept (mm, odometry)
+ * @param y
+ * @param heading - Robot heading when swept (deg, CCW positive)
+ */
+void scancache_store(scancache_t *cache, const scan_t *scan, double x, double y, double heading)
+{
+    int i;
+    double sx, sy;
+
+    if (scan->count == 0) {
+        return;
+    }
+
+    scancache_sensor(x, y, heading, &sx, &sy);
+    cache->valid = 1;
+    cache->time = scan->time;
+    cache->x = (int16_t)sx;
+    cache->y = (int16_t)sy;
+    cache->heading = (int16_t)heading;
+    cache->first = scan->samples[0].angle;
+    cache->step = scan->step;
+    cache->count = scan->count;
+
+    for (i = 0; i < scan->count; i++)
+    {
+        const scan_sample_t *sample = &scan->samples[i];
+        scancache_ray_t *ray = &cache->rays[i];
+
+        // Servo 90 looks along the heading, lower angles to the right
+        double bearing = SCANCACHE_RAD(heading + sample->angle - 90);
+        int cm = sample->range <= SCAN_IR_RANGE ? sample->range : SCAN_IR_RANGE;
+
+        ray->hit = sample->range <= SCAN_IR_RANGE;
+        ray->x = (int16_t)(sx + cm * 10 * cos(bearing));
+        ray->y = (int16_t)(sy + cm * 10 * sin(bearing));
+    }
+}
+
+/**
+ * Whether a world point (mm) is known to be free from the cached sweep
+ */
+static int scancache_isFree(const scancache_t *cache, double px, double py)
+{
+    double dx = px - cache->x;
+    double dy = py - cache->y;
+    double cm = sqrt(dx * dx + dy * dy) / 10;
+    double angle;
+    int i;
+
+    if (cm < SCANCACHE_POINT_CM) {
+        return 1; // The cached sensor was standing on it
+    }
+
+    angle = SCANCACHE_DEG(atan2(dy, dx)) - cache->heading + 90;
+    while (angle < -180) {
+        angle += 360;
+    }
+    while (angle >= 180) {
+        angle -= 360;
+    }
+
+    i = (int)floor((angle - cache->first) / cache->step + 0.5);
+    if (i < 0 || i >= cache->count) {
+        return 0; // Behind the cached sweep or beyond its ends
+    }
+
+    const scancache_ray_t *ray = &cache->rays[i];
+    double rx = ray->x - cache->x;
+    double ry = ray->y - cache->y;
+    double freeCm = sqrt(rx * rx + ry * ry) / 10;
+
+    if (ray->hit) {
+        freeCm -= SCANCACHE_MARGIN_CM;
+    }
+    return cm <= freeCm + 1; // Ray ends are rounded to the mm
+}
+
+/**
+ * Decide how much has to be swept to know whether a cone in front of the
+ * robot is clear up to a range
+ *
+ * @param cache - Cache to consult, its counters are updated
+ * @param x - Robot position now (mm, odometry)
+ * @param y
+ * @param heading - Robot heading now (deg, CCW positive)
+ * @param startAngle - First servo angle of the cone, replaced by the first angle to sweep
+ * @param endAngle - Last servo angle of the cone, replaced by the last angle to sweep
+ * @param reach - Range the cone has to be known clear to (cm)
+ *
+ * @returns what to sweep, for SCANCACHE_NONE the angles are left alone
+ */
+scancache_plan_t scancache_plan(scancache_t *cache, double x, double y, double heading,
+                                uint8_t *startAngle, uint8_t *endAngle, uint16_t reach)
+{
+    scancache_plan_t plan;
+    int angle, cm;
+    int unseenFirst = -1, unseenLast = -1;
+    double sx, sy;
+
+    scancache_sensor(x, y, heading, &sx, &sy);
+
+    if (!cache->valid || timer_getMillis() - cache->time > SCANCACHE_MAX_AGE_MS
+            || hypot(sx - cache->x, sy - cache->y) > SCANCACHE_MAX_TRAVEL_MM)
+    {
+        cache->plans[SCANCACHE_FULL]++;
+        *startAngle = 0;
+        *endAngle = 180;
+        return SCANCACHE_FULL;
+    }
+
+    // Follow every ray of the cone until it leaves what the cache knows is free
+    for (angle = *startAngle; angle <= *endAngle; angle += cache->step)
+    {
+        double bearing = SCANCACHE_RAD(heading + angle - 90);
+        double ux = cos(bearing) * 10;
+        double uy = sin(bearing) * 10;
+
+        for (cm = SCANCACHE_POINT_CM; cm <= reach; cm += SCANCACHE_POINT_CM)
+        {
+            if (!scancache_isFree(cache, sx + cm * ux, sy + cm * uy)) {
+                if (unseenFirst < 0) {
+                    unseenFirst = angle;
+                }
+                unseenLast = angle;
+                break;
+            }
+        }
+    }
+
+    if (unseenFirst < 0) {
+        plan = SCANCACHE_NONE;
+        cache->saved += SCAN_MAX_SAMPLES;
+    } else {
+        plan = SCANCACHE_PARTIAL;
+        unseenFirst -= SCANCACHE_SWEEP_MARGIN;
+        unseenLast += SCANCACHE_SWEEP_MARGIN;
+        *startAngle = unseenFirst > 0 ? unseenFirst : 0;
+        *endAngle = unseenLast < 180 ? unseenLast : 180;
+        cache->saved += SCAN_MAX_SAMPLES - ((*endAngle - *startAngle) / cache->step + 1);
+    }
+
+    cache->plans[plan]++;
+    return plan;
+}
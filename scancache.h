@@ -0,0 +1,91 @@
+/*
+ * scancache.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Memory of the last full sweep, kept in world coordinates so a roadway
+ *  check can be answered from it after the CyBot moved. Every ray of the
+ *  sweep is stored as the point where it ended: on an object, or where the
+ *  IR stops being trusted. Before sweeping, scancache_plan() walks the rays
+ *  the check needs from the current pose through the cached sweep and says
+ *  whether they are all known to be clear (no sweep), which angles nobody
+ *  has seen (partial sweep) or that the cache is too old or too far away to
+ *  be of use (full sweep, which then refills it).
+ */
+
+#ifndef SCANCACHE_H_
+#define SCANCACHE_H_
+
+#include "scan.h"
+
+#include <stdint.h>
+
+typedef enum
+{
+    SCANCACHE_NONE = 0,    // Everything asked about is known to be clear
+    SCANCACHE_PARTIAL = 1, // Sweep the returned angles only
+    SCANCACHE_FULL = 2     // Sweep 0-180 and store it
+} scancache_plan_t;
+
+// Typedef struct - Where one ray of the cached sweep ended, in world coordinates
+typedef struct scancache_ray
+{
+    int16_t x;   // (mm)
+    int16_t y;   // (mm)
+    uint8_t hit; // Ended on an object rather than at the edge of the IR range
+} scancache_ray_t;
+
+// Typedef struct - The last full sweep and how often it saved one
+typedef struct scancache
+{
+    uint8_t valid;
+    uint32_t time;      // timer_getMillis() of the sweep
+    int16_t x;          // Sensor position when swept (mm)
+    int16_t y;
+    int16_t heading;    // Robot heading when swept (deg, CCW positive)
+    uint8_t first;      // Angle of rays[0] (deg)
+    uint8_t step;       // Degrees between rays
+    uint8_t count;
+    scancache_ray_t rays[SCAN_MAX_SAMPLES];
+
+    uint16_t plans[3];  // Plans made, by scancache_plan_t
+    uint32_t saved;     // Samples not taken compared to sweeping 0-180 every time
+} scancache_t;
+
+/**
+ * Forget the cached sweep and clear the counters
+ *
+ * @param cache - Cache to reset
+ */
+void scancache_init(scancache_t *cache);
+
+/**
+ * Store a sweep taken at a pose, replacing the cached one
+ *
+ * @param cache - Cache to fill
+ * @param scan - Fused sweep
+ * @param x - Robot position when swept (mm, odometry)
+ * @param y
+ * @param heading - Robot heading when swept (deg, CCW positive)
+ */
+void scancache_store(scancache_t *cache, const scan_t *scan, double x, double y, double heading);
+
+/**
+ * Decide how much has to be swept to know whether a cone in front of the
+ * robot is clear up to a range
+ *
+ * @param cache - Cache to consult, its counters are updated
+ * @param x - Robot position now (mm, odometry)
+ * @param y
+ * @param heading - Robot heading now (deg, CCW positive)
+ * @param startAngle - First servo angle of the cone, replaced by the first angle to sweep
+ * @param endAngle - Last servo angle of the cone, replaced by the last angle to sweep
+ * @param reach - Range the cone has to be known clear to (cm)
+ *
+ * @returns what to sweep, for SCANCACHE_NONE the angles are left alone
+ */
+scancache_plan_t scancache_plan(scancache_t *cache, double x, double y, double heading,
+                                uint8_t *startAngle, uint8_t *endAngle, uint16_t reach);
+
+#endif /* SCANCACHE_H_ */
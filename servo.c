@@ -9,15 +9,60 @@
 #include "Timer.h"
 #include "lcd.h"
 
-#define ZERO_DEG 311910
-#define MAX_DEG 284856
+// Typedef struct - One calibration point, PWM match value (prescaler:match, 24 bits) for an angle
+typedef struct servo_cal
+{
+    int angle;
+    uint32_t match;
+} servo_cal_t;
 
-int steps = (ZERO_DEG - MAX_DEG) / 180.0;
+/*
+ * Calibrated match values, ascending angle. The match falls as the angle rises
+ * (shorter low time, longer pulse). Between points the value is interpolated.
+ */
+#if SERVO_CYBOT == 6
+static const servo_cal_t servo_cal[] = {
+    {   0, 311910 }, // 0x4C266
+    {  90, 298500 }, // 0x48E04
+    { 180, 284856 }, // 0x458B8
+};
+#elif SERVO_CYBOT == 13
+static const servo_cal_t servo_cal[] = {
+    {   0, 312000 }, // 0x4C2C0
+    {  90, 297000 }, // 0x48828
+    { 180, 282750 }, // 0x4507E
+};
+#else
+#error "No servo calibration for this SERVO_CYBOT"
+#endif
+
+#define SERVO_CAL_POINTS (sizeof(servo_cal) / sizeof(servo_cal[0]))
+
+static int servo_angle = 90;          // Commanded angle
+static unsigned int servo_arrival;    // timer_getMillis() when the servo will have settled
+
+/**
+ * Match value for an angle, interpolated from the calibration table
+ */
+static uint32_t servo_matchFor(int degrees) {
+    int i;
+
+    for (i = 1; i < (int)SERVO_CAL_POINTS - 1 && degrees > servo_cal[i].angle; i++);
 
-// Use CyBot 6
-// 311910 (0xC266) callib (304000) = Match for 0 deg
-// 298500 (0x8E04) callib (296000) = Match for 90 deg
-// 284856 (0x58B8) callib (288000) = Match for 180 deg
+    const servo_cal_t *a = &servo_cal[i - 1];
+    const servo_cal_t *b = &servo_cal[i];
+    int32_t span = (int32_t)b->match - (int32_t)a->match;
+
+    return a->match + span * (degrees - a->angle) / (b->angle - a->angle);
+}
+
+/**
+ * Load a 24 bit match value, the prescaler holds the upper 8 bits
+ */
+static void servo_setMatch(uint32_t match) {
+    TIMER1_TBPMR_R = match >> 16;
+    TIMER1_TBMATCHR_R = match & 0xFFFF;
+}
 
 /**
  * Initialize the servo capability using the onboard Timer in PWM mode
@@ -49,52 +94,95 @@ void servo_init(void) {
     /* 24-bit Timer: 16-bit ILR + 8-bit Pre-scaler */
     TIMER1_TBILR_R = 0xE200; // Servo Period 20 ms, 320,000 clock ticks per period
     TIMER1_TBPR_R = 0x04; // Preset value
-    TIMER1_TBMATCHR_R = 0x8E04; // Match value init at 90 deg
-    TIMER1_TBPMR_R = 0x04; // Prest init (same for 0-180 deg)
+    servo_setMatch(servo_matchFor(90)); // Start at 90 deg
 
     TIMER1_CTL_R |= 0b0000000100000000;
+
+    // Unknown where it was at power up, allow a full sweep
+    servo_angle = 90;
+    servo_arrival = timer_getMillis() + 180 * SERVO_MS_PER_DEG + SERVO_SETTLE_MS;
+}
+
+/**
+ * Command an absolute angle, returns without waiting
+ * @param degrees - Angle from 0 (right) to 180 (left), clamped to that range
+ *
+ * @returns the timer_getMillis() time the servo is predicted to have settled at
+ */
+unsigned int servo_set_angle(int degrees) {
+    unsigned int now = timer_getMillis();
+    int travel;
+
+    degrees = degrees < 0 ? 0 : (degrees > 180 ? 180 : degrees);
+    travel = degrees > servo_angle ? degrees - servo_angle : servo_angle - degrees;
+
+    servo_setMatch(servo_matchFor(degrees));
+    servo_angle = degrees;
+
+    // A move still in progress is not where it was sent; count its remaining time too
+    if ((int)(servo_arrival - now) > 0) {
+        now = servo_arrival;
+    }
+    servo_arrival = now + travel * SERVO_MS_PER_DEG + SERVO_SETTLE_MS;
+
+    return servo_arrival;
+}
+
+/**
+ * @returns the last commanded angle
+ */
+int servo_get_angle(void) {
+    return servo_angle;
+}
+
+/**
+ * @returns 1 once the servo is predicted to have settled at the commanded angle
+ */
+int servo_arrived(void) {
+    return (int)(servo_arrival - timer_getMillis()) <= 0;
+}
+
+/**
+ * Wait until the servo is predicted to have settled at the commanded angle
+ */
+void servo_wait(void) {
+    int remaining = servo_arrival - timer_getMillis();
+
+    if (remaining > 0) {
+        timer_waitMillis(remaining);
+    }
 }
 
 /*
- * Move the Servo a given number of degrees by manipulating the generated PWM waveform
+ * Move the Servo a given number of degrees from the commanded angle and wait for it to settle
  * @param degrees - the number of degrees to adjust the servo angle by
  *
- * @returns the current servo position count
+ * @returns the new commanded angle
  */
 int servo_move(float degrees) {
-    // Don't move past 180 or 0
-    if (TIMER1_TBMATCHR_R >= 0xC2C1) {
-        TIMER1_TBMATCHR_R = 0xC2C0; // Reached 0 deg
-    } else if (TIMER1_TBMATCHR_R <= 0x58B7) {
-        TIMER1_TBMATCHR_R = 0x58B8; // Reached 180 deg
-    } else {
-        TIMER1_TBMATCHR_R -= (steps * degrees);
-    }
-
-    timer_waitMillis(150);
-    return TIMER1_TBMATCHR_R + 0x040000;
+    servo_set_angle(servo_angle + (int)(degrees + (degrees < 0 ? -0.5f : 0.5f)));
+    servo_wait();
+    return servo_angle;
 }
 
 /**
  * Go to 180 degrees
  *
- * @returns the current servo position count
+ * @returns the new commanded angle
  */
 int servo_to_left() {
-    TIMER1_TBMATCHR_R = 0x507E;
-
-    timer_waitMillis(15);
-    return TIMER1_TBMATCHR_R + 0x040000;
+    servo_set_angle(180);
+    servo_wait();
+    return servo_angle;
 }
 
 /**
  * Go to 0 degrees
  *
- * @returns the current servo position count
+ * @returns the new commanded angle
  */
 int servo_to_right() {
-    TIMER1_TBMATCHR_R = 0xC2C0;
-
-    timer_waitMillis(15);
-    return TIMER1_TBMATCHR_R + 0x040000;
+    servo_set_angle(0);
+    servo_wait();
+    return servo_angle;
 }
@@ -13,34 +13,62 @@
 #include <inc/tm4c123gh6pm.h>
 #include "driverlib/interrupt.h"
 
+// Robot whose calibration table is used (see servo.c), the host tests build every one
+#ifndef SERVO_CYBOT
+#define SERVO_CYBOT 6
+#endif
+
+// Predicted speed of the servo (about 0.17 s per 60 deg) and the time it takes to settle
+#define SERVO_MS_PER_DEG 3
+#define SERVO_SETTLE_MS 20
+
 /**
  * Initialize the servo capability using the onboard Timer in PWM mode
  */
 void servo_init(void);
 
+/**
+ * Command an absolute angle, returns without waiting
+ * @param degrees - Angle from 0 (right) to 180 (left), clamped to that range
+ *
+ * @returns the timer_getMillis() time the servo is predicted to have settled at
+ */
+unsigned int servo_set_angle(int degrees);
+
+/**
+ * @returns the last commanded angle
+ */
+int servo_get_angle(void);
+
+/**
+ * @returns 1 once the servo is predicted to have settled at the commanded angle
+ */
+int servo_arrived(void);
+
+/**
+ * Wait until the servo is predicted to have settled at the commanded angle
+ */
+void servo_wait(void);
+
 /*
- * Move the Servo a given number of degrees by manipulating the generated PWM waveform
- * - Use CyBot 13
-   - 312000 (0xC2C0) callib (304000) = Match for 0 deg
-   - 297000 (0x8828) callib (296000) = Match for 90 deg
-   - 282750 (0x507E) callib (288000) = Match for 180 deg
+ * Move the Servo a given number of degrees from the commanded angle and wait for it to settle
  * @param degrees - the number of degrees to adjust the servo angle by
  *
- * @returns 1 when the servo has completed movement
+ * @returns the new commanded angle
  */
 int servo_move(float degrees);
 
 /**
  * Go to 180 degrees
  *
- * @returns 1 when the servo has completed movement
+ * @returns the new commanded angle
  */
 int servo_to_left();
 
 /**
  * Go to 0 degrees
  *
- * @returns 1 when the servo has completed movement
+ * @returns the new commanded angle
  */
 int servo_to_right();
 
@@ -0,0 +1,307 @@
+/*
+ * telemetry.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "telemetry.h"
+#include "Timer.h"
+#include "trace.h"
+
+#include <stddef.h>
+
+#define TELEMETRY_HEADER_SIZE 6 // type, sequence, time
+#define TELEMETRY_MAX_RECORD (TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_BODY + 2)
+
+// COBS adds one code byte per 254 data bytes plus the leading code byte
+#define TELEMETRY_MAX_FRAME (TELEMETRY_MAX_RECORD + TELEMETRY_MAX_RECORD / 254 + 2)
+
+static void (*telemetry_output)(char);
+static uint8_t telemetry_sequence;
+
+/* Record being built, records are only sent from the main loop */
+static uint8_t telemetry_record[TELEMETRY_MAX_RECORD];
+static uint16_t telemetry_length;
+static uint16_t telemetry_traceOffset; // Bytes of the trace dump in the records before this one
+
+/**
+ * CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF)
+ */
+static uint16_t telemetry_crc16(const uint8_t *data, uint16_t length)
+{
+    uint16_t crc = 0xFFFF;
+    int bit;
+
+    while (length-- > 0)
+    {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+
+    return crc;
+}
+
+/**
+ * Append a little-endian integer of the given size to the record
+ */
+static void telemetry_put(uint32_t value, int bytes)
+{
+    while (bytes-- > 0 && telemetry_length < TELEMETRY_MAX_RECORD - 2) {
+        telemetry_record[telemetry_length++] = (uint8_t)(value & 0xFF);
+        value >>= 8;
+    }
+}
+
+/**
+ * Start a new record with its header
+ */
+static void telemetry_begin(telemetry_record_t type)
+{
+    telemetry_length = 0;
+    telemetry_put(type, 1);
+    telemetry_put(telemetry_sequence++, 1);
+    telemetry_put(timer_getMillis(), 4);
+}
+
+/**
+ * Append the CRC, COBS encode the record and send it with its 0x00 delimiter
+ */
+static void telemetry_end(void)
+{
+    static uint8_t frame[TELEMETRY_MAX_FRAME];
+    uint16_t crc = telemetry_crc16(telemetry_record, telemetry_length);
+    uint16_t code = 0;  // Position of the current code byte
+    uint16_t out = 1;
+    uint16_t i;
+
+    if (telemetry_output == NULL) {
+        return;
+    }
+
+    telemetry_record[telemetry_length++] = (uint8_t)(crc & 0xFF);
+    telemetry_record[telemetry_length++] = (uint8_t)(crc >> 8);
+
+    // Each code byte holds the distance to the next zero (or to the end of a 254 byte run)
+    for (i = 0; i < telemetry_length; i++)
+    {
+        if (telemetry_record[i] != 0) {
+            frame[out++] = telemetry_record[i];
+        }
+
+        if (telemetry_record[i] == 0 || out - code == 0xFF)
+        {
+            frame[code] = (uint8_t)(out - code);
+            code = out++;
+        }
+    }
+    frame[code] = (uint8_t)(out - code);
+
+    for (i = 0; i < out; i++) {
+        telemetry_output((char)frame[i]);
+    }
+    telemetry_output(0);
+}
+
+/**
+ * Start sending telemetry and announce the format version with a HELLO record
+ *
+ * @param output - Function each byte is written through (uart_sendChar on the CyBot)
+ */
+void telemetry_init(void (*output)(char))
+{
+    telemetry_output = output;
+    telemetry_sequence = 0;
+
+    // A lone delimiter ends whatever garbage the receiver has seen so far
+    if (output != NULL) {
+        output(0);
+    }
+
+    telemetry_begin(TELEMETRY_HELLO);
+    telemetry_put(TELEMETRY_FORMAT_VERSION, 1);
+    telemetry_end();
+}
+
+/**
+ * Send the dead reckoning pose
+ *
+ * @param x - (mm)
+ * @param y - (mm)
+ * @param heading - (0.01 deg, CCW positive)
+ */
+void telemetry_sendPose(int16_t x, int16_t y, int16_t heading)
+{
+    telemetry_begin(TELEMETRY_POSE);
+    telemetry_put((uint16_t)x, 2);
+    telemetry_put((uint16_t)y, 2);
+    telemetry_put((uint16_t)heading, 2);
+    telemetry_end();
+}
+
+/**
+ * Send one sweep of distance samples
+ *
+ * @param startAngle - Servo angle of the first sample (deg)
+ * @param step - Angle between samples (deg)
+ * @param dist - Distances (cm), at most TELEMETRY_MAX_SCAN
+ * @param count - Number of samples
+ */
+void telemetry_sendScan(uint8_t startAngle, uint8_t step, const uint16_t *dist, uint8_t count)
+{
+    int i;
+
+    if (count > TELEMETRY_MAX_SCAN) {
+        count = TELEMETRY_MAX_SCAN;
+    }
+
+    telemetry_begin(TELEMETRY_SCAN);
+    telemetry_put(startAngle, 1);
+    telemetry_put(step, 1);
+    telemetry_put(count, 1);
+    for (i = 0; i < count; i++) {
+        telemetry_put(dist[i], 2);
+    }
+    telemetry_end();
+}
+
+/**
+ * Send one detected obstacle
+ */
+void telemetry_sendObstacle(const telemetry_obstacle_t *obstacle)
+{
+    telemetry_begin(TELEMETRY_OBSTACLE);
+    telemetry_put(obstacle->index, 1);
+    telemetry_put(obstacle->angle, 1);
+    telemetry_put(obstacle->startAngle, 1);
+    telemetry_put(obstacle->endAngle, 1);
+    telemetry_put(obstacle->dist, 2);
+    telemetry_put(obstacle->ping, 2);
+    telemetry_put(obstacle->linearWidth, 2);
+    telemetry_put(obstacle->confidence, 1);
+    telemetry_end();
+}
+
+/**
+ * Send the number of passengers counted at the platform
+ */
+void telemetry_sendPassengers(uint8_t count)
+{
+    telemetry_begin(TELEMETRY_PASSENGERS);
+    telemetry_put(count, 1);
+    telemetry_end();
+}
+
+/**
+ * Send an alert or route event
+ *
+ * @param alert - What happened
+ * @param arg - Alert specific detail, see telemetry_alert_t
+ */
+void telemetry_sendAlert(telemetry_alert_t alert, uint8_t arg)
+{
+    telemetry_begin(TELEMETRY_ALERT);
+    telemetry_put(alert, 1);
+    telemetry_put(arg, 1);
+    telemetry_end();
+}
+
+/**
+ * Send a free form message, truncated to TELEMETRY_MAX_BODY characters
+ */
+void telemetry_sendText(const char *text)
+{
+    int i;
+
+    telemetry_begin(TELEMETRY_TEXT);
+    for (i = 0; text[i] != '\0' && i < TELEMETRY_MAX_BODY; i++) {
+        telemetry_put((uint8_t)text[i], 1);
+    }
+    telemetry_end();
+}
+
+/**
+ * One byte of trace_dump(), a full record is sent and the next one started
+ */
+static void telemetry_traceByte(char byte)
+{
+    if (telemetry_length == TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_BODY) {
+        telemetry_end();
+        telemetry_begin(TELEMETRY_TRACE);
+        telemetry_put(telemetry_traceOffset, 2);
+    }
+    telemetry_put((uint8_t)byte, 1);
+    telemetry_traceOffset++;
+}
+
+/**
+ * Send the trace buffer (see trace.h) as TRACE records, each a piece of what trace_dump() writes
+ * Offset 0 starts a new dump, tools/trace2json.py puts the pieces back together
+ */
+void telemetry_sendTrace(void)
+{
+    telemetry_traceOffset = 0;
+    telemetry_begin(TELEMETRY_TRACE);
+    telemetry_put(0, 2);
+    trace_dump(telemetry_traceByte);
+    telemetry_end();
+}
+
+/**
+ * Send one tokenized log message (see log.h)
+ *
+ * @param id - Message number from log_msgs.h
+ * @param time - timer_getMillis() when the message was logged
+ * @param args - Integer arguments of the message
+ * @param argc - Number of arguments
+ */
+void telemetry_sendLog(uint8_t id, uint32_t time, const int32_t *args, uint8_t argc)
+{
+    int i;
+
+    telemetry_begin(TELEMETRY_LOG);
+    telemetry_put(id, 1);
+    telemetry_put(time, 4);
+    for (i = 0; i < argc; i++) {
+        telemetry_put((uint32_t)args[i], 4);
+    }
+    telemetry_end();
+}
+
+/**
+ * Answer a command from the control center (see cmd.h)
+ *
+ * @param id - Request id of the command
+ * @param verb - cmd_verb_t of the command, 0xFF if it was not recognised
+ * @param status - cmd_status_t result
+ */
+void telemetry_sendAck(uint16_t id, uint8_t verb, uint8_t status)
+{
+    telemetry_begin(TELEMETRY_ACK);
+    telemetry_put(id, 2);
+    telemetry_put(verb, 1);
+    telemetry_put(status, 1);
+    telemetry_end();
+}
+
+/**
+ * Report a state change of obstacle avoidance (see avoid.h)
+ *
+ * @param state - avoid_state_t entered
+ * @param previous - avoid_state_t left
+ * @param spent - Time spent in the state left (ms)
+ * @param attempt - Plans made so far
+ * @param waypoint - Waypoint of the path being driven to
+ */
+void telemetry_sendAvoid(uint8_t state, uint8_t previous, uint32_t spent, uint8_t attempt, uint8_t waypoint)
+{
+    telemetry_begin(TELEMETRY_AVOID);
+    telemetry_put(state, 1);
+    telemetry_put(previous, 1);
+    telemetry_put(spent, 4);
+    telemetry_put(attempt, 1);
+    telemetry_put(waypoint, 1);
+    telemetry_end();
+}
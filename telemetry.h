@@ -0,0 +1,158 @@
+/*
+ * telemetry.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Binary telemetry to the control center. Every record is one frame:
+ *
+ *    COBS( u8 type, u8 sequence, u32 time (ms), body..., u16 CRC ) 0x00
+ *
+ *  Integers are little-endian, the CRC is CRC-16/CCITT-FALSE over everything
+ *  before it. COBS removes every zero byte from the frame so 0x00 only ever
+ *  marks the end of a frame and a receiver can resynchronise after noise.
+ *  The record bodies below are the schema; tools/telemetry.py decodes them
+ *  and must be updated together with this file.
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+
+// Bumped whenever a record layout changes, sent in the HELLO record
+#define TELEMETRY_FORMAT_VERSION 6
+
+// Largest record body in bytes (a full 0-180 degree scan at 2 degree steps)
+#define TELEMETRY_MAX_BODY 192
+
+// Most samples one SCAN record can carry
+#define TELEMETRY_MAX_SCAN ((TELEMETRY_MAX_BODY - 3) / 2)
+
+/**
+ * Record types and their bodies
+ */
+typedef enum
+{
+    TELEMETRY_HELLO = 0,       // u8 format version
+    TELEMETRY_POSE = 1,        // i16 x (mm), i16 y (mm), i16 heading (0.01 deg, CCW positive)
+    TELEMETRY_SCAN = 2,        // u8 start angle, u8 step (deg), u8 count, u16 distance (cm) x count
+    TELEMETRY_OBSTACLE = 3,    // telemetry_obstacle_t
+    TELEMETRY_PASSENGERS = 4,  // u8 passenger count
+    TELEMETRY_ALERT = 5,       // u8 telemetry_alert_t, u8 argument
+    TELEMETRY_TEXT = 6,        // ASCII text, not terminated
+    TELEMETRY_LOG = 7,         // u8 message (log_msgs.h), u32 time logged (ms), i32 argument x n
+    TELEMETRY_ACK = 8,         // u16 request id, u8 cmd_verb_t (0xFF if unknown), u8 cmd_status_t
+    TELEMETRY_AVOID = 9,       // u8 avoid_state_t entered, u8 state left, u32 time in it (ms), u8 attempt, u8 waypoint
+    TELEMETRY_TRACE = 10       // u16 offset into the trace_dump() output, bytes of it (since version 6)
+} telemetry_record_t;
+
+/**
+ * Route events for the control center
+ * Hazards (bump, cliff, tall object) are LOG records since version 2, codes 0-2 are retired
+ */
+typedef enum
+{
+    TELEMETRY_ALERT_APPROACHING = 3,  // Approaching a stop, arg = stop number (4 = Park & Ride terminal)
+    TELEMETRY_ALERT_STOP_REACHED = 4  // Reached a stop, arg = stop number
+} telemetry_alert_t;
+
+// Typedef struct - Body of an OBSTACLE record, sent in this field order
+typedef struct telemetry_obstacle
+{
+    uint8_t index;        // Position in the scan's obstacle list
+    uint8_t angle;        // Servo angle at the midpoint (deg)
+    uint8_t startAngle;   // (deg)
+    uint8_t endAngle;     // (deg)
+    uint16_t dist;        // IR distance at the midpoint (cm)
+    uint16_t ping;        // PING))) distance at the midpoint (cm)
+    uint16_t linearWidth; // (cm)
+    uint8_t confidence;   // 0-100 (since version 4)
+} telemetry_obstacle_t;
+
+/**
+ * Start sending telemetry and announce the format version with a HELLO record
+ *
+ * @param output - Function each byte is written through (uart_sendChar on the CyBot)
+ */
+void telemetry_init(void (*output)(char));
+
+/**
+ * Send the dead reckoning pose
+ *
+ * @param x - (mm)
+ * @param y - (mm)
+ * @param heading - (0.01 deg, CCW positive)
+ */
+void telemetry_sendPose(int16_t x, int16_t y, int16_t heading);
+
+/**
+ * Send one sweep of distance samples
+ *
+ * @param startAngle - Servo angle of the first sample (deg)
+ * @param step - Angle between samples (deg)
+ * @param dist - Distances (cm), at most TELEMETRY_MAX_SCAN
+ * @param count - Number of samples
+ */
+void telemetry_sendScan(uint8_t startAngle, uint8_t step, const uint16_t *dist, uint8_t count);
+
+/**
+ * Send one detected obstacle
+ */
+void telemetry_sendObstacle(const telemetry_obstacle_t *obstacle);
+
+/**
+ * Send the number of passengers counted at the platform
+ */
+void telemetry_sendPassengers(uint8_t count);
+
+/**
+ * Send an alert or route event
+ *
+ * @param alert - What happened
+ * @param arg - Alert specific detail, see telemetry_alert_t
+ */
+void telemetry_sendAlert(telemetry_alert_t alert, uint8_t arg);
+
+/**
+ * Send a free form message, truncated to TELEMETRY_MAX_BODY characters
+ */
+void telemetry_sendText(const char *text);
+
+/**
+ * Send the trace buffer (see trace.h) as TRACE records, each a piece of what trace_dump() writes
+ * Offset 0 starts a new dump, tools/trace2json.py puts the pieces back together
+ */
+void telemetry_sendTrace(void);
+
+/**
+ * Send one tokenized log message (see log.h)
+ *
+ * @param id - Message number from log_msgs.h
+ * @param time - timer_getMillis() when the message was logged
+ * @param args - Integer arguments of the message
+ * @param argc - Number of arguments
+ */
+void telemetry_sendLog(uint8_t id, uint32_t time, const int32_t *args, uint8_t argc);
+
+/**
+ * Answer a command from the control center (see cmd.h)
+ *
+ * @param id - Request id of the command
+ * @param verb - cmd_verb_t of the command, 0xFF if it was not recognised
+ * @param status - cmd_status_t result
+ */
+void telemetry_sendAck(uint16_t id, uint8_t verb, uint8_t status);
+
+/**
+ * Report a state change of obstacle avoidance (see avoid.h)
+ *
+ * @param state - avoid_state_t entered
+ * @param previous - avoid_state_t left
+ * @param spent - Time spent in the state left (ms)
+ * @param attempt - Plans made so far
+ * @param waypoint - Waypoint of the path being driven to
+ */
+void telemetry_sendAvoid(uint8_t state, uint8_t previous, uint32_t spent, uint8_t attempt, uint8_t waypoint);
+
+#endif /* TELEMETRY_H_ */
@@ -10,7 +10,8 @@
 
 MEMORY
 {
-    FLASH (RX) : origin = 0x00000000, length = 0x00040000
+    FLASH (RX) : origin = 0x00000000, length = 0x0003F000
+    GRID (R)   : origin = 0x0003F000, length = 0x00001000 /* Field map kept between runs, see grid.h */
     SRAM (RWX) : origin = 0x20000000, length = 0x00008000
 }
 
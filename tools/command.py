@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""
+command.py
+
+Send a command to the CyBot over its UART1 serial link and wait for the
+telemetry ACK with the same request id (see cmd.h). Prints the round-trip
+time, so it doubles as the command latency measurement:
+
+  command.py /dev/ttyUSB0 POSE                 one request
+  command.py /dev/ttyUSB0 STOP 2
+  command.py /dev/ttyUSB0 POSE --repeat 100    min/mean/max round trip
+
+Any other records received while waiting are printed, the PROFILE dump as
+TEXT records and the TRACE dump as TRACE records, and bytes that were not a
+telemetry frame are counted.
+"""
+
+import argparse
+import os
+import select
+import sys
+import termios
+import time
+import tty
+
+from telemetry import Decoder
+
+
+def open_serial(path, baud):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    if os.isatty(fd):
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def request(fd, decoder, request_id, words, timeout, quiet):
+    """Send one command, returns (round trip seconds, ack) or (None, None) on timeout"""
+    line = ("%d %s\r" % (request_id, " ".join(words))).encode("ascii")
+    start = time.monotonic()
+    os.write(fd, line)
+
+    while True:
+        left = timeout - (time.monotonic() - start)
+        if left <= 0:
+            return None, None
+        ready, _, _ = select.select([fd], [], [], left)
+        if not ready:
+            continue
+        for record in decoder.feed(os.read(fd, 4096)):
+            if record["type"] == "ack" and record["request"] == request_id:
+                return time.monotonic() - start, record
+            if not quiet:
+                print(record)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", help="serial device of the CyBot (or a pseudo-terminal)")
+    parser.add_argument("command", nargs="+", help="verb and argument, e.g. STOP 2")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--repeat", type=int, default=1)
+    parser.add_argument("--timeout", type=float, default=1.0, help="seconds to wait for each ACK")
+    args = parser.parse_args()
+
+    fd = open_serial(args.port, args.baud)
+    decoder = Decoder()
+    times = []
+    for i in range(args.repeat):
+        rtt, ack = request(fd, decoder, (i % 0xFFFF) + 1, args.command, args.timeout, args.repeat > 1)
+        if rtt is None:
+            print("request %d: no ACK within %.1f s" % (i + 1, args.timeout))
+            continue
+        times.append(rtt)
+        if args.repeat == 1:
+            print("%s: %s in %.2f ms" % (ack["verb"], ack["status"], rtt * 1000))
+    os.close(fd)
+
+    if decoder.errors:
+        print("%d bad frames" % decoder.errors)
+    if args.repeat > 1 and times:
+        print("%d/%d acknowledged, round trip min %.2f / mean %.2f / max %.2f ms"
+              % (len(times), args.repeat, min(times) * 1000, sum(times) / len(times) * 1000,
+                 max(times) * 1000))
+    return 0 if len(times) == args.repeat else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
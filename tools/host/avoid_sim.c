@@ -0,0 +1,201 @@
+/*
+ * avoid_sim.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Tick by tick simulation of avoid_step() against a kinematic Create: the
+ *  robot drives along a leg until a box hits its bumpers or a hole its cliff
+ *  sensors, then the detour steers the wheels every 60 ms control tick. The
+ *  bumpers span 120 degrees of the 170 mm body, the cliff sensors sit 150 mm
+ *  out at 70 and 20 degrees either side. Every state change is printed with
+ *  -v; each scenario must end in DONE facing the leg, except a wall with no
+ *  way round, which must give up facing the leg.
+ *
+ *  Usage: avoid_sim [-v]
+ */
+
+#include "avoid.h"
+#include "grid.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define SIM_TICK_MS 60        // Control loop period
+#define SIM_SPEED 100         // Driving speed (mm/s)
+#define SIM_WHEEL_BASE 235    // (mm)
+#define SIM_LIMIT_MS 200000   // A detour still running after this is a failure
+#define SIM_RAD(deg) ((deg) * (M_PI / 180))
+
+// Typedef struct - Rectangle of the field (mm)
+typedef struct sim_box
+{
+    double x0, y0, x1, y1;
+} sim_box_t;
+
+static sim_box_t sim_boxes[4]; // Obstacles, felt by the bumpers
+static int sim_numBoxes;
+static sim_box_t sim_holes[4]; // Seen by the cliff sensors
+static int sim_numHoles;
+
+static const char *const sim_states[AVOID_NUM_STATES] = {
+#define SIM_NAME(id, name) name,
+    AVOID_STATES(SIM_NAME)
+#undef SIM_NAME
+};
+
+static int sim_inside(const sim_box_t *boxes, int count, double x, double y)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (x >= boxes[i].x0 && x <= boxes[i].x1 && y >= boxes[i].y0 && y <= boxes[i].y1) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Set the bumper and cliff bits for the pose
+ */
+static void sim_sense(oi_t *sensor)
+{
+    double heading = sensor->poseHeading;
+    int angle;
+
+    sensor->bumpLeft = 0;
+    sensor->bumpRight = 0;
+    for (angle = -60; angle <= 60; angle += 5)
+    {
+        double bearing = SIM_RAD(heading + angle);
+        if (sim_inside(sim_boxes, sim_numBoxes, sensor->poseX + 170 * cos(bearing), sensor->poseY + 170 * sin(bearing))) {
+            sensor->bumpLeft |= angle >= 0;
+            sensor->bumpRight |= angle <= 0;
+        }
+    }
+
+#define SIM_CLIFF(field, angle) \
+    sensor->field = sim_inside(sim_holes, sim_numHoles, sensor->poseX + 150 * cos(SIM_RAD(heading + (angle))), \
+                               sensor->poseY + 150 * sin(SIM_RAD(heading + (angle))));
+    SIM_CLIFF(cliffLeft, 70)
+    SIM_CLIFF(cliffFrontLeft, 20)
+    SIM_CLIFF(cliffFrontRight, -20)
+    SIM_CLIFF(cliffRight, -70)
+#undef SIM_CLIFF
+}
+
+static int sim_hit(const oi_t *sensor)
+{
+    return sensor->bumpLeft || sensor->bumpRight
+        || sensor->cliffLeft || sensor->cliffFrontLeft || sensor->cliffFrontRight || sensor->cliffRight;
+}
+
+/**
+ * Drive the leg from (1000, 1000) until contact, then step the detour to its end
+ *
+ * @returns 1 if the detour ended in DONE within SIM_LIMIT_MS facing the leg
+ */
+static int sim_run(const char *title, double heading, int verbose)
+{
+    oi_t sensor;
+    avoid_t avoid;
+    uint32_t now = 0;
+    int scans = 0, contacts = 0, changes = 0;
+    int wasHit = 1;
+    double along, left;
+
+    memset(&sensor, 0, sizeof(sensor));
+    grid_init();
+    sensor.poseX = 1000;
+    sensor.poseY = 1000;
+    sensor.poseHeading = heading;
+
+    do {
+        sensor.poseX += cos(SIM_RAD(heading)) * SIM_SPEED * SIM_TICK_MS / 1000.0;
+        sensor.poseY += sin(SIM_RAD(heading)) * SIM_SPEED * SIM_TICK_MS / 1000.0;
+        now += SIM_TICK_MS;
+        sim_sense(&sensor);
+    } while (!sim_hit(&sensor) && now < SIM_LIMIT_MS);
+
+    printf("%s: contact at (%.0f, %.0f)\n", title, sensor.poseX, sensor.poseY);
+    grid_markContact(&sensor);
+    avoid_start(&avoid, &sensor, 2000, SIM_SPEED, now);
+
+    while (now < SIM_LIMIT_MS)
+    {
+        // Move by the wheel speeds of the last step, like control_update() between two steps
+        double v = (avoid.right + avoid.left) / 2.0;
+        double w = (avoid.right - avoid.left) / (double)SIM_WHEEL_BASE;
+
+        now += SIM_TICK_MS;
+        sensor.poseHeading += w * SIM_TICK_MS / 1000.0 * (180 / M_PI);
+        sensor.poseX += v * cos(SIM_RAD(sensor.poseHeading)) * SIM_TICK_MS / 1000.0;
+        sensor.poseY += v * sin(SIM_RAD(sensor.poseHeading)) * SIM_TICK_MS / 1000.0;
+        sim_sense(&sensor);
+        grid_markContact(&sensor);
+
+        int hit = sim_hit(&sensor);
+        contacts += hit && !wasHit;
+        wasHit = hit;
+
+        int running = avoid_step(&avoid, &sensor, now);
+        scans += avoid.scan;
+        if (avoid.changed)
+        {
+            changes++;
+            if (verbose) {
+                printf("  %6u ms %-6s -> %-6s after %4u ms, attempt %d waypoint %d, pose (%.0f, %.0f, %.0f)\n",
+                       now, sim_states[avoid.previous], sim_states[avoid.state], avoid.spent,
+                       avoid.attempt, avoid.waypoint, sensor.poseX, sensor.poseY, sensor.poseHeading);
+            }
+        }
+        if (!running) {
+            break;
+        }
+    }
+
+    avoid_offset(&avoid, &sensor, &along, &left);
+    double error = fmod(sensor.poseHeading - heading + 540, 360) - 180;
+    printf("  %s after %u ms: along %.0f mm, left %.0f mm, heading error %.1f deg; %d plans, %d scans, %d re-contacts, %d state changes\n",
+           sim_states[avoid.state], now, along, left, error, avoid.attempt, scans, contacts, changes);
+
+    return avoid.state == AVOID_DONE && fabs(error) < 5;
+}
+
+int main(int argc, char *argv[])
+{
+    int verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+    int failed = 0;
+
+    sim_numBoxes = 1;
+    sim_boxes[0] = (sim_box_t){ 1300, 900, 1400, 1100 };
+    sim_numHoles = 0;
+    failed += !sim_run("bump, box ahead", 0, verbose);
+
+    sim_numBoxes = 0;
+    sim_numHoles = 1;
+    sim_holes[0] = (sim_box_t){ 1250, 1000, 1400, 1300 };
+    failed += !sim_run("cliff left", 0, verbose);
+
+    sim_holes[0] = (sim_box_t){ 1250, 700, 1400, 1000 };
+    failed += !sim_run("cliff right", 0, verbose);
+
+    // The first detour runs into a second box
+    sim_numHoles = 0;
+    sim_numBoxes = 2;
+    sim_boxes[0] = (sim_box_t){ 1300, 900, 1400, 1100 };
+    sim_boxes[1] = (sim_box_t){ 1350, 1150, 1700, 1250 };
+    failed += !sim_run("re-contact", 0, verbose);
+
+    sim_numBoxes = 1;
+    sim_boxes[0] = (sim_box_t){ 900, 1300, 1100, 1400 };
+    failed += !sim_run("bump, heading 90", 90, verbose);
+
+    // No way round inside the planning window, gives up after AVOID_ATTEMPTS plans facing the leg
+    sim_boxes[0] = (sim_box_t){ 1300, -400, 1400, 3400 };
+    failed += !sim_run("wall", 0, verbose);
+
+    printf("%d of 6 scenarios failed\n", failed);
+    return failed != 0;
+}
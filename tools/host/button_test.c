@@ -0,0 +1,172 @@
+/*
+ * button_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  The debouncing of button.c on synthetic bounce waveforms: each waveform
+ *  is fed to button_debounce() one BUTTON_TICK_MS sample at a time and the
+ *  events must come out once per press, release and long press, at the tick
+ *  the reading has been stable for BUTTON_DEBOUNCE_MS (BUTTON_LONG_MS), with
+ *  bounces and glitches shorter than that ignored. A bouncing press is also
+ *  run through the TIMER4A and Port E ISRs to the event queue, which must
+ *  give the same events and go back to waiting for an edge afterwards.
+ *
+ *  Usage: button_test
+ */
+
+#include "button.h"
+#include "profile.h"
+#include "driverlib/interrupt.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_MAX_TICKS 256
+
+// Typedef struct - A waveform and the events it must give
+typedef struct {
+    const char *name;
+    const char *raw;    // "pins:ticks" runs, pins is a hex digit of the buttons pressed, bit 0 is button 1
+    const char *events; // "<button><P|R|L>@<tick>", in order
+} test_waveform_t;
+
+static const test_waveform_t test_waveforms[] = {
+    { "clean press", "0:2 1:10 0:8", "1P@5 1R@15" },
+    { "bouncing press", "0:2 1:1 0:1 1:1 0:2 1:1 0:1 1:12 0:8", "1P@12 1R@24" },
+    { "bouncing release", "1:10 0:1 1:1 0:1 1:2 0:8", "1P@3 1R@18" },
+    { "glitches", "0:2 1:3 0:3 1:1 0:1 1:2 0:5", "" },
+    { "long press", "4:170 0:6", "3P@3 3L@162 3R@173" },
+    { "two buttons", "0:1 1:6 3:10 2:6 0:6", "1P@4 2P@10 1R@20 2R@26" },
+};
+
+static int test_failed;
+static int test_tick;
+static char test_events[512];
+
+// What button.c needs from Timer.c, a tick is BUTTON_TICK_MS
+unsigned int timer_getMillis(void)
+{
+    return test_tick * BUTTON_TICK_MS;
+}
+
+void timer_waitMillis(unsigned int delay_time)
+{
+    (void)delay_time;
+}
+
+static void test_check(const char *name, const char *what, int ok)
+{
+    if (!ok) {
+        printf("%s: %s FAILED\n", name, what);
+        test_failed++;
+    }
+}
+
+/**
+ * Append an event to test_events in the notation of test_waveform_t
+ */
+static void test_record(uint8_t button, button_event_type_t type, int tick)
+{
+    static const char types[] = { 'P', 'R', 'L' };
+    size_t length = strlen(test_events);
+
+    snprintf(test_events + length, sizeof(test_events) - length, "%s%u%c@%d", length > 0 ? " " : "", button,
+             types[type], tick);
+}
+
+static void test_post(uint8_t button, button_event_type_t type)
+{
+    test_record(button, type, test_tick);
+}
+
+/**
+ * Expand the runs of a waveform
+ *
+ * @returns the number of ticks
+ */
+static int test_expand(const char *raw, uint8_t *samples)
+{
+    int ticks = 0;
+
+    while (*raw != '\0')
+    {
+        char *end;
+        uint8_t pins = strtoul(raw, &end, 16);
+        int count = strtol(end + 1, &end, 10);
+
+        while (count-- > 0 && ticks < TEST_MAX_TICKS) {
+            samples[ticks++] = pins;
+        }
+        raw = end + strspn(end, " ");
+    }
+
+    return ticks;
+}
+
+static void test_waveform(const test_waveform_t *waveform)
+{
+    button_state_t states[BUTTON_COUNT];
+    uint8_t samples[TEST_MAX_TICKS];
+    int ticks = test_expand(waveform->raw, samples);
+    int busy = 0;
+
+    memset(states, 0, sizeof(states));
+    test_events[0] = '\0';
+    for (test_tick = 0; test_tick < ticks; test_tick++) {
+        busy = button_debounce(states, samples[test_tick], test_post);
+    }
+
+    printf("%-17s %3d ticks: %s\n", waveform->name, ticks, test_events);
+    test_check(waveform->name, waveform->events, strcmp(test_events, waveform->events) == 0);
+    test_check(waveform->name, "idle at the end", !busy);
+}
+
+/**
+ * The bouncing press through the ISRs, Port E reads low for a pressed button
+ */
+static void test_interrupts(const test_waveform_t *waveform)
+{
+    uint8_t samples[TEST_MAX_TICKS];
+    int ticks = test_expand(waveform->raw, samples);
+    button_event_t event;
+
+    button_init();
+    test_events[0] = '\0';
+    GPIO_PORTE_DATA_R = 0x0F;
+    for (test_tick = 0; test_tick < ticks; test_tick++)
+    {
+        GPIO_PORTE_DATA_R = ~samples[test_tick] & 0x0F;
+        if (samples[test_tick] != 0 && (GPIO_PORTE_IM_R & 0x0F) != 0) {
+            host_interrupt(INT_GPIOE);
+        }
+        if (TIMER4_CTL_R & TIMER_CTL_TAEN) {
+            host_interrupt(INT_TIMER4A);
+        }
+    }
+    while (button_getEvent(&event)) {
+        test_record(event.button, event.type, event.time / BUTTON_TICK_MS);
+    }
+
+    printf("%-17s %3d ticks through the ISRs: %s\n", waveform->name, ticks, test_events);
+    test_check(waveform->name, "ISR events", strcmp(test_events, waveform->events) == 0);
+    test_check(waveform->name, "tick stopped", (TIMER4_CTL_R & TIMER_CTL_TAEN) == 0);
+    test_check(waveform->name, "edge interrupt armed", (GPIO_PORTE_IM_R & 0x0F) == 0x0F);
+}
+
+int main(void)
+{
+    unsigned int i;
+
+    profile_init();
+    trace_init();
+
+    for (i = 0; i < sizeof(test_waveforms) / sizeof(test_waveforms[0]); i++) {
+        test_waveform(&test_waveforms[i]);
+    }
+    test_interrupts(&test_waveforms[1]);
+
+    printf("%d failures\n", test_failed);
+    return test_failed != 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * cmd_link.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  The command end of the UART1 link on the host: the bytes arriving on
+ *  stdin are parsed by cmd.c and answered through telemetry.c on stdout,
+ *  the way the CyBot answers them. PROFILE and TRACE send their dumps as
+ *  records, every other verb is acknowledged with what cmd_poll() made of
+ *  it and nothing more. command_check.py connects tools/command.py to it
+ *  through a pseudo-terminal.
+ *
+ *  Usage: cmd_link < link > link
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "cmd.h"
+#include "profile.h"
+#include "telemetry.h"
+
+#include <poll.h>
+#include <unistd.h>
+
+#define LINK_BUFFER_SIZE 256
+
+static char link_received[LINK_BUFFER_SIZE];
+static int link_length;
+static int link_next;
+static uint32_t link_time;      // profile_now() when the bytes were read
+
+static char link_sent[4096];
+static int link_sentLength;
+
+static void link_flush(void)
+{
+    int done = 0;
+
+    while (done < link_sentLength)
+    {
+        ssize_t n = write(STDOUT_FILENO, link_sent + done, link_sentLength - done);
+        if (n <= 0) {
+            break;
+        }
+        done += n;
+    }
+    link_sentLength = 0;
+}
+
+static void link_output(char c)
+{
+    if (link_sentLength == (int)sizeof(link_sent)) {
+        link_flush();
+    }
+    link_sent[link_sentLength++] = c;
+}
+
+// What cmd.c needs from uart.c and telemetry.c from Timer.c
+int uart_tryReceive(char *data)
+{
+    if (link_next == link_length) {
+        return 0;
+    }
+    *data = link_received[link_next++];
+    return 1;
+}
+
+uint32_t uart_rxTime(void)
+{
+    return link_time;
+}
+
+unsigned int timer_getMillis(void)
+{
+    return profile_now() / PROFILE_TICKS_PER_US / 1000;
+}
+
+int main(void)
+{
+    struct pollfd input = { STDIN_FILENO, POLLIN, 0 };
+    cmd_t cmd;
+
+    profile_init();
+    trace_init();
+    telemetry_init(link_output);
+    link_flush();
+
+    while (poll(&input, 1, -1) > 0)
+    {
+        ssize_t n = read(STDIN_FILENO, link_received, sizeof(link_received));
+        if (n <= 0) {
+            break;
+        }
+        link_length = n;
+        link_next = 0;
+        link_time = profile_now();
+
+        while (cmd_poll(&cmd))
+        {
+            // A region around each command, so the dumps have something to show
+            PROFILE_BEGIN(WORK_ITEM);
+            if (cmd.verb == CMD_PROFILE) {
+                profile_dump(telemetry_sendText);
+            } else if (cmd.verb == CMD_TRACE) {
+                telemetry_sendTrace();
+            }
+            PROFILE_END(WORK_ITEM);
+            cmd_ack(&cmd, CMD_OK);
+        }
+        link_flush();
+    }
+
+    return 0;
+}
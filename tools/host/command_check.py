@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""
+command_check.py
+
+Runs tools/command.py against the command parser and telemetry of the host
+build (cmd_link) on a pseudo-terminal, the way it talks to the CyBot over
+UART1: every request is acknowledged with its verb and status, arguments
+beyond what a verb takes are rejected, the PROFILE and TRACE dumps arrive as
+records without a single bad frame, --repeat reports the round trips, and a
+link nobody answers times out. A raw capture of the TRACE answer converts
+with tools/trace2json.py.
+
+Usage: command_check.py [path to cmd_link]
+"""
+
+import os
+import select
+import subprocess
+import sys
+import time
+import tty
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+COMMAND = os.path.join(HERE, "..", "command.py")
+sys.path.insert(0, os.path.join(HERE, ".."))
+
+import telemetry  # noqa: E402
+import trace2json  # noqa: E402
+
+failures = []
+
+
+def check(what, ok):
+    if not ok:
+        failures.append(what)
+        print("%s FAILED" % what)
+
+
+def command(port, *words):
+    """Run command.py, returns (exit code, output lines)"""
+    result = subprocess.run([sys.executable, COMMAND, port] + list(words), stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT, timeout=30)
+    return result.returncode, result.stdout.decode("ascii", "replace").splitlines()
+
+
+def capture(port, line):
+    """Send one line, returns the raw bytes received up to its ACK"""
+    fd = os.open(port, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    os.write(fd, line)
+
+    data = bytearray()
+    decoder = telemetry.Decoder()
+    deadline = time.monotonic() + 5
+    while time.monotonic() < deadline:
+        ready, _, _ = select.select([fd], [], [], 0.1)
+        if ready:
+            chunk = os.read(fd, 4096)
+            data += chunk
+            if any(record["type"] == "ack" for record in decoder.feed(chunk)):
+                break
+    os.close(fd)
+    return bytes(data)
+
+
+def acked(lines, verb, status):
+    return any(line.startswith("%s: %s in " % (verb, status)) for line in lines)
+
+
+def main():
+    program = sys.argv[1] if len(sys.argv) > 1 else os.path.join(HERE, "cmd_link")
+    master, slave = os.openpty()
+    tty.setraw(slave)  # No echo of what cmd_link sends before command.py opens it, like a UART
+    port = os.ttyname(slave)
+    link = subprocess.Popen([program], stdin=master, stdout=master)
+
+    try:
+        code, lines = command(port, "POSE")
+        check("POSE acknowledged", code == 0 and acked(lines, "POSE", "ok"))
+
+        code, lines = command(port, "STOP", "2")
+        check("STOP 2 acknowledged", code == 0 and acked(lines, "STOP", "ok"))
+        code, lines = command(port, "STOP", "2", "5")
+        check("STOP with a trailing argument rejected", acked(lines, "STOP", "bad argument"))
+        code, lines = command(port, "POSE", "1")
+        check("POSE with an argument rejected", acked(lines, "POSE", "bad argument"))
+        code, lines = command(port, "JUMP")
+        check("unknown verb", acked(lines, "None", "unknown verb"))
+
+        code, lines = command(port, "PROFILE")
+        check("PROFILE acknowledged", acked(lines, "PROFILE", "ok"))
+        check("profile dump as TEXT records", any("'type': 'text'" in line and "Profile" in line
+                                                  for line in lines))
+        check("profile dump framed", not any("bad frames" in line for line in lines))
+
+        code, lines = command(port, "TRACE")
+        check("TRACE acknowledged", acked(lines, "TRACE", "ok"))
+        check("trace dump as TRACE records", any("'type': 'trace'" in line for line in lines))
+        check("trace dump framed", not any("bad frames" in line for line in lines))
+
+        code, lines = command(port, "POSE", "--repeat", "20")
+        check("repeated requests", code == 0 and any(line.startswith("20/20 acknowledged")
+                                                     for line in lines))
+        print("\n".join(line for line in lines if "acknowledged" in line))
+
+        # The trace dump put back together from a raw capture of the link
+        data = capture(port, b"7 TRACE\r")
+        events = trace2json.convert(data)["traceEvents"]
+        check("trace dump converted", len(telemetry.trace_dumps(data)) == 1 and
+              any(e.get("name") == "work item" for e in events))
+    finally:
+        link.terminate()
+        link.wait()
+        os.close(master)
+        os.close(slave)
+
+    # Nobody at the other end
+    master, slave = os.openpty()
+    try:
+        code, lines = command(os.ttyname(slave), "POSE", "--timeout", "0.2")
+        check("no answer times out", code == 1 and any("no ACK within" in line for line in lines))
+    finally:
+        os.close(master)
+        os.close(slave)
+
+    print("%d failures" % len(failures))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
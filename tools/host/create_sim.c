@@ -0,0 +1,112 @@
+/*
+ * create_sim.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  The iRobot Create at the other end of the simulated UART4, see create_sim.h
+ */
+
+#include "create_sim.h"
+#include "uart_sim.h"
+#include "profile.h"
+
+#include <string.h>
+
+#define CREATE_FRAME_SIZE 80
+#define CREATE_GROUP100 100
+
+static create_command_t create_log[CREATE_MAX_COMMANDS];
+static int create_count;
+static int create_lost;                // Frames still to send only part of
+static create_command_t create_open;   // The command being received
+static int create_received;            // Bytes of it so far, opcode included
+
+/**
+ * @returns the number of data bytes that follow an opcode, those of a song once its length is known
+ */
+static int create_dataLength(const create_command_t *command, int received)
+{
+    switch (command->opcode)
+    {
+    case 129: case 138: case 141: case 142:
+        return 1;
+    case 139:
+        return 3;
+    case 137: case 145: case 146:
+        return 4;
+    case 140:
+        // Song number, note count and two bytes per note
+        return received < 3 ? 2 : 2 + 2 * command->args[1];
+    default:
+        return 0;
+    }
+}
+
+static void create_sensorFrame(void)
+{
+    uint8_t frame[CREATE_FRAME_SIZE] = { 0 };
+
+    frame[17] = CREATE_VOLTAGE >> 8;
+    frame[18] = CREATE_VOLTAGE & 0xFF;
+    if (create_lost > 0) {
+        create_lost--;
+        sim_receive(SIM_UART4, frame, CREATE_FRAME_SIZE / 3);
+    } else {
+        sim_receive(SIM_UART4, frame, CREATE_FRAME_SIZE);
+    }
+}
+
+static void create_byte(uint8_t byte)
+{
+    if (create_received == 0) {
+        memset(&create_open, 0, sizeof(create_open));
+        create_open.opcode = byte;
+    } else if (create_received - 1 < CREATE_MAX_ARGS) {
+        create_open.args[create_received - 1] = byte;
+    }
+    create_received++;
+    if (create_received < 1 + create_dataLength(&create_open, create_received)) {
+        return;
+    }
+
+    create_open.length = create_received - 1;
+    create_open.time = profile_now();
+    if (create_count < CREATE_MAX_COMMANDS) {
+        create_log[create_count++] = create_open;
+    }
+    create_received = 0;
+
+    if (create_open.opcode == 142 && create_open.args[0] == CREATE_GROUP100) {
+        create_sensorFrame();
+    }
+}
+
+void create_init(void)
+{
+    create_count = 0;
+    create_lost = 0;
+    create_received = 0;
+    sim_connect(SIM_UART4, create_byte);
+}
+
+int create_commands(const create_command_t **commands)
+{
+    *commands = create_log;
+    return create_count;
+}
+
+void create_loseFrames(int count)
+{
+    create_lost = count;
+}
+
+int16_t create_rightSpeed(const create_command_t *command)
+{
+    return (int16_t)(command->args[0] << 8 | command->args[1]);
+}
+
+int16_t create_leftSpeed(const create_command_t *command)
+{
+    return (int16_t)(command->args[2] << 8 | command->args[3]);
+}
@@ -0,0 +1,55 @@
+/*
+ * create_sim.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  The iRobot Create at the other end of the simulated UART4 (uart_sim.c):
+ *  it parses the Open Interface commands open_interface.c writes, logs each
+ *  one with the time its last byte arrived, and answers a query for sensor
+ *  group 100 with an 80 byte frame.
+ */
+
+#ifndef CREATE_SIM_H_
+#define CREATE_SIM_H_
+
+#include <stdint.h>
+
+#define CREATE_MAX_COMMANDS 4096
+#define CREATE_MAX_ARGS 8       // Longer commands (songs) are logged cut short
+#define CREATE_VOLTAGE 15000    // Battery voltage in the sensor frames (mV)
+
+// Typedef struct - One Open Interface command as the Create received it
+typedef struct {
+    uint8_t opcode;
+    uint8_t length;             // Data bytes after the opcode
+    uint8_t args[CREATE_MAX_ARGS];
+    uint32_t time;              // profile_now() when the last byte arrived
+} create_command_t;
+
+/**
+ * Connect a Create to UART4 with an empty log, call after sim_init()
+ */
+void create_init(void);
+
+/**
+ * @param commands - Set to the commands received so far, oldest first
+ *
+ * @returns the number of commands, an opcode the Open Interface does not have is logged with length 0
+ */
+int create_commands(const create_command_t **commands);
+
+/**
+ * Send only the first third of the next sensor frames
+ *
+ * @param count - How many frames
+ */
+void create_loseFrames(int count);
+
+/**
+ * @returns the right (high byte first) or left wheel speed of a Drive Direct command, in mm/s
+ */
+int16_t create_rightSpeed(const create_command_t *command);
+int16_t create_leftSpeed(const create_command_t *command);
+
+#endif /* CREATE_SIM_H_ */
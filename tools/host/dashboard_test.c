@@ -0,0 +1,239 @@
+/*
+ * dashboard_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  The pages of dashboard.c rendered through lcd.c on the simulated HD44780
+ *  of hd44780_sim.c: pressing button n must show page n at once with the
+ *  statistics it was given, a long press must dismiss an alert, and a page
+ *  must not be redrawn before DASHBOARD_PERIOD_MS has passed. No
+ *  dashboard_update() may put a byte on the LCD bus itself, all of them go
+ *  out from the TIMER2A flush. Reported are the bus bytes and the flush time
+ *  of each page.
+ *
+ *  Usage: dashboard_test
+ */
+
+#include "dashboard.h"
+#include "button.h"
+#include "lcd.h"
+#include "uart.h"
+#include "work.h"
+#include "hd44780_sim.h"
+#include "profile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_FLUSH_LIMIT_MS 100 // A flush that takes longer is stuck
+
+static int test_failed;
+static unsigned int test_millis;        // timer_getMillis(), moved on by the test
+static button_event_t test_events[BUTTON_QUEUE_SIZE];
+static int test_eventCount;
+static int test_eventNext;
+static const oi_linkStats_t test_link = { 1500, 2, 1, 0, 0, 0, 3 };
+
+// What dashboard.c and lcd.c need from Timer.c, button.c, uart.c, work.c and open_interface.c
+unsigned int timer_getMillis(void)
+{
+    return test_millis;
+}
+
+unsigned int timer_getMicros(void)
+{
+    return profile_now() / PROFILE_TICKS_PER_US;
+}
+
+void timer_waitMicros(unsigned int delay_time)
+{
+    uint32_t start = profile_now();
+
+    while (profile_now() - start < delay_time * PROFILE_TICKS_PER_US) {
+    }
+}
+
+void timer_waitMillis(unsigned int delay_time)
+{
+    timer_waitMicros(delay_time * 1000);
+}
+
+int button_getEvent(button_event_t *event)
+{
+    if (test_eventNext == test_eventCount) {
+        return 0;
+    }
+    *event = test_events[test_eventNext++];
+    return 1;
+}
+
+void uart_getTxStats(uart_tx_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->dropped = 7;
+}
+
+uint32_t work_dropped(void)
+{
+    return 4;
+}
+
+const oi_linkStats_t *oi_getLinkStats(void)
+{
+    return &test_link;
+}
+
+static void test_check(const char *name, const char *what, int ok)
+{
+    if (!ok) {
+        printf("%s: %s FAILED\n", name, what);
+        test_failed++;
+    }
+}
+
+static void test_press(uint8_t button, button_event_type_t type)
+{
+    test_events[0].button = button;
+    test_events[0].type = type;
+    test_events[0].time = test_millis;
+    test_eventCount = 1;
+    test_eventNext = 0;
+}
+
+/**
+ * Tick TIMER2A until the flush stops it, a tick comes a whole period after the last one started
+ *
+ * @returns how long the flush took (us)
+ */
+static uint32_t test_flush(const char *name)
+{
+    uint32_t start = profile_now();
+    uint32_t tick = start;
+
+    while (!lcd_flushed())
+    {
+        while (profile_now() - tick < (TIMER2_TAILR_R + 1) * PROFILE_TICKS_PER_US) {
+        }
+        tick = profile_now();
+        host_interrupt(INT_TIMER2A);
+
+        if (tick - start > TEST_FLUSH_LIMIT_MS * 1000 * PROFILE_TICKS_PER_US) {
+            test_check(name, "flushed", 0);
+            break;
+        }
+    }
+
+    return (profile_now() - start) / PROFILE_TICKS_PER_US;
+}
+
+/**
+ * Run dashboard_update() and the flush, check the display against the lines expected
+ */
+static void test_render(const char *name, const oi_t *sensor, const char *const lines[4])
+{
+    uint32_t bytes = hd44780_stats()->characters + hd44780_stats()->commands;
+    char shown[21], expected[21];
+    int y;
+
+    dashboard_update(sensor);
+    test_check(name, "no bus bytes from dashboard_update()",
+               hd44780_stats()->characters + hd44780_stats()->commands == bytes);
+    uint32_t us = test_flush(name);
+
+    bytes = hd44780_stats()->characters + hd44780_stats()->commands - bytes;
+    printf("%-16s %3lu bus bytes, flushed in %5lu us\n", name, (unsigned long)bytes, (unsigned long)us);
+    test_check(name, "nothing sent while busy", hd44780_stats()->ignored == 0);
+
+    for (y = 0; y < 4; y++)
+    {
+        hd44780_line(y, shown);
+        snprintf(expected, sizeof(expected), "%-20s", lines[y]);
+        if (strcmp(shown, expected) != 0) {
+            printf("  line %d shows \"%s\", expected \"%s\"\n", y, shown, expected);
+            test_check(name, "page shown", 0);
+        }
+    }
+}
+
+int main(void)
+{
+    static const char *const pose[4] = { "1/4 POSE", "x  1234 y  -567 mm", "hdg   90 v  200 mm/s", "leg 2   350/  500" };
+    static const char *const moved[4] = { "1/4 POSE", "x  1301 y  -498 mm", "hdg   92 v  180 mm/s", "leg 2   400/  500" };
+    static const char *const link[4] = { "3/4 LINK", "frames 1500", "bad 2 fe 1 oe 0", "brk 0 par 0 to 3" };
+    static const char *const noScan[4] = { "4/4 SCAN", "no scan yet", "", "" };
+    static const char *const scan[4] = { "4/4 SCAN", "2 objects", "near  45 deg  80 cm", "3 s ago" };
+    static const char *const clear[4] = { "4/4 SCAN", "0 objects", "road clear", "0 s ago" };
+    static const char *const alert[4] = { "STOP REQUESTED", "0 objects", "road clear", "0 s ago" };
+    oi_t sensor;
+    char shown[21];
+
+    profile_init();
+    trace_init();
+    hd44780_init(1);
+    lcd_init();
+    dashboard_init();
+
+    memset(&sensor, 0, sizeof(sensor));
+    sensor.poseX = 1234;
+    sensor.poseY = -567;
+    sensor.poseHeading = 90;
+    sensor.requestedLeftVelocity = 200;
+    sensor.requestedRightVelocity = 200;
+    dashboard_setLeg(2, 350, 500);
+
+    // The first redraw waits for the period
+    dashboard_update(&sensor);
+    test_check("first update", "waits for the period", lcd_flushed());
+    test_millis += DASHBOARD_PERIOD_MS;
+    test_render("pose", &sensor, pose);
+
+    // Within the period nothing changes on the display, after it only the new values go out
+    sensor.poseX = 1301;
+    sensor.poseY = -498;
+    sensor.poseHeading = 92;
+    sensor.requestedLeftVelocity = 180;
+    sensor.requestedRightVelocity = 180;
+    dashboard_setLeg(2, 400, 500);
+    test_millis += DASHBOARD_PERIOD_MS - 1;
+    dashboard_update(&sensor);
+    test_check("pose within the period", "not redrawn", lcd_flushed());
+    test_millis++;
+    test_render("pose moved", &sensor, moved);
+
+    // A button shows its page right away
+    test_press(3, BUTTON_PRESS);
+    test_render("button 3", &sensor, link);
+    test_press(4, BUTTON_PRESS);
+    test_render("button 4", &sensor, noScan);
+
+    dashboard_setScan(2, 45, 80);
+    test_millis += 3000;
+    test_render("scan", &sensor, scan);
+    dashboard_setScan(0, DASHBOARD_NO_OBJECT, DASHBOARD_NO_OBJECT);
+    test_millis += DASHBOARD_PERIOD_MS;
+    test_render("scan clear", &sensor, clear);
+
+    // An alert takes the title line until a long press
+    dashboard_alert("STOP REQUESTED");
+    test_millis += DASHBOARD_PERIOD_MS;
+    test_render("alert", &sensor, alert);
+    test_press(1, BUTTON_LONG_PRESS);
+    test_render("long press", &sensor, clear);
+
+    // The loop page only has to show a rate, its value depends on the host
+    test_press(2, BUTTON_PRESS);
+    dashboard_loopTick();
+    dashboard_loopTick();
+    dashboard_update(&sensor);
+    test_flush("button 2");
+    hd44780_line(0, shown);
+    test_check("button 2", "loop page", strncmp(shown, "2/4 LOOP", 8) == 0);
+    hd44780_line(1, shown);
+    test_check("button 2", "loop rate", strstr(shown, " Hz ") != NULL);
+    hd44780_line(3, shown);
+    test_check("button 2", "drops", strncmp(shown, "drop wk 4 tx 7", 14) == 0);
+
+    printf("%d failures\n", test_failed);
+    return test_failed != 0;
+}
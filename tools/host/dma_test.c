@@ -0,0 +1,170 @@
+/*
+ * dma_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  The uDMA paths of uart.c and open_interface.c on the simulated UARTs and
+ *  uDMA engine of uart_sim.c:
+ *   - a UART1 transmit the uDMA never completes is abandoned after
+ *     UART_TX_DMA_TIMEOUT_MS while interrupts are disabled, when the Timer5
+ *     clock stands still, and every byte is accounted for
+ *   - a scatter/gather transmit arrives in order and is reported done once,
+ *     one started while the transmitter is busy is queued as copies
+ *   - a sensor frame the Create sends only part of is requested again after
+ *     OI_FRAME_TIMEOUT_MS and oi_update() returns with the next frame
+ *
+ *  Usage: dma_test
+ */
+
+#include "uart.h"
+#include "uart_sim.h"
+#include "create_sim.h"
+#include "open_interface.h"
+#include "profile.h"
+#include "work.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int test_failed;
+static int test_gatherDone;
+
+// What uart.c and open_interface.c need from Timer.c and work.c, the clock never ticks
+void timer_init(void)
+{
+}
+
+void timer_waitMillis(unsigned int delay_time)
+{
+    sim_run(delay_time * 1000);
+}
+
+void timer_waitMicros(unsigned int delay_time)
+{
+    sim_run(delay_time);
+}
+
+int work_post(work_fn_t fn, uint32_t arg, work_priority_t prio)
+{
+    (void)fn;
+    (void)arg;
+    (void)prio;
+    return 0;
+}
+
+static void test_check(const char *what, int ok)
+{
+    if (!ok) {
+        printf("%s FAILED\n", what);
+        test_failed++;
+    }
+}
+
+static void test_stuckTransmit(void)
+{
+    char text[101];
+    uart_tx_stats_t before, after;
+    const uint8_t *wire;
+
+    memset(text, 's', 100);
+    text[100] = '\0';
+
+    sim_init();
+    sim_stallDma(1);
+    uart_getTxStats(&before);
+    uart_sendStr(text);
+
+    bool was_disabled = IntMasterDisable();
+    uint32_t start = profile_now();
+    uart_flush();
+    uint32_t took = (profile_now() - start) / PROFILE_TICKS_PER_US / 1000;
+    if (!was_disabled) {
+        IntMasterEnable();
+    }
+    uart_getTxStats(&after);
+    size_t length = sim_sent(SIM_UART1, &wire);
+
+    printf("stuck transmit: %u transfers abandoned in %lu ms, %lu bytes sent, %lu dropped\n",
+           after.dmaTimeouts - before.dmaTimeouts, (unsigned long)took, (unsigned long)length,
+           (unsigned long)(after.dropped - before.dropped));
+    test_check("stuck transfer abandoned", after.dmaTimeouts > before.dmaTimeouts);
+    test_check("abandoned after UART_TX_DMA_TIMEOUT_MS", took >= UART_TX_DMA_TIMEOUT_MS &&
+               took < (uint32_t)(after.dmaTimeouts - before.dmaTimeouts + 1) * UART_TX_DMA_TIMEOUT_MS);
+    test_check("stuck bytes counted", length + (after.dropped - before.dropped) == 100 &&
+               after.sent - before.sent == length);
+}
+
+static void test_gatherDoneCallback(void)
+{
+    test_gatherDone++;
+}
+
+static void test_gather(void)
+{
+    static char body[300];
+    udma_segment_t segments[3] = { { "head ", 5 }, { body, sizeof(body) }, { " tail\n", 6 } };
+    udma_segment_t second[2] = { { "second ", 7 }, { "gather\n", 7 } };
+    char expected[5 + sizeof(body) + 6 + 14 + 1];
+    const uint8_t *wire;
+    int i;
+
+    for (i = 0; i < (int)sizeof(body); i++) {
+        body[i] = 'a' + i % 26;
+    }
+    sprintf(expected, "head %.*s tail\nsecond gather\n", (int)sizeof(body), body);
+
+    sim_init();
+    test_gatherDone = 0;
+    uart_sendGather(segments, 3, test_gatherDoneCallback);
+    test_check("gather running", test_gatherDone == 0);
+    uart_sendGather(second, 2, test_gatherDoneCallback);
+    test_check("busy gather queued as copies", test_gatherDone == 1);
+    uart_flush();
+
+    size_t length = sim_sent(SIM_UART1, &wire);
+    printf("gather: %lu bytes sent, %d done callbacks\n", (unsigned long)length, test_gatherDone);
+    test_check("gather in order", length == sizeof(expected) - 1 && memcmp(wire, expected, length) == 0);
+    test_check("gather done once each", test_gatherDone == 2);
+}
+
+static void test_lostFrame(void)
+{
+    oi_t *sensor = oi_alloc();
+
+    sim_init();
+    create_init();
+    oi_init(sensor);
+    test_check("first frame", sensor->batteryVoltage == CREATE_VOLTAGE);
+
+    uint32_t timeouts = oi_getLinkStats()->timeouts;
+    sensor->batteryVoltage = 0;
+    create_loseFrames(1);
+
+    uint32_t start = profile_now();
+    oi_update(sensor);
+    uint32_t took = (profile_now() - start) / PROFILE_TICKS_PER_US / 1000;
+
+    printf("lost frame: oi_update() returned after %lu ms, %lu requested again\n", (unsigned long)took,
+           (unsigned long)(oi_getLinkStats()->timeouts - timeouts));
+    test_check("frame requested again", oi_getLinkStats()->timeouts == timeouts + 1);
+    test_check("after OI_FRAME_TIMEOUT_MS", took >= OI_FRAME_TIMEOUT_MS && took < 3 * OI_FRAME_TIMEOUT_MS);
+    test_check("next frame aligned", sensor->batteryVoltage == CREATE_VOLTAGE);
+    test_check("no receive errors", oi_getLinkStats()->badFrames == 0);
+    free(sensor);
+}
+
+int main(void)
+{
+    profile_init();
+    trace_init();
+    uart_init(115200);
+    uart_interrupt_init();
+
+    test_stuckTransmit();
+    test_gather();
+    test_lostFrame();
+
+    printf("%d failures\n", test_failed);
+    return test_failed != 0;
+}
@@ -0,0 +1,165 @@
+/*
+ * filter_bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Benchmark of the DSP paths of filter.c (see filter_simd.c) against the
+ *  plain C loops, at the sizes the firmware uses them: the trimmed mean of
+ *  the SCAN_IR_READS readings of a scan sample, and sums and smoothing over
+ *  whole sweeps. Prints the host time per call of both builds and, for the
+ *  DSP build, the DSP instructions per call. On the host the intrinsics are
+ *  emulated, so its time says little about the M4; the instruction count
+ *  against the samples (one add, or one subtract and multiply, per sample in
+ *  C) is what carries over. The cycles on the CyBot come from the profiler.
+ *
+ *  Usage: filter_bench [calls [seed]]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "filter.h"
+#include "scan.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_IR_READS 5 // SCAN_IR_READS of scan.c
+#define BENCH_IR_TRIM 1
+
+int32_t filter_simdSum(const int16_t *samples, int count);
+int16_t filter_simdTrimmedMean(int16_t *samples, int count, int trim);
+void filter_simdEma(int16_t *state, const int16_t *samples, int count, int16_t alpha);
+
+extern uint32_t filter_simdInstructions;
+
+// Typedef struct - Result of one build over the calls
+typedef struct bench_result
+{
+    double ns;      // Mean host time per call
+    long sum;       // Of the results, both builds must agree
+} bench_result_t;
+
+static int32_t words[SCAN_MAX_SAMPLES / 2 + 1]; // Keeps the buffers 32-bit aligned
+static int32_t stateWords[SCAN_MAX_SAMPLES / 2 + 1];
+static int16_t *samples = (int16_t *)words;
+static int16_t *state = (int16_t *)stateWords;
+
+/**
+ * Nanoseconds from CLOCK_MONOTONIC
+ */
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * IR readings around a distance, the way the ADC gives them
+ */
+static void bench_fill(int count)
+{
+    int base = 500 + rand() % 2500;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        samples[i] = base + rand() % 64 - 32;
+    }
+}
+
+static bench_result_t bench_sum(int32_t (*sum)(const int16_t *, int), int count, int calls)
+{
+    bench_result_t result = { 0, 0 };
+    double start = bench_now();
+    int i;
+
+    for (i = 0; i < calls; i++) {
+        result.sum += sum(samples, count);
+    }
+    result.ns = (bench_now() - start) / calls;
+    return result;
+}
+
+static bench_result_t bench_trimmedMean(int16_t (*mean)(int16_t *, int, int), int calls)
+{
+    bench_result_t result = { 0, 0 };
+    int16_t reads[BENCH_IR_READS];
+    double start = bench_now();
+    int i;
+
+    for (i = 0; i < calls; i++)
+    {
+        memcpy(reads, samples + i % (SCAN_MAX_SAMPLES - BENCH_IR_READS), sizeof(reads));
+        result.sum += mean(reads, BENCH_IR_READS, BENCH_IR_TRIM);
+    }
+    result.ns = (bench_now() - start) / calls;
+    return result;
+}
+
+static bench_result_t bench_ema(void (*ema)(int16_t *, const int16_t *, int, int16_t), int calls)
+{
+    bench_result_t result = { 0, 0 };
+    double start;
+    int i;
+
+    memset(stateWords, 0, sizeof(stateWords));
+    start = bench_now();
+    for (i = 0; i < calls; i++) {
+        ema(state, samples, SCAN_MAX_SAMPLES, 8192);
+    }
+    result.ns = (bench_now() - start) / calls;
+    for (i = 0; i < SCAN_MAX_SAMPLES; i++) {
+        result.sum += state[i];
+    }
+    return result;
+}
+
+/**
+ * Print one line of the table, the instructions are counted over the DSP calls
+ */
+static int bench_report(const char *name, int count, bench_result_t plain, bench_result_t simd, int calls)
+{
+    printf("%-22s %3d samples: C %7.1f ns, DSP %7.1f ns, %5.1f DSP instructions per call\n", name, count,
+           plain.ns, simd.ns, (double)filter_simdInstructions / calls);
+    filter_simdInstructions = 0;
+
+    if (plain.sum != simd.sum) {
+        printf("%s: C %ld, DSP %ld FAILED\n", name, plain.sum, simd.sum);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    static const int sums[] = { BENCH_IR_READS - 2 * BENCH_IR_TRIM, 16, SCAN_MAX_SAMPLES };
+    int calls = argc > 1 ? atoi(argv[1]) : 200000;
+    int failed = 0;
+    unsigned int i;
+
+    srand(argc > 2 ? atoi(argv[2]) : 1);
+    bench_fill(SCAN_MAX_SAMPLES);
+
+    for (i = 0; i < sizeof(sums) / sizeof(sums[0]); i++)
+    {
+        bench_result_t plain = bench_sum(filter_sum, sums[i], calls);
+        filter_simdInstructions = 0;
+        bench_result_t simd = bench_sum(filter_simdSum, sums[i], calls);
+        failed += bench_report("sum", sums[i], plain, simd, calls);
+    }
+
+    bench_result_t plain = bench_trimmedMean(filter_trimmedMean, calls);
+    filter_simdInstructions = 0;
+    bench_result_t simd = bench_trimmedMean(filter_simdTrimmedMean, calls);
+    failed += bench_report("trimmed mean (IR read)", BENCH_IR_READS, plain, simd, calls);
+
+    plain = bench_ema(filter_ema, calls / 10);
+    filter_simdInstructions = 0;
+    simd = bench_ema(filter_simdEma, calls / 10);
+    failed += bench_report("ema (sweep)", SCAN_MAX_SAMPLES, plain, simd, calls / 10);
+
+    return failed != 0;
+}
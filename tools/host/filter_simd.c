@@ -0,0 +1,78 @@
+/*
+ * filter_simd.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  filter.c built with its Cortex-M4 DSP paths on the host: the TI compiler
+ *  is faked so FILTER_SIMD is 1, and the intrinsics are written out after
+ *  the instruction pseudocode of the ARMv7-M Architecture Reference Manual.
+ *  The functions are renamed filter_simd*, so filter_test and filter_bench
+ *  can run them next to the plain C build of filter.c. Every intrinsic
+ *  counts itself in filter_simdInstructions, one instruction on the M4.
+ */
+
+#include <stdint.h>
+
+#define __TI_ARM__ 1
+#define __TI_TMS470_V7M4__ 1
+
+#define filter_sum filter_simdSum
+#define filter_median filter_simdMedian
+#define filter_trimmedMean filter_simdTrimmedMean
+#define filter_ema filter_simdEma
+
+#define FILTER_LOW(x) ((int32_t)(int16_t)((uint32_t)(x) & 0xFFFF))
+#define FILTER_HIGH(x) ((int32_t)(int16_t)((uint32_t)(x) >> 16))
+
+uint32_t filter_simdInstructions;
+
+/**
+ * SMLAD: both signed 16x16 products added to the accumulator, the sum wraps at 32 bits
+ */
+static int32_t _smlad(int32_t a, int32_t b, int32_t acc)
+{
+    filter_simdInstructions++;
+    int64_t sum = (int64_t)acc + FILTER_LOW(a) * FILTER_LOW(b) + FILTER_HIGH(a) * FILTER_HIGH(b);
+    return (int32_t)(uint32_t)sum;
+}
+
+static int32_t filter_saturate16(int32_t value)
+{
+    return value > 32767 ? 32767 : (value < -32768 ? -32768 : value);
+}
+
+/**
+ * QSUB16: both halfwords subtracted, each saturated to 16 bits
+ */
+static int32_t _qsub16(int32_t a, int32_t b)
+{
+    filter_simdInstructions++;
+    uint32_t low = (uint16_t)filter_saturate16(FILTER_LOW(a) - FILTER_LOW(b));
+    uint32_t high = (uint16_t)filter_saturate16(FILTER_HIGH(a) - FILTER_HIGH(b));
+    return (int32_t)(low | (high << 16));
+}
+
+/**
+ * SMULBB: bottom halfword by bottom halfword
+ */
+static int32_t _smulbb(int32_t a, int32_t b)
+{
+    filter_simdInstructions++;
+    return FILTER_LOW(a) * FILTER_LOW(b);
+}
+
+/**
+ * SMULTB: top halfword by bottom halfword
+ */
+static int32_t _smultb(int32_t a, int32_t b)
+{
+    filter_simdInstructions++;
+    return FILTER_HIGH(a) * FILTER_LOW(b);
+}
+
+#include "filter.c"
+
+#if !FILTER_SIMD
+#error filter.c was built without its DSP paths
+#endif
@@ -0,0 +1,112 @@
+/*
+ * filter_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  The DSP paths of filter.c (SMLAD, QSUB16, SMULBB/SMULTB, see
+ *  filter_simd.c) must give bit-identical results to the plain C loops.
+ *  Random buffers of 0 to 40 samples, aligned and not, are run through
+ *  both builds, with the extremes of int16_t mixed in so the saturation
+ *  of QSUB16 and the clamp of the C path are both reached.
+ *
+ *  Usage: filter_test [rounds [seed]]
+ */
+
+#include "filter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_MAX_COUNT 40
+
+int32_t filter_simdSum(const int16_t *samples, int count);
+int16_t filter_simdTrimmedMean(int16_t *samples, int count, int trim);
+void filter_simdEma(int16_t *state, const int16_t *samples, int count, int16_t alpha);
+
+static int test_failed;
+
+/**
+ * A sample, one in eight at either extreme of int16_t
+ */
+static int16_t test_sample(void)
+{
+    switch (rand() % 16)
+    {
+    case 0:
+        return INT16_MIN;
+    case 1:
+        return INT16_MAX;
+    default:
+        return (int16_t)(rand() & 0xFFFF);
+    }
+}
+
+static void test_fill(int16_t *samples, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        samples[i] = test_sample();
+    }
+}
+
+static void test_check(const char *name, int count, int offset, long plain, long simd)
+{
+    if (plain != simd && test_failed++ < 10) {
+        printf("%s of %d samples at offset %d: C %ld, DSP %ld FAILED\n", name, count, offset, plain, simd);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    static const int16_t alphas[] = { 0, 1, 2, 8192, 16384, 32766, 32767 };
+    int rounds = argc > 1 ? atoi(argv[1]) : 20000;
+    int32_t words[TEST_MAX_COUNT / 2 + 1]; // Keeps the buffers 32-bit aligned
+    int32_t stateWords[TEST_MAX_COUNT / 2 + 1];
+    int32_t simdWords[TEST_MAX_COUNT / 2 + 1];
+    int16_t *samples = (int16_t *)words;
+    int16_t *state = (int16_t *)stateWords;
+    int16_t *simdState = (int16_t *)simdWords;
+    int16_t sorted[TEST_MAX_COUNT + 1];
+    int16_t simdSorted[TEST_MAX_COUNT + 1];
+    int round, count, offset, i;
+
+    srand(argc > 2 ? atoi(argv[2]) : 1);
+
+    for (round = 0; round < rounds; round++)
+    {
+        count = rand() % (TEST_MAX_COUNT + 1);
+        offset = rand() % 2;
+        test_fill(samples, TEST_MAX_COUNT + 2);
+
+        // The sum loads words from an odd start after one sample on its own
+        test_check("sum", count, offset, filter_sum(samples + offset, count),
+                   filter_simdSum(samples + offset, count));
+
+        int trim = count > 0 ? rand() % (count / 2 + 1) : 0;
+        memcpy(sorted, samples, count * sizeof(int16_t));
+        memcpy(simdSorted, samples, count * sizeof(int16_t));
+        test_check("trimmed mean", count, 0, filter_trimmedMean(sorted, count, trim),
+                   filter_simdTrimmedMean(simdSorted, count, trim));
+
+        // The EMA needs both buffers aligned
+        int16_t alpha = alphas[round % (sizeof(alphas) / sizeof(alphas[0]))];
+        if (round % 3 == 0) {
+            alpha = rand() & 0x7FFF;
+        }
+        test_fill(state, count);
+        memcpy(simdState, state, count * sizeof(int16_t));
+        filter_ema(state, samples, count, alpha);
+        filter_simdEma(simdState, samples, count, alpha);
+        for (i = 0; i < count && state[i] == simdState[i]; i++) {
+        }
+        if (i < count) {
+            test_check("ema", count, 0, state[i], simdState[i]);
+        }
+    }
+
+    printf("%d rounds of sum, trimmed mean and ema: %d differences\n", rounds, test_failed);
+    return test_failed != 0;
+}
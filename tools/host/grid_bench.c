@@ -0,0 +1,198 @@
+/*
+ * grid_bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Benchmark of the occupancy grid of grid.c: tracing a full 91 ray sweep
+ *  into the grid with grid_markScan(), marking a contact, and the ray cast
+ *  of grid_hazardAhead() over the path the motion loop checks every pass,
+ *  on random fields and poses. Prints the host time of each, mean and
+ *  worst; the M4 is far slower, it does the doubles of grid_markScan() in
+ *  software. Then the memory budget of the map and the planner: the RAM of
+ *  the grid, the flash image of grid_save() and the search window of
+ *  plan.c, against the 32 KB of SRAM of the TM4C123.
+ *
+ *  Usage: grid_bench [rounds [seed]]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "grid.h"
+#include "plan.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_REACH_MM 300 // HAZARD_SLOW_MM of movement.c
+#define BENCH_SRAM 32768
+#define BENCH_FIELD_MM 3000 // Poses are drawn from the grid less half a metre at each side
+
+// Typedef struct - Mean and worst time of one operation (us)
+typedef struct bench_time
+{
+    const char *name;
+    double total;
+    double worst;
+    long calls;
+} bench_time_t;
+
+/**
+ * Microseconds from CLOCK_MONOTONIC
+ */
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void bench_add(bench_time_t *time, double start)
+{
+    double spent = bench_now() - start;
+
+    time->total += spent;
+    time->calls++;
+    if (spent > time->worst) {
+        time->worst = spent;
+    }
+}
+
+static void bench_print(const bench_time_t *time)
+{
+    printf("%-24s %8.2f us mean, %8.2f us worst over %ld calls\n", time->name, time->total / time->calls,
+           time->worst, time->calls);
+}
+
+static double bench_coord(void)
+{
+    return GRID_ORIGIN_MM + 500 + rand() % BENCH_FIELD_MM;
+}
+
+/**
+ * A full sweep from a random pose, a third of the rays end on an object
+ */
+static void bench_scan(scan_t *scan)
+{
+    int16_t x = (int16_t)bench_coord();
+    int16_t y = (int16_t)bench_coord();
+    int16_t heading = (int16_t)(rand() % 36000 - 18000);
+    int i;
+
+    memset(scan, 0, sizeof(*scan));
+    scan->step = 2;
+    scan->count = SCAN_MAX_SAMPLES;
+    for (i = 0; i < SCAN_MAX_SAMPLES; i++)
+    {
+        scan_sample_t *sample = &scan->samples[i];
+
+        sample->angle = i * 2;
+        sample->range = rand() % 3 == 0 ? 10 + rand() % (SCAN_IR_RANGE - 10) : 999;
+        sample->x = x;
+        sample->y = y;
+        sample->heading = heading;
+    }
+}
+
+/**
+ * 1 to 6 blobs of hazard cells anywhere on the field
+ */
+static void bench_hazards(void)
+{
+    int blobs = 1 + rand() % 6;
+    int i, col, row;
+
+    for (i = 0; i < blobs; i++)
+    {
+        double x = bench_coord();
+        double y = bench_coord();
+        int size = 1 + rand() % 4;
+
+        for (col = 0; col < size; col++) {
+            for (row = 0; row < size; row++) {
+                grid_set(x + col * GRID_CELL_MM, y + row * GRID_CELL_MM, GRID_HAZARD);
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : 2000;
+    bench_time_t markScan = { "grid_markScan() sweep", 0, 0, 0 };
+    bench_time_t markContact = { "grid_markContact()", 0, 0, 0 };
+    bench_time_t hazardAhead = { "grid_hazardAhead() 300mm", 0, 0, 0 };
+    int found = 0, freed = 0;
+    scan_t scan;
+    oi_t sensor;
+    int i, j;
+
+    srand(argc > 2 ? atoi(argv[2]) : 1);
+    memset(&sensor, 0, sizeof(sensor));
+
+    for (i = 0; i < rounds; i++)
+    {
+        if (i % 100 == 0) {
+            grid_init();
+            bench_hazards();
+        }
+
+        bench_scan(&scan);
+        double start = bench_now();
+        grid_markScan(&scan);
+        bench_add(&markScan, start);
+
+        // The sensor stands on the first cell of every ray
+        double heading = scan.samples[0].heading / 100.0 * (M_PI / 180);
+        freed += grid_get(scan.samples[0].x + SCAN_SENSOR_MM * cos(heading),
+                          scan.samples[0].y + SCAN_SENSOR_MM * sin(heading)) != GRID_UNKNOWN;
+
+        sensor.poseX = bench_coord();
+        sensor.poseY = bench_coord();
+        sensor.poseHeading = rand() % 360 - 180;
+        sensor.bumpLeft = rand() % 2;
+        sensor.bumpRight = rand() % 2;
+        sensor.cliffFrontLeft = rand() % 2;
+        start = bench_now();
+        grid_markContact(&sensor);
+        bench_add(&markContact, start);
+
+        // The motion loop checks every pass, on a field the contacts above keep adding hazards to
+        for (j = 0; j < 10; j++)
+        {
+            double x = bench_coord(), y = bench_coord(), h = rand() % 360 - 180;
+
+            start = bench_now();
+            found += grid_hazardAhead(x, y, h, BENCH_REACH_MM) >= 0;
+            bench_add(&hazardAhead, start);
+        }
+    }
+
+    bench_print(&markScan);
+    printf("%-24s %8.3f us per ray\n", "", markScan.total / markScan.calls / SCAN_MAX_SAMPLES);
+    bench_print(&markContact);
+    bench_print(&hazardAhead);
+    printf("%-24s %ld of %ld found a hazard\n", "", (long)found, hazardAhead.calls);
+
+    // As declared in grid.c and plan.c
+    long cells = GRID_SIZE * GRID_SIZE / 4;
+    long gridRam = 2 * cells;
+    long gridFlash = 2 * sizeof(uint32_t) + 2 * cells;
+    long planRam = 3 * PLAN_WINDOW * sizeof(uint32_t)
+        + (long)PLAN_WINDOW * PLAN_WINDOW * (sizeof(uint16_t) + sizeof(uint8_t) + 2 * sizeof(uint16_t));
+    long scanRam = 2 * sizeof(scan_t);
+
+    printf("memory: grid cells %ld B + hazard ages %ld B, plan window %ld B, route sweeps %ld B:"
+           " %ld B of RAM (%.1f%% of %d KB)\n", cells, cells, planRam, scanRam, gridRam + planRam + scanRam,
+           100.0 * (gridRam + planRam + scanRam) / BENCH_SRAM, BENCH_SRAM / 1024);
+    printf("        grid_save() image %ld B of the 4 KB flash region\n", gridFlash);
+
+    if (freed != rounds) {
+        printf("%d of %d sweeps did not mark the cell of the sensor FAILED\n", rounds - freed, rounds);
+        return 1;
+    }
+    return 0;
+}
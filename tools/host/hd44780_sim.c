@@ -0,0 +1,214 @@
+/*
+ * hd44780_sim.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  The HD44780 on ports D and F, see hd44780_sim.h. As the data registers
+ *  of uart_sim.c, every access to a port data register hands out a cell and
+ *  the next access to either port looks at what was done to it: an edge of
+ *  EN on port D is taken to have happened at the access that handed the cell
+ *  out. A read of port F while EN and RW are high finds the nibble the
+ *  controller drives onto PF1:4. Looking at the statistics or the display
+ *  settles the last access too.
+ */
+
+#include "hd44780_sim.h"
+#include "profile.h"
+
+#include <inc/tm4c123gh6pm.h>
+#include <string.h>
+
+#define HD44780_EN 0x04         // PD2
+#define HD44780_RS 0x08         // PD3
+#define HD44780_RW 0x40         // PD6
+#define HD44780_PINS 0x1E       // PF1:4, D7:4 of the controller
+#define HD44780_BUSY 0x80
+#define HD44780_DDRAM_SIZE 0x80
+
+static const uint8_t hd44780_lineAddress[4] = { 0x00, 0x40, 0x14, 0x54 };
+
+static volatile uint32_t hd44780_control;  // Port D cell
+static volatile uint32_t hd44780_data;     // Port F cell
+static uint32_t hd44780_controlSeen;       // What the control cell held when last looked at
+static uint32_t hd44780_lastAccess;        // profile_now() of the last access to either port
+
+static int hd44780_readable;
+static int hd44780_fourBit;                // Function set to a 4 bit interface
+static int hd44780_lowNibble;              // The next nibble written is the low one
+static uint8_t hd44780_high;
+static int hd44780_readLow;                // The next nibble read is the low one
+static uint32_t hd44780_busyUntil;
+static uint8_t hd44780_address;
+static char hd44780_ddram[HD44780_DDRAM_SIZE];
+static hd44780_stats_t hd44780_counts;
+
+static int hd44780_busy(uint32_t time)
+{
+    return (int32_t)(time - hd44780_busyUntil) < 0;
+}
+
+/**
+ * The address counter after a character, the two lines of 40 cells follow each other
+ */
+static uint8_t hd44780_next(uint8_t address)
+{
+    address++;
+    if (address == 0x28) {
+        return 0x40;
+    }
+    return address == 0x68 ? 0x00 : address;
+}
+
+static void hd44780_execute(uint8_t byte, int rs, uint32_t time)
+{
+    uint32_t us = HD44780_EXEC_US;
+
+    if (hd44780_busy(time)) {
+        hd44780_counts.ignored++;
+        return;
+    }
+
+    if (rs) {
+        hd44780_counts.characters++;
+        hd44780_ddram[hd44780_address] = byte;
+        hd44780_address = hd44780_next(hd44780_address);
+    } else {
+        hd44780_counts.commands++;
+        if (byte & 0x80) {
+            hd44780_address = byte & 0x7F;
+        } else if ((byte & 0xE0) == 0x20) {
+            hd44780_fourBit = (byte & 0x10) == 0;
+        } else if (byte == 0x01) {
+            memset(hd44780_ddram, ' ', sizeof(hd44780_ddram));
+            hd44780_address = 0;
+            us = HD44780_CLEAR_US;
+        } else if ((byte & 0xFE) == 0x02) {
+            hd44780_address = 0;
+            us = HD44780_CLEAR_US;
+        }
+    }
+
+    hd44780_busyUntil = time + us * PROFILE_TICKS_PER_US;
+}
+
+/**
+ * Falling edge of EN, the controller latches a nibble or ends a read
+ */
+static void hd44780_strobe(uint32_t control, uint32_t time)
+{
+    uint8_t nibble = (hd44780_data & HD44780_PINS) >> 1;
+
+    if (control & HD44780_RW) {
+        hd44780_readLow = !hd44780_readLow;
+        return;
+    }
+
+    if (!hd44780_fourBit) {
+        // 8 bit interface, D3:0 are not wired and read as 0
+        hd44780_execute(nibble << 4, control & HD44780_RS, time);
+        hd44780_lowNibble = 0;
+    } else if (!hd44780_lowNibble) {
+        hd44780_high = nibble;
+        hd44780_lowNibble = 1;
+    } else {
+        hd44780_execute(hd44780_high << 4 | nibble, control & HD44780_RS, time);
+        hd44780_lowNibble = 0;
+    }
+}
+
+/**
+ * Settle what was done to the cells since the last access
+ */
+static void hd44780_resolve(void)
+{
+    uint32_t control = hd44780_control;
+
+    if ((hd44780_controlSeen & HD44780_EN) && !(control & HD44780_EN)) {
+        hd44780_strobe(hd44780_controlSeen, hd44780_lastAccess);
+    }
+    if ((hd44780_controlSeen & HD44780_RW) && !(control & HD44780_RW)) {
+        hd44780_readLow = 0;
+    }
+    hd44780_controlSeen = control;
+}
+
+/**
+ * Drive D7:4 onto the data pins while EN and RW are high and the pins are inputs
+ */
+static void hd44780_drive(uint32_t time)
+{
+    uint8_t status, nibble;
+
+    if ((hd44780_control & (HD44780_EN | HD44780_RW)) != (HD44780_EN | HD44780_RW) ||
+        (GPIO_PORTF_DIR_R & HD44780_PINS) != 0) {
+        return;
+    }
+
+    status = (hd44780_busy(time) ? HD44780_BUSY : 0) | hd44780_address;
+    if (!hd44780_readLow) {
+        hd44780_counts.statusReads++;
+        hd44780_counts.busyReads += (status & HD44780_BUSY) != 0;
+    }
+    nibble = hd44780_readLow ? status & 0x0F : status >> 4;
+    if (!hd44780_readable) {
+        nibble = 0x0F; // Nobody drives the pins, the pull-ups read high
+    }
+
+    hd44780_data = (hd44780_data & ~HD44780_PINS) | nibble << 1;
+}
+
+volatile uint32_t *host_gpioData(int port)
+{
+    uint32_t now = profile_now();
+
+    hd44780_resolve();
+    hd44780_lastAccess = now;
+    if (port == 5) {
+        hd44780_drive(now);
+        return &hd44780_data;
+    }
+    return &hd44780_control;
+}
+
+/**
+ * Power up a blank display in 8 bit mode and connect it to the ports
+ *
+ * @param readable - 0 for an LCD whose RW pin is not wired, every read returns the pull-ups (busy)
+ */
+void hd44780_init(int readable)
+{
+    hd44780_control = 0;
+    hd44780_data = 0;
+    hd44780_controlSeen = 0;
+    hd44780_readable = readable;
+    hd44780_fourBit = 0;
+    hd44780_lowNibble = 0;
+    hd44780_readLow = 0;
+    hd44780_busyUntil = profile_now();
+    hd44780_address = 0;
+    memset(hd44780_ddram, ' ', sizeof(hd44780_ddram));
+    memset(&hd44780_counts, 0, sizeof(hd44780_counts));
+}
+
+/**
+ * @returns the transactions so far
+ */
+const hd44780_stats_t *hd44780_stats(void)
+{
+    hd44780_resolve();
+    return &hd44780_counts;
+}
+
+/**
+ * Copy what one line of the display shows
+ *
+ * @param y - Line, 0 is the top
+ * @param text - Set to the 20 characters and a terminator
+ */
+void hd44780_line(int y, char *text)
+{
+    hd44780_resolve();
+    memcpy(text, &hd44780_ddram[hd44780_lineAddress[y]], 20);
+    text[20] = '\0';
+}
@@ -0,0 +1,52 @@
+/*
+ * hd44780_sim.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  The HD44780 20x4 character LCD on ports D and F for host tests of
+ *  lcd.c: it latches the nibbles lcd.c clocks in on the falling edge of EN,
+ *  runs the commands and characters with the execution times of the
+ *  datasheet, answers busy flag reads and counts every transaction, as well
+ *  as the bytes written while it was still busy (which it ignores, as the
+ *  controller does).
+ */
+
+#ifndef HD44780_SIM_H_
+#define HD44780_SIM_H_
+
+#include <stdint.h>
+
+#define HD44780_EXEC_US 37      // Every command and character but clear and home
+#define HD44780_CLEAR_US 1520   // Clear display and return home
+
+// Typedef struct - What went over the bus since hd44780_init()
+typedef struct {
+    uint32_t commands;          // Bytes written with RS low
+    uint32_t characters;        // Bytes written with RS high
+    uint32_t ignored;           // Bytes written while busy, lost
+    uint32_t statusReads;       // Busy flag and address reads
+    uint32_t busyReads;         // Of those, the ones that found it busy
+} hd44780_stats_t;
+
+/**
+ * Power up a blank display in 8 bit mode and connect it to the ports
+ *
+ * @param readable - 0 for an LCD whose RW pin is not wired, every read returns the pull-ups (busy)
+ */
+void hd44780_init(int readable);
+
+/**
+ * @returns the transactions so far
+ */
+const hd44780_stats_t *hd44780_stats(void);
+
+/**
+ * Copy what one line of the display shows
+ *
+ * @param y - Line, 0 is the top
+ * @param text - Set to the 20 characters and a terminator
+ */
+void hd44780_line(int y, char *text);
+
+#endif /* HD44780_SIM_H_ */
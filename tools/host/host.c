@@ -0,0 +1,112 @@
+/*
+ * host.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  What the firmware modules built on the host need from the hardware.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <inc/tm4c123gh6pm.h>
+#include "driverlib/interrupt.h"
+
+#include <stddef.h>
+#include <time.h>
+
+volatile uint32_t host_registers[80];
+
+void (*host_vectors[256])(void);
+
+void (*host_interruptSource)(void);
+
+static bool host_masked;           // Interrupts disabled
+static bool host_polling;          // The source is running, what it calls must not run it again
+static uint32_t host_maskedSince;  // host_cpuTime() when they were disabled
+static uint32_t host_maskedLongest;
+
+/**
+ * CPU time of the thread in nanoseconds, unlike profile_now() it stands still while the host
+ * runs other programs
+ */
+static uint32_t host_cpuTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+/**
+ * Give the simulated interrupts a chance to run, as the hardware would between two instructions
+ * Does nothing while interrupts are disabled, inside a simulated ISR (NVIC_INT_CTRL_R set) or
+ * the source itself
+ */
+void host_poll(void)
+{
+    if (!host_masked && !host_polling && NVIC_INT_CTRL_R == 0 && host_interruptSource != NULL) {
+        host_polling = true;
+        host_interruptSource();
+        host_polling = false;
+    }
+}
+
+/**
+ * @returns the longest CPU time (ns) interrupts were disabled since the last call
+ */
+uint32_t host_maskedMax(void)
+{
+    uint32_t longest = host_maskedLongest;
+
+    host_maskedLongest = 0;
+    return longest;
+}
+
+bool IntMasterEnable(void)
+{
+    bool was_disabled = host_masked;
+
+    if (host_masked && host_cpuTime() - host_maskedSince > host_maskedLongest) {
+        host_maskedLongest = host_cpuTime() - host_maskedSince;
+    }
+    host_masked = false;
+    host_poll(); // Pending interrupts are taken right away
+    return was_disabled;
+}
+
+bool IntMasterDisable(void)
+{
+    bool was_disabled = host_masked;
+
+    host_poll();
+    if (!host_masked) {
+        host_masked = true;
+        host_maskedSince = host_cpuTime();
+    }
+    return was_disabled;
+}
+
+void IntRegister(uint32_t interrupt, void (*handler)(void))
+{
+    host_vectors[interrupt] = handler;
+}
+
+/**
+ * Run the ISR registered for an exception, as the exception (NVIC_INT_CTRL_R)
+ *
+ * @returns 1 if there was one
+ */
+int host_interrupt(uint8_t exception)
+{
+    uint32_t interrupted = NVIC_INT_CTRL_R;
+
+    if (host_vectors[exception] == NULL) {
+        return 0;
+    }
+
+    NVIC_INT_CTRL_R = exception;
+    host_vectors[exception]();
+    NVIC_INT_CTRL_R = interrupted;
+    return 1;
+}
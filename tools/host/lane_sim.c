@@ -0,0 +1,283 @@
+/*
+ * lane_sim.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Simulation of the lane keeping of lane.c over the legs of auto_drive().
+ *  Each leg is a 600 mm lane between 50 mm strips of white tape, with a
+ *  wall beside the right tape along the first 2 m of the route. The CyBot
+ *  calibrates standing in the middle of the lane as calibrate_lane() does,
+ *  then drives every leg until the odometry has covered its length, with a
+ *  wheel mismatch of random sign, a heading error at the start, a turn error
+ *  at every corner and wheel noise on every 60 ms sensor frame. The cliff
+ *  sensors read the floor level of each sensor, or the tape under their
+ *  spot; the side light bumpers the reflection of the wall along their
+ *  direction.
+ *
+ *  Each scenario reports the lateral deviation from the middle of the lane
+ *  (rms and worst), the runs that left the lane (the centre of the CyBot
+ *  past the tape), the frames a wheel was on the tape, the route time (the
+ *  driving only, the sweeps at the checks come on top) and how far along
+ *  the lane from the end of each leg the CyBot stopped. Lane keeping that
+ *  lets a run leave the lane, or is not closer to the middle than driving
+ *  without it, fails.
+ *
+ *  Usage: lane_sim [runs [seed]]
+ */
+
+#include "lane.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_FRAME_MS 60
+#define SIM_WHEEL_BASE 235      // Between the wheels of the Create (mm)
+#define SIM_LANE_HALF 300       // Middle of the lane to the inner edge of the tape (mm)
+#define SIM_TAPE 50             // Width of the tape (mm)
+#define SIM_SPOT 10             // Half the width a cliff sensor sees (mm)
+#define SIM_WALL 420            // Middle of the lane to the wall (mm, right side)
+#define SIM_WALL_END 2000       // Length of the wall along the first leg (mm)
+#define SIM_FLOOR 1200          // Mean cliff signal of the floor, each sensor is off by up to 300
+#define SIM_FLOOR_NOISE 15
+#define SIM_TAPE_CONTRAST 1000  // Tape brighter than the floor
+#define SIM_AMBIENT 20          // Light bumper signal without a wall
+#define SIM_AMBIENT_NOISE 3
+#define SIM_WALL_SIGNAL 3000    // Light bumper signal 100 mm from the wall
+#define SIM_HEADING_DEG 2       // Standard deviation of the heading error at the start
+#define SIM_TURN_ERROR 0.02     // and of the turn scale error at a corner
+#define SIM_WHEEL_NOISE 2       // and of the speed of a wheel in a frame (mm/s)
+#define SIM_NUM_SENSORS 4
+#define SIM_RAD(deg) ((deg) * (M_PI / 180))
+
+// The legs of auto_drive() (mm) and the turn after each (deg, CCW positive)
+static const int sim_legs[][2] = {
+    { 2030, 78 }, { 900, 0 }, { 365, 7 }, { 1710, 65 }, { 500, 78 }, { 1360, -81 }, { 1000, 78 }, { 1400, 73 },
+};
+
+#define SIM_NUM_LEGS ((int)(sizeof(sim_legs) / sizeof(sim_legs[0])))
+
+// Cliff sensors and light bumpers left to right (deg from ahead, at 150 and 165 mm from the centre)
+static const double sim_cliffAngles[SIM_NUM_SENSORS] = { 70, 20, -20, -70 };
+static const double sim_lightAngles[SIM_NUM_SENSORS] = { 65, 35, -35, -65 };
+
+// Typedef struct - One way of driving the route
+typedef struct sim_scenario
+{
+    const char *name;
+    int steer;          // Lane keeping on
+    int speed;          // (mm/s)
+    double mismatch;    // Right wheel faster than the left by this fraction, random sign
+    int contrast;       // Tape brighter than the floor
+} sim_scenario_t;
+
+static const sim_scenario_t sim_scenarios[] = {
+    { "no steering", 0, 100, 0.01, SIM_TAPE_CONTRAST },
+    { "lane keeping", 1, 100, 0.01, SIM_TAPE_CONTRAST },
+    { "lane keeping 200 mm/s", 1, 200, 0.01, SIM_TAPE_CONTRAST },
+    { "3% wheel mismatch", 1, 100, 0.03, SIM_TAPE_CONTRAST },
+    { "half the tape contrast", 1, 100, 0.01, SIM_TAPE_CONTRAST / 2 },
+};
+
+// Typedef struct - Where the CyBot is in the lane of the leg it drives (mm, rad)
+typedef struct sim_pose
+{
+    double along;
+    double lateral;     // Left of the middle
+    double heading;     // Left of the lane
+} sim_pose_t;
+
+// Typedef struct - Sums over the runs of a scenario
+typedef struct sim_result
+{
+    double squares;     // Of the lateral deviation, every frame
+    double worst;
+    double seconds;
+    double missed;      // Stops off the end of the leg along the lane (mm)
+    long frames;
+    long onTape;
+    int left;           // Runs that left the lane
+} sim_result_t;
+
+static int sim_floor[SIM_NUM_SENSORS];
+
+/**
+ * Normally distributed, mean 0 and deviation 1
+ */
+static double sim_gauss(void)
+{
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+/**
+ * How much of a cliff sensor spot at a lateral position lies on the tape, 0-1
+ */
+static double sim_onTape(double lateral)
+{
+    double from = fabs(lateral) - SIM_SPOT;
+    double to = fabs(lateral) + SIM_SPOT;
+    double start = from > SIM_LANE_HALF ? from : SIM_LANE_HALF;
+    double end = to < SIM_LANE_HALF + SIM_TAPE ? to : SIM_LANE_HALF + SIM_TAPE;
+
+    return end > start ? (end - start) / (2 * SIM_SPOT) : 0;
+}
+
+/**
+ * Signal of a light bumper at a lateral position looking at an angle to the lane
+ */
+static int sim_light(const sim_pose_t *pose, int leg, double lateral, double angle)
+{
+    double signal = SIM_AMBIENT + sim_gauss() * SIM_AMBIENT_NOISE;
+
+    if (leg == 0 && sin(angle) < -0.1 && pose->along < SIM_WALL_END)
+    {
+        double d = (-SIM_WALL - lateral) / sin(angle);
+        if (d > 0) {
+            signal += SIM_WALL_SIGNAL * (100 / d) * (100 / d);
+        }
+    }
+    return signal < 0 ? 0 : (signal > 4095 ? 4095 : (int)signal);
+}
+
+/**
+ * Fill the analog signals of a sensor frame from the pose in the lane
+ */
+static void sim_sense(const sim_pose_t *pose, int leg, int contrast, oi_t *sensor)
+{
+    int cliff[SIM_NUM_SENSORS], light[SIM_NUM_SENSORS];
+    int i;
+
+    for (i = 0; i < SIM_NUM_SENSORS; i++)
+    {
+        double a = pose->heading + SIM_RAD(sim_cliffAngles[i]);
+        double signal = sim_floor[i] + sim_gauss() * SIM_FLOOR_NOISE
+                      + contrast * sim_onTape(pose->lateral + 150 * sin(a));
+        cliff[i] = signal > 4095 ? 4095 : (int)signal;
+
+        a = pose->heading + SIM_RAD(sim_lightAngles[i]);
+        light[i] = sim_light(pose, leg, pose->lateral + 165 * sin(a), a);
+    }
+
+    sensor->cliffLeftSignal = cliff[0];
+    sensor->cliffFrontLeftSignal = cliff[1];
+    sensor->cliffFrontRightSignal = cliff[2];
+    sensor->cliffRightSignal = cliff[3];
+    sensor->lightBumpLeftSignal = light[0];
+    sensor->lightBumpFrontLeftSignal = light[1];
+    sensor->lightBumpFrontRightSignal = light[2];
+    sensor->lightBumpRightSignal = light[3];
+}
+
+/**
+ * One run of the route
+ */
+static void sim_run(const sim_scenario_t *scenario, sim_result_t *result)
+{
+    double mismatch = rand() % 2 ? scenario->mismatch : -scenario->mismatch;
+    sim_pose_t pose = { 0, 0, SIM_RAD(sim_gauss() * SIM_HEADING_DEG) };
+    double worst = 0;
+    lane_t lane;
+    oi_t sensor;
+    int leg, i;
+
+    memset(&sensor, 0, sizeof(sensor));
+    for (i = 0; i < SIM_NUM_SENSORS; i++) {
+        sim_floor[i] = SIM_FLOOR + rand() % 601 - 300;
+    }
+
+    // calibrate_lane(), standing still in the middle
+    sim_pose_t start = { 0, 0, 0 };
+    lane_init(&lane);
+    do {
+        sim_sense(&start, 1, scenario->contrast, &sensor);
+    } while (!lane_learn(&lane, &sensor));
+
+    for (leg = 0; leg < SIM_NUM_LEGS; leg++)
+    {
+        double odometry = 0;
+        int steer = 0;
+
+        while (odometry < sim_legs[leg][0])
+        {
+            sim_sense(&pose, leg, scenario->contrast, &sensor);
+            if (scenario->steer) {
+                steer = lane_steer(&lane, &sensor, scenario->speed);
+            }
+
+            // The wheels get the command, but not quite
+            double right = (scenario->speed + steer) * (1 + mismatch / 2) + sim_gauss() * SIM_WHEEL_NOISE;
+            double left = (scenario->speed - steer) * (1 - mismatch / 2) + sim_gauss() * SIM_WHEEL_NOISE;
+            double dt = SIM_FRAME_MS / 1000.0;
+            double heading = pose.heading + (right - left) / SIM_WHEEL_BASE * dt / 2;
+
+            pose.along += (right + left) / 2 * dt * cos(heading);
+            pose.lateral += (right + left) / 2 * dt * sin(heading);
+            pose.heading += (right - left) / SIM_WHEEL_BASE * dt;
+            odometry += (scenario->speed + steer + scenario->speed - steer) / 2.0 * dt;
+            result->seconds += dt;
+
+            double wheel = SIM_WHEEL_BASE / 2 * fabs(cos(pose.heading));
+            result->squares += pose.lateral * pose.lateral;
+            result->onTape += fabs(pose.lateral) + wheel > SIM_LANE_HALF;
+            result->frames++;
+            if (fabs(pose.lateral) > worst) {
+                worst = fabs(pose.lateral);
+            }
+        }
+        result->missed += fabs(sim_legs[leg][0] - pose.along);
+
+        // Into the lane of the next leg, which starts where this one ends, turning with an error
+        double turn = SIM_RAD(sim_legs[leg][1]);
+        double along = pose.along - sim_legs[leg][0];
+        pose.along = along * cos(turn) + pose.lateral * sin(turn);
+        pose.lateral = pose.lateral * cos(turn) - along * sin(turn);
+        pose.heading += turn * sim_gauss() * SIM_TURN_ERROR;
+    }
+
+    result->worst = worst > result->worst ? worst : result->worst;
+    result->left += worst > SIM_LANE_HALF + SIM_TAPE;
+}
+
+int main(int argc, char *argv[])
+{
+    int runs = argc > 1 ? atoi(argv[1]) : 300;
+    int numScenarios = sizeof(sim_scenarios) / sizeof(sim_scenarios[0]);
+    double rms[sizeof(sim_scenarios) / sizeof(sim_scenarios[0])];
+    int failed = 0, route = 0;
+    int s, i;
+
+    for (i = 0; i < SIM_NUM_LEGS; i++) {
+        route += sim_legs[i][0];
+    }
+    printf("%d runs of %.1f m of route legs, %d mm lane\n", runs, route / 1000.0, 2 * SIM_LANE_HALF);
+
+    for (s = 0; s < numScenarios; s++)
+    {
+        const sim_scenario_t *scenario = &sim_scenarios[s];
+        sim_result_t result;
+
+        memset(&result, 0, sizeof(result));
+        srand(argc > 2 ? atoi(argv[2]) : 1);
+        for (i = 0; i < runs; i++) {
+            sim_run(scenario, &result);
+        }
+
+        rms[s] = sqrt(result.squares / result.frames);
+        printf("%-24s rms %5.1f mm, worst %5.1f mm, %3d runs left the lane, wheel on the tape %5.2f%% of frames,"
+               " route %5.1f s, stops %5.1f mm off\n", scenario->name, rms[s], result.worst, result.left,
+               100.0 * result.onTape / result.frames, result.seconds / runs,
+               result.missed / (runs * SIM_NUM_LEGS));
+
+        if (scenario->steer && (result.left > 0 || rms[s] >= rms[0])) {
+            printf("  %s does not keep the lane FAILED\n", scenario->name);
+            failed++;
+        }
+    }
+
+    printf("%d of %d scenarios failed\n", failed, numScenarios);
+    return failed != 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * latency_sim.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Command-to-wheel latency of teleop DRIVE commands on the simulated UARTs
+ *  and Create of uart_sim.c and create_sim.c, with the real uart.c, cmd.c,
+ *  telemetry.c and open_interface.c: an operator sends a DRIVE line every
+ *  SIM_PERIOD_MS at a random phase of the sensor cycle, and each is timed
+ *  from the last bit of its terminator on UART1 to the last byte of the
+ *  drive command it becomes at the Create. Two control loops are compared:
+ *
+ *    blocking  oi_update() and then the commands, the loop before teleop
+ *              streaming (a command waits for the frame and the 25 ms gap)
+ *    polling   the loop of control_poll() in movement.c, commands served
+ *              while the frame is received and during the gap
+ *
+ *  Work control_idle() does besides commands (work items, the log, the
+ *  dashboard) is left out, it adds to the polling loop's latency on the
+ *  CyBot.
+ *
+ *  Usage: latency_sim
+ */
+
+#include "cmd.h"
+#include "open_interface.h"
+#include "telemetry.h"
+#include "uart.h"
+#include "uart_sim.h"
+#include "create_sim.h"
+#include "profile.h"
+#include "work.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_COMMANDS 50
+#define SIM_PERIOD_MS 47        // Between DRIVE lines, off the 32 ms sensor cycle
+#define SIM_GAP_MS 25           // CONTROL_OI_GAP_MS of movement.c
+#define SIM_BYTE_US 87          // One byte on the wire at 115200 baud
+
+static uint32_t sim_nextAt;     // profile_now() the operator sends the next line
+static uint32_t sim_arrived[SIM_COMMANDS]; // profile_now() its terminator is in
+static int sim_lines;           // Lines sent
+static void (*sim_uarts)(void);
+
+// What the firmware modules need from Timer.c and work.c
+void timer_init(void)
+{
+}
+
+unsigned int timer_getMillis(void)
+{
+    return profile_now() / PROFILE_TICKS_PER_US / 1000;
+}
+
+void timer_waitMillis(unsigned int delay_time)
+{
+    sim_run(delay_time * 1000);
+}
+
+void timer_waitMicros(unsigned int delay_time)
+{
+    sim_run(delay_time);
+}
+
+int work_post(work_fn_t fn, uint32_t arg, work_priority_t prio)
+{
+    (void)fn;
+    (void)arg;
+    (void)prio;
+    return 0;
+}
+
+/**
+ * The operator, an interrupt source in front of the UARTs: one DRIVE line per period,
+ * the velocity tells the commands apart at the Create
+ */
+static void sim_operator(void)
+{
+    if (sim_lines < SIM_COMMANDS && (int32_t)(profile_now() - sim_nextAt) >= 0)
+    {
+        char line[CMD_LINE_SIZE];
+        int length = snprintf(line, sizeof(line), "%d DRIVE %d 0\r", sim_lines + 1, 100 + sim_lines);
+
+        // The line is idle, the terminator is in once the whole line has been shifted in
+        sim_receive(SIM_UART1, line, length);
+        sim_arrived[sim_lines++] = sim_nextAt + length * SIM_BYTE_US * PROFILE_TICKS_PER_US;
+        sim_nextAt += (SIM_PERIOD_MS * 1000 + rand() % (SIM_PERIOD_MS * 1000)) * PROFILE_TICKS_PER_US;
+    }
+    sim_uarts();
+}
+
+static void sim_command(const cmd_t *cmd)
+{
+    if (cmd->verb == CMD_DRIVE) {
+        oi_setWheels(cmd->args[0], cmd->args[0]);
+    }
+    cmd_ack(cmd, CMD_OK);
+}
+
+static void sim_blocking(oi_t *sensor)
+{
+    cmd_t cmd;
+
+    oi_update(sensor);
+    while (cmd_poll(&cmd)) {
+        sim_command(&cmd);
+    }
+}
+
+static void sim_polling(oi_t *sensor)
+{
+    static unsigned int lastFrame;
+    cmd_t cmd;
+
+    for (;;)
+    {
+        while (cmd_poll(&cmd)) {
+            sim_command(&cmd);
+        }
+        if (timer_getMillis() - lastFrame >= SIM_GAP_MS) {
+            oi_updateStart(sensor);
+        }
+        if (oi_updatePoll(sensor)) {
+            break;
+        }
+    }
+    lastFrame = timer_getMillis();
+}
+
+static void sim_loop(const char *name, void (*loop)(oi_t *sensor))
+{
+    oi_t *sensor = oi_alloc();
+    const create_command_t *log;
+    uint32_t latency, total = 0, min = UINT32_MAX, max = 0;
+    int count, i, matched = 0;
+
+    srand(1);
+    sim_init();
+    create_init();
+    oi_init(sensor);
+
+    // profile_now() runs the interrupt source, the operator has to be set before it is installed
+    sim_lines = 0;
+    sim_nextAt = profile_now() + SIM_PERIOD_MS * 1000 * PROFILE_TICKS_PER_US;
+    sim_uarts = host_interruptSource;
+    host_interruptSource = sim_operator;
+    while (sim_lines < SIM_COMMANDS) {
+        loop(sensor);
+    }
+    for (i = 0; i < 3; i++) {
+        loop(sensor);
+    }
+    host_interruptSource = sim_uarts;
+
+    count = create_commands(&log);
+    for (i = 0; i < count; i++)
+    {
+        int line = create_rightSpeed(&log[i]) - 100;
+        if (log[i].opcode != 145 || line < 0 || line >= SIM_COMMANDS) {
+            continue;
+        }
+        latency = (log[i].time - sim_arrived[line]) / PROFILE_TICKS_PER_US;
+        total += latency;
+        min = latency < min ? latency : min;
+        max = latency > max ? latency : max;
+        matched++;
+    }
+
+    printf("%-9s %2d of %d DRIVE commands at the wheels, latency min %6lu us mean %6lu us max %6lu us\n", name,
+           matched, SIM_COMMANDS, (unsigned long)min, (unsigned long)(matched ? total / matched : 0),
+           (unsigned long)max);
+    free(sensor);
+}
+
+int main(void)
+{
+    profile_init();
+    trace_init();
+    uart_init(115200);
+    uart_interrupt_init();
+    telemetry_init(uart_sendChar);
+
+    sim_loop("blocking", sim_blocking);
+    sim_loop("polling", sim_polling);
+    return 0;
+}
@@ -0,0 +1,231 @@
+/*
+ * lcd_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  The framebuffer of lcd.c on the simulated HD44780 of hd44780_sim.c, the
+ *  TIMER2A flush ticking at the period lcd.c sets: for typical updates the
+ *  display must end up showing the framebuffer, each changed cell must be
+ *  sent once and nothing else but the set address commands in front of a run
+ *  of changed cells, and no byte may be sent while the controller is busy.
+ *  The flush ISR must be profiled without putting events in the trace
+ *  buffer. All of it is run twice: on an LCD that answers busy flag reads,
+ *  where lcd.c must keep polling the flag, and on one whose RW pin is not
+ *  wired, where it must fall back to the fixed delays and a flush tick no
+ *  shorter than a byte takes the controller. Reported are the bus bytes and
+ *  the transfer time of each update, and the time lcd_init() took.
+ *
+ *  Usage: lcd_test
+ */
+
+#include "lcd.h"
+#include "hd44780_sim.h"
+#include "profile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_FLUSH_LIMIT_MS 100 // A flush that takes longer is stuck
+
+// Typedef struct - A screen update and what the display shows after it
+typedef struct {
+    const char *name;
+    const char *text;           // lcd_printf() text, NULL for lcd_clear()
+} test_update_t;
+
+static const test_update_t test_updates[] = {
+    { "whole screen", "CyBot Conquerors\nx  1234 y  -567 mm\nhdg  90 v  200 mm/s\nleg 2   350/  500" },
+    { "same text again", "CyBot Conquerors\nx  1234 y  -567 mm\nhdg  90 v  200 mm/s\nleg 2   350/  500" },
+    { "one digit", "CyBot Conquerors\nx  1234 y  -567 mm\nhdg  90 v  200 mm/s\nleg 2   351/  500" },
+    { "speed and progress", "CyBot Conquerors\nx  1234 y  -567 mm\nhdg  90 v  180 mm/s\nleg 2   400/  500" },
+    { "pose", "CyBot Conquerors\nx  1301 y  -498 mm\nhdg  92 v  180 mm/s\nleg 2   400/  500" },
+    { "clear", NULL },
+};
+
+static int test_failed;
+static size_t test_traceBytes;
+
+// What lcd.c needs from Timer.c, the clock is profile_now()
+unsigned int timer_getMicros(void)
+{
+    return profile_now() / PROFILE_TICKS_PER_US;
+}
+
+void timer_waitMicros(unsigned int delay_time)
+{
+    uint32_t start = profile_now();
+
+    while (profile_now() - start < delay_time * PROFILE_TICKS_PER_US) {
+    }
+}
+
+void timer_waitMillis(unsigned int delay_time)
+{
+    timer_waitMicros(delay_time * 1000);
+}
+
+static const char *test_mode;   // The LCD the updates run on
+
+static void test_check(const char *name, const char *what, int ok)
+{
+    if (!ok) {
+        printf("%s, %s: %s FAILED\n", test_mode, name, what);
+        test_failed++;
+    }
+}
+
+static void test_countTrace(char c)
+{
+    (void)c;
+    test_traceBytes++;
+}
+
+/**
+ * Tick TIMER2A until the flush stops it, a tick comes a whole period after the last one started
+ *
+ * @param us - Set to how long the flush took
+ *
+ * @returns 1 if the flush finished
+ */
+static int test_flush(uint32_t *us)
+{
+    uint32_t start = profile_now();
+    uint32_t tick = start;
+
+    *us = 0;
+    while (!lcd_flushed())
+    {
+        uint32_t period = (TIMER2_TAILR_R + 1) * PROFILE_TICKS_PER_US;
+
+        while (profile_now() - tick < period) {
+        }
+        tick = profile_now();
+        host_interrupt(INT_TIMER2A);
+        *us = (tick - start) / PROFILE_TICKS_PER_US;
+
+        if (*us > TEST_FLUSH_LIMIT_MS * 1000) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Lay text out the way lcd_printf() does
+ */
+static void test_layout(const char *text, char lines[4][21])
+{
+    int x, y;
+
+    for (y = 0; y < 4; y++)
+    {
+        for (x = 0; x < 20; x++) {
+            lines[y][x] = text != NULL && *text != '\0' && *text != '\n' ? *text++ : ' ';
+        }
+        lines[y][20] = '\0';
+        if (text != NULL && *text == '\n') {
+            text++;
+        }
+    }
+}
+
+/**
+ * Apply one update and check what went over the bus
+ */
+static void test_update(const test_update_t *update, char shown[4][21])
+{
+    char expected[4][21], line[21];
+    hd44780_stats_t before = *hd44780_stats();
+    uint32_t writes = lcd_busWrites();
+    uint32_t us;
+    int changed = 0, runs = 0, x, y;
+
+    test_layout(update->text, expected);
+    for (y = 0; y < 4; y++) {
+        for (x = 0; x < 20; x++) {
+            if (expected[y][x] != shown[y][x]) {
+                changed++;
+                runs += x == 0 || expected[y][x - 1] == shown[y][x - 1];
+            }
+        }
+    }
+
+    if (update->text != NULL) {
+        lcd_printf("%s", update->text);
+    } else {
+        lcd_clear();
+    }
+    test_check(update->name, "flushed", test_flush(&us));
+
+    const hd44780_stats_t *after = hd44780_stats();
+    uint32_t characters = after->characters - before.characters;
+    uint32_t commands = after->commands - before.commands;
+
+    printf("  %-20s %2d cells changed: %3lu bus bytes, %2lu of them set address, %5lu us\n", update->name,
+           changed, (unsigned long)(characters + commands), (unsigned long)commands, (unsigned long)us);
+    test_check(update->name, "every byte counted", lcd_busWrites() - writes == characters + commands);
+    test_check(update->name, "changed cells sent once", characters == (uint32_t)changed);
+    test_check(update->name, "one set address per run at most", commands <= (uint32_t)runs);
+    test_check(update->name, "nothing sent while busy", after->ignored == 0);
+
+    for (y = 0; y < 4; y++) {
+        hd44780_line(y, line);
+        test_check(update->name, expected[y], strcmp(line, expected[y]) == 0);
+        strcpy(shown[y], expected[y]);
+    }
+}
+
+/**
+ * Initialize the LCD and run the updates on it
+ *
+ * @param readable - The LCD answers busy flag reads
+ */
+static void test_lcd(int readable)
+{
+    char shown[4][21];
+    unsigned int i;
+
+    test_mode = readable ? "busy flag" : "RW not wired";
+    hd44780_init(readable);
+    uint32_t start = profile_now();
+    lcd_init();
+    uint32_t us = (profile_now() - start) / PROFILE_TICKS_PER_US;
+    uint32_t polls = lcd_busyFlagPolls();
+
+    printf("%s: lcd_init() %lu us, %lu busy flag reads, flush tick %lu us\n", test_mode, (unsigned long)us,
+           (unsigned long)hd44780_stats()->statusReads, (unsigned long)TIMER2_TAILR_R + 1);
+    test_check("lcd_init()", "busy flag used if it can be read", lcd_busyFlagUsed() == readable);
+    test_check("lcd_init()", "nothing sent while busy", hd44780_stats()->ignored == 0);
+    test_check("lcd_init()", "flush tick covers a byte", TIMER2_TAILR_R + 1 >= HD44780_EXEC_US);
+
+    test_layout(NULL, shown);
+    for (i = 0; i < sizeof(test_updates) / sizeof(test_updates[0]); i++) {
+        test_update(&test_updates[i], shown);
+    }
+    test_check("flush", "busy flag polled if it can be read", (lcd_busyFlagPolls() > polls) == readable);
+}
+
+int main(void)
+{
+    profile_init();
+    trace_init();
+
+    test_lcd(1);
+    test_lcd(0);
+
+    // Dumped twice, the second time the buffer is empty: the flush left no events behind
+    trace_dump(test_countTrace);
+    size_t traced = test_traceBytes;
+    test_traceBytes = 0;
+    trace_dump(test_countTrace);
+    printf("%lu flush ticks profiled, %lu bytes of trace events\n",
+           (unsigned long)profile_get(PROFILE_ISR_LCD)->count, (unsigned long)(traced - test_traceBytes));
+    test_mode = "both";
+    test_check("flush", "profiled", profile_get(PROFILE_ISR_LCD)->count > 0);
+    test_check("flush", "no trace events", traced == test_traceBytes);
+
+    printf("%d failures\n", test_failed);
+    return test_failed != 0;
+}
@@ -0,0 +1,280 @@
+/*
+ * locate_bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Benchmark of the landmark localization of locate.c on simulated runs of
+ *  the route of auto_drive(). The odometry follows the legs and turns the
+ *  route commands, the CyBot really drives them with a distance and turn
+ *  scale error drawn for every run and noise on every 60 ms sensor frame.
+ *  At each stop it sweeps from where it really stands: the posts of
+ *  LOCATE_LANDMARKS within IR range are seen with the range and angle noise
+ *  of a scan, as are a passenger (too wide to be a post) and a stray post
+ *  that is no landmark. locate_observe() corrects the pose with them.
+ *
+ *  Reported are the pose errors at the stops and at the end of the route,
+ *  odometry alone against corrected by the landmarks, how often the true
+ *  pose lay within 3 sigma of the estimate, and the host time of
+ *  locate_predict() per frame and locate_observe() per sweep; on the M4 the
+ *  doubles are done in software and take far longer. Built with
+ *  LOCATE_ENABLE, the landmarks do not need to be measured for this.
+ *
+ *  Usage: locate_bench [runs [seed]]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "locate.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_FRAME_MM 6        // Driven per sensor frame at 100 mm/s
+#define BENCH_FRAME_DEG 2       // Turned per sensor frame
+#define BENCH_DIST_SCALE 0.015  // Standard deviation of the distance scale error of a run
+#define BENCH_TURN_SCALE 0.03   // and of the turn scale error
+#define BENCH_FRAME_NOISE 0.05  // Heading noise per frame (deg)
+#define BENCH_RANGE_CM 1.5      // Noise of the range of a scanned object
+#define BENCH_ANGLE_DEG 2       // Noise of its angle, which is also rounded to the 2 degree step
+#define BENCH_MAX_OBJECTS 8
+#define BENCH_RAD(deg) ((deg) * (M_PI / 180))
+#define BENCH_DEG(rad) ((rad) * (180 / M_PI))
+
+// Typedef struct - One move of the route: drive (mm) or turn (deg, CCW positive), stop after it
+typedef struct bench_move
+{
+    double drive;
+    double turn;
+    int stop;
+} bench_move_t;
+
+// The moves of auto_drive(), every leg driven as commanded
+static const bench_move_t bench_route[] = {
+    { 2030, 0, 0 }, { 0, 78, 0 }, { 900, 0, 1 },
+    { 365, 0, 0 }, { 0, 7, 0 }, { 1710, 0, 0 }, { 0, 65, 2 },
+    { 500, 0, 0 }, { 0, 78, 0 }, { 1360, 0, 0 }, { 0, -81, 3 },
+    { 1000, 0, 0 }, { 0, 78, 0 }, { 1400, 0, 0 }, { 0, 73, 0 },
+};
+
+#define BENCH_NUM_MOVES ((int)(sizeof(bench_route) / sizeof(bench_route[0])))
+#define BENCH_NUM_STOPS 3
+
+// Typedef struct - Something round on the field, centre and radius (mm)
+typedef struct bench_thing
+{
+    double x, y, r;
+} bench_thing_t;
+
+static const bench_thing_t bench_posts[] = {
+#define BENCH_POST(id, x, y, radius) { x, y, radius },
+    LOCATE_LANDMARKS(BENCH_POST)
+#undef BENCH_POST
+};
+
+// A passenger waiting at stop 1 and a post nobody measured near stop 2
+static const bench_thing_t bench_passenger = { 2100, 1150, 120 };
+static const bench_thing_t bench_stray = { 2700, 2950, 25 };
+
+// Typedef struct - Where the CyBot really is (mm, deg)
+typedef struct bench_pose
+{
+    double x, y, heading;
+} bench_pose_t;
+
+// Typedef struct - Error sums of one way of keeping the pose
+typedef struct bench_error
+{
+    double stops;       // Position error at the stops (mm)
+    double stopsHeading;
+    double end;         // at the end of the route
+    double endHeading;
+    long within;        // Stops where the truth was within 3 sigma
+} bench_error_t;
+
+static double bench_predictNs, bench_observeNs;
+static long bench_frames, bench_sweeps, bench_matched;
+
+/**
+ * Nanoseconds from CLOCK_MONOTONIC
+ */
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * Normally distributed, mean 0 and deviation 1
+ */
+static double bench_gauss(void)
+{
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+static double bench_wrap(double deg)
+{
+    while (deg > 180) {
+        deg -= 360;
+    }
+    while (deg <= -180) {
+        deg += 360;
+    }
+    return deg;
+}
+
+/**
+ * Add a round thing to a sweep from the true pose if the IR sensor sees it
+ */
+static void bench_see(const bench_pose_t *truth, const bench_thing_t *thing, Obstacle *obstacles, int *count)
+{
+    double heading = BENCH_RAD(truth->heading);
+    double dx = thing->x - (truth->x + SCAN_SENSOR_MM * cos(heading));
+    double dy = thing->y - (truth->y + SCAN_SENSOR_MM * sin(heading));
+    double range = sqrt(dx * dx + dy * dy) - thing->r;
+    double angle = 90 + bench_wrap(BENCH_DEG(atan2(dy, dx)) - truth->heading) + bench_gauss() * BENCH_ANGLE_DEG;
+
+    if (range > SCAN_IR_RANGE * 10 || angle < 0 || angle > 180 || *count == BENCH_MAX_OBJECTS) {
+        return;
+    }
+
+    Obstacle *obstacle = &obstacles[(*count)++];
+    memset(obstacle, 0, sizeof(*obstacle));
+    obstacle->angle = 2 * (int)lround(angle / 2);
+    obstacle->dist = (int)lround(range / 10 + bench_gauss() * BENCH_RANGE_CM);
+    obstacle->variance = 4;
+    obstacle->linearWidth = (int)lround(2 * thing->r / 10);
+    obstacle->confidence = 100;
+}
+
+/**
+ * One run of the route
+ *
+ * @param correct - Correct the pose at the stops
+ */
+static void bench_run(double distScale, double turnScale, int correct, bench_error_t *error)
+{
+    bench_pose_t truth = { 0, 0, 0 };
+    oi_t sensor;
+    Obstacle obstacles[BENCH_MAX_OBJECTS];
+    int move;
+    unsigned int i;
+
+    memset(&sensor, 0, sizeof(sensor));
+    locate_init(&sensor, 0, 0, 0);
+
+    for (move = 0; move < BENCH_NUM_MOVES; move++)
+    {
+        const bench_move_t *m = &bench_route[move];
+        double left = m->drive != 0 ? m->drive : fabs(m->turn);
+
+        // Frame by frame, the odometry reports what was commanded, the CyBot does a little else
+        while (left > 0)
+        {
+            double step = fmin(left, m->drive != 0 ? BENCH_FRAME_MM : BENCH_FRAME_DEG);
+            double d = m->drive != 0 ? step : 0;
+            double a = m->drive != 0 ? 0 : (m->turn > 0 ? step : -step);
+
+            sensor.distance = d;
+            sensor.angle = a;
+            sensor.poseHeading += a;
+            sensor.poseX += d * cos(BENCH_RAD(sensor.poseHeading));
+            sensor.poseY += d * sin(BENCH_RAD(sensor.poseHeading));
+            double start = bench_now();
+            locate_predict(&sensor);
+            bench_predictNs += bench_now() - start;
+            bench_frames++;
+
+            truth.heading += a * (1 + turnScale) + bench_gauss() * BENCH_FRAME_NOISE;
+            truth.x += d * (1 + distScale) * cos(BENCH_RAD(truth.heading));
+            truth.y += d * (1 + distScale) * sin(BENCH_RAD(truth.heading));
+            left -= step;
+        }
+
+        if (m->stop == 0) {
+            continue;
+        }
+
+        // The sweep at the stop
+        int count = 0;
+        for (i = 0; i < sizeof(bench_posts) / sizeof(bench_posts[0]); i++) {
+            bench_see(&truth, &bench_posts[i], obstacles, &count);
+        }
+        bench_see(&truth, &bench_passenger, obstacles, &count);
+        bench_see(&truth, &bench_stray, obstacles, &count);
+
+        if (correct)
+        {
+            double start = bench_now();
+            bench_matched += locate_observe(&sensor, obstacles, count);
+            bench_observeNs += bench_now() - start;
+            bench_sweeps++;
+        }
+
+        double sx, sy, sh;
+        double ex = truth.x - sensor.poseX;
+        double ey = truth.y - sensor.poseY;
+        double eh = bench_wrap(truth.heading - sensor.poseHeading);
+        locate_sigma(&sx, &sy, &sh);
+        error->stops += sqrt(ex * ex + ey * ey);
+        error->stopsHeading += fabs(eh);
+        error->within += fabs(ex) <= 3 * sx && fabs(ey) <= 3 * sy && fabs(eh) <= 3 * sh;
+    }
+
+    double ex = truth.x - sensor.poseX;
+    double ey = truth.y - sensor.poseY;
+    error->end += sqrt(ex * ex + ey * ey);
+    error->endHeading += fabs(bench_wrap(truth.heading - sensor.poseHeading));
+}
+
+static void bench_print(const char *name, const bench_error_t *error, int runs)
+{
+    printf("%-18s at the stops %5.1f mm %4.2f deg, at the end %5.1f mm %4.2f deg, truth within 3 sigma %5.1f%%\n",
+           name, error->stops / (runs * BENCH_NUM_STOPS), error->stopsHeading / (runs * BENCH_NUM_STOPS),
+           error->end / runs, error->endHeading / runs, 100.0 * error->within / (runs * BENCH_NUM_STOPS));
+}
+
+int main(int argc, char *argv[])
+{
+    int runs = argc > 1 ? atoi(argv[1]) : 500;
+    bench_error_t odometry, landmarks;
+    int i;
+
+    srand(argc > 2 ? atoi(argv[2]) : 1);
+    memset(&odometry, 0, sizeof(odometry));
+    memset(&landmarks, 0, sizeof(landmarks));
+
+    for (i = 0; i < runs; i++)
+    {
+        double distScale = bench_gauss() * BENCH_DIST_SCALE;
+        double turnScale = bench_gauss() * BENCH_TURN_SCALE;
+        unsigned int seed = rand();
+
+        // Both ways see the same frame noise
+        srand(seed);
+        bench_run(distScale, turnScale, 0, &odometry);
+        srand(seed);
+        bench_run(distScale, turnScale, 1, &landmarks);
+        srand(seed);
+    }
+
+    printf("%d runs of the route, %d stops each\n", runs, BENCH_NUM_STOPS);
+    bench_print("odometry alone", &odometry, runs);
+    bench_print("landmarks", &landmarks, runs);
+    printf("%.2f of %d posts matched per stop\n", (double)bench_matched / bench_sweeps,
+           (int)(sizeof(bench_posts) / sizeof(bench_posts[0])));
+    printf("locate_predict() %.0f ns per frame, locate_observe() %.0f ns per sweep (host)\n",
+           bench_predictNs / bench_frames, bench_observeNs / bench_sweeps);
+
+    if (landmarks.stops >= odometry.stops || landmarks.end >= odometry.end) {
+        printf("landmarks do not lower the pose error FAILED\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * log_bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Benchmark of the tokenized logging of log.c against sending the text,
+ *  for every message of log_msgs.h with typical arguments. The text is what
+ *  the firmware sent before: the message formatted with sprintf() and
+ *  "\n\r", written with uart_sendStr() to the simulated UART1 of uart_sim.c.
+ *  The tokenized message is a LOG() call; its bytes on the wire are those of
+ *  the LOG record log_drain() sends later, out of the caller's way.
+ *
+ *  Reported per message are the bytes of both, and the caller's time (host
+ *  ns, mean over the calls) of LOG() against sprintf() and uart_sendStr().
+ *  Each call starts on an empty transmit ring, so no caller waits for the
+ *  wire; a burst of text longer than UART_TX_BUFFER_SIZE would. The
+ *  simulation moves on whenever the code reads the clock or masks
+ *  interrupts, which both do, so the times include some of it and say more
+ *  relative to each other than about the M4; the cycles on the CyBot are
+ *  the log_write and uart_sendStr regions of the profiler. Messages
+ *  below LOG_LEVEL are compiled out of LOG() and cost nothing. A LOG record
+ *  that is not shorter than the text, or LOG() callers that are not faster
+ *  than the text ones, fail.
+ *
+ *  Usage: log_bench [calls]
+ */
+
+#include "log.h"
+#include "profile.h"
+#include "telemetry.h"
+#include "uart.h"
+#include "uart_sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_ARG_A 3      // Arguments of every message, the format uses the first ones
+#define BENCH_ARG_B 120
+#define BENCH_ARG_C 3500
+#define BENCH_TEXT_SIZE 128
+
+static const char *const bench_formats[] = {
+#define BENCH_FORMAT(id, level, format) format,
+    LOG_MESSAGES(BENCH_FORMAT)
+#undef BENCH_FORMAT
+};
+
+static const char *const bench_names[] = {
+#define BENCH_NAME(id, level, format) #id,
+    LOG_MESSAGES(BENCH_NAME)
+#undef BENCH_NAME
+};
+
+static int bench_recordBytes;   // Of the LOG records drained since the last reset
+
+// What uart.c, telemetry.c and log.c need from Timer.c
+void timer_waitMillis(unsigned int delay_time)
+{
+    (void)delay_time;
+}
+
+unsigned int timer_getMillis(void)
+{
+    return profile_now() / PROFILE_TICKS_PER_US / 1000;
+}
+
+static void bench_output(char c)
+{
+    (void)c;
+    bench_recordBytes++;
+}
+
+/**
+ * LOG() of one message, the level test of each is a constant as in the firmware
+ *
+ * @returns 0 if the message is compiled out
+ */
+static int bench_log(log_message_t id)
+{
+    switch (id)
+    {
+#define BENCH_CASE(name, level, format) \
+    case LOG_##name: \
+        LOG(name, BENCH_ARG_A, BENCH_ARG_B, BENCH_ARG_C); \
+        return LOG_LEVEL_OF_##name >= LOG_LEVEL;
+        LOG_MESSAGES(BENCH_CASE)
+#undef BENCH_CASE
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @returns the number of arguments the format of a message uses
+ */
+static int bench_argc(const char *format)
+{
+    int argc = 0;
+
+    for (; *format != '\0'; format++) {
+        argc += format[0] == '%' && format[1] != '%';
+    }
+    return argc;
+}
+
+int main(int argc, char *argv[])
+{
+    int calls = argc > 1 ? atoi(argv[1]) : 200;
+    uint64_t logTotal = 0, textTotal = 0;
+    int failed = 0;
+    int id, i;
+
+    profile_init();
+    trace_init();
+    sim_init();
+    uart_init(115200);
+    uart_interrupt_init();
+    telemetry_init(bench_output);
+    log_init();
+
+    printf("%-17s %5s %5s %9s %9s\n", "message", "LOG", "text", "LOG()", "sendStr");
+    for (id = 0; id < LOG_NUM_MESSAGES; id++)
+    {
+        char text[BENCH_TEXT_SIZE];
+        int32_t args[LOG_MAX_ARGS] = { BENCH_ARG_A, BENCH_ARG_B, BENCH_ARG_C };
+        uint32_t logTime = 0, textTime = 0;
+        int compiled = 1;
+
+        // The record of one message on its own
+        bench_recordBytes = 0;
+        telemetry_sendLog(id, timer_getMillis(), args, bench_argc(bench_formats[id]));
+        int recordBytes = bench_recordBytes;
+        int textBytes = snprintf(text, sizeof(text), bench_formats[id], BENCH_ARG_A, BENCH_ARG_B, BENCH_ARG_C) + 2;
+
+        for (i = 0; i < calls; i++)
+        {
+            uint32_t start = profile_now();
+            compiled = bench_log(id);
+            logTime += profile_now() - start;
+            log_drain();
+
+            start = profile_now();
+            sprintf(text, bench_formats[id], BENCH_ARG_A, BENCH_ARG_B, BENCH_ARG_C);
+            uart_sendStr(text);
+            uart_sendStr("\n\r");
+            textTime += profile_now() - start;
+            uart_flush();
+        }
+
+        logTotal += logTime;
+        textTotal += textTime;
+        printf("%-17s %3d B %3d B %6lu ns %6lu ns%s\n", bench_names[id], recordBytes, textBytes,
+               (unsigned long)(logTime / calls), (unsigned long)(textTime / calls),
+               compiled ? "" : "  (below LOG_LEVEL, compiled out)");
+
+        if (recordBytes >= textBytes) {
+            printf("  LOG record not shorter than the text FAILED\n");
+            failed++;
+        }
+    }
+
+    printf("all messages: LOG() %lu ns, sprintf() and uart_sendStr() %lu ns per call (host)\n",
+           (unsigned long)(logTotal / calls / LOG_NUM_MESSAGES), (unsigned long)(textTotal / calls / LOG_NUM_MESSAGES));
+    if (logTotal >= textTotal) {
+        printf("LOG() not faster than the text FAILED\n");
+        failed++;
+    }
+    return failed != 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * plan_bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Benchmark of plan_find() on random fields: 1 to 6 blobs of hazard cells
+ *  across an 800 mm leg, the situation of a detour. Prints how often a path
+ *  was found, how much longer than the straight line it is, how close it
+ *  comes to a hazard and how long the search takes on the host.
+ *
+ *  Usage: plan_bench [fields [seed]]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "grid.h"
+#include "plan.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_FROM_X 1000 // Leg of every field (mm)
+#define BENCH_FROM_Y 1000
+#define BENCH_TO_X 1800
+#define BENCH_TO_Y 1000
+#define BENCH_RADIUS_MM 170 // Of the Create, a path closer to a hazard would hit it
+
+/**
+ * Microseconds from CLOCK_MONOTONIC
+ */
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/**
+ * Scatter 1 to 6 rectangles of 1x1 to 4x4 hazard cells over the middle of the leg
+ */
+static void bench_field(void)
+{
+    int blobs = 1 + rand() % 6;
+    int i, col, row;
+
+    grid_init();
+    for (i = 0; i < blobs; i++)
+    {
+        double x = 1250 + rand() % 400;
+        double y = 850 + rand() % 300;
+        int width = 1 + rand() % 4;
+        int height = 1 + rand() % 4;
+
+        for (col = 0; col < width; col++) {
+            for (row = 0; row < height; row++) {
+                grid_set(x + col * GRID_CELL_MM, y + row * GRID_CELL_MM, GRID_HAZARD);
+            }
+        }
+    }
+}
+
+/**
+ * Distance from a point to the nearest hazard cell within 8 cells, taken as a GRID_CELL_MM square
+ */
+static double bench_clearanceAt(double x, double y)
+{
+    double nearest = 1e9;
+    int i, j;
+
+    for (i = -8; i <= 8; i++)
+    {
+        for (j = -8; j <= 8; j++)
+        {
+            double cx = x + i * GRID_CELL_MM;
+            double cy = y + j * GRID_CELL_MM;
+            if (grid_get(cx, cy) != GRID_HAZARD) {
+                continue;
+            }
+
+            double x0 = floor((cx - GRID_ORIGIN_MM) / GRID_CELL_MM) * GRID_CELL_MM + GRID_ORIGIN_MM;
+            double y0 = floor((cy - GRID_ORIGIN_MM) / GRID_CELL_MM) * GRID_CELL_MM + GRID_ORIGIN_MM;
+            double dx = x < x0 ? x0 - x : (x > x0 + GRID_CELL_MM ? x - x0 - GRID_CELL_MM : 0);
+            double dy = y < y0 ? y0 - y : (y > y0 + GRID_CELL_MM ? y - y0 - GRID_CELL_MM : 0);
+            double d = sqrt(dx * dx + dy * dy);
+            if (d < nearest) {
+                nearest = d;
+            }
+        }
+    }
+
+    return nearest;
+}
+
+/**
+ * Closest approach of a path to a hazard, sampled 200 times per segment
+ */
+static double bench_clearance(const plan_path_t *path)
+{
+    double x = BENCH_FROM_X;
+    double y = BENCH_FROM_Y;
+    double nearest = 1e9;
+    int i, s;
+
+    for (i = 0; i < path->count; i++)
+    {
+        double toX = path->points[i].x;
+        double toY = path->points[i].y;
+
+        for (s = 0; s <= 200; s++)
+        {
+            double d = bench_clearanceAt(x + (toX - x) * s / 200, y + (toY - y) * s / 200);
+            if (d < nearest) {
+                nearest = d;
+            }
+        }
+        x = toX;
+        y = toY;
+    }
+
+    return nearest;
+}
+
+int main(int argc, char *argv[])
+{
+    int fields = argc > 1 ? atoi(argv[1]) : 1000;
+    int found = 0, tooClose = 0;
+    long expanded = 0;
+    double stretch = 0, closest = 1e9;
+    double total = 0, worst = 0;
+    plan_path_t path;
+    int i;
+
+    srand(argc > 2 ? atoi(argv[2]) : 1);
+
+    for (i = 0; i < fields; i++)
+    {
+        bench_field();
+
+        double start = bench_now();
+        int result = plan_find(BENCH_FROM_X, BENCH_FROM_Y, BENCH_TO_X, BENCH_TO_Y, &path);
+        double spent = bench_now() - start;
+
+        total += spent;
+        if (spent > worst) {
+            worst = spent;
+        }
+        if (result < 0) {
+            continue;
+        }
+
+        double clearance = bench_clearance(&path);
+        found++;
+        expanded += path.expanded;
+        stretch += path.length / (double)(BENCH_TO_X - BENCH_FROM_X);
+        tooClose += clearance < BENCH_RADIUS_MM;
+        if (clearance < closest) {
+            closest = clearance;
+        }
+    }
+
+    printf("fields %d: path found %d, none %d\n", fields, found, fields - found);
+    if (found > 0) {
+        printf("mean length %.2fx the straight line, closest to a hazard %.0f mm (%d paths under %d mm)\n",
+               stretch / found, closest, tooClose, BENCH_RADIUS_MM);
+        printf("mean %ld cells expanded\n", expanded / found);
+    }
+    printf("search %.1f us mean, %.1f us worst\n", total / fields, worst);
+
+    return tooClose == 0 ? 0 : 1;
+}
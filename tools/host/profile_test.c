@@ -0,0 +1,102 @@
+/*
+ * profile_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Statistics and histogram buckets of profile.c on the host: durations fed
+ *  to profile_record() must land in floor(log2) buckets with the overflow in
+ *  the last one, which the dump labels as such; min/mean/max must follow,
+ *  and a PROFILE_BEGIN/PROFILE_END pair around a sleep must measure it with
+ *  the clock_gettime() counter.
+ *
+ *  Usage: profile_test
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "profile.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static int test_failed;
+static char test_report[4096];
+
+static void test_check(const char *what, int ok)
+{
+    if (!ok) {
+        printf("%s FAILED\n", what);
+        test_failed++;
+    }
+}
+
+/**
+ * Collect the profile_dump() report
+ */
+static void test_output(const char *text)
+{
+    strncat(test_report, text, sizeof(test_report) - strlen(test_report) - 1);
+}
+
+int main(void)
+{
+    static const struct
+    {
+        uint32_t ticks;
+        int bucket;
+    } durations[] = {
+        { 0, 0 }, { 1, 0 }, { 2, 1 }, { 3, 1 }, { 4, 2 }, { 1023, 9 }, { 1024, 10 },
+        { 1UL << (PROFILE_BUCKETS - 1), PROFILE_BUCKETS - 1 }, { 0xFFFFFFFF, PROFILE_BUCKETS - 1 },
+    };
+    const int count = sizeof(durations) / sizeof(durations[0]);
+    const profile_stats_t *stats = profile_get(PROFILE_PLAN);
+    uint64_t total = 0;
+    int i;
+
+    profile_init();
+    trace_init();
+
+    for (i = 0; i < count; i++)
+    {
+        uint32_t before = stats->histogram[durations[i].bucket];
+        char what[64];
+
+        profile_record(PROFILE_PLAN, durations[i].ticks);
+        total += durations[i].ticks;
+        sprintf(what, "%lu ticks in bucket %d", (unsigned long)durations[i].ticks, durations[i].bucket);
+        test_check(what, stats->histogram[durations[i].bucket] == before + 1);
+    }
+    test_check("count", stats->count == (uint32_t)count);
+    test_check("min", stats->min == 0);
+    test_check("max", stats->max == 0xFFFFFFFF);
+    test_check("total", stats->total == total);
+
+    // Other regions are untouched, and a reset clears everything
+    test_check("other region", profile_get(PROFILE_AVOID)->count == 0);
+    profile_reset();
+    test_check("reset", stats->count == 0 && stats->max == 0 && stats->histogram[0] == 0);
+
+    // 2 ms slept between the markers, measured in nanoseconds on the host
+    struct timespec nap = { 0, 2000000 };
+    PROFILE_BEGIN(PLAN);
+    nanosleep(&nap, NULL);
+    PROFILE_END(PLAN);
+    test_check("one sleep recorded", stats->count == 1);
+    test_check("sleep measured", stats->min >= 2000 * PROFILE_TICKS_PER_US && stats->max < 200000 * PROFILE_TICKS_PER_US);
+
+    // The last bucket also holds everything longer, it is labelled with its lower bound
+    char overflow[40];
+    profile_record(PROFILE_HAZARD_AHEAD, 0xFFFFFFFF);
+    sprintf(overflow, "   >= %lu us: 1", (unsigned long)((1UL << (PROFILE_BUCKETS - 1)) / PROFILE_TICKS_PER_US));
+
+    profile_dump(test_output);
+    test_check("dump names the region", strstr(test_report, "plan_find") != NULL);
+    test_check("dump labels the overflow bucket", strstr(test_report, overflow) != NULL);
+    test_check("dump skips empty regions", strstr(test_report, "avoid_step") == NULL);
+
+    printf("%d durations, a 2 ms sleep measured %lu us: %d failures\n", count,
+           (unsigned long)(stats->max / PROFILE_TICKS_PER_US), test_failed);
+    return test_failed != 0;
+}
@@ -0,0 +1,232 @@
+/*
+ * scan_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  The caller-owned scan API of scan.c on replayed sweeps: the ADC readings
+ *  of a scene (five per angle, with a spike and a dropout among them) are
+ *  played back as the servo moves, and the PING))) sensor answers with the
+ *  range at the angle it is aimed at.
+ *   - scan_sweep() fills the caller's scan with the angle, the trimmed raw
+ *     reading, its distance and the time of every sample
+ *   - scan_segment() writes no more obstacles than it is given room for,
+ *     does not change the scan, and segmenting two scans in turn gives each
+ *     the same obstacles as segmenting it alone (no state is kept)
+ *   - scan_ping() and scan_fusePing() work on the same scan, and scan_send()
+ *     sends its fused ranges
+ *
+ *  Usage: scan_test
+ */
+
+#include "scan.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_FAR 999
+#define TEST_MAX_OBSTACLES 8
+#define TEST_SENTINEL 0x5A5A5A5A
+
+// Typedef struct - A scene, start to end angle (deg) of up to three objects at dist (cm)
+typedef struct test_scene
+{
+    const char *name;
+    int objects[3][3];
+    int count;
+} test_scene_t;
+
+// Midpoints on a sample, so the PING))) reading lands in the scan
+static const test_scene_t test_scenes[] = {
+    { "three objects", { { 40, 60, 30 }, { 90, 102, 20 }, { 140, 152, 35 } }, 3 },
+    { "one object", { { 70, 110, 25 } }, 1 },
+    { "nothing", { { 0 } }, 0 },
+};
+
+static int test_failed;
+static const test_scene_t *test_playing;   // Scene the ADC and PING))) readings come from
+static int test_angle;                     // Where the servo points
+static int test_read;                      // Readings taken at that angle
+static unsigned int test_millis;
+static uint16_t test_sent[SCAN_MAX_SAMPLES];
+static int test_sentCount;
+
+/**
+ * Range of the scene at an angle (cm)
+ */
+static int test_range(const test_scene_t *scene, int angle)
+{
+    int i;
+
+    for (i = 0; i < scene->count; i++) {
+        if (angle >= scene->objects[i][0] && angle <= scene->objects[i][1]) {
+            return scene->objects[i][2];
+        }
+    }
+    return TEST_FAR;
+}
+
+/**
+ * ADC reading the IR curve of scan_irToCm() gives for a range
+ */
+static int test_raw(int cm)
+{
+    return (int)(pow(51792.0 / cm, 1 / 1.149) + 0.5);
+}
+
+// What scan.c needs from the sensors, the servo, Timer.c, movement.c and telemetry.c
+int adc_read(void)
+{
+    static const int offsets[] = { 3, -3, 0, 4000, -4000 }; // The trimmed mean drops the spike and the dropout
+    int raw = test_raw(test_range(test_playing, test_angle)) + offsets[test_read++ % 5];
+
+    return raw < 0 ? 0 : (raw > 4095 ? 4095 : raw);
+}
+
+int ping_read(void)
+{
+    return test_range(test_playing, test_angle);
+}
+
+unsigned int servo_set_angle(int degrees)
+{
+    test_angle = degrees;
+    test_read = 0;
+    return test_millis;
+}
+
+void servo_wait(void)
+{
+}
+
+unsigned int timer_getMillis(void)
+{
+    return test_millis;
+}
+
+void timer_waitMillis(unsigned int delay_time)
+{
+    test_millis += delay_time;
+}
+
+int control_poll(oi_t *sensor, unsigned int timeout)
+{
+    (void)sensor;
+    (void)timeout;
+    return 0;
+}
+
+void telemetry_sendScan(uint8_t startAngle, uint8_t step, const uint16_t *dist, uint8_t count)
+{
+    (void)startAngle;
+    (void)step;
+    memcpy(test_sent, dist, count * sizeof(dist[0]));
+    test_sentCount = count;
+}
+
+static void test_check(const char *name, const char *what, int ok)
+{
+    if (!ok) {
+        printf("%s: %s FAILED\n", name, what);
+        test_failed++;
+    }
+}
+
+static void test_sweep(const test_scene_t *scene, scan_t *scan)
+{
+    int i, ok = 1;
+
+    test_playing = scene;
+    test_millis += 1000;
+    scan_sweep(scan, 0, 180, 2, NULL);
+
+    test_check(scene->name, "91 samples at 2 deg", scan->count == SCAN_MAX_SAMPLES && scan->step == 2);
+    test_check(scene->name, "stamped", scan->time == test_millis);
+    for (i = 0; i < scan->count; i++)
+    {
+        const scan_sample_t *sample = &scan->samples[i];
+        int raw = test_raw(test_range(scene, i * 2));
+
+        int dist = scan_irToCm(raw) < TEST_FAR ? scan_irToCm(raw) : TEST_FAR;
+
+        ok &= sample->angle == i * 2 && sample->raw == raw && sample->dist == dist &&
+              sample->range == sample->dist && sample->ping == SCAN_NO_PING;
+    }
+    test_check(scene->name, "every sample from the replayed readings", ok);
+}
+
+/**
+ * @returns the number of obstacles, checking the array past them is untouched
+ */
+static int test_segment(const test_scene_t *scene, const scan_t *scan, Obstacle *obstacles, int max)
+{
+    scan_t before = *scan;
+    int found, i;
+
+    memset(obstacles, 0x5A, TEST_MAX_OBSTACLES * sizeof(Obstacle));
+    found = scan_segment(scan, obstacles, max);
+
+    test_check(scene->name, "within the room given", found <= max);
+    for (i = max; i < TEST_MAX_OBSTACLES; i++) {
+        test_check(scene->name, "nothing written past the room", obstacles[i].startAngle == (int)TEST_SENTINEL);
+    }
+    test_check(scene->name, "scan unchanged", memcmp(&before, scan, sizeof(before)) == 0);
+    return found;
+}
+
+int main(void)
+{
+    static scan_t scans[3];
+    Obstacle alone[3][TEST_MAX_OBSTACLES], turns[TEST_MAX_OBSTACLES];
+    int found[3], i, j;
+    const int count = sizeof(test_scenes) / sizeof(test_scenes[0]);
+
+    // Each scene swept into its own buffer and segmented on its own
+    for (i = 0; i < count; i++)
+    {
+        test_sweep(&test_scenes[i], &scans[i]);
+        found[i] = test_segment(&test_scenes[i], &scans[i], alone[i], TEST_MAX_OBSTACLES);
+        printf("%-14s %d objects found:", test_scenes[i].name, found[i]);
+        for (j = 0; j < found[i]; j++) {
+            printf(" %d-%d deg at %d cm", alone[i][j].startAngle, alone[i][j].endAngle, alone[i][j].dist);
+        }
+        printf("\n");
+        test_check(test_scenes[i].name, "every object found", found[i] == test_scenes[i].count);
+    }
+
+    // In turn, the second time round after the others: the same obstacles
+    for (i = 0; i < 2 * count; i++)
+    {
+        const test_scene_t *scene = &test_scenes[i % count];
+        int n = test_segment(scene, &scans[i % count], turns, TEST_MAX_OBSTACLES);
+
+        test_check(scene->name, "same obstacles in turn", n == found[i % count] &&
+                   memcmp(turns, alone[i % count], n * sizeof(Obstacle)) == 0);
+    }
+
+    // Less room than objects: the first ones in angle order
+    test_check("one slot", "one obstacle", test_segment(&test_scenes[0], &scans[0], turns, 1) == 1);
+    test_check("one slot", "the first one", turns[0].startAngle == alone[0][0].startAngle);
+
+    // PING))) and fusion write into the same scan that is sent
+    test_playing = &test_scenes[0];
+    scan_ping(&scans[0], alone[0], found[0]);
+    int fused = scan_fusePing(&scans[0], alone[0], found[0]);
+    scan_send(&scans[0]);
+    int pinged = 0, ok = test_sentCount == scans[0].count;
+    for (j = 0; j < scans[0].count; j++) {
+        pinged += scans[0].samples[j].ping != SCAN_NO_PING;
+        ok &= test_sent[j] == scans[0].samples[j].range;
+    }
+    printf("%-14s %d samples pinged, %d fused, %d ranges sent\n", test_scenes[0].name, pinged, fused, test_sentCount);
+    test_check(test_scenes[0].name, "pinged in the scan", pinged == found[0]);
+    for (j = 0; j < found[0]; j++) {
+        test_check(test_scenes[0].name, "ping of the object", alone[0][j].ping == test_scenes[0].objects[j][2]);
+    }
+    test_check(test_scenes[0].name, "fused in the scan", fused > 0);
+    test_check(test_scenes[0].name, "fused ranges sent", ok);
+
+    printf("%d failures\n", test_failed);
+    return test_failed != 0;
+}
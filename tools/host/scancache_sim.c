@@ -0,0 +1,270 @@
+/*
+ * scancache_sim.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Simulation of the roadway checks of a route with the sweep cache of
+ *  scancache.c. The CyBot drives the legs of a route past round obstacles
+ *  and makes a check every so many mm along a leg, as move_forward_auto()
+ *  does, or as closely as a detour rescans, or checks again and again at a
+ *  stop while it waits to cross. Every check is planned from the
+ *  cache the way ir_sensor_check() does; the sweep the plan asks for is taken
+ *  from the field (IR range only, no noise) and a full sweep refills the
+ *  cache. A sweep costs the servo travel and settle time of servo.h.
+ *
+ *  Each route reports how many checks needed no sweep, a partial or a full
+ *  one, and the samples and seconds of sweeping saved against a full 0-180
+ *  sweep at every check. A plan that leaves an angle of the roadway unswept
+ *  while an obstacle stands within reach there is a failure.
+ *
+ *  Usage: scancache_sim [-v]
+ */
+
+#include "scancache.h"
+#include "servo.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_ROADWAY_START 75 // ROADWAY_START, ROADWAY_END and ROADWAY_CM of movement.c
+#define SIM_ROADWAY_END 115
+#define SIM_ROADWAY_CM 50
+#define SIM_STEP 2           // Degrees between samples, as detect_obj()
+#define SIM_FAR_CM 999
+#define SIM_TURN_MS 2000     // A 90 degree turn in place
+#define SIM_WAIT_MS 1000
+#define SIM_MAX_LEGS 4
+#define SIM_MAX_POLES 8
+#define SIM_RAD(deg) ((deg) * (M_PI / 180))
+
+// Typedef struct - A round obstacle, centre and radius (mm)
+typedef struct sim_pole
+{
+    double x, y, r;
+} sim_pole_t;
+
+// Typedef struct - A route from (0, 0) heading 0: legs with a turn in between, and the field along it
+typedef struct sim_route
+{
+    const char *name;
+    int speed;              // (mm/s)
+    int spacing;            // Between checks (mm)
+    int waits;              // Checks repeated at each stop, SIM_WAIT_MS apart, as while waiting to cross
+    int legs[SIM_MAX_LEGS]; // Length (mm), 0 ends the list
+    int turns[SIM_MAX_LEGS]; // After each leg (deg, CCW positive)
+    sim_pole_t poles[SIM_MAX_POLES];
+    int numPoles;
+} sim_route_t;
+
+static const sim_route_t sim_routes[] = {
+    { "straight, poles along it", 100, 500, 0, { 3000 }, { 0 },
+      { { 700, 350, 40 }, { 1400, -380, 40 }, { 2100, 330, 60 }, { 2600, -300, 40 } }, 4 },
+    { "block of four corners", 100, 500, 0, { 1500, 1500, 1500, 1500 }, { 90, 90, 90, 90 },
+      { { 1700, -200, 50 }, { 1750, 1700, 50 }, { -200, 1700, 50 }, { 300, -250, 40 } }, 4 },
+    { "detour rescans", 60, 150, 0, { 1500 }, { 0 },
+      { { 400, 260, 40 }, { 800, -250, 50 }, { 1200, 240, 40 } }, 3 },
+    { "object beside the lane", 100, 250, 0, { 2000 }, { 0 },
+      { { 900, 180, 40 }, { 1500, -200, 60 } }, 2 },
+    { "slow", 40, 500, 0, { 2000 }, { 0 },
+      { { 900, 300, 40 } }, 1 },
+    { "waiting at crossings", 100, 1000, 3, { 3000 }, { 0 },
+      { { 900, 300, 40 }, { 2000, -280, 50 } }, 2 },
+};
+
+static unsigned int sim_millis;
+static int sim_servo;   // Where the servo points (deg)
+
+// What scancache.c needs from Timer.c
+unsigned int timer_getMillis(void)
+{
+    return sim_millis;
+}
+
+/**
+ * Range to the nearest pole along a ray (cm), SIM_FAR_CM if none
+ */
+static double sim_ray(const sim_route_t *route, double x, double y, double bearing)
+{
+    double ux = cos(SIM_RAD(bearing));
+    double uy = sin(SIM_RAD(bearing));
+    double nearest = SIM_FAR_CM * 10.0;
+    int i;
+
+    for (i = 0; i < route->numPoles; i++)
+    {
+        const sim_pole_t *pole = &route->poles[i];
+        double along = (pole->x - x) * ux + (pole->y - y) * uy;
+        double off = (pole->x - x) * uy - (pole->y - y) * ux;
+
+        if (along > 0 && fabs(off) < pole->r)
+        {
+            double hit = along - sqrt(pole->r * pole->r - off * off);
+            if (hit < nearest) {
+                nearest = hit > 0 ? hit : 0;
+            }
+        }
+    }
+    return nearest / 10;
+}
+
+/**
+ * Time the servo takes to sweep from where it points, it stays at the last angle
+ *
+ * @returns the time taken (ms)
+ */
+static unsigned int sim_sweepMs(int startAngle, int endAngle)
+{
+    unsigned int ms = abs(startAngle - sim_servo) * SERVO_MS_PER_DEG + SERVO_SETTLE_MS;
+
+    ms += (endAngle - startAngle) / SIM_STEP * (SIM_STEP * SERVO_MS_PER_DEG + SERVO_SETTLE_MS);
+    sim_servo = endAngle;
+    return ms;
+}
+
+/**
+ * Sweep the field from a pose as scan_sweep() does, without noise
+ */
+static void sim_sweep(const sim_route_t *route, scan_t *scan, double x, double y, double heading)
+{
+    double sx = x + SCAN_SENSOR_MM * cos(SIM_RAD(heading));
+    double sy = y + SCAN_SENSOR_MM * sin(SIM_RAD(heading));
+    int angle;
+
+    memset(scan, 0, sizeof(*scan));
+    scan->time = sim_millis;
+    scan->step = SIM_STEP;
+    for (angle = 0; angle <= 180; angle += SIM_STEP)
+    {
+        scan_sample_t *sample = &scan->samples[scan->count++];
+        double cm = sim_ray(route, sx, sy, heading + angle - 90);
+
+        sample->angle = angle;
+        sample->range = cm <= SCAN_IR_RANGE ? (uint16_t)cm : SIM_FAR_CM;
+        sample->dist = sample->range;
+        sample->ping = SCAN_NO_PING;
+    }
+}
+
+/**
+ * Whether the plan sweeps every angle of the roadway with an obstacle within reach
+ */
+static int sim_safe(const sim_route_t *route, double x, double y, double heading, scancache_plan_t plan,
+                    int startAngle, int endAngle)
+{
+    double sx = x + SCAN_SENSOR_MM * cos(SIM_RAD(heading));
+    double sy = y + SCAN_SENSOR_MM * sin(SIM_RAD(heading));
+    int angle;
+
+    for (angle = SIM_ROADWAY_START; angle <= SIM_ROADWAY_END; angle += SIM_STEP)
+    {
+        int swept = plan != SCANCACHE_NONE && angle >= startAngle && angle <= endAngle;
+        if (!swept && sim_ray(route, sx, sy, heading + angle - 90) <= SIM_ROADWAY_CM) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Drive a route making the checks
+ *
+ * @returns the number of unsafe plans
+ */
+static int sim_run(const sim_route_t *route, int verbose)
+{
+    static const char *const plans[] = { "none", "partial", "full" };
+    scancache_t cache;
+    scan_t scan;
+    double x = 0, y = 0, heading = 0;
+    unsigned int sweepMs = 0, fullMs = 0, driveMs = 0;
+    int checks = 0, swept = 0, unsafe = 0;
+    int leg, done, wait = 0;
+
+    scancache_init(&cache);
+    sim_millis = 0;
+    sim_servo = 90;
+
+    for (leg = 0; leg < SIM_MAX_LEGS && route->legs[leg] > 0; leg++)
+    {
+        for (done = 0; done + route->spacing <= route->legs[leg] || wait < route->waits; )
+        {
+            uint8_t startAngle = SIM_ROADWAY_START;
+            uint8_t endAngle = SIM_ROADWAY_END;
+
+            if (done > 0 && wait < route->waits) {
+                sim_millis += SIM_WAIT_MS;
+                driveMs += SIM_WAIT_MS;
+                wait++;
+            } else {
+                unsigned int ms = route->spacing * 1000 / route->speed;
+
+                x += route->spacing * cos(SIM_RAD(heading));
+                y += route->spacing * sin(SIM_RAD(heading));
+                sim_millis += ms;
+                driveMs += ms;
+                done += route->spacing;
+                wait = 0;
+            }
+
+            scancache_plan_t plan = scancache_plan(&cache, x, y, heading, &startAngle, &endAngle, SIM_ROADWAY_CM);
+            if (!sim_safe(route, x, y, heading, plan, startAngle, endAngle)) {
+                printf("  unsafe %s plan at (%.0f, %.0f) FAILED\n", plans[plan], x, y);
+                unsafe++;
+            }
+
+            // What an uncached check would have spent, from the same servo position
+            int servo = sim_servo;
+            fullMs += sim_sweepMs(0, 180);
+            sim_servo = servo;
+
+            if (plan != SCANCACHE_NONE)
+            {
+                unsigned int took = sim_sweepMs(startAngle, endAngle);
+                sim_sweep(route, &scan, x, y, heading);
+                swept += (endAngle - startAngle) / SIM_STEP + 1;
+                sweepMs += took;
+                sim_millis += took;
+                if (plan == SCANCACHE_FULL) {
+                    scancache_store(&cache, &scan, x, y, heading);
+                }
+            }
+            if (verbose) {
+                printf("  %6u ms (%5.0f, %5.0f) %-7s %3d-%3d\n", sim_millis, x, y, plans[plan],
+                       plan == SCANCACHE_NONE ? 0 : startAngle, plan == SCANCACHE_NONE ? 0 : endAngle);
+            }
+            checks++;
+        }
+        heading += route->turns[leg];
+        sim_millis += SIM_TURN_MS;
+        driveMs += SIM_TURN_MS;
+    }
+
+    printf("%-26s %2d checks: %2u none, %2u partial, %2u full; %4d of %4d samples swept, %4lu saved;"
+           " %5.1f s of %5.1f s sweeping saved, route %5.1f s\n", route->name, checks,
+           cache.plans[SCANCACHE_NONE], cache.plans[SCANCACHE_PARTIAL], cache.plans[SCANCACHE_FULL],
+           swept, checks * SCAN_MAX_SAMPLES, (unsigned long)cache.saved, (fullMs - sweepMs) / 1000.0,
+           fullMs / 1000.0, (driveMs + sweepMs) / 1000.0);
+
+    if (swept + (int)cache.saved != checks * SCAN_MAX_SAMPLES) {
+        printf("  samples saved miscounted FAILED\n");
+        unsafe++;
+    }
+    return unsafe;
+}
+
+int main(int argc, char *argv[])
+{
+    int verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+    int failed = 0;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(sim_routes) / sizeof(sim_routes[0]); i++) {
+        failed += sim_run(&sim_routes[i], verbose) != 0;
+    }
+
+    printf("%d of %u routes failed\n", failed, (unsigned int)(sizeof(sim_routes) / sizeof(sim_routes[0])));
+    return failed != 0;
+}
@@ -0,0 +1,412 @@
+/*
+ * segment_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Precision and recall of scan_segment() on a labelled corpus of sweeps.
+ *  The hand-made scenes each exercise one rule of the segmentation (gap
+ *  merging, edges, hysteresis, clipping, noise spikes) and must come out
+ *  exactly as labelled. The random scenes scatter 1 to 4 objects over a far
+ *  background with the IR noise model of scan.c, dropouts inside objects and
+ *  single close spikes outside them, and are scored as a whole.
+ *
+ *  A detection matches a labelled object if its midpoint lies within the
+ *  object and its range is within 3 noise sigmas (at least 5 cm); every
+ *  object matches at most one detection.
+ *
+ *  Each random scene is also put through the fusion of detect_obj(): the
+ *  PING))) sensor, with its noise model, is aimed at every detection by
+ *  scan_ping() and fused by scan_fusePing(), then an earlier sweep of the
+ *  scene is fused by scan_fusePrior(). The mean absolute range error on the
+ *  samples that read an object must fall with each step below the error of
+ *  the IR readings alone.
+ *
+ *  Usage: segment_test [scenes [seed]]
+ */
+
+#include "scan.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_MAX_OBJECTS 4
+#define TEST_FAR 999
+#define TEST_DROPOUT 0.03   // Chance a sample inside an object reads far
+#define TEST_SPIKE 0.01     // Chance a background sample reads close
+// What scan_segment() achieves with the seed 1 corpus, less a margin. Most
+// false detections are objects at 30-40 cm split in two where the IR noise
+// makes neighbours jump by more than SCAN_EDGE_CM.
+#define TEST_MIN_PRECISION 0.93
+#define TEST_MIN_RECALL 0.98
+#define TEST_PRIOR_AGE_MS 1000  // Between the earlier sweep and the new one
+
+// Typedef struct - A labelled object, start to end angle (deg) at dist (cm)
+typedef struct test_object
+{
+    int start;
+    int end;
+    int dist;
+    int clipped;
+} test_object_t;
+
+// Typedef struct - A labelled sweep of 0-180 degrees at 2 degree steps
+typedef struct test_scene
+{
+    const char *name;
+    int background;     // Range of the samples outside the objects (cm)
+    int count;
+    test_object_t objects[TEST_MAX_OBJECTS];
+    int readings[4][2]; // Angle and range of samples that read otherwise, range 0 ends the list
+} test_scene_t;
+
+static const test_scene_t test_scenes[] = {
+    { "one object", TEST_FAR, 1, { { 80, 100, 30, 0 } }, { { 0 } } },
+    { "narrowest object", TEST_FAR, 1, { { 90, 92, 25, 0 } }, { { 0 } } },
+    { "one far sample merged", TEST_FAR, 1, { { 60, 90, 30, 0 } }, { { 74, TEST_FAR } } },
+    { "two far samples merged", TEST_FAR, 1, { { 60, 90, 30, 0 } }, { { 74, TEST_FAR }, { 76, TEST_FAR } } },
+    { "three far samples split", TEST_FAR, 2, { { 60, 72, 30, 0 }, { 80, 90, 30, 0 } }, { { 0 } } },
+    { "edge in front of an object", TEST_FAR, 2, { { 60, 78, 40, 0 }, { 80, 100, 20, 0 } }, { { 0 } } },
+    { "clipped at 0", TEST_FAR, 1, { { 0, 10, 30, 1 } }, { { 0 } } },
+    { "clipped at 180", TEST_FAR, 1, { { 170, 180, 30, 1 } }, { { 0 } } },
+    { "held open at 50 cm", 80, 1, { { 60, 100, 50, 0 } }, { { 60, 42 } } },
+    { "single close spike", TEST_FAR, 0, { { 0 } }, { { 90, 20 } } },
+    { "empty", TEST_FAR, 0, { { 0 } }, { { 0 } } },
+};
+
+#define TEST_NUM_SCENES ((int)(sizeof(test_scenes) / sizeof(test_scenes[0])))
+
+static const test_scene_t *test_pinged;    // Scene the PING))) sensor sees
+static int test_angle;                     // Where the servo points
+
+static int test_rangeAt(const test_scene_t *scene, int angle, int *inside);
+static double test_gauss(void);
+
+// What scan.c needs from the sensors, only scan_ping() calls any of it
+int adc_read(void)
+{
+    return 0;
+}
+
+/**
+ * Range of the pinged scene where the servo points, with the noise of SCAN_PING_SIGMA in scan.c
+ */
+int ping_read(void)
+{
+    int range = test_rangeAt(test_pinged, test_angle, NULL);
+    return range + (int)lround(test_gauss() * (1 + range / 100.0));
+}
+
+unsigned int servo_set_angle(int degrees)
+{
+    test_angle = degrees;
+    return 0;
+}
+
+void servo_wait(void)
+{
+}
+
+unsigned int timer_getMillis(void)
+{
+    return 0;
+}
+
+void timer_waitMillis(unsigned int delay_time)
+{
+    (void)delay_time;
+}
+
+int control_poll(oi_t *sensor, unsigned int timeout)
+{
+    (void)sensor;
+    (void)timeout;
+    return 0;
+}
+
+void telemetry_sendScan(uint8_t startAngle, uint8_t step, const uint16_t *dist, uint8_t count)
+{
+    (void)startAngle;
+    (void)step;
+    (void)dist;
+    (void)count;
+}
+
+/**
+ * Noise of an IR reading at a range, as SCAN_IR_SIGMA in scan.c (cm)
+ */
+static double test_sigma(int cm)
+{
+    if (cm > 80) {
+        cm = 80;
+    }
+    return 1 + cm * cm / 400.0;
+}
+
+/**
+ * Normally distributed, mean 0 and deviation 1
+ */
+static double test_gauss(void)
+{
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+static double test_chance(void)
+{
+    return rand() / (RAND_MAX + 1.0);
+}
+
+static void test_sample(scan_sample_t *sample, int angle, int range)
+{
+    double sigma = test_sigma(range);
+
+    memset(sample, 0, sizeof(*sample));
+    sample->angle = angle;
+    sample->dist = range;
+    sample->range = range;
+    sample->var = sigma * sigma;
+    sample->ping = SCAN_NO_PING;
+}
+
+/**
+ * Range of a scene at an angle without noise (cm)
+ *
+ * @param inside - Set to 1 if an object is there, may be NULL
+ */
+static int test_rangeAt(const test_scene_t *scene, int angle, int *inside)
+{
+    int range = scene->background;
+    int j;
+
+    if (inside != NULL) {
+        *inside = 0;
+    }
+    for (j = 0; j < scene->count; j++)
+    {
+        const test_object_t *object = &scene->objects[j];
+        if (angle >= object->start && angle <= object->end && object->dist < range) {
+            range = object->dist;
+            if (inside != NULL) {
+                *inside = 1;
+            }
+        }
+    }
+    for (j = 0; j < 4 && scene->readings[j][1] != 0; j++) {
+        if (scene->readings[j][0] == angle) {
+            range = scene->readings[j][1];
+        }
+    }
+
+    return range;
+}
+
+/**
+ * Sweep a scene, noisy adds IR noise, dropouts and spikes
+ *
+ * @param truth - Set to the range of every sample that read an object, -1 for
+ *                the others and the dropouts, may be NULL
+ */
+static void test_sweep(const test_scene_t *scene, scan_t *scan, int noisy, int *truth)
+{
+    int i;
+
+    memset(scan, 0, sizeof(*scan));
+    scan->step = 2;
+    scan->count = SCAN_MAX_SAMPLES;
+
+    for (i = 0; i < SCAN_MAX_SAMPLES; i++)
+    {
+        int angle = i * 2;
+        int inside;
+        int range = test_rangeAt(scene, angle, &inside);
+
+        if (truth != NULL) {
+            truth[i] = inside ? range : -1;
+        }
+        if (noisy)
+        {
+            if (inside && test_chance() < TEST_DROPOUT) {
+                range = TEST_FAR;
+                if (truth != NULL) {
+                    truth[i] = -1;
+                }
+            } else if (!inside && test_chance() < TEST_SPIKE) {
+                range = 10 + rand() % 30;
+            } else if (range < TEST_FAR) {
+                range += (int)lround(test_gauss() * test_sigma(range));
+                range = range < 1 ? 1 : range;
+            }
+        }
+        test_sample(&scan->samples[i], angle, range);
+    }
+}
+
+/**
+ * Add the absolute range errors of the samples that read an object
+ */
+static void test_error(const scan_t *scan, const int *truth, double *sum)
+{
+    int i;
+
+    for (i = 0; i < scan->count; i++) {
+        if (truth[i] >= 0) {
+            *sum += abs(scan->samples[i].range - truth[i]);
+        }
+    }
+}
+
+/**
+ * Match detections to labels one to one
+ *
+ * @param checkClipped - The clipped flag must match the label as well
+ *
+ * @returns the number of detections that matched a label
+ */
+static int test_match(const test_scene_t *scene, const Obstacle *obstacles, int found, int checkClipped)
+{
+    int used[TEST_MAX_OBJECTS] = { 0 };
+    int matched = 0;
+    int i, j;
+
+    for (i = 0; i < found; i++)
+    {
+        for (j = 0; j < scene->count; j++)
+        {
+            const test_object_t *object = &scene->objects[j];
+            double tolerance = 3 * test_sigma(object->dist);
+
+            if (used[j] || obstacles[i].angle < object->start || obstacles[i].angle > object->end) {
+                continue;
+            }
+            if (abs(obstacles[i].dist - object->dist) > (tolerance > 5 ? tolerance : 5)) {
+                continue;
+            }
+            if (checkClipped && obstacles[i].clipped != object->clipped) {
+                continue;
+            }
+            used[j] = 1;
+            matched++;
+            break;
+        }
+    }
+
+    return matched;
+}
+
+/**
+ * 1 to 4 objects 4 to 30 degrees wide at 10 to 40 cm. Neighbours are either 4
+ * samples apart or differ by more than 20 cm in range, otherwise even a
+ * person could not tell them apart.
+ */
+static void test_randomScene(test_scene_t *scene)
+{
+    int angle = rand() % 20;
+    int j;
+
+    memset(scene, 0, sizeof(*scene));
+    scene->name = "random";
+    scene->background = rand() % 2 ? TEST_FAR : 70 + rand() % 60;
+
+    for (j = 1 + rand() % TEST_MAX_OBJECTS; j > 0 && angle <= 176; j--)
+    {
+        test_object_t *object = &scene->objects[scene->count];
+        int dist = 10 + rand() % 31;
+
+        if (scene->count > 0)
+        {
+            test_object_t *last = &scene->objects[scene->count - 1];
+            if (angle - last->end < 8 && abs(dist - last->dist) <= 20) {
+                angle = last->end + 8;
+            }
+            if (angle > 176) {
+                break;
+            }
+        }
+
+        object->start = angle;
+        object->end = angle + 4 + 2 * (rand() % 14);
+        object->end = object->end > 180 ? 180 : object->end;
+        object->dist = dist;
+        object->clipped = object->start == 0 || object->end == 180;
+        scene->count++;
+        angle = object->end + 2 + 2 * (rand() % 20);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int scenes = argc > 1 ? atoi(argv[1]) : 2000;
+    int detections = 0, labels = 0, matches = 0;
+    int failed = 0;
+    Obstacle obstacles[SCAN_MAX_SAMPLES];
+    test_scene_t scene;
+    scan_t scan, prior;
+    int truth[SCAN_MAX_SAMPLES];
+    double irError = 0, pingError = 0, priorError = 0;
+    long measured = 0;
+    int i, j;
+
+    srand(argc > 2 ? atoi(argv[2]) : 1);
+
+    for (i = 0; i < TEST_NUM_SCENES; i++)
+    {
+        test_sweep(&test_scenes[i], &scan, 0, NULL);
+        int found = scan_segment(&scan, obstacles, SCAN_MAX_SAMPLES);
+        int matched = test_match(&test_scenes[i], obstacles, found, 1);
+        int ok = found == test_scenes[i].count && matched == found;
+
+        printf("%-28s %d objects, %d found, %d matched %s\n", test_scenes[i].name, test_scenes[i].count,
+               found, matched, ok ? "" : "FAILED");
+        failed += !ok;
+    }
+
+    for (i = 0; i < scenes; i++)
+    {
+        test_randomScene(&scene);
+        test_sweep(&scene, &prior, 1, NULL);
+        test_sweep(&scene, &scan, 1, truth);
+        scan.time = TEST_PRIOR_AGE_MS;
+        int found = scan_segment(&scan, obstacles, SCAN_MAX_SAMPLES);
+
+        detections += found;
+        labels += scene.count;
+        matches += test_match(&scene, obstacles, found, 0);
+
+        // The fusion steps of detect_obj()
+        test_error(&scan, truth, &irError);
+        test_pinged = &scene;
+        scan_ping(&scan, obstacles, found);
+        scan_fusePing(&scan, obstacles, found);
+        test_error(&scan, truth, &pingError);
+        scan_fusePrior(&scan, &prior);
+        test_error(&scan, truth, &priorError);
+        for (j = 0; j < SCAN_MAX_SAMPLES; j++) {
+            measured += truth[j] >= 0;
+        }
+    }
+
+    double precision = detections > 0 ? matches / (double)detections : 1;
+    double recall = labels > 0 ? matches / (double)labels : 1;
+    printf("%d random scenes: %d objects, %d found, %d matched, precision %.3f, recall %.3f\n",
+           scenes, labels, detections, matches, precision, recall);
+    if (precision < TEST_MIN_PRECISION || recall < TEST_MIN_RECALL) {
+        printf("under %.2f precision or %.2f recall FAILED\n", TEST_MIN_PRECISION, TEST_MIN_RECALL);
+        failed++;
+    }
+
+    irError /= measured;
+    pingError /= measured;
+    priorError /= measured;
+    printf("%ld samples on objects: mean range error %.2f cm IR alone, %.2f cm with PING))), %.2f cm with the earlier sweep\n",
+           measured, irError, pingError, priorError);
+    if (!(pingError < irError && priorError < pingError)) {
+        printf("fusion does not lower the range error FAILED\n");
+        failed++;
+    }
+
+    return failed != 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * servo_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  The calibration table of servo.c (the one of SERVO_CYBOT) through
+ *  servo_set_angle() and the TIMER1B match it loads: the match must fall
+ *  strictly from 0 to 180 degrees and keep the pulse within what a hobby
+ *  servo takes, and angles outside 0 to 180 must be clamped to the ends.
+ *  The predicted settle time must follow the travel. servo_test_13 is the
+ *  same test on the table of CyBot 13.
+ *
+ *  Usage: servo_test
+ */
+
+#include "servo.h"
+#include "profile.h"
+
+#include <stdio.h>
+
+#define TEST_PULSE_MIN_US 500
+#define TEST_PULSE_MAX_US 2500
+
+static int test_failed;
+static unsigned int test_millis;
+
+// What servo.c needs from Timer.c
+unsigned int timer_getMillis(void)
+{
+    return test_millis;
+}
+
+void timer_waitMillis(unsigned int delay_time)
+{
+    test_millis += delay_time;
+}
+
+static void test_check(int degrees, const char *what, int ok)
+{
+    if (!ok) {
+        printf("%d deg: %s FAILED\n", degrees, what);
+        test_failed++;
+    }
+}
+
+/**
+ * @returns the 24 bit match value servo_set_angle() loaded for an angle
+ */
+static uint32_t test_match(int degrees)
+{
+    servo_set_angle(degrees);
+    return TIMER1_TBPMR_R << 16 | TIMER1_TBMATCHR_R;
+}
+
+int main(void)
+{
+    uint32_t period, match, previous = 0, first, last;
+    int degrees;
+
+    profile_init();
+    trace_init();
+    servo_init();
+    period = TIMER1_TBPR_R << 16 | TIMER1_TBILR_R;
+
+    first = test_match(0);
+    last = test_match(180);
+    for (degrees = 0; degrees <= 180; degrees++)
+    {
+        match = test_match(degrees);
+        uint32_t pulse = (period - match) / 16; // 16 MHz timer clock
+
+        test_check(degrees, "angle kept", servo_get_angle() == degrees);
+        test_check(degrees, "match falls with the angle", degrees == 0 || match < previous);
+        test_check(degrees, "pulse in range", pulse >= TEST_PULSE_MIN_US && pulse <= TEST_PULSE_MAX_US);
+        previous = match;
+    }
+
+    // Clamped at both ends
+    for (degrees = -90; degrees < 0; degrees++) {
+        test_check(degrees, "clamped to 0", test_match(degrees) == first && servo_get_angle() == 0);
+    }
+    for (degrees = 181; degrees <= 270; degrees++) {
+        test_check(degrees, "clamped to 180", test_match(degrees) == last && servo_get_angle() == 180);
+    }
+
+    // Settled after the travel, a move still under way counts too
+    servo_wait();
+    servo_set_angle(90);
+    servo_wait();
+    unsigned int arrival = servo_set_angle(30);
+    test_check(30, "settle time", arrival == test_millis + 60 * SERVO_MS_PER_DEG + SERVO_SETTLE_MS);
+    test_check(30, "not arrived yet", !servo_arrived());
+    arrival = servo_set_angle(60);
+    test_check(60, "settle after the move under way", arrival == test_millis + 90 * SERVO_MS_PER_DEG + 2 * SERVO_SETTLE_MS);
+    servo_wait();
+    test_check(60, "arrived after waiting", servo_arrived() && test_millis == arrival);
+
+    printf("CyBot %d: pulse %lu us at 0 deg, %lu us at 180 deg, match falls over all 181 angles\n", SERVO_CYBOT,
+           (unsigned long)((period - first) / 16), (unsigned long)((period - last) / 16));
+    printf("%d failures\n", test_failed);
+    return test_failed != 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * shutoff_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  The shutoff button of open_interface.c on the simulated UART4 and Create
+ *  of uart_sim.c and create_sim.c: a series of oi_setWheels() commands is
+ *  sent and the button is pressed 10 us, 20 us, ... after the first, the
+ *  GPIOF interrupt taken at the next point the control loop can be
+ *  interrupted. Whenever it is pressed, the Create must receive only whole
+ *  commands, one stop besides those of the control loop, after every command
+ *  the loop wrote before the press, and no wheel may turn again after it.
+ *  Reported are the longest (CPU) time the ISR took and the most bytes the Create
+ *  received from the press to the end of the stop.
+ *
+ *  Usage: shutoff_test
+ */
+
+#include "open_interface.h"
+#include "uart_sim.h"
+#include "create_sim.h"
+#include "profile.h"
+#include "work.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define TEST_COMMANDS 6
+#define TEST_STEP_US 10         // Between the press times tried
+#define TEST_BYTE_US 87         // One byte on the wire at 115200 baud
+#define TEST_MARGIN_US 200      // Host overhead
+
+void oi_init_noupdate(void);
+
+static int test_failed;
+static int test_pressing;       // The button is to be pressed
+static uint32_t test_pressAt;   // profile_now() from which it is
+static size_t test_pressBytes;  // Bytes on the wire when it was
+static uint32_t test_isrMax;    // Longest CPU time (ns) the GPIOF ISR took, it spins on UART4
+static void (*test_simSource)(void);
+
+/**
+ * CPU time of the thread in nanoseconds, unlike profile_now() it stands still while the host
+ * runs other programs
+ */
+static uint32_t test_cpuTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+// What open_interface.c needs from Timer.c and work.c
+void timer_init(void)
+{
+}
+
+void timer_waitMillis(unsigned int delay_time)
+{
+    sim_run(delay_time * 1000);
+}
+
+int work_post(work_fn_t fn, uint32_t arg, work_priority_t prio)
+{
+    (void)fn;
+    (void)arg;
+    (void)prio;
+    return 0;
+}
+
+static void test_check(uint32_t us, const char *what, int ok)
+{
+    if (!ok) {
+        printf("press at %lu us: %s FAILED\n", (unsigned long)us, what);
+        test_failed++;
+    }
+}
+
+/**
+ * The interrupt source while the commands are sent, presses the button once its time has come
+ */
+static void test_source(void)
+{
+    if (test_pressing && (int32_t)(profile_now() - test_pressAt) >= 0) {
+        const uint8_t *wire;
+
+        test_pressing = 0;
+        test_pressBytes = sim_sent(SIM_UART4, &wire);
+        GPIO_PORTF_RIS_R = BIT0;
+        uint32_t start = test_cpuTime();
+        host_interrupt(INT_GPIOF);
+        uint32_t took = test_cpuTime() - start;
+        test_isrMax = took > test_isrMax ? took : test_isrMax;
+        GPIO_PORTF_RIS_R = 0;
+    }
+    test_simSource();
+}
+
+/**
+ * Send the commands with the button pressed a while after the first is written
+ *
+ * @param us - How long after, 0 for never
+ * @param stopBytes - Set to how many bytes after the press the stop was on the wire
+ *
+ * @returns 1 if the button was pressed before the last command was written
+ */
+static int test_run(uint32_t us, size_t *stopBytes)
+{
+    const create_command_t *log;
+    const uint8_t *wire;
+    int count, i, start, pressed, stopped = -1;
+    size_t bytes;
+
+    sim_init();
+    create_init();
+    oi_init_noupdate();
+    sim_run(2000);
+    start = create_commands(&log);
+    bytes = sim_sent(SIM_UART4, &wire);
+
+    test_simSource = host_interruptSource;
+    host_interruptSource = test_source;
+    test_pressAt = profile_now() + us * PROFILE_TICKS_PER_US; // Runs the source, not pressing yet
+    test_pressing = us > 0;
+    for (i = 0; i < TEST_COMMANDS; i++) {
+        oi_setWheels(100 + i, 200 + i);
+    }
+    pressed = us > 0 && !test_pressing;
+    test_pressing = 0;
+    while (UART4_FR_R & UART_FR_BUSY) {
+        sim_run(TEST_BYTE_US);
+    }
+    host_interruptSource = test_simSource;
+
+    count = create_commands(&log);
+    for (i = start; i < count; i++)
+    {
+        int zero = create_rightSpeed(&log[i]) == 0 && create_leftSpeed(&log[i]) == 0;
+
+        test_check(us, "whole commands", log[i].opcode == 145 && log[i].length == 4);
+        if (stopped < 0) {
+            bytes += 1 + log[i].length;
+            stopped = zero ? i : -1;
+        }
+        if (stopped >= 0) {
+            test_check(us, "wheels stay stopped after the stop", zero);
+        }
+    }
+
+    if (pressed) {
+        test_check(us, "stopped once", stopped >= 0 && count - start == TEST_COMMANDS + 1);
+        if (stopped >= 0) {
+            *stopBytes = bytes - test_pressBytes;
+            // Ahead of the stop: the byte shifting out, a full FIFO and the rest of the command the loop was writing
+            test_check(us, "stop on the wire after a FIFO and a command", *stopBytes <= 1 + 16 + 4 + 5);
+        }
+    } else {
+        test_check(us, "every command sent", count - start == TEST_COMMANDS && stopped < 0);
+    }
+
+    return pressed;
+}
+
+int main(void)
+{
+    uint32_t us;
+    size_t stopBytes, stopMax = 0;
+    int pressed = 0;
+
+    profile_init();
+    trace_init();
+
+    test_run(0, &stopBytes);
+    // Past the last command the button no longer finds the loop writing one
+    for (us = TEST_STEP_US; us < TEST_COMMANDS * 5 * TEST_BYTE_US; us += TEST_STEP_US)
+    {
+        stopBytes = 0;
+        pressed += test_run(us, &stopBytes);
+        stopMax = stopBytes > stopMax ? stopBytes : stopMax;
+    }
+
+    uint32_t isrUs = test_isrMax / 1000;
+    printf("%d presses over %d commands: ISR %lu us at most, stop on the wire %lu bytes after the press at most\n",
+           pressed, TEST_COMMANDS, (unsigned long)isrUs, (unsigned long)stopMax);
+    test_check(0, "pressed while the commands were written", pressed > 0);
+    test_check(0, "ISR waits for at most the 5 bytes of the stop", isrUs < 5 * TEST_BYTE_US + TEST_MARGIN_US);
+
+    printf("%d failures\n", test_failed);
+    return test_failed != 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * interrupt.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Host stand-in for the TivaWare interrupt API (host.c). A simulation may
+ *  register a source of interrupts, it is run whenever the control loop has
+ *  them enabled: when they are enabled again and at every host_poll().
+ */
+
+#ifndef INTERRUPT_H_
+#define INTERRUPT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+bool IntMasterEnable(void);
+bool IntMasterDisable(void);
+void IntRegister(uint32_t interrupt, void (*handler)(void));
+
+/**
+ * Handlers registered with IntRegister(), by exception number
+ */
+extern void (*host_vectors[256])(void);
+
+/**
+ * Run the ISR registered for an exception, as the exception (NVIC_INT_CTRL_R)
+ *
+ * @returns 1 if there was one
+ */
+int host_interrupt(uint8_t exception);
+
+/**
+ * Runs the ISRs of a simulated peripheral that are pending, NULL if there is none
+ */
+extern void (*host_interruptSource)(void);
+
+/**
+ * Give the simulated interrupts a chance to run, as the hardware would between two instructions
+ * Does nothing while interrupts are disabled, inside a simulated ISR (NVIC_INT_CTRL_R set) or
+ * the source itself
+ */
+void host_poll(void);
+
+/**
+ * @returns the longest CPU time (ns) interrupts were disabled since the last call
+ */
+uint32_t host_maskedMax(void);
+
+#endif /* INTERRUPT_H_ */
@@ -0,0 +1,179 @@
+/*
+ * tm4c123gh6pm.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Host stand-in for the TivaWare register header. Only the registers the
+ *  modules built by tools/host/Makefile refer to are here, backed by plain
+ *  memory (host.c); most code paths that touch them are not run on the host.
+ *  The UART FIFOs and flags are computed by the simulation in uart_sim.c,
+ *  the LCD data and control ports by the HD44780 of hd44780_sim.c.
+ */
+
+#ifndef TM4C123GH6PM_H_
+#define TM4C123GH6PM_H_
+
+#include <stdint.h>
+
+extern volatile uint32_t host_registers[80];
+
+// Flash memory controller (grid.c)
+#define FLASH_FMA_R (host_registers[0])
+#define FLASH_FMD_R (host_registers[1])
+#define FLASH_FMC_R (host_registers[2])
+#define FLASH_FMC_WRKEY 0xA4420000
+#define FLASH_FMC_ERASE 0x00000002
+#define FLASH_FMC_WRITE 0x00000001
+
+// Interrupt control, the active exception number: 0 is the control loop, a test sets it to simulate an ISR (trace.c)
+#define NVIC_INT_CTRL_R (host_registers[3])
+#define NVIC_INT_CTRL_VEC_ACT_M 0x000000FF
+#define NVIC_EN0_R (host_registers[4])
+#define NVIC_EN1_R (host_registers[5])
+#define INT_UART1 22
+#define INT_GPIOF 46
+#define INT_UART4 76
+#define INT_TIMER2A 39
+#define INT_GPIOE 20
+#define INT_TIMER4A 86
+#define NVIC_PRI5_R (host_registers[44])
+#define NVIC_PRI5_INTD_M 0xE0000000
+#define NVIC_PRI17_R (host_registers[56])
+#define NVIC_PRI17_INTC_M 0x00E00000
+#define NVIC_EN2_R (host_registers[57])
+
+// Clock gating and ports B, C and F (uart.c, open_interface.c)
+#define SYSCTL_RCGCUART_R (host_registers[6])
+#define SYSCTL_RCGCGPIO_R (host_registers[7])
+#define SYSCTL_RCGCGPIO_R2 0x00000004
+#define SYSCTL_RCGCGPIO_R5 0x00000020
+#define SYSCTL_RCGCUART_R4 0x00000010
+#define GPIO_PORTB_AFSEL_R (host_registers[8])
+#define GPIO_PORTB_PCTL_R (host_registers[9])
+#define GPIO_PORTB_DEN_R (host_registers[10])
+#define GPIO_PORTB_DIR_R (host_registers[11])
+#define GPIO_PORTC_AFSEL_R (host_registers[12])
+#define GPIO_PORTC_PCTL_R (host_registers[13])
+#define GPIO_PORTC_DEN_R (host_registers[14])
+#define GPIO_PORTC_DIR_R (host_registers[15])
+#define GPIO_PORTF_LOCK_R (host_registers[16])
+#define GPIO_PORTF_CR_R (host_registers[17])
+#define GPIO_PORTF_DEN_R (host_registers[18])
+#define GPIO_PORTF_DIR_R (host_registers[19])
+#define GPIO_PORTF_IBE_R (host_registers[20])
+#define GPIO_PORTF_IEV_R (host_registers[21])
+#define GPIO_PORTF_ICR_R (host_registers[22])
+#define GPIO_PORTF_IM_R (host_registers[23])
+#define GPIO_PORTF_RIS_R (host_registers[24])
+
+// LCD ports D (control) and F (data) (lcd.c), the data registers come from hd44780_sim.c
+volatile uint32_t *host_gpioData(int port);
+#define GPIO_PORTD_DATA_R (*host_gpioData(3))
+#define GPIO_PORTF_DATA_R (*host_gpioData(5))
+#define GPIO_PORTD_DEN_R (host_registers[45])
+#define GPIO_PORTD_DIR_R (host_registers[46])
+#define GPIO_PORTF_PUR_R (host_registers[47])
+
+// TIMER2A, the LCD flush tick (lcd.c)
+#define SYSCTL_RCGCTIMER_R (host_registers[48])
+#define SYSCTL_RCGCTIMER_R2 0x00000004
+#define TIMER2_CTL_R (host_registers[49])
+#define TIMER2_CFG_R (host_registers[50])
+#define TIMER2_TAMR_R (host_registers[51])
+#define TIMER2_TAPR_R (host_registers[52])
+#define TIMER2_TAILR_R (host_registers[53])
+#define TIMER2_ICR_R (host_registers[54])
+#define TIMER2_IMR_R (host_registers[55])
+
+// Port E (the buttons) and TIMER4A, their debounce tick (button.c)
+#define GPIO_PORTE_DATA_R (host_registers[58])
+#define GPIO_PORTE_DIR_R (host_registers[59])
+#define GPIO_PORTE_DEN_R (host_registers[60])
+#define GPIO_PORTE_IM_R (host_registers[61])
+#define GPIO_PORTE_IS_R (host_registers[62])
+#define GPIO_PORTE_IBE_R (host_registers[63])
+#define GPIO_PORTE_ICR_R (host_registers[64])
+#define SYSCTL_RCGCTIMER_R4 0x00000010
+#define TIMER4_CTL_R (host_registers[65])
+#define TIMER4_CFG_R (host_registers[66])
+#define TIMER4_TAMR_R (host_registers[67])
+#define TIMER4_TAPR_R (host_registers[68])
+#define TIMER4_TAILR_R (host_registers[69])
+#define TIMER4_ICR_R (host_registers[70])
+#define TIMER4_IMR_R (host_registers[71])
+
+// TIMER1B, the servo PWM (servo.c)
+#define TIMER1_CTL_R (host_registers[72])
+#define TIMER1_CFG_R (host_registers[73])
+#define TIMER1_TBMR_R (host_registers[74])
+#define TIMER1_TBILR_R (host_registers[75])
+#define TIMER1_TBPR_R (host_registers[76])
+#define TIMER1_TBPMR_R (host_registers[77])
+#define TIMER1_TBMATCHR_R (host_registers[78])
+
+// Timer bits (lcd.c, button.c)
+#define TIMER_CTL_TAEN 0x00000001
+#define TIMER_CFG_16_BIT 0x00000004
+#define TIMER_TAMR_TAMR_PERIOD 0x00000002
+#define TIMER_ICR_TATOCINT 0x00000001
+#define TIMER_IMR_TATOIM 0x00000001
+
+// UART1 (uart.c) and UART4 (open_interface.c), data, flags and interrupt status come from uart_sim.c
+volatile uint32_t *host_uartData(int uart);
+volatile uint32_t *host_uartFlags(int uart);
+volatile uint32_t *host_uartStatus(int uart);
+#define UART1_DR_R (*host_uartData(1))
+#define UART1_FR_R (*host_uartFlags(1))
+#define UART1_MIS_R (*host_uartStatus(1))
+#define UART1_IM_R (host_registers[25])
+#define UART1_ICR_R (host_registers[26])
+#define UART1_CTL_R (host_registers[27])
+#define UART1_IBRD_R (host_registers[28])
+#define UART1_FBRD_R (host_registers[29])
+#define UART1_LCRH_R (host_registers[30])
+#define UART1_IFLS_R (host_registers[31])
+#define UART1_CC_R (host_registers[32])
+#define UART1_DMACTL_R (host_registers[33])
+#define UART1_RSR_R (host_registers[34])
+#define UART4_DR_R (*host_uartData(4))
+#define UART4_FR_R (*host_uartFlags(4))
+#define UART4_MIS_R (*host_uartStatus(4))
+#define UART4_IM_R (host_registers[35])
+#define UART4_ICR_R (host_registers[36])
+#define UART4_CTL_R (host_registers[37])
+#define UART4_IBRD_R (host_registers[38])
+#define UART4_FBRD_R (host_registers[39])
+#define UART4_LCRH_R (host_registers[40])
+#define UART4_CC_R (host_registers[41])
+#define UART4_DMACTL_R (host_registers[42])
+#define UART4_RSR_R (host_registers[43])
+#define UART4_ECR_R UART4_RSR_R // Same register, a write clears the error flags
+#define UART_FR_TXFF 0x00000020
+#define UART_FR_RXFE 0x00000010
+#define UART_FR_BUSY 0x00000008
+#define UART_IM_RTIM 0x00000040
+#define UART_IM_TXIM 0x00000020
+#define UART_IM_RXIM 0x00000010
+#define UART_MIS_RTMIS 0x00000040
+#define UART_MIS_TXMIS 0x00000020
+#define UART_MIS_RXMIS 0x00000010
+#define UART_ICR_RTIC 0x00000040
+#define UART_ICR_TXIC 0x00000020
+#define UART_ICR_RXIC 0x00000010
+#define UART_IFLS_RX2_8 0x00000008
+#define UART_IFLS_TX2_8 0x00000001
+#define UART_DMACTL_TXDMAE 0x00000002
+#define UART_DMACTL_RXDMAE 0x00000001
+#define UART_LCRH_WLEN_8 0x00000060
+#define UART_LCRH_FEN 0x00000010
+#define UART_CTL_RXE 0x00000200
+#define UART_CTL_TXE 0x00000100
+#define UART_CTL_UARTEN 0x00000001
+#define UART_CC_CS_SYSCLK 0x00000000
+#define UART_RSR_OE 0x00000008
+#define UART_RSR_BE 0x00000004
+#define UART_RSR_PE 0x00000002
+#define UART_RSR_FE 0x00000001
+
+#endif /* TM4C123GH6PM_H_ */
@@ -0,0 +1,103 @@
+/*
+ * trace_capture.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Records a known timeline with the trace.c of the host build and writes
+ *  the TRACE records telemetry_sendTrace() sends to a file, between TEXT
+ *  records like a UART1 capture: a motion loop with a sensor update, a PING))) and a UART1 ISR
+ *  interrupting it (the active exception set in the NVIC_INT_CTRL_R stand-in)
+ *  and a bump marker, then a second trace that overflows the ring.
+ *  trace_check.py runs tools/trace2json.py on the file.
+ *
+ *  Usage: trace_capture capture.bin
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "profile.h"
+#include "telemetry.h"
+
+#include <inc/tm4c123gh6pm.h>
+#include <stdio.h>
+#include <time.h>
+
+static FILE *capture_file;
+
+static void capture_output(char c)
+{
+    fputc(c, capture_file);
+}
+
+// What telemetry.c needs from Timer.c
+unsigned int timer_getMillis(void)
+{
+    return profile_now() / PROFILE_TICKS_PER_US / 1000;
+}
+
+/**
+ * Let the clock move on, so every event gets a later time stamp
+ */
+static void capture_pause(void)
+{
+    struct timespec nap = { 0, 50000 };
+    nanosleep(&nap, NULL);
+}
+
+/**
+ * A simulated ISR, the exception number is what the trace records as its context
+ */
+static void capture_isr(uint8_t exception, profile_region_t region)
+{
+    uint32_t interrupted = NVIC_INT_CTRL_R;
+
+    NVIC_INT_CTRL_R = exception;
+    TRACE_BEGIN(region);
+    capture_pause();
+    TRACE_END(region);
+    NVIC_INT_CTRL_R = interrupted;
+}
+
+int main(int argc, char *argv[])
+{
+    int i;
+
+    if (argc < 2 || (capture_file = fopen(argv[1], "wb")) == NULL) {
+        fprintf(stderr, "usage: trace_capture capture.bin\n");
+        return 2;
+    }
+
+    profile_init();
+    trace_init();
+    telemetry_init(capture_output);
+    NVIC_INT_CTRL_R = 0;
+
+    PROFILE_BEGIN(MOTION_LOOP);
+    capture_pause();
+    PROFILE_BEGIN(OI_UPDATE);
+    capture_pause();
+    capture_isr(52, PROFILE_ISR_PING);
+    capture_pause();
+    PROFILE_END(OI_UPDATE);
+    capture_isr(22, PROFILE_ISR_UART);
+    TRACE_INSTANT(BUMP, 3);
+    capture_pause();
+    PROFILE_END(MOTION_LOOP);
+
+    telemetry_sendText("Records before the dump");
+    telemetry_sendTrace();
+    telemetry_sendText("and after it");
+
+    // More events than the ring holds, only the newest TRACE_BUFFER_SIZE are streamed
+    for (i = 0; i < TRACE_BUFFER_SIZE; i++)
+    {
+        PROFILE_BEGIN(PLAN);
+        PROFILE_END(PLAN);
+    }
+    TRACE_INSTANT(STOP_REACHED, 1);
+    telemetry_sendTrace();
+
+    fclose(capture_file);
+    return 0;
+}
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""
+trace_check.py
+
+Runs tools/trace2json.py on a trace captured from the host build
+(trace_capture) and checks the Chrome trace it produces: the dumps arrive
+as TRACE records between other records without a broken frame, the events
+of the known timeline in order, begin/end pairs per thread, ISRs on threads of
+their own with the names from CONTEXT_NAMES, and only the newest events of
+a trace that overflowed the ring. Every ISR the firmware registers with
+IntRegister() must have a thread name.
+
+Usage: trace_check.py [path to trace_capture]
+"""
+
+import glob
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, ".."))
+
+import telemetry  # noqa: E402
+import trace2json  # noqa: E402
+
+TRACE_BUFFER_SIZE = 256  # Must match trace.h
+
+failures = []
+
+
+def check(what, ok):
+    if not ok:
+        failures.append(what)
+        print("%s FAILED" % what)
+
+
+def main():
+    program = sys.argv[1] if len(sys.argv) > 1 else os.path.join(HERE, "trace_capture")
+    with tempfile.TemporaryDirectory() as tmp:
+        capture = os.path.join(tmp, "capture.bin")
+        subprocess.check_call([program, capture])
+        with open(capture, "rb") as f:
+            data = f.read()
+
+    # Framed like every other record
+    decoder = telemetry.Decoder()
+    records = decoder.feed(data)
+    check("no broken frames", decoder.errors == 0 and decoder.lost == 0)
+    check("records around the dumps", [r["text"] for r in records if r["type"] == "text"] ==
+          ["Records before the dump", "and after it"])
+    dumps = telemetry.trace_dumps(data)
+    check("two dumps", len(dumps) == 2)
+
+    # The first dump: the known timeline
+    events, _ = trace2json.parse_block(dumps[0], dumps[0].find(b"CYTR"))
+    timeline = [(e["ph"], e["name"], e["tid"]) for e in events]
+    check("timeline", timeline == [
+        ("B", "move_forward_auto", 0),
+        ("B", "oi_update", 0),
+        ("B", "TIMER3B_Handler", 52),
+        ("E", "TIMER3B_Handler", 52),
+        ("E", "oi_update", 0),
+        ("B", "uart_interrupt_handler", 22),
+        ("E", "uart_interrupt_handler", 22),
+        ("i", "bump", 0),
+        ("E", "move_forward_auto", 0),
+    ])
+    check("bump argument", [e["args"]["arg"] for e in events if e["ph"] == "i"] == [3])
+    check("time order", all(a["ts"] <= b["ts"] for a, b in zip(events, events[1:])))
+    check("loop lasts at least the 5 pauses", events[-1]["ts"] - events[0]["ts"] >= 250)
+
+    # The second block: only the newest TRACE_BUFFER_SIZE events survive the overflow
+    second, _ = trace2json.parse_block(dumps[1], dumps[1].find(b"CYTR"))
+    check("overflowed trace length", len(second) == TRACE_BUFFER_SIZE)
+    check("overflowed trace ends with the marker", second[-1]["name"] == "stop_reached")
+
+    # The whole capture, other records and all, as Chrome trace JSON
+    trace = trace2json.convert(data)
+    threads = {e["tid"]: e["args"]["name"] for e in trace["traceEvents"] if e.get("name") == "thread_name"}
+    check("thread names", threads == {0: "control loop", 22: "UART1 (uart_interrupt_handler)",
+                                      52: "Timer 3B (TIMER3B_Handler)"})
+    check("timeline starts at 0", min(e["ts"] for e in trace["traceEvents"] if "ts" in e) == 0)
+    for tid in threads:
+        depth = 0
+        for e in events:
+            if e["tid"] == tid and e["ph"] in "BE":
+                depth += 1 if e["ph"] == "B" else -1
+                check("end without begin on thread %d" % tid, depth >= 0)
+        check("begin without end on thread %d" % tid, depth == 0)
+
+    # Every registered ISR has a thread name
+    for source in glob.glob(os.path.join(HERE, "..", "..", "*.c")):
+        with open(source) as f:
+            for handler in re.findall(r"IntRegister\(\s*\w+\s*,\s*(\w+)\s*\)", f.read()):
+                check("thread name for %s" % handler,
+                      any("(%s)" % handler in name for name in trace2json.CONTEXT_NAMES.values()))
+
+    print("%d trace events converted: %d failures" % (len(events) + len(second), len(failures)))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,528 @@
+/*
+ * uart_sim.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Simulated UART1, UART4 and uDMA controller for host tests, see
+ *  uart_sim.h. Every access to a data register hands out a cell holding the
+ *  oldest received byte; at the next access to the UART the cell tells
+ *  whether it was written (a byte for the TX FIFO) or read (the byte leaves
+ *  the RX FIFO). Taking the address of a data register counts as a read.
+ *  The simulation advances whenever the firmware looks at the flags, the
+ *  interrupt status or a data register, or reads the clock (profile_now()).
+ */
+
+#include "uart_sim.h"
+#include "udma.h"
+#include "profile.h"
+
+#include <inc/tm4c123gh6pm.h>
+#include "driverlib/interrupt.h"
+
+#define SIM_BYTE_TICKS (86806UL * PROFILE_TICKS_PER_US / 1000) // 10 bits at 115200 baud
+#define SIM_FIFO_SIZE 16
+#define SIM_TX_LEVEL 4              // UART_IFLS_TX2_8, the TX interrupt at or below 1/4 full
+#define SIM_LINE_SIZE 65536         // Bytes recorded or queued per line
+#define SIM_NO_WRITE 0x5A000000     // Reserved bits of a data register, no char converts to them
+
+// Typedef struct - A uDMA channel of the simulated controller
+typedef struct sim_channel
+{
+    uint8_t channel;
+    udma_callback_t done;
+    int pending;    // Started and not serviced yet (udma_busy())
+    int running;    // Still moving bytes
+    int completed;  // Waiting for udma_service()
+    udma_segment_t segments[UDMA_MAX_SEGMENTS]; // Transmit
+    uint8_t count;
+    uint8_t current;
+    uint8_t *dst;   // Receive
+    uint16_t offset;
+} sim_channel_t;
+
+// Typedef struct - A simulated UART and its lines
+typedef struct sim_uart
+{
+    uint8_t vector;
+    uint8_t txChannel;
+    uint8_t rxChannel;
+    volatile uint32_t *lcrh;
+    volatile uint32_t *im;
+    volatile uint32_t *dmactl;
+    volatile uint32_t *rsr;
+
+    uint8_t tx[SIM_FIFO_SIZE];
+    int txHead;
+    int txCount;
+    uint32_t txStart;           // profile_now() when the oldest TX byte started shifting out
+    uint8_t sent[SIM_LINE_SIZE];
+    size_t sentLength;
+    void (*peer)(uint8_t byte);
+
+    uint8_t rx[SIM_FIFO_SIZE];
+    int rxHead;
+    int rxCount;
+    uint8_t incoming[SIM_LINE_SIZE];
+    size_t incomingLength;
+    size_t incomingNext;
+    uint32_t rxStart;           // profile_now() when the next incoming byte started
+
+    volatile uint32_t data;     // Data register cell handed out
+    uint32_t loaded;            // What the cell held when it was handed out
+    int accessed;
+    volatile uint32_t flags;
+    volatile uint32_t status;
+} sim_uart_t;
+
+static sim_channel_t sim_channels[UDMA_MAX_CHANNELS];
+static int sim_numChannels;
+static int sim_dmaStalled;
+static uint32_t sim_isrCount;
+static int sim_busy;        // Advancing, the clock it reads meanwhile must not advance it again
+
+static sim_uart_t sim_uarts[2] = {
+    { .vector = INT_UART1, .txChannel = UDMA_CH_UART1_TX, .rxChannel = UDMA_CH_UART1_RX, .lcrh = &UART1_LCRH_R,
+      .im = &UART1_IM_R, .dmactl = &UART1_DMACTL_R, .rsr = &UART1_RSR_R },
+    { .vector = INT_UART4, .txChannel = UDMA_CH_UART4_TX, .rxChannel = UDMA_CH_UART4_RX, .lcrh = &UART4_LCRH_R,
+      .im = &UART4_IM_R, .dmactl = &UART4_DMACTL_R, .rsr = &UART4_RSR_R },
+};
+
+static sim_uart_t *sim_uart(int uart)
+{
+    return &sim_uarts[uart == SIM_UART4];
+}
+
+static sim_channel_t *sim_find(uint8_t channel)
+{
+    int i;
+
+    for (i = 0; i < sim_numChannels; i++) {
+        if (sim_channels[i].channel == channel) {
+            return &sim_channels[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int sim_depth(const sim_uart_t *u)
+{
+    return (*u->lcrh & UART_LCRH_FEN) != 0 ? SIM_FIFO_SIZE : 1;
+}
+
+static void sim_push(sim_uart_t *u, uint8_t byte)
+{
+    if (u->txCount == sim_depth(u)) {
+        return; // The hardware ignores writes to a full FIFO
+    }
+    if (u->txCount == 0) {
+        u->txStart = profile_now();
+    }
+    u->tx[(u->txHead + u->txCount) % SIM_FIFO_SIZE] = byte;
+    u->txCount++;
+}
+
+static uint8_t sim_pop(sim_uart_t *u)
+{
+    uint8_t byte = u->rx[u->rxHead];
+
+    u->rxHead = (u->rxHead + 1) % SIM_FIFO_SIZE;
+    u->rxCount--;
+    return byte;
+}
+
+/**
+ * Settle the last access to the data register: a write goes into the TX FIFO, a read takes a byte off the RX FIFO
+ */
+static void sim_resolve(sim_uart_t *u)
+{
+    if (!u->accessed) {
+        return;
+    }
+
+    u->accessed = 0;
+    if (u->data != u->loaded) {
+        sim_push(u, u->data & 0xFF);
+    } else if (u->loaded != SIM_NO_WRITE) {
+        sim_pop(u);
+    }
+}
+
+/**
+ * The uDMA moves bytes between the FIFOs and memory as long as the UART requests it
+ */
+static void sim_feed(sim_uart_t *u)
+{
+    sim_channel_t *tx = sim_find(u->txChannel);
+    sim_channel_t *rx = sim_find(u->rxChannel);
+
+    if (sim_dmaStalled) {
+        return;
+    }
+
+    while (tx != NULL && tx->running && (*u->dmactl & UART_DMACTL_TXDMAE) != 0 && u->txCount < sim_depth(u))
+    {
+        const udma_segment_t *segment = &tx->segments[tx->current];
+
+        sim_push(u, ((const uint8_t *)segment->data)[tx->offset++]);
+        if (tx->offset == segment->length) {
+            tx->offset = 0;
+            if (++tx->current == tx->count) {
+                tx->running = 0;
+                tx->completed = 1;
+            }
+        }
+    }
+
+    while (rx != NULL && rx->running && (*u->dmactl & UART_DMACTL_RXDMAE) != 0 && u->rxCount > 0)
+    {
+        rx->dst[rx->offset++] = sim_pop(u);
+        if (rx->offset == rx->segments[0].length) {
+            rx->running = 0;
+            rx->completed = 1;
+        }
+    }
+}
+
+/**
+ * Receive and shift out the bytes whose time has come, the uDMA serving the FIFOs meanwhile
+ */
+static void sim_advance(sim_uart_t *u)
+{
+    if (sim_busy) {
+        return;
+    }
+    sim_busy = 1;
+
+    uint32_t now = profile_now(); // A byte pushed meanwhile starts shifting after now
+
+    sim_resolve(u);
+
+    for (;;)
+    {
+        sim_feed(u);
+        if (u->incomingNext == u->incomingLength || (int32_t)(now - u->rxStart) < (int32_t)SIM_BYTE_TICKS) {
+            break;
+        }
+
+        if (u->rxCount < sim_depth(u)) {
+            u->rx[(u->rxHead + u->rxCount) % SIM_FIFO_SIZE] = u->incoming[u->incomingNext];
+            u->rxCount++;
+        } else {
+            *u->rsr |= UART_RSR_OE; // Nobody read the FIFO in time
+        }
+        u->rxStart += SIM_BYTE_TICKS;
+        if (++u->incomingNext == u->incomingLength) {
+            u->incomingNext = u->incomingLength = 0;
+        }
+    }
+
+    for (;;)
+    {
+        sim_feed(u);
+        if (u->txCount == 0 || (int32_t)(now - u->txStart) < (int32_t)SIM_BYTE_TICKS) {
+            break;
+        }
+
+        uint8_t byte = u->tx[u->txHead];
+        u->txHead = (u->txHead + 1) % SIM_FIFO_SIZE;
+        u->txCount--;
+        u->txStart += SIM_BYTE_TICKS;
+        if (u->sentLength < SIM_LINE_SIZE) {
+            u->sent[u->sentLength++] = byte;
+        }
+        if (u->peer != NULL) {
+            u->peer(byte);
+        }
+    }
+
+    sim_busy = 0;
+}
+
+static uint32_t sim_masked(sim_uart_t *u)
+{
+    sim_channel_t *tx = sim_find(u->txChannel);
+    sim_channel_t *rx = sim_find(u->rxChannel);
+    uint32_t status = 0;
+
+    if ((*u->im & UART_IM_TXIM) != 0 && u->txCount <= SIM_TX_LEVEL) {
+        status |= UART_MIS_TXMIS;
+    }
+    if ((*u->im & (UART_IM_RXIM | UART_IM_RTIM)) != 0 && u->rxCount > 0) {
+        status |= *u->im & (UART_MIS_RXMIS | UART_MIS_RTMIS);
+    }
+    if ((tx != NULL && tx->completed) || (rx != NULL && rx->completed)) {
+        status |= 0x00010000; // DMA completions share the vector, they have no MIS bit of their own here
+    }
+    return status;
+}
+
+/**
+ * The UART vectors, run by host_poll()
+ */
+static void sim_interrupt(void)
+{
+    int i, j;
+
+    for (i = 0; i < 2; i++)
+    {
+        sim_uart_t *u = &sim_uarts[i];
+
+        sim_advance(u);
+        for (j = 0; j < 4 && sim_masked(u) != 0 && host_interrupt(u->vector); j++) {
+            sim_isrCount++;
+            sim_advance(u);
+        }
+    }
+}
+
+/**
+ * Every profile_now(), the hardware runs on while the firmware waits on the clock
+ */
+static void sim_clock(void)
+{
+    if (sim_busy) {
+        return;
+    }
+
+    sim_advance(&sim_uarts[0]);
+    sim_advance(&sim_uarts[1]);
+    host_poll();
+}
+
+volatile uint32_t *host_uartData(int uart)
+{
+    sim_uart_t *u = sim_uart(uart);
+
+    sim_advance(u);
+    u->loaded = u->rxCount > 0 ? SIM_NO_WRITE | u->rx[u->rxHead] : SIM_NO_WRITE;
+    u->data = u->loaded;
+    u->accessed = 1;
+    return &u->data;
+}
+
+volatile uint32_t *host_uartFlags(int uart)
+{
+    sim_uart_t *u = sim_uart(uart);
+
+    sim_advance(u);
+    host_poll();
+
+    u->flags = 0;
+    if (u->txCount == sim_depth(u)) {
+        u->flags |= UART_FR_TXFF;
+    }
+    if (u->txCount > 0) {
+        u->flags |= UART_FR_BUSY;
+    }
+    if (u->rxCount == 0) {
+        u->flags |= UART_FR_RXFE;
+    }
+    return &u->flags;
+}
+
+volatile uint32_t *host_uartStatus(int uart)
+{
+    sim_uart_t *u = sim_uart(uart);
+
+    sim_advance(u);
+    u->status = sim_masked(u) & 0xFFFF;
+    return &u->status;
+}
+
+/**
+ * Empty the FIFOs and the lines, stop every uDMA transfer and take over the interrupts
+ */
+void sim_init(void)
+{
+    int i;
+
+    for (i = 0; i < sim_numChannels; i++) {
+        udma_abort(sim_channels[i].channel);
+    }
+    for (i = 0; i < 2; i++)
+    {
+        sim_uart_t *u = &sim_uarts[i];
+
+        u->txCount = u->rxCount = 0;
+        u->sentLength = u->incomingLength = u->incomingNext = 0;
+        u->accessed = 0;
+        u->peer = NULL;
+        *u->rsr = 0;
+    }
+    sim_dmaStalled = 0;
+    sim_isrCount = 0;
+    host_interruptSource = sim_interrupt;
+    profile_hostClock = sim_clock;
+}
+
+/**
+ * Let the simulation run for a while with interrupts enabled
+ *
+ * @param us - How long (us of profile_now() time)
+ */
+void sim_run(uint32_t us)
+{
+    uint32_t start = profile_now();
+
+    while (profile_now() - start < us * PROFILE_TICKS_PER_US); // sim_clock() runs the UARTs
+}
+
+/**
+ * @param uart - SIM_UART1 or SIM_UART4
+ * @param bytes - Set to what the UART has shifted out so far
+ *
+ * @returns the number of bytes
+ */
+size_t sim_sent(int uart, const uint8_t **bytes)
+{
+    *bytes = sim_uart(uart)->sent;
+    return sim_uart(uart)->sentLength;
+}
+
+/**
+ * Bytes arriving on the RX line, one per byte time after those already on their way
+ */
+void sim_receive(int uart, const void *bytes, size_t length)
+{
+    sim_uart_t *u = sim_uart(uart);
+    size_t i;
+
+    if (u->incomingNext == u->incomingLength) {
+        u->rxStart = profile_now();
+    }
+    for (i = 0; i < length && u->incomingLength < SIM_LINE_SIZE; i++) {
+        u->incoming[u->incomingLength++] = ((const uint8_t *)bytes)[i];
+    }
+}
+
+/**
+ * Give the other end of a line every byte the UART shifts out, as it is shifted out
+ */
+void sim_connect(int uart, void (*peer)(uint8_t byte))
+{
+    sim_uart(uart)->peer = peer;
+}
+
+/**
+ * Stop or resume moving bytes of the uDMA transfers, a stopped transfer never completes
+ */
+void sim_stallDma(int stalled)
+{
+    sim_dmaStalled = stalled;
+}
+
+/**
+ * @returns how often the ISRs of the UARTs were run
+ */
+uint32_t sim_interrupts(void)
+{
+    return sim_isrCount;
+}
+
+/* udma.h, the engine above takes the place of the controller */
+
+void udma_init(void)
+{
+}
+
+int udma_assign(uint8_t channel, uint8_t encoding, udma_callback_t done)
+{
+    sim_channel_t *state = sim_find(channel);
+
+    (void)encoding;
+    if (state == NULL) {
+        if (sim_numChannels >= UDMA_MAX_CHANNELS) {
+            return -1;
+        }
+        state = &sim_channels[sim_numChannels++];
+        state->channel = channel;
+    }
+    state->done = done;
+    return 0;
+}
+
+static void sim_start(sim_channel_t *state)
+{
+    state->current = 0;
+    state->offset = 0;
+    state->completed = 0;
+    state->running = 1;
+    state->pending = 1;
+}
+
+int udma_transmitGather(uint8_t channel, const udma_segment_t *segments, uint8_t count, volatile uint32_t *dst)
+{
+    sim_channel_t *state = sim_find(channel);
+    int i;
+
+    (void)dst;
+    if (state == NULL || count == 0 || count > UDMA_MAX_SEGMENTS || state->pending) {
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        if (segments[i].length == 0 || segments[i].length > UDMA_MAX_TRANSFER) {
+            return -1;
+        }
+        state->segments[i] = segments[i];
+    }
+
+    state->count = count;
+    sim_start(state);
+    return 0;
+}
+
+int udma_transmit(uint8_t channel, const void *src, volatile uint32_t *dst, uint16_t length)
+{
+    udma_segment_t segment = { src, length };
+
+    return udma_transmitGather(channel, &segment, 1, dst);
+}
+
+int udma_receive(uint8_t channel, volatile uint32_t *src, void *dst, uint16_t length)
+{
+    sim_channel_t *state = sim_find(channel);
+
+    (void)src;
+    if (state == NULL || length == 0 || length > UDMA_MAX_TRANSFER || state->pending) {
+        return -1;
+    }
+
+    state->dst = dst;
+    state->segments[0].length = length;
+    sim_start(state);
+    return 0;
+}
+
+bool udma_busy(uint8_t channel)
+{
+    sim_channel_t *state = sim_find(channel);
+
+    return state != NULL && state->pending;
+}
+
+void udma_abort(uint8_t channel)
+{
+    sim_channel_t *state = sim_find(channel);
+
+    if (state != NULL) {
+        state->pending = 0;
+        state->running = 0;
+        state->completed = 0;
+    }
+}
+
+void udma_service(uint8_t channel)
+{
+    sim_channel_t *state = sim_find(channel);
+
+    if (state != NULL && state->completed)
+    {
+        state->completed = 0;
+        state->pending = 0;
+        if (state->done != NULL) {
+            state->done(channel);
+        }
+    }
+}
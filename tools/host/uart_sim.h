@@ -0,0 +1,68 @@
+/*
+ * uart_sim.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Simulated UART1, UART4 and uDMA controller for host tests of uart.c and
+ *  open_interface.c. Each UART shifts one byte every 86.8 us (115200 baud)
+ *  of profile_now() time: out of its TX FIFO onto a recorded line, and in
+ *  from a queue the test fills into its RX FIFO. The FIFOs are 16 bytes deep
+ *  with UART_LCRH_FEN and a single holding register without, the flags, the
+ *  error status and the interrupts follow them, and udma.h is implemented by
+ *  an engine that moves bytes between the FIFOs and memory. The ISRs
+ *  registered with IntRegister() run whenever their interrupt is pending and
+ *  the control loop has interrupts enabled (host_poll()).
+ */
+
+#ifndef UART_SIM_H_
+#define UART_SIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The simulated UARTs, by their number
+#define SIM_UART1 1
+#define SIM_UART4 4
+
+/**
+ * Empty the FIFOs and the lines, stop every uDMA transfer and take over the interrupts
+ */
+void sim_init(void);
+
+/**
+ * Let the simulation run for a while with interrupts enabled
+ *
+ * @param us - How long (us of profile_now() time)
+ */
+void sim_run(uint32_t us);
+
+/**
+ * @param uart - SIM_UART1 or SIM_UART4
+ * @param bytes - Set to what the UART has shifted out so far
+ *
+ * @returns the number of bytes
+ */
+size_t sim_sent(int uart, const uint8_t **bytes);
+
+/**
+ * Bytes arriving on the RX line, one per byte time after those already on their way
+ */
+void sim_receive(int uart, const void *bytes, size_t length);
+
+/**
+ * Give the other end of a line every byte the UART shifts out, as it is shifted out
+ */
+void sim_connect(int uart, void (*peer)(uint8_t byte));
+
+/**
+ * Stop or resume moving bytes of the uDMA transfers, a stopped transfer never completes
+ */
+void sim_stallDma(int stalled);
+
+/**
+ * @returns how often the ISRs of the UARTs were run
+ */
+uint32_t sim_interrupts(void);
+
+#endif /* UART_SIM_H_ */
@@ -0,0 +1,220 @@
+/*
+ * uart_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  The overflow policies of the uart.c transmit ring buffer on the simulated
+ *  UART1 of uart_sim.c: a burst of messages five times the size of the ring
+ *  is sent under each policy, the wire must carry what the policy promises
+ *  and the statistics must account for every byte. Reported per policy are
+ *  the caller's latency per message and the longest (CPU) time interrupts
+ *  were disabled, which must stay short under UART_TX_BLOCK as well. A
+ *  caller that has interrupts disabled must give up after
+ *  UART_TX_BLOCK_MASKED_US. A received character must carry the time of
+ *  its own receive interrupt, not of those that came after it.
+ *
+ *  Usage: uart_test
+ */
+
+#include "uart.h"
+#include "uart_sim.h"
+#include "profile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_MESSAGES 40
+#define TEST_MESSAGE_LENGTH 64
+#define TEST_BYTE_US 87           // One byte on the wire at 115200 baud
+#define TEST_MAX_MASKED_US 1000   // Longest uart.c may keep interrupts disabled, a FIFO takes 1.4 ms
+
+static char test_messages[TEST_MESSAGES][TEST_MESSAGE_LENGTH + 1];
+static uint8_t test_sent[TEST_MESSAGES * TEST_MESSAGE_LENGTH];
+static int test_failed;
+
+// What uart.c needs from Timer.c
+void timer_waitMillis(unsigned int delay_time)
+{
+    (void)delay_time;
+}
+
+static void test_check(const char *policy, const char *what, int ok)
+{
+    if (!ok) {
+        printf("%s: %s FAILED\n", policy, what);
+        test_failed++;
+    }
+}
+
+/**
+ * @returns 1 if the wire holds bytes of the burst in their order, with gaps where bytes were dropped
+ */
+static int test_subsequence(const uint8_t *wire, size_t length)
+{
+    size_t i, j = 0;
+
+    for (i = 0; i < length; i++)
+    {
+        while (j < sizeof(test_sent) && test_sent[j] != wire[i]) {
+            j++;
+        }
+        if (j++ == sizeof(test_sent)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static void test_policy(const char *name, uart_tx_policy_t policy)
+{
+    uart_tx_stats_t before, after;
+    uint32_t latency, latencyTotal = 0, latencyMax = 0, masked;
+    const uint8_t *wire;
+    size_t length;
+    int i;
+
+    sim_init();
+    uart_setTxPolicy(policy);
+    uart_getTxStats(&before);
+    host_maskedMax();
+
+    for (i = 0; i < TEST_MESSAGES; i++)
+    {
+        uint32_t start = profile_now();
+        uart_sendStr(test_messages[i]);
+        latency = profile_now() - start;
+
+        latencyTotal += latency;
+        latencyMax = latency > latencyMax ? latency : latencyMax;
+    }
+    masked = host_maskedMax();
+
+    uart_flush();
+    uart_getTxStats(&after);
+    length = sim_sent(SIM_UART1, &wire);
+
+    uint32_t dropped = after.dropped - before.dropped;
+    uint32_t meanUs = latencyTotal / TEST_MESSAGES / PROFILE_TICKS_PER_US;
+    printf("%-11s %4lu of %lu bytes on the wire, %4lu dropped, %4lu waited, latency per message %5lu us mean %6lu us max, "
+           "interrupts disabled %4lu us at most\n", name, (unsigned long)length, (unsigned long)sizeof(test_sent),
+           (unsigned long)dropped, (unsigned long)(after.blocked - before.blocked), (unsigned long)meanUs,
+           (unsigned long)(latencyMax / PROFILE_TICKS_PER_US), (unsigned long)(masked / 1000));
+
+    test_check(name, "every byte sent or counted as dropped", length + dropped == sizeof(test_sent));
+    test_check(name, "every byte counted as sent", after.sent - before.sent == length);
+    test_check(name, "bytes in order", test_subsequence(wire, length));
+    test_check(name, "interrupts disabled briefly", masked < TEST_MAX_MASKED_US * 1000);
+
+    if (policy == UART_TX_BLOCK) {
+        test_check(name, "nothing dropped", dropped == 0 && length == sizeof(test_sent) &&
+                   memcmp(wire, test_sent, length) == 0);
+        test_check(name, "callers waited with the interrupts running", after.blocked > before.blocked &&
+                   sim_interrupts() > 0);
+        test_check(name, "a message waits at most for a full ring to drain",
+                   latencyMax < 2 * UART_TX_BUFFER_SIZE * TEST_BYTE_US * PROFILE_TICKS_PER_US);
+    } else {
+        test_check(name, "bytes dropped", dropped > 0);
+        test_check(name, "the ring does not overflow before it is full",
+                   length >= UART_TX_BUFFER_SIZE && memcmp(wire, test_sent, UART_TX_BUFFER_SIZE - 1) == 0);
+        test_check(name, "callers do not wait for the wire",
+                   meanUs < TEST_MESSAGE_LENGTH * TEST_BYTE_US / 4);
+    }
+}
+
+/**
+ * A caller with interrupts disabled (an ISR) meets a full ring the uDMA does not drain
+ */
+static void test_masked(void)
+{
+    uart_tx_stats_t before, after;
+    int i;
+
+    sim_init();
+    sim_stallDma(1);
+    uart_setTxPolicy(UART_TX_DROP);
+    for (i = 0; i < UART_TX_BUFFER_SIZE + 16; i++) {
+        uart_sendChar('m');
+    }
+
+    uart_setTxPolicy(UART_TX_BLOCK);
+    uart_getTxStats(&before);
+    bool was_disabled = IntMasterDisable();
+    uint32_t start = profile_now();
+    uart_sendChar('x');
+    uint32_t waited = profile_now() - start;
+    if (!was_disabled) {
+        IntMasterEnable();
+    }
+    uart_getTxStats(&after);
+
+    printf("masked      gave up after %lu us\n", (unsigned long)(waited / PROFILE_TICKS_PER_US));
+    test_check("masked", "byte dropped", after.dropped == before.dropped + 1 && after.queued == before.queued);
+    test_check("masked", "waited UART_TX_BLOCK_MASKED_US", waited >= UART_TX_BLOCK_MASKED_US * PROFILE_TICKS_PER_US &&
+               waited < 10 * UART_TX_BLOCK_MASKED_US * PROFILE_TICKS_PER_US);
+
+    // The transfer moves on again and the ring drains
+    sim_stallDma(0);
+    uart_flush();
+}
+
+/**
+ * Two command lines received one after the other, both read once the second is in
+ */
+static void test_rxTime(void)
+{
+    uint32_t between, first, second;
+    char c;
+
+    sim_init();
+    while (uart_tryReceive(&c));
+
+    sim_receive(SIM_UART1, "1 POSE\r", 7);
+    sim_run(8 * TEST_BYTE_US);
+    between = profile_now();
+    sim_receive(SIM_UART1, "2 POSE\r", 7);
+    sim_run(8 * TEST_BYTE_US);
+
+    while (uart_tryReceive(&c) && c != '\r');
+    first = uart_rxTime();
+    while (uart_tryReceive(&c) && c != '\r');
+    second = uart_rxTime();
+
+    printf("receive     terminators stamped %ld us and %ld us after the first line was in\n",
+           (long)(int32_t)(first - between) / PROFILE_TICKS_PER_US,
+           (long)(int32_t)(second - between) / PROFILE_TICKS_PER_US);
+    test_check("receive", "stamped with its own interrupt", (int32_t)(first - between) <= 0 &&
+               (int32_t)(between - first) < 2 * TEST_BYTE_US * PROFILE_TICKS_PER_US);
+    test_check("receive", "the next line later", (int32_t)(second - between) >= 6 * TEST_BYTE_US * PROFILE_TICKS_PER_US);
+}
+
+int main(void)
+{
+    int i, j;
+
+    for (i = 0; i < TEST_MESSAGES; i++)
+    {
+        for (j = 0; j < TEST_MESSAGE_LENGTH; j++) {
+            test_messages[i][j] = 'A' + (i + j) % 26;
+        }
+        sprintf(test_messages[i], "%02d", i);
+        test_messages[i][2] = ' ';
+        test_messages[i][TEST_MESSAGE_LENGTH - 1] = '\n';
+        memcpy(&test_sent[i * TEST_MESSAGE_LENGTH], test_messages[i], TEST_MESSAGE_LENGTH);
+    }
+
+    profile_init();
+    trace_init();
+    uart_init(115200);
+    uart_interrupt_init();
+
+    test_policy("block", UART_TX_BLOCK);
+    test_policy("drop", UART_TX_DROP);
+    test_policy("drop oldest", UART_TX_DROP_OLDEST);
+    test_masked();
+    test_rxTime();
+
+    printf("%d failures\n", test_failed);
+    return test_failed != 0;
+}
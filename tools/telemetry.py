@@ -0,0 +1,332 @@
+#!/usr/bin/env python3
+"""
+telemetry.py
+
+Decoder for the CyBot binary telemetry (telemetry.h). Usable as a library by
+the control center (Decoder, decode_frame) or from the command line:
+
+  telemetry.py decode capture.bin     print every record in a raw UART1 capture
+  telemetry.py decode -               same, reading the capture from stdin
+  telemetry.py bench                  compare the link throughput of the binary
+                                      records and log messages against text output
+
+Frames are COBS( u8 type, u8 sequence, u32 time ms, body, u16 CRC ) 0x00.
+Bytes between frames that fail the CRC (noise) are skipped. The profile dump
+arrives as TEXT records, the trace dump as TRACE records (see trace_dumps()).
+LOG records are expanded with the format strings from log_msgs.h, AVOID records
+with the state names from avoid.h.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+TELEMETRY_FORMAT_VERSION = 6  # Must match TELEMETRY_FORMAT_VERSION in telemetry.h
+
+LOG_MSGS_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "log_msgs.h")
+AVOID_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "avoid.h")
+
+HELLO = 0
+POSE = 1
+SCAN = 2
+OBSTACLE = 3
+PASSENGERS = 4
+ALERT = 5
+TEXT = 6
+LOG = 7
+ACK = 8
+AVOID = 9
+TRACE = 10
+
+RECORD_NAMES = {HELLO: "hello", POSE: "pose", SCAN: "scan", OBSTACLE: "obstacle",
+                PASSENGERS: "passengers", ALERT: "alert", TEXT: "text", LOG: "log", ACK: "ack",
+                AVOID: "avoid", TRACE: "trace"}
+
+# cmd_verb_t and cmd_status_t, must match cmd.h
+CMD_VERBS = ["START", "STOP", "SPEED", "POSE", "PROFILE", "TRACE", "TELEOP", "DRIVE", "AUTO", "CLEAR"]
+CMD_STATUS = {0: "ok", 1: "unknown verb", 2: "bad argument", 3: "not possible now"}
+
+# telemetry_alert_t
+ALERT_NAMES = {3: "approaching", 4: "stop_reached"}
+
+
+def load_log_messages(path=LOG_MSGS_H):
+    """Read the LOG_MESSAGES table, returns a list of (id, level, format) in message number order"""
+    with open(path) as f:
+        text = f.read()
+    table = text[text.index("#define LOG_MESSAGES(X)"):]
+    return [(ident, level, bytes(fmt, "ascii").decode("unicode_escape"))
+            for ident, level, fmt in re.findall(r'X\(\s*(\w+)\s*,\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', table)]
+
+
+LOG_MESSAGES = load_log_messages() if os.path.exists(LOG_MSGS_H) else []
+
+
+def load_avoid_states(path=AVOID_H):
+    """Read the AVOID_STATES table, returns the state names in avoid_state_t order"""
+    with open(path) as f:
+        text = f.read()
+    table = text[text.index("#define AVOID_STATES(X)"):]
+    table = table[:table.index("\n\n")]
+    return re.findall(r'X\(\s*\w+\s*,\s*"(\w+)"\s*\)', table)
+
+
+AVOID_STATES = load_avoid_states() if os.path.exists(AVOID_H) else []
+
+
+def avoid_state(state):
+    return AVOID_STATES[state] if state < len(AVOID_STATES) else state
+
+
+def format_log(ident, args):
+    if ident >= len(LOG_MESSAGES):
+        return "unknown log message %d %s" % (ident, args)
+    name, level, fmt = LOG_MESSAGES[ident]
+    # Arguments travel as i32, %u and %x show the unsigned view like printf would
+    kinds = re.findall(r"%[-0-9]*([dux])", fmt)
+    args = tuple(a if k == "d" else a & 0xFFFFFFFF for k, a in zip(kinds, args))
+    try:
+        return "%-5s %s" % (level, fmt % args)
+    except TypeError:
+        return "%-5s %s %s" % (level, fmt, args)
+
+
+HEADER = struct.Struct("<BBI")
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, same as telemetry_crc16()"""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code = 0
+    for byte in data:
+        if byte != 0:
+            out.append(byte)
+        if byte == 0 or len(out) - code == 0xFF:
+            out[code] = len(out) - code
+            code = len(out)
+            out.append(0)
+    out[code] = len(out) - code
+    return bytes(out)
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    pos = 0
+    while pos < len(frame):
+        code = frame[pos]
+        if code == 0 or pos + code > len(frame):
+            raise ValueError("bad COBS frame")
+        out += frame[pos + 1:pos + code]
+        pos += code
+        if code < 0xFF and pos < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def encode_record(kind, sequence, time_ms, body):
+    """Build a complete frame the way telemetry_end() does (used by the benchmark)"""
+    record = HEADER.pack(kind, sequence & 0xFF, time_ms & 0xFFFFFFFF) + body
+    record += struct.pack("<H", crc16(record))
+    return cobs_encode(record) + b"\x00"
+
+
+def parse_body(kind, body):
+    if kind == HELLO:
+        return {"version": body[0]}
+    if kind == POSE:
+        x, y, heading = struct.unpack_from("<hhh", body)
+        return {"x_mm": x, "y_mm": y, "heading_deg": heading / 100.0}
+    if kind == SCAN:
+        start, step, count = struct.unpack_from("<BBB", body)
+        return {"start_deg": start, "step_deg": step,
+                "dist_cm": list(struct.unpack_from("<%dH" % count, body, 3))}
+    if kind == OBSTACLE:
+        index, angle, start, end, dist, ping, linear, confidence = struct.unpack_from("<BBBBHHHB", body)
+        return {"index": index, "angle_deg": angle, "start_deg": start, "end_deg": end,
+                "dist_cm": dist, "ping_cm": ping, "linear_width_cm": linear, "confidence": confidence}
+    if kind == PASSENGERS:
+        return {"count": body[0]}
+    if kind == ALERT:
+        return {"alert": ALERT_NAMES.get(body[0], body[0]), "arg": body[1]}
+    if kind == TEXT:
+        return {"text": body.decode("ascii", "replace")}
+    if kind == LOG:
+        ident, logged = struct.unpack_from("<BI", body)
+        args = struct.unpack_from("<%di" % ((len(body) - 5) // 4), body, 5)
+        return {"logged_ms": logged, "message": format_log(ident, args)}
+    if kind == ACK:
+        request, verb, status = struct.unpack_from("<HBB", body)
+        return {"request": request, "verb": CMD_VERBS[verb] if verb < len(CMD_VERBS) else None,
+                "status": CMD_STATUS.get(status, status)}
+    if kind == AVOID:
+        state, previous, spent, attempt, waypoint = struct.unpack_from("<BBIBB", body)
+        return {"state": avoid_state(state), "previous": avoid_state(previous), "spent_ms": spent,
+                "attempt": attempt, "waypoint": waypoint}
+    if kind == TRACE:
+        (offset,) = struct.unpack_from("<H", body)
+        return {"offset": offset, "data": body[2:]}
+    return {"raw": body.hex()}
+
+
+def decode_frame(frame):
+    """Decode one frame without its delimiter, returns a dict or raises ValueError"""
+    record = cobs_decode(frame)
+    if len(record) < HEADER.size + 2:
+        raise ValueError("short frame")
+    if crc16(record[:-2]) != struct.unpack_from("<H", record, len(record) - 2)[0]:
+        raise ValueError("CRC mismatch")
+
+    kind, sequence, time_ms = HEADER.unpack_from(record)
+    try:
+        fields = parse_body(kind, record[HEADER.size:-2])
+    except (struct.error, IndexError):
+        raise ValueError("truncated %s record" % RECORD_NAMES.get(kind, kind))
+
+    if kind == HELLO and fields["version"] != TELEMETRY_FORMAT_VERSION:
+        raise ValueError("unsupported telemetry format version %d" % fields["version"])
+
+    return dict(type=RECORD_NAMES.get(kind, kind), seq=sequence, time_ms=time_ms, **fields)
+
+
+class Decoder(object):
+    """Incremental decoder: feed() raw bytes as they arrive, get back complete records"""
+
+    def __init__(self):
+        self.pending = bytearray()
+        self.errors = 0
+        self.lost = 0
+        self.last_seq = None
+
+    def feed(self, data):
+        records = []
+        self.pending += data
+        while True:
+            end = self.pending.find(b"\x00")
+            if end < 0:
+                return records
+            frame = bytes(self.pending[:end])
+            del self.pending[:end + 1]
+            if not frame:
+                continue
+            try:
+                record = decode_frame(frame)
+            except ValueError:
+                self.errors += 1
+                continue
+            if self.last_seq is not None and record["type"] != "hello":
+                self.lost += (record["seq"] - self.last_seq - 1) & 0xFF
+            self.last_seq = record["seq"]
+            records.append(record)
+
+
+def trace_dumps(data):
+    """The trace_dump() output carried by the TRACE records of a capture, one bytes object per
+    complete dump; a dump missing a record is left out"""
+    dumps = []
+    dump = None
+    for record in Decoder().feed(data):
+        if record["type"] != "trace":
+            continue
+        if record["offset"] == 0:
+            dump = bytearray()
+            dumps.append(dump)
+        elif dump is None or record["offset"] != len(dump):
+            if dump is not None:
+                dumps.remove(dump)
+            dump = None
+            continue
+        dump += record["data"]
+    return [bytes(d) for d in dumps]
+
+
+def decode(args):
+    stream = sys.stdin.buffer if args.capture == "-" else open(args.capture, "rb")
+    decoder = Decoder()
+    with stream:
+        while True:
+            chunk = stream.read(4096)
+            if not chunk:
+                break
+            for record in decoder.feed(chunk):
+                print(record)
+    sys.stderr.write("%d bad frames, %d records lost\n" % (decoder.errors, decoder.lost))
+
+
+def bench(args):
+    """Bytes on the wire per useful payload byte for a typical passenger scan report"""
+    baud = args.baud
+    link = baud / 10.0  # 8N1: 10 bit times per byte
+    objects = [(1, 34, 24, 44, 31, 33, 8), (2, 88, 80, 96, 27, 28, 7), (3, 140, 132, 148, 42, 44, 11)]
+
+    # The old detect_passengers() output
+    text = "\n\rPassenger Count: %d\n\r" % len(objects)
+    text += "\n\r### List of Passengers ###\n\r%-12s%-12s%-12s%-12s%-12s\n\r" % (
+        "Passenger #", "Angle", "IR Distance", "Width", "Linear")
+    for (i, angle, start, end, dist, ping, linear) in objects:
+        text += "%-12d%-12d%-12d%-12d%-12d\n\r" % (i, angle, dist, end - start, linear)
+    text += "\n\r"
+    text += "ALERT! CyRide has hit a short object in the road.\n\r"
+
+    # The same information as records
+    binary = encode_record(PASSENGERS, 0, 1000, struct.pack("<B", len(objects)))
+    for seq, (i, angle, start, end, dist, ping, linear) in enumerate(objects, 1):
+        binary += encode_record(OBSTACLE, seq, 1000,
+                                struct.pack("<BBBBHHHB", i - 1, angle, start, end, dist, ping, linear, 100))
+    binary += encode_record(LOG, 4, 1000, struct.pack("<BIi", 1, 1000, 3))  # LOG(BUMP, 3)
+
+    # Useful data: passenger count, 5 values per object (the text has no ping), the alert
+    useful = 1 + len(objects) * 5 + 1
+    for name, size in (("sprintf text", len(text.encode())), ("binary records", len(binary))):
+        seconds = size / link
+        print("%-16s %5d bytes  %6.1f ms at %d baud  %7.1f useful values/s"
+              % (name, size, seconds * 1000, baud, useful / seconds))
+
+    # Log messages: one LOG record against uart_sendStr() of the expanded text
+    print("\n%-16s %6s %6s" % ("log message", "text", "LOG"))
+    for ident, (name, level, fmt) in enumerate(LOG_MESSAGES):
+        argc = len(re.findall(r"%[dux]", fmt))
+        args = (1,) * argc
+        record = encode_record(LOG, 0, 0, struct.pack("<BI%di" % argc, ident, 0, *args))
+        print("%-16s %6d %6d" % (name, len((fmt % args + "\n\r").encode()), len(record)))
+    print("(caller cost on the CyBot: compare log_write and uart_sendStr in the 'p' profile dump)\n")
+
+    # Pose stream: one record every POSE_PERIOD_MS against a printed "x y heading" line
+    pose = len(encode_record(POSE, 0, 0, struct.pack("<hhh", 1234, -567, 9000)))
+    pose_text = len(("%-12d%-12d%-12.2f\n\r" % (1234, -567, 90.0)).encode())
+    print("%-16s %5d bytes/pose (%d bytes as text), link headroom %.0f poses/s"
+          % ("pose stream", pose, pose_text, link / pose))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command")
+    p = commands.add_parser("decode", help="print the records in a raw UART capture")
+    p.add_argument("capture", help="capture file, - for stdin")
+    p.set_defaults(run=decode)
+    p = commands.add_parser("bench", help="compare binary records with the old text output")
+    p.add_argument("--baud", type=int, default=115200)
+    p.set_defaults(run=bench)
+    args = parser.parse_args()
+
+    if not hasattr(args, "run"):
+        parser.print_help()
+        return 1
+    args.run(args)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+trace2json.py
+
+Convert a binary CyBot trace (sent as TRACE telemetry records after pressing
+'x' or the TRACE command) into Chrome/Perfetto trace JSON. The capture may
+contain other records; every trace dump found in it is converted. A capture
+of trace_dump() output written straight to the UART, with other terminal
+output around it, is converted as well.
+
+Usage: trace2json.py capture.bin [-o trace.json]
+Open the result in chrome://tracing or https://ui.perfetto.dev
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+from telemetry import trace_dumps
+
+TRACE_FORMAT_VERSION = 1  # Must match TRACE_FORMAT_VERSION in trace.h
+
+TYPE_BEGIN = 0
+TYPE_END = 1
+TYPE_INSTANT = 2
+
+# Exception numbers of the ISRs we register (Table 2-9 of the TM4C123 datasheet)
+CONTEXT_NAMES = {
+    0: "control loop",
+    20: "GPIO Port E (button_edgeHandler)",
+    22: "UART1 (uart_interrupt_handler)",
+    39: "Timer 2A (lcd_flushHandler)",
+    46: "GPIO Port F (GPIOF_Handler)",
+    52: "Timer 3B (TIMER3B_Handler)",
+    76: "UART4 (UART4_Handler)",
+    86: "Timer 4A (button_tickHandler)",
+    108: "Timer 5A (timer_clockTickHandler)",
+}
+
+
+def read_names(data, pos):
+    count = data[pos]
+    pos += 1
+    names = []
+    for _ in range(count):
+        length = data[pos]
+        names.append(data[pos + 1:pos + 1 + length].decode("ascii", "replace"))
+        pos += 1 + length
+    return names, pos
+
+
+def parse_block(data, pos):
+    """Parse one trace block starting at the "CYTR" magic, returns (events, end position)"""
+    pos += 4
+    version, ticks_per_us = struct.unpack_from("<BH", data, pos)
+    pos += 3
+    if version != TRACE_FORMAT_VERSION:
+        raise ValueError("unsupported trace format version %d" % version)
+
+    regions, pos = read_names(data, pos)
+    markers, pos = read_names(data, pos)
+    (count,) = struct.unpack_from("<H", data, pos)
+    pos += 2
+
+    events = []
+    offset = 0
+    previous = None
+    for _ in range(count):
+        time, kind, ident, context, arg = struct.unpack_from("<IBBBB", data, pos)
+        pos += 8
+
+        # The tick counter is 32 bits, unwrap it (small backwards steps are ISR reordering)
+        if previous is not None and time < previous and previous - time > 0x80000000:
+            offset += 1 << 32
+        previous = time
+        ts = (time + offset) / float(ticks_per_us)
+
+        event = {"pid": 1, "tid": context, "ts": ts}
+        if kind == TYPE_BEGIN:
+            event.update(ph="B", name=regions[ident])
+        elif kind == TYPE_END:
+            event.update(ph="E", name=regions[ident])
+        elif kind == TYPE_INSTANT:
+            event.update(ph="i", s="t", name=markers[ident], args={"arg": arg})
+        else:
+            continue
+        events.append(event)
+
+    return events, pos
+
+
+def convert(data):
+    events = []
+    contexts = set()
+    # The bytes of the dumps in a telemetry capture, or the raw capture itself
+    for dump in trace_dumps(data) or [data]:
+        pos = dump.find(b"CYTR")
+        while pos >= 0:
+            block, pos = parse_block(dump, pos)
+            events.extend(block)
+            pos = dump.find(b"CYTR", pos)
+
+    if events:
+        # Start the timeline at zero
+        start = min(e["ts"] for e in events)
+        for e in events:
+            e["ts"] -= start
+            contexts.add(e["tid"])
+
+    for context in sorted(contexts):
+        name = CONTEXT_NAMES.get(context, "exception %d" % context)
+        events.append({"ph": "M", "pid": 1, "tid": context, "name": "thread_name",
+                       "args": {"name": name}})
+    events.append({"ph": "M", "pid": 1, "name": "process_name", "args": {"name": "CyBot"}})
+
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="raw UART1 capture containing the trace dumps")
+    parser.add_argument("-o", "--output", help="JSON file to write (default: stdout)")
+    args = parser.parse_args()
+
+    with open(args.capture, "rb") as f:
+        trace = convert(f.read())
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
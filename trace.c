@@ -0,0 +1,148 @@
+/*
+ * trace.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "trace.h"
+#include "profile.h"
+
+#include <string.h>
+#include <inc/tm4c123gh6pm.h>
+
+// The host build backs the register with memory, so a simulated ISR can set its exception number
+#define TRACE_CONTEXT() (NVIC_INT_CTRL_R & NVIC_INT_CTRL_VEC_ACT_M)
+
+#if defined(__linux__)
+#define TRACE_LOCK() 1
+#define TRACE_UNLOCK(was_disabled) ((void)(was_disabled))
+#else
+#include <stdbool.h>
+#include "driverlib/interrupt.h"
+
+#define TRACE_LOCK() IntMasterDisable()
+#define TRACE_UNLOCK(was_disabled) if (!(was_disabled)) IntMasterEnable()
+#endif
+
+static trace_event_t trace_buffer[TRACE_BUFFER_SIZE];
+static volatile uint32_t trace_head;  // Total number of events recorded since trace_init()
+static volatile char trace_paused;
+
+static const char *const trace_marker_names[TRACE_NUM_MARKERS] = {
+#define TRACE_NAME(id, name) name,
+    TRACE_MARKERS(TRACE_NAME)
+#undef TRACE_NAME
+};
+
+/**
+ * Empty the trace buffer and start recording
+ */
+void trace_init(void)
+{
+    memset(trace_buffer, 0, sizeof(trace_buffer));
+    trace_head = 0;
+    trace_paused = 0;
+}
+
+/**
+ * Append one event to the trace buffer, safe to call from an ISR
+ *
+ * @param type - trace_type_t of the event
+ * @param id - Profile region (begin/end) or trace marker (instant)
+ * @param arg - Extra value shown with instant events
+ */
+void trace_record(uint8_t type, uint8_t id, uint8_t arg)
+{
+    if (trace_paused) {
+        return;
+    }
+
+    // Claim the slot and stamp it together so events stay in time order across ISRs
+    int was_disabled = TRACE_LOCK();
+    trace_event_t *event = &trace_buffer[trace_head & (TRACE_BUFFER_SIZE - 1)];
+    event->time = profile_now();
+    trace_head++;
+    TRACE_UNLOCK(was_disabled);
+
+    event->type = type;
+    event->id = id;
+    event->context = TRACE_CONTEXT();
+    event->arg = arg;
+}
+
+/**
+ * Write a little-endian integer of the given size
+ */
+static void trace_writeInt(void (*output)(char), uint32_t value, int bytes)
+{
+    while (bytes-- > 0) {
+        output((char)(value & 0xFF));
+        value >>= 8;
+    }
+}
+
+/**
+ * Write a length prefixed name
+ */
+static void trace_writeName(void (*output)(char), const char *name)
+{
+    int len = strlen(name);
+
+    output((char)len);
+    while (*name != '\0') {
+        output(*name++);
+    }
+}
+
+/**
+ * Stream the buffered events as a binary trace (see tools/trace2json.py)
+ * Recording is paused while the trace is streamed and the buffer is emptied afterwards
+ *
+ * Layout (little-endian):
+ *   "CYTR", u8 version, u16 ticks per microsecond,
+ *   u8 region count, names..., u8 marker count, names...,
+ *   u16 event count, events (u32 time, u8 type, u8 id, u8 context, u8 arg)
+ *
+ * @param output - Function each byte is written through (telemetry_sendTrace() on the CyBot)
+ */
+void trace_dump(void (*output)(char))
+{
+    uint32_t i;
+
+    trace_paused = 1;
+
+    uint32_t count = trace_head < TRACE_BUFFER_SIZE ? trace_head : TRACE_BUFFER_SIZE;
+    uint32_t first = trace_head - count;
+
+    output('C');
+    output('Y');
+    output('T');
+    output('R');
+    trace_writeInt(output, TRACE_FORMAT_VERSION, 1);
+    trace_writeInt(output, PROFILE_TICKS_PER_US, 2);
+
+    trace_writeInt(output, PROFILE_NUM_REGIONS, 1);
+    for (i = 0; i < PROFILE_NUM_REGIONS; i++) {
+        trace_writeName(output, profile_name((profile_region_t)i));
+    }
+
+    trace_writeInt(output, TRACE_NUM_MARKERS, 1);
+    for (i = 0; i < TRACE_NUM_MARKERS; i++) {
+        trace_writeName(output, trace_marker_names[i]);
+    }
+
+    trace_writeInt(output, count, 2);
+    for (i = 0; i < count; i++) {
+        const trace_event_t *event = &trace_buffer[(first + i) & (TRACE_BUFFER_SIZE - 1)];
+
+        trace_writeInt(output, event->time, 4);
+        trace_writeInt(output, event->type, 1);
+        trace_writeInt(output, event->id, 1);
+        trace_writeInt(output, event->context, 1);
+        trace_writeInt(output, event->arg, 1);
+    }
+
+    trace_head = 0;
+    trace_paused = 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * trace.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Timeline trace of the firmware: a RAM ring buffer of timestamped
+ *  begin/end/instant events that can be streamed out over UART1 and
+ *  converted to Chrome/Perfetto trace JSON with tools/trace2json.py.
+ *  Every PROFILE_BEGIN/PROFILE_END marker also records a begin/end event,
+ *  the _UNTRACED markers of ISRs that run every few microseconds do not.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+
+// Comment out to compile every trace event out of the firmware
+#define TRACE_ENABLE
+
+// Number of events kept (power of two), the oldest events are overwritten
+#define TRACE_BUFFER_SIZE 256
+
+// Bumped whenever the streamed format changes, checked by tools/trace2json.py
+#define TRACE_FORMAT_VERSION 1
+
+/**
+ * Instant events that can be marked on the timeline, X(id, name)
+ */
+#define TRACE_MARKERS(X) \
+    X(BUMP,          "bump") \
+    X(CLIFF,         "cliff") \
+    X(STOP_REQUEST,  "stop_request") \
+    X(STOP_REACHED,  "stop_reached") \
+    X(LEG_START,     "leg_start")
+
+typedef enum
+{
+#define TRACE_ENUM(id, name) TRACE_##id,
+    TRACE_MARKERS(TRACE_ENUM)
+#undef TRACE_ENUM
+    TRACE_NUM_MARKERS
+} trace_marker_t;
+
+typedef enum
+{
+    TRACE_TYPE_BEGIN = 0,   // id is a profile_region_t
+    TRACE_TYPE_END = 1,     // id is a profile_region_t
+    TRACE_TYPE_INSTANT = 2  // id is a trace_marker_t
+} trace_type_t;
+
+// Typedef struct - One 8 byte timeline event
+typedef struct trace_event
+{
+    uint32_t time;    // profile_now() ticks
+    uint8_t type;     // trace_type_t
+    uint8_t id;
+    uint8_t context;  // Active exception number, 0 for thread mode
+    uint8_t arg;
+} trace_event_t;
+
+#ifdef TRACE_ENABLE
+#define TRACE_BEGIN(region) trace_record(TRACE_TYPE_BEGIN, (region), 0)
+#define TRACE_END(region) trace_record(TRACE_TYPE_END, (region), 0)
+#define TRACE_INSTANT(marker, arg) trace_record(TRACE_TYPE_INSTANT, TRACE_##marker, (arg))
+#else
+#define TRACE_BEGIN(region) ((void)0)
+#define TRACE_END(region) ((void)0)
+#define TRACE_INSTANT(marker, arg) ((void)0)
+#endif
+
+/**
+ * Empty the trace buffer and start recording
+ */
+void trace_init(void);
+
+/**
+ * Append one event to the trace buffer, safe to call from an ISR
+ *
+ * @param type - trace_type_t of the event
+ * @param id - Profile region (begin/end) or trace marker (instant)
+ * @param arg - Extra value shown with instant events
+ */
+void trace_record(uint8_t type, uint8_t id, uint8_t arg);
+
+/**
+ * Stream the buffered events as a binary trace (see tools/trace2json.py)
+ * Recording is paused while the trace is streamed and the buffer is emptied afterwards
+ *
+ * @param output - Function each byte is written through (telemetry_sendTrace() on the CyBot)
+ */
+void trace_dump(void (*output)(char));
+
+#endif /* TRACE_H_ */
@@ -4,16 +4,81 @@
 */
 
 #include "uart.h"
-#include "timer.h"
+#include "Timer.h"
 #include "lcd.h"
+#include "profile.h"
 
 volatile char uart_data;
 
+#define UART_TX_MASK (UART_TX_BUFFER_SIZE - 1)
+
+/* Transmit ring buffer, filled by callers and drained by the TX interrupt */
+static volatile char uart_tx_buffer[UART_TX_BUFFER_SIZE];
+static volatile uint16_t uart_tx_head; // Next slot to write
+static volatile uint16_t uart_tx_tail; // Next slot to transmit
+static uart_tx_policy_t uart_tx_policy = UART_TX_BLOCK;
+static uart_tx_stats_t uart_tx_stats;
+
+/* uDMA state of the transmitter */
+static volatile char uart_tx_dma_active;      // A DMA transfer owns the transmitter
+static volatile uint16_t uart_tx_dma_len;     // Ring bytes being sent by DMA (0 for a gather transfer)
+static volatile uint16_t uart_tx_gather_len;  // Bytes of the running uart_sendGather() transfer
+static volatile uint32_t uart_tx_dma_start;   // profile_now() when the transfer started
+static void (*uart_tx_gather_done)(void);     // Completion of a uart_sendGather() transfer
+
+/* Receive ring buffer, filled by the RX interrupt and read by the command parser */
+static volatile char uart_rx_buffer[UART_RX_BUFFER_SIZE];
+static volatile uint16_t uart_rx_head; // Next slot to write
+static volatile uint16_t uart_rx_tail; // Next slot to read
+static volatile uint32_t uart_rx_dropped;
+static volatile uint32_t uart_rx_times[UART_RX_BUFFER_SIZE]; // profile_now() of the receive interrupt, per slot
+static uint32_t uart_rx_taken;          // That of the character uart_tryReceive() took last
+
+static void uart_txFill(void);
+
+/**
+ * End of a UART1 uDMA transmit, counted as sent when it completed and as dropped when it was abandoned
+ * Must be called with interrupts disabled or from the UART1 ISR
+ */
+static void uart_txDmaEnd(int completed)
+{
+    uint16_t length = uart_tx_dma_len != 0 ? uart_tx_dma_len : uart_tx_gather_len;
+
+    if (completed) {
+        uart_tx_stats.sent += length;
+    } else {
+        uart_tx_stats.dropped += length;
+        uart_tx_stats.dmaTimeouts++;
+    }
+
+    if (uart_tx_dma_len != 0) {
+        // Release the ring bytes the DMA has sent
+        uart_tx_tail = (uart_tx_tail + uart_tx_dma_len) & UART_TX_MASK;
+        uart_tx_dma_len = 0;
+    } else if (uart_tx_gather_done != NULL) {
+        uart_tx_gather_done();
+        uart_tx_gather_done = NULL;
+    }
+    uart_tx_gather_len = 0;
+    uart_tx_dma_active = 0;
+}
+
+/**
+ * uDMA completion of a UART1 transmit, runs in the UART1 ISR
+ */
+static void uart_txDmaDone(uint8_t channel)
+{
+    (void)channel;
+    uart_txDmaEnd(1);
+    uart_txFill(); // Continue with whatever was queued meanwhile
+}
+
 /**
  * Initialize the UART module
  */
 void uart_init(int baud)
 {
+    (void)baud; // The divisors below are fixed for 115200
     // Enable UART Module with RCGCUART
     SYSCTL_RCGCUART_R |= 0b00000010;
 
@@ -55,45 +120,274 @@ void uart_init(int baud)
     UART1_CTL_R &= 0xFFF0; // disable UART1 (page 918)
     UART1_IBRD_R = ibrd; // write integer portion of BRD to IBRD
     UART1_FBRD_R = fbrd; // write fractional portion of BRD to FBRD
-    UART1_LCRH_R = 0b01100000; // write serial communication parameters (page 916) * 8bit and no parity
+    UART1_LCRH_R = 0b01110000; // write serial communication parameters (page 916) * 8bit, no parity, FIFOs on
+    UART1_IFLS_R = UART_IFLS_TX2_8 | UART_IFLS_RX2_8; // TX interrupt at 1/4 full, RX at 1/4 full (page 920)
     UART1_CC_R   = 0x0; // use system clock as clock source (page 939)
+    UART1_DMACTL_R |= UART_DMACTL_TXDMAE; // let the uDMA serve the TX FIFO (page 936)
     UART1_CTL_R |= 0x0001; // enable UART1
+
+    udma_init();
+    udma_assign(UDMA_CH_UART1_TX, 0, uart_txDmaDone);
 }
 
 /**
- * Send a character to the Serial terminal (PuTTY)
+ * Move queued characters into the TX FIFO until it is full or the ring buffer is empty
+ * Must be called with interrupts disabled or from the UART1 ISR
+ */
+static void uart_txFill(void)
+{
+    // profile_now() also advances with interrupts disabled, timer_getMillis() needs the Timer5 ISR
+    if (uart_tx_dma_active &&
+        profile_now() - uart_tx_dma_start >= UART_TX_DMA_TIMEOUT_MS * 1000UL * PROFILE_TICKS_PER_US) {
+        // Stuck, give the transmitter back to the ring buffer
+        udma_abort(UDMA_CH_UART1_TX);
+        uart_txDmaEnd(0);
+    }
+    if (uart_tx_dma_active) {
+        // The DMA completion restarts the transmitter
+        UART1_IM_R &= ~UART_IM_TXIM;
+        return;
+    }
+
+    // Long contiguous runs are handed to the uDMA instead of being copied byte by byte
+    uint16_t run = (uart_tx_tail <= uart_tx_head ? uart_tx_head : UART_TX_BUFFER_SIZE) - uart_tx_tail;
+    if (run >= UART_TX_DMA_MIN)
+    {
+        uart_tx_dma_active = 1;
+        uart_tx_dma_len = run;
+        uart_tx_dma_start = profile_now();
+        udma_transmit(UDMA_CH_UART1_TX, (const void *)&uart_tx_buffer[uart_tx_tail], &UART1_DR_R, run);
+        UART1_IM_R &= ~UART_IM_TXIM;
+        return;
+    }
+
+    while (uart_tx_tail != uart_tx_head && (UART1_FR_R & UART_FR_TXFF) == 0)
+    {
+        UART1_DR_R = uart_tx_buffer[uart_tx_tail];
+        uart_tx_tail = (uart_tx_tail + 1) & UART_TX_MASK;
+        uart_tx_stats.sent++;
+    }
+
+    // The TX interrupt fires when the FIFO drains past its level, only needed while bytes are waiting
+    if (uart_tx_tail != uart_tx_head) {
+        UART1_IM_R |= UART_IM_TXIM;
+    } else {
+        UART1_IM_R &= ~UART_IM_TXIM;
+    }
+}
+
+/**
+ * Queue a character for the Serial terminal (PuTTY)
+ * Returns as soon as the character is buffered, the UART1 TX interrupt sends it
  */
 void uart_sendChar(char data)
 {
-   // Only transmit when FIFO is empty
-   while ((UART1_FR_R & 0x20) != 0);
-   UART1_DR_R = data;
+    bool was_disabled = IntMasterDisable();
+    uint16_t next = (uart_tx_head + 1) & UART_TX_MASK;
+
+    if (next == uart_tx_tail)
+    {
+        // Ring buffer full, apply the overflow policy
+        if (uart_tx_policy == UART_TX_DROP) {
+            uart_tx_stats.dropped++;
+            if (!was_disabled) {
+                IntMasterEnable();
+            }
+            return;
+        } else if (uart_tx_policy == UART_TX_DROP_OLDEST && !uart_tx_dma_active) {
+            uart_tx_tail = (uart_tx_tail + 1) & UART_TX_MASK;
+            uart_tx_stats.dropped++;
+        } else if (uart_tx_policy == UART_TX_DROP_OLDEST) {
+            // The oldest bytes belong to the running DMA transfer, drop the new one instead
+            uart_tx_stats.dropped++;
+            if (!was_disabled) {
+                IntMasterEnable();
+            }
+            return;
+        } else {
+            uint32_t start = profile_now();
+
+            uart_tx_stats.blocked++;
+            while (next == uart_tx_tail)
+            {
+                if (!was_disabled) {
+                    // Wait with interrupts on, the TX and uDMA interrupts make room meanwhile
+                    IntMasterEnable();
+                    IntMasterDisable();
+                } else if (profile_now() - start >= UART_TX_BLOCK_MASKED_US * PROFILE_TICKS_PER_US) {
+                    // Called with interrupts off (from an ISR), do not hold them off any longer
+                    uart_tx_stats.dropped++;
+                    return;
+                }
+
+                // Feed the FIFO ourselves in case the interrupts cannot run, at most a FIFO's worth
+                // of bytes, and end a stuck uDMA transfer
+                udma_service(UDMA_CH_UART1_TX);
+                uart_txFill();
+            }
+        }
+    }
+
+    uart_tx_buffer[uart_tx_head] = data;
+    uart_tx_head = next;
+    uart_tx_stats.queued++;
+
+    uint16_t used = (uart_tx_head - uart_tx_tail) & UART_TX_MASK;
+    if (used > uart_tx_stats.highWater) {
+        uart_tx_stats.highWater = used;
+    }
+
+    uart_txFill(); // Start transmitting right away if the FIFO has room
+
+    if (!was_disabled) {
+        IntMasterEnable();
+    }
+}
+
+/**
+ * Take a received character without waiting
+ *
+ * @param data - Set to the character
+ *
+ * @returns 1 if a character was available, 0 if the receive buffer is empty
+ */
+int uart_tryReceive(char *data)
+{
+    if (uart_rx_tail == uart_rx_head) {
+        return 0;
+    }
+
+    *data = uart_rx_buffer[uart_rx_tail];
+    uart_rx_taken = uart_rx_times[uart_rx_tail];
+    uart_rx_tail = (uart_rx_tail + 1) & (UART_RX_BUFFER_SIZE - 1);
+    return 1;
+}
+
+/**
+ * @returns profile_now() when the character uart_tryReceive() took last was received
+ */
+uint32_t uart_rxTime(void)
+{
+    return uart_rx_taken;
 }
 
 /**
- * Receive a character from the Serial terminal (from PuTTY)
+ * Receive a character from the Serial terminal (from PuTTY), waits until one arrives
  */
 char uart_receive(void)
 {
     char data;
 
-    // Only receive when FIFO read is not empty
-    while ((UART1_FR_R & 0x10) != 0);
-    data = (char)(UART1_DR_R & 0xFF);
+    while (!uart_tryReceive(&data));
 
     return data;
 }
 
 /**
- * Send a string over UART (multiple character input)
+ * Queue a string for the Serial terminal (multiple character input)
  */
 void uart_sendStr(const char *data)
 {
+    PROFILE_BEGIN(UART_SEND);
+
     while(*data != '\0')
     {
         uart_sendChar(*data);
         data++;
     }
+
+    PROFILE_END(UART_SEND);
+}
+
+/**
+ * Transmit several buffers back to back without copying them (uDMA scatter/gather)
+ * When the transmitter is busy the buffers are queued as copies instead
+ *
+ * @param segments - Buffers to send in order, at most UDMA_MAX_SEGMENTS
+ * @param count - Number of segments
+ * @param done - Called once the buffers may be reused, may be NULL
+ */
+void uart_sendGather(const udma_segment_t *segments, uint8_t count, void (*done)(void))
+{
+    bool was_disabled = IntMasterDisable();
+    int i, j;
+
+    if (!uart_tx_dma_active && uart_tx_tail == uart_tx_head)
+    {
+        uart_tx_dma_active = 1;
+        uart_tx_dma_len = 0;
+        uart_tx_gather_len = 0;
+        uart_tx_dma_start = profile_now();
+        uart_tx_gather_done = done;
+
+        if (udma_transmitGather(UDMA_CH_UART1_TX, segments, count, &UART1_DR_R) == 0) {
+            // Sent once the transfer completes, see uart_txDmaEnd()
+            for (i = 0; i < count; i++) {
+                uart_tx_stats.queued += segments[i].length;
+                uart_tx_gather_len += segments[i].length;
+            }
+
+            if (!was_disabled) {
+                IntMasterEnable();
+            }
+            return;
+        }
+
+        uart_tx_dma_active = 0;
+        uart_tx_gather_done = NULL;
+    }
+
+    if (!was_disabled) {
+        IntMasterEnable();
+    }
+
+    for (i = 0; i < count; i++) {
+        const char *data = (const char *)segments[i].data;
+        for (j = 0; j < segments[i].length; j++) {
+            uart_sendChar(data[j]);
+        }
+    }
+
+    if (done != NULL) {
+        done();
+    }
+}
+
+/**
+ * Wait until every queued character has been transmitted
+ */
+void uart_flush(void)
+{
+    while (uart_tx_dma_active || uart_tx_tail != uart_tx_head || (UART1_FR_R & UART_FR_BUSY) != 0)
+    {
+        // Also ends a stuck uDMA transfer, see uart_txFill()
+        bool was_disabled = IntMasterDisable();
+        uart_txFill();
+        if (!was_disabled) {
+            IntMasterEnable();
+        }
+    }
+}
+
+/**
+ * Choose what happens when the transmit ring buffer is full (UART_TX_BLOCK by default)
+ */
+void uart_setTxPolicy(uart_tx_policy_t policy)
+{
+    uart_tx_policy = policy;
+}
+
+/**
+ * Copy the transmit ring buffer statistics
+ */
+void uart_getTxStats(uart_tx_stats_t *stats)
+{
+    bool was_disabled = IntMasterDisable();
+    *stats = uart_tx_stats;
+
+    if (!was_disabled) {
+        IntMasterEnable();
+    }
 }
 
 /**
@@ -102,7 +396,8 @@ void uart_sendStr(const char *data)
 void uart_interrupt_init()
 {
     // Enable interrupts for receiving bytes through UART1
-    UART1_IM_R |= 0b000000010000; //enable interrupt on receive - page 924
+    UART1_IM_R |= UART_IM_RXIM | UART_IM_RTIM; //enable interrupt on receive and receive timeout - page 924
+    // The TX interrupt is enabled by uart_txFill() only while characters are queued
 
     // Find the NVIC enable register and bit responsible for UART1 in table 2-9
     // Note: NVIC register descriptions are found in chapter 3.4
@@ -118,18 +413,37 @@ void uart_interrupt_init()
  */
 void uart_interrupt_handler()
 {
-    // STEP 1: Check the Masked Interrupt Status
-    if (UART1_MIS_R & 0b000000010000) {
-        // STEP 2:  Copy the data
-        uart_data = (char)(UART1_DR_R & 0xFF);
-
-        if (uart_data == ' ') {
-            oi_play_song(0); // Stop Requested Tone
-            lcd_printf("STOP REQUESTED");
-            uart_sendStr("Stop Requested\n\r");
-            STOP_FLAG = 1;
+    PROFILE_BEGIN(ISR_UART);
+
+    // uDMA transmit completions arrive on the UART1 vector
+    udma_service(UDMA_CH_UART1_TX);
+
+    // STEP 1: Check the Masked Interrupt Status (FIFO past its level, or a partial FIFO timed out)
+    if (UART1_MIS_R & (UART_MIS_RXMIS | UART_MIS_RTMIS)) {
+        UART1_ICR_R |= (UART_ICR_RXIC | UART_ICR_RTIC); // STEP 2: Interrupt Clear
+
+        // STEP 3: Copy the data, the FIFO may hold several characters
+        // Commands are parsed at thread level by cmd_poll()
+        uint32_t now = profile_now();
+        while ((UART1_FR_R & UART_FR_RXFE) == 0) {
+            uart_data = (char)(UART1_DR_R & 0xFF);
+
+            uint16_t next = (uart_rx_head + 1) & (UART_RX_BUFFER_SIZE - 1);
+            if (next == uart_rx_tail) {
+                uart_rx_dropped++;
+            } else {
+                uart_rx_buffer[uart_rx_head] = uart_data;
+                uart_rx_times[uart_rx_head] = now;
+                uart_rx_head = next;
+            }
         }
+    }
 
-        UART1_ICR_R |= 0b00010000; // STEP 3: Interrupt Clear
+    // TX FIFO drained past its level, refill it from the ring buffer
+    if (UART1_MIS_R & UART_MIS_TXMIS) {
+        UART1_ICR_R |= UART_ICR_TXIC;
+        uart_txFill();
     }
+
+    PROFILE_END(ISR_UART);
 }
@@ -13,34 +13,113 @@
 #include <stdbool.h>
 #include <inc/tm4c123gh6pm.h>
 #include "driverlib/interrupt.h"
+#include "udma.h"
 
 // These two varbles have been declared
 // in the file containing main
 extern volatile  char uart_data;  // Your UART interrupt code can place read data here
-extern volatile  char STOP_FLAG;
+extern volatile  char STOP_FLAG;  // Requested stops, bit n for stop n and bit 0 for the next stop
 extern volatile  char STOP_FLAG_2;
 extern volatile  char STOP_FLAG_3;
 
+// Size of the transmit ring buffer in bytes (power of two)
+#define UART_TX_BUFFER_SIZE 512
+
+// Size of the receive ring buffer in bytes (power of two)
+#define UART_RX_BUFFER_SIZE 64
+
+// Contiguous queued bytes at or above this count are sent by uDMA instead of the TX interrupt
+#define UART_TX_DMA_MIN 16
+
+// A uDMA transfer still running after this long is abandoned (1024 bytes take 89 ms at 115200)
+#define UART_TX_DMA_TIMEOUT_MS 200
+
+// Longest uart_sendChar() waits for room with interrupts disabled by its caller (6 bytes at 115200)
+#define UART_TX_BLOCK_MASKED_US 500
+
+/**
+ * What uart_sendChar() does when the transmit ring buffer is full
+ */
+typedef enum
+{
+    UART_TX_DROP,        // Discard the new byte
+    UART_TX_DROP_OLDEST, // Discard the oldest queued byte to make room
+    UART_TX_BLOCK        // Wait for room with interrupts enabled, callers that have them disabled
+                         // wait at most UART_TX_BLOCK_MASKED_US, then the new byte is discarded
+} uart_tx_policy_t;
+
+// Typedef struct - Transmit ring buffer statistics
+typedef struct uart_tx_stats
+{
+    uint32_t queued;     // Bytes accepted into the ring buffer
+    uint32_t sent;       // Bytes moved into the hardware FIFO, by uDMA once the transfer completed
+    uint32_t dropped;    // Bytes discarded by the overflow policy or by an abandoned uDMA transfer
+    uint32_t blocked;    // Bytes that had to wait for room
+    uint16_t highWater;  // Most bytes ever queued at once
+    uint16_t dmaTimeouts; // uDMA transfers abandoned after UART_TX_DMA_TIMEOUT_MS
+} uart_tx_stats_t;
+
 /**
  * Initialize the UART module
  */
 void uart_init(int baud);
 
 /**
- * Send a character to the Serial terminal (PuTTY)
+ * Queue a character for the Serial terminal (PuTTY)
+ * Returns as soon as the character is buffered, the UART1 TX interrupt sends it
  */
 void uart_sendChar(char data);
 
 /**
- * Receive a character from the Serial terminal (from PuTTY)
+ * Take a received character without waiting
+ *
+ * @param data - Set to the character
+ *
+ * @returns 1 if a character was available, 0 if the receive buffer is empty
+ */
+int uart_tryReceive(char *data);
+
+/**
+ * @returns profile_now() when the character uart_tryReceive() took last was received
+ * (the receive interrupt that read it out of the FIFO)
+ */
+uint32_t uart_rxTime(void);
+
+/**
+ * Receive a character from the Serial terminal (from PuTTY), waits until one arrives
  */
 char uart_receive(void);
 
 /**
- * Send a string over UART (multiple character input)
+ * Queue a string for the Serial terminal (multiple character input)
  */
 void uart_sendStr(const char *data);
 
+/**
+ * Transmit several buffers back to back without copying them (uDMA scatter/gather)
+ * When the transmitter is busy the buffers are queued as copies instead
+ *
+ * @param segments - Buffers to send in order, at most UDMA_MAX_SEGMENTS
+ * @param count - Number of segments
+ * @param done - Called once the buffers may be reused, may be NULL
+ */
+void uart_sendGather(const udma_segment_t *segments, uint8_t count, void (*done)(void));
+
+/**
+ * Wait until every queued character has been transmitted
+ */
+void uart_flush(void);
+
+/**
+ * Choose what happens when the transmit ring buffer is full (UART_TX_BLOCK by default)
+ */
+void uart_setTxPolicy(uart_tx_policy_t policy);
+
+/**
+ * Copy the transmit ring buffer statistics
+ */
+void uart_getTxStats(uart_tx_stats_t *stats);
+
 /**
  * Initialize the UART interrupt
  */
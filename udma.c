@@ -0,0 +1,276 @@
+/*
+ * udma.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "udma.h"
+#include "driverlib/interrupt.h"
+
+#include <stddef.h>
+
+#define UDMA_ALT_OFFSET 32 // Alternate control structures start 512 bytes (32 entries) into the table
+
+// Typedef struct - One channel control structure (page 608)
+typedef struct udma_control
+{
+    volatile uint32_t srcEnd;
+    volatile uint32_t dstEnd;
+    volatile uint32_t control;
+    volatile uint32_t unused;
+} udma_control_t;
+
+// Typedef struct - State of an assigned channel
+typedef struct udma_channel
+{
+    uint8_t channel;
+    udma_callback_t done;
+    udma_control_t tasks[UDMA_MAX_SEGMENTS]; // Task list for scatter/gather transmits
+} udma_channel_t;
+
+/* Channel control table, must be 1024 byte aligned (page 585) */
+#if defined(ccs)
+#pragma DATA_ALIGN(udma_table, 1024)
+static udma_control_t udma_table[2 * 32];
+#else
+static udma_control_t udma_table[2 * 32] __attribute__((aligned(1024)));
+#endif
+
+static udma_channel_t udma_channels[UDMA_MAX_CHANNELS];
+static uint8_t udma_numChannels;
+static volatile uint32_t udma_pending; // Channels with a transfer that has not been serviced
+
+/**
+ * Enable the uDMA controller and point it at the channel control table
+ * Safe to call more than once
+ */
+void udma_init(void)
+{
+    static uint8_t initialized = 0;
+
+    if (initialized) {
+        return;
+    }
+
+    SYSCTL_RCGCDMA_R |= SYSCTL_RCGCDMA_R0; // Turn on the uDMA clock
+    while ((SYSCTL_PRDMA_R & SYSCTL_PRDMA_R0) == 0); // Wait until it is ready
+
+    UDMA_CFG_R = UDMA_CFG_MASTEN;             // Enable the controller
+    UDMA_CTLBASE_R = (uint32_t)udma_table;    // Channel control table
+
+    initialized = 1;
+}
+
+/**
+ * Find the state of an assigned channel
+ */
+static udma_channel_t *udma_find(uint8_t channel)
+{
+    int i;
+
+    for (i = 0; i < udma_numChannels; i++) {
+        if (udma_channels[i].channel == channel) {
+            return &udma_channels[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Route a channel to a peripheral and register its completion callback
+ *
+ * @param channel - uDMA channel number (UDMA_CH_*)
+ * @param encoding - Peripheral encoding of the channel from Table 9-1
+ * @param done - Callback run when a transfer completes, may be NULL
+ *
+ * @returns 0 on success, -1 if no channel slots are left
+ */
+int udma_assign(uint8_t channel, uint8_t encoding, udma_callback_t done)
+{
+    udma_channel_t *state = udma_find(channel);
+    uint32_t bit = 1UL << channel;
+
+    if (state == NULL) {
+        if (udma_numChannels >= UDMA_MAX_CHANNELS) {
+            return -1;
+        }
+        state = &udma_channels[udma_numChannels++];
+        state->channel = channel;
+    }
+    state->done = done;
+
+    // Select the peripheral, 4 bits per channel across the CHMAPn registers (page 640)
+    volatile uint32_t *chmap = &UDMA_CHMAP0_R + (channel / 8);
+    uint32_t shift = (channel % 8) * 4;
+    *chmap = (*chmap & ~(0xFUL << shift)) | ((uint32_t)encoding << shift);
+
+    UDMA_ENACLR_R = bit;      // Not running yet
+    UDMA_ALTCLR_R = bit;      // Start from the primary structure
+    UDMA_PRIOCLR_R = bit;     // Default priority
+    UDMA_USEBURSTCLR_R = bit; // Accept single requests as well as bursts
+    UDMA_REQMASKCLR_R = bit;  // Let the peripheral request transfers
+
+    return 0;
+}
+
+/**
+ * Arm a channel whose primary control structure has been written
+ */
+static void udma_start(uint8_t channel)
+{
+    uint32_t bit = 1UL << channel;
+
+    udma_pending |= bit;
+    UDMA_CHIS_R = bit;   // Clear a stale completion
+    UDMA_ALTCLR_R = bit;
+    UDMA_ENASET_R = bit;
+}
+
+/**
+ * Copy bytes from memory into a peripheral data register
+ * The source buffer must stay untouched until the transfer completes
+ *
+ * @returns 0 when started, -1 if the channel is busy or the length is invalid
+ */
+int udma_transmit(uint8_t channel, const void *src, volatile uint32_t *dst, uint16_t length)
+{
+    if (length == 0 || length > UDMA_MAX_TRANSFER || udma_busy(channel)) {
+        return -1;
+    }
+
+    udma_control_t *primary = &udma_table[channel];
+    primary->srcEnd = (uint32_t)src + length - 1; // End pointers point at the last item
+    primary->dstEnd = (uint32_t)dst;
+    primary->control = UDMA_CHCTL_DSTINC_NONE | UDMA_CHCTL_DSTSIZE_8 |
+                       UDMA_CHCTL_SRCINC_8 | UDMA_CHCTL_SRCSIZE_8 |
+                       UDMA_CHCTL_ARBSIZE_4 |
+                       ((uint32_t)(length - 1) << UDMA_CHCTL_XFERSIZE_S) |
+                       UDMA_CHCTL_XFERMODE_BASIC;
+
+    udma_start(channel);
+    return 0;
+}
+
+/**
+ * Copy several buffers back to back into a peripheral data register (peripheral scatter/gather)
+ * The segment buffers must stay untouched until the transfer completes
+ *
+ * @returns 0 when started, -1 if the channel is busy or the segments are invalid
+ */
+int udma_transmitGather(uint8_t channel, const udma_segment_t *segments, uint8_t count, volatile uint32_t *dst)
+{
+    udma_channel_t *state = udma_find(channel);
+    int i;
+
+    if (state == NULL || count == 0 || count > UDMA_MAX_SEGMENTS || udma_busy(channel)) {
+        return -1;
+    }
+
+    // Each task is copied into the alternate structure and run there (page 598)
+    for (i = 0; i < count; i++)
+    {
+        if (segments[i].length == 0 || segments[i].length > UDMA_MAX_TRANSFER) {
+            return -1;
+        }
+
+        udma_control_t *task = &state->tasks[i];
+        task->srcEnd = (uint32_t)segments[i].data + segments[i].length - 1;
+        task->dstEnd = (uint32_t)dst;
+        task->control = UDMA_CHCTL_DSTINC_NONE | UDMA_CHCTL_DSTSIZE_8 |
+                        UDMA_CHCTL_SRCINC_8 | UDMA_CHCTL_SRCSIZE_8 |
+                        UDMA_CHCTL_ARBSIZE_4 |
+                        ((uint32_t)(segments[i].length - 1) << UDMA_CHCTL_XFERSIZE_S) |
+                        (i == count - 1 ? UDMA_CHCTL_XFERMODE_BASIC : UDMA_CHCTL_XFERMODE_PER_SGA);
+        task->unused = 0;
+    }
+
+    // The primary structure copies one 4 word task at a time into the alternate structure
+    udma_control_t *primary = &udma_table[channel];
+    primary->srcEnd = (uint32_t)&state->tasks[count - 1].unused;
+    primary->dstEnd = (uint32_t)&udma_table[UDMA_ALT_OFFSET + channel].unused;
+    primary->control = UDMA_CHCTL_DSTINC_32 | UDMA_CHCTL_DSTSIZE_32 |
+                       UDMA_CHCTL_SRCINC_32 | UDMA_CHCTL_SRCSIZE_32 |
+                       UDMA_CHCTL_ARBSIZE_4 |
+                       ((uint32_t)(count * 4 - 1) << UDMA_CHCTL_XFERSIZE_S) |
+                       UDMA_CHCTL_XFERMODE_PER_SG;
+
+    udma_start(channel);
+    return 0;
+}
+
+/**
+ * Copy bytes from a peripheral data register into memory
+ *
+ * @returns 0 when started, -1 if the channel is busy or the length is invalid
+ */
+int udma_receive(uint8_t channel, volatile uint32_t *src, void *dst, uint16_t length)
+{
+    if (length == 0 || length > UDMA_MAX_TRANSFER || udma_busy(channel)) {
+        return -1;
+    }
+
+    udma_control_t *primary = &udma_table[channel];
+    primary->srcEnd = (uint32_t)src;
+    primary->dstEnd = (uint32_t)dst + length - 1;
+    primary->control = UDMA_CHCTL_DSTINC_8 | UDMA_CHCTL_DSTSIZE_8 |
+                       UDMA_CHCTL_SRCINC_NONE | UDMA_CHCTL_SRCSIZE_8 |
+                       UDMA_CHCTL_ARBSIZE_1 |
+                       ((uint32_t)(length - 1) << UDMA_CHCTL_XFERSIZE_S) |
+                       UDMA_CHCTL_XFERMODE_BASIC;
+
+    udma_start(channel);
+    return 0;
+}
+
+/**
+ * @returns true while a transfer on the channel has not completed
+ */
+bool udma_busy(uint8_t channel)
+{
+    return (udma_pending & (1UL << channel)) != 0;
+}
+
+/**
+ * Stop a transfer that is not completing, its callback is not run
+ * Items already moved stay moved, the rest are not transferred
+ */
+void udma_abort(uint8_t channel)
+{
+    uint32_t bit = 1UL << channel;
+
+    bool was_disabled = IntMasterDisable();
+    UDMA_ENACLR_R = bit;
+    UDMA_CHIS_R = bit;
+    udma_pending &= ~bit;
+    if (!was_disabled) {
+        IntMasterEnable();
+    }
+}
+
+/**
+ * Acknowledge a completed transfer on the channel and run its callback
+ * Call from the ISR of the peripheral that owns the channel
+ */
+void udma_service(uint8_t channel)
+{
+    uint32_t bit = 1UL << channel;
+
+    bool was_disabled = IntMasterDisable();
+    bool complete = (udma_pending & bit) && (UDMA_CHIS_R & bit);
+    if (complete) {
+        UDMA_CHIS_R = bit; // Write 1 to clear
+        udma_pending &= ~bit;
+    }
+    if (!was_disabled) {
+        IntMasterEnable();
+    }
+
+    if (complete) {
+        udma_channel_t *state = udma_find(channel);
+        if (state != NULL && state->done != NULL) {
+            state->done(channel);
+        }
+    }
+}
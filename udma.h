@@ -0,0 +1,100 @@
+/*
+ * udma.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Channel manager for the TM4C123 micro DMA controller (datasheet chapter 9).
+ *  Drivers assign the channels of their peripheral once, then start
+ *  memory <-> peripheral transfers that complete in the background. Completion
+ *  is signalled on the peripheral's own interrupt vector, so the driver's ISR
+ *  must call udma_service() for each of its channels.
+ */
+
+#ifndef UDMA_H_
+#define UDMA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <inc/tm4c123gh6pm.h>
+
+/* Channel numbers and encodings from Table 9-1 */
+#define UDMA_CH_UART4_RX 18 // Encoding 2
+#define UDMA_CH_UART4_TX 19 // Encoding 2
+#define UDMA_CH_UART1_RX 22 // Encoding 0
+#define UDMA_CH_UART1_TX 23 // Encoding 0
+
+#define UDMA_MAX_TRANSFER 1024 // Items per control structure
+#define UDMA_MAX_CHANNELS 4    // Channels that can be assigned at once
+#define UDMA_MAX_SEGMENTS 4    // Segments in one scatter/gather transfer
+
+/**
+ * Called from the peripheral's ISR once a transfer on the channel has completed
+ */
+typedef void (*udma_callback_t)(uint8_t channel);
+
+// Typedef struct - One piece of a scatter/gather transmit
+typedef struct udma_segment
+{
+    const void *data;
+    uint16_t length;
+} udma_segment_t;
+
+/**
+ * Enable the uDMA controller and point it at the channel control table
+ * Safe to call more than once
+ */
+void udma_init(void);
+
+/**
+ * Route a channel to a peripheral and register its completion callback
+ *
+ * @param channel - uDMA channel number (UDMA_CH_*)
+ * @param encoding - Peripheral encoding of the channel from Table 9-1
+ * @param done - Callback run when a transfer completes, may be NULL
+ *
+ * @returns 0 on success, -1 if no channel slots are left
+ */
+int udma_assign(uint8_t channel, uint8_t encoding, udma_callback_t done);
+
+/**
+ * Copy bytes from memory into a peripheral data register
+ * The source buffer must stay untouched until the transfer completes
+ *
+ * @returns 0 when started, -1 if the channel is busy or the length is invalid
+ */
+int udma_transmit(uint8_t channel, const void *src, volatile uint32_t *dst, uint16_t length);
+
+/**
+ * Copy several buffers back to back into a peripheral data register (peripheral scatter/gather)
+ * The segment buffers must stay untouched until the transfer completes
+ *
+ * @returns 0 when started, -1 if the channel is busy or the segments are invalid
+ */
+int udma_transmitGather(uint8_t channel, const udma_segment_t *segments, uint8_t count, volatile uint32_t *dst);
+
+/**
+ * Copy bytes from a peripheral data register into memory
+ *
+ * @returns 0 when started, -1 if the channel is busy or the length is invalid
+ */
+int udma_receive(uint8_t channel, volatile uint32_t *src, void *dst, uint16_t length);
+
+/**
+ * @returns true while a transfer on the channel has not completed
+ */
+bool udma_busy(uint8_t channel);
+
+/**
+ * Stop a transfer that is not completing, its callback is not run
+ * Items already moved stay moved, the rest are not transferred
+ */
+void udma_abort(uint8_t channel);
+
+/**
+ * Acknowledge a completed transfer on the channel and run its callback
+ * Call from the ISR of the peripheral that owns the channel
+ */
+void udma_service(uint8_t channel);
+
+#endif /* UDMA_H_ */
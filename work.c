@@ -0,0 +1,128 @@
+/*
+ * work.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ */
+
+#include "work.h"
+#include "profile.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "driverlib/interrupt.h"
+
+// Typedef struct - One deferred function call
+typedef struct work_item
+{
+    work_fn_t fn;
+    uint32_t arg;
+} work_item_t;
+
+// Typedef struct - Ring of work items of one priority
+typedef struct work_queue
+{
+    work_item_t items[WORK_QUEUE_SIZE];
+    volatile uint32_t head;  // Next item to write
+    volatile uint32_t tail;  // Next item to run
+} work_queue_t;
+
+static work_queue_t work_queues[WORK_NUM_PRIOS];
+static volatile uint32_t work_droppedCount;
+
+/**
+ * Empty every queue
+ */
+void work_init(void)
+{
+    int i;
+
+    for (i = 0; i < WORK_NUM_PRIOS; i++) {
+        work_queues[i].head = 0;
+        work_queues[i].tail = 0;
+    }
+    work_droppedCount = 0;
+}
+
+/**
+ * Queue a function to be run by work_run(), safe to call from an ISR
+ *
+ * @param fn - Function to run
+ * @param arg - Argument passed to fn
+ * @param prio - Queue to use, higher priorities run first
+ *
+ * @returns 0 on success, -1 if the queue is full (the item is dropped and counted)
+ */
+int work_post(work_fn_t fn, uint32_t arg, work_priority_t prio)
+{
+    work_queue_t *queue = &work_queues[prio];
+    int result = 0;
+
+    bool was_disabled = IntMasterDisable();
+    if (queue->head - queue->tail >= WORK_QUEUE_SIZE) {
+        work_droppedCount++;
+        result = -1;
+    } else {
+        work_item_t *item = &queue->items[queue->head & (WORK_QUEUE_SIZE - 1)];
+        item->fn = fn;
+        item->arg = arg;
+        queue->head++;
+    }
+    if (!was_disabled) {
+        IntMasterEnable();
+    }
+
+    return result;
+}
+
+/**
+ * Take the next item of the highest priority that has one
+ *
+ * @returns false if every queue is empty
+ */
+static bool work_take(work_item_t *item)
+{
+    int i;
+    bool found = false;
+
+    bool was_disabled = IntMasterDisable();
+    for (i = 0; i < WORK_NUM_PRIOS && !found; i++)
+    {
+        work_queue_t *queue = &work_queues[i];
+        if (queue->tail != queue->head) {
+            *item = queue->items[queue->tail & (WORK_QUEUE_SIZE - 1)];
+            queue->tail++;
+            found = true;
+        }
+    }
+    if (!was_disabled) {
+        IntMasterEnable();
+    }
+
+    return found;
+}
+
+/**
+ * Run every queued item in priority order, call from the main loop
+ * Items posted while running are run before returning
+ */
+void work_run(void)
+{
+    work_item_t item;
+
+    // Re-pick after every item so a new high priority item overtakes queued low ones
+    while (work_take(&item))
+    {
+        PROFILE_BEGIN(WORK_ITEM);
+        item.fn(item.arg);
+        PROFILE_END(WORK_ITEM);
+    }
+}
+
+/**
+ * @returns the number of items dropped because their queue was full
+ */
+uint32_t work_dropped(void)
+{
+    return work_droppedCount;
+}
@@ -0,0 +1,62 @@
+/*
+ * work.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: CyBot Conquerors
+ *
+ *  Bottom halves for the interrupt handlers. An ISR only captures its data
+ *  and posts a work item; the main loop runs the queued items at thread
+ *  level through work_run(), highest priority first, so slow work (OI
+ *  commands, LCD writes, songs) never delays the PING capture or the clock
+ *  tick. Worst-case ISR durations show up in the 'p' profile dump.
+ */
+
+#ifndef WORK_H_
+#define WORK_H_
+
+#include <stdint.h>
+
+// Items each priority can hold (power of two)
+#define WORK_QUEUE_SIZE 16
+
+/**
+ * Function run at thread level with the argument given to work_post()
+ */
+typedef void (*work_fn_t)(uint32_t arg);
+
+typedef enum
+{
+    WORK_PRIO_HIGH = 0,   // Safety (stopping the motors)
+    WORK_PRIO_NORMAL = 1, // Reactions to user input
+    WORK_PRIO_LOW = 2,    // Cosmetic (LCD, songs)
+    WORK_NUM_PRIOS
+} work_priority_t;
+
+/**
+ * Empty every queue
+ */
+void work_init(void);
+
+/**
+ * Queue a function to be run by work_run(), safe to call from an ISR
+ *
+ * @param fn - Function to run
+ * @param arg - Argument passed to fn
+ * @param prio - Queue to use, higher priorities run first
+ *
+ * @returns 0 on success, -1 if the queue is full (the item is dropped and counted)
+ */
+int work_post(work_fn_t fn, uint32_t arg, work_priority_t prio);
+
+/**
+ * Run every queued item in priority order, call from the main loop
+ * Items posted while running are run before returning
+ */
+void work_run(void);
+
+/**
+ * @returns the number of items dropped because their queue was full
+ */
+uint32_t work_dropped(void);
+
+#endif /* WORK_H_ */